@@ -0,0 +1,246 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+
+/**
+ * DB TILE BENCHMARK - SIMDIS SDK
+ *
+ * Measures tile read throughput from a SIMDIS 9 SQLite .db file.  Writes a synthetic .db with a
+ * square grid of tiles, then reads every tile back with SQLiteDataBaseReadUtil::readDataBuffer()
+ * on a shared connection, and with SQLiteTileReader on its pool of connections, both with and
+ * without background prefetch of neighboring tiles.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "sqlite3.h"
+#include "simCore/Common/Version.h"
+#include "simCore/System/ThreadPool.h"
+#include "simCore/Time/Utils.h"
+#include "simVis/DB/QSCommon.h"
+#include "simVis/DB/QSNodeID96.h"
+#include "simVis/DB/SQLiteDataBaseReadUtil.h"
+#include "simVis/DB/SQLiteTileReader.h"
+
+using namespace simVis_db;
+
+namespace
+{
+
+/** Node ID of the tile at grid position (x, y); any unique ID serves for reading */
+QSNodeId tileNodeId(unsigned int x, unsigned int y, unsigned int tilesPerSide)
+{
+  return QSNodeId(y * tilesPerSide + x);
+}
+
+/** Stand-in for decoding a tile: a checksum over its bytes, which also verifies the tile's content */
+uint64_t decodeTile(const TextureDataType* data, uint32_t dataSize)
+{
+  uint64_t sum = 0;
+  for (uint32_t k = 0; k < dataSize; ++k)
+    sum = sum * 31 + data[k];
+  return sum;
+}
+
+/** Writes a table of tilesPerSide x tilesPerSide tiles of pseudo-random bytes, returning the sum of the tile checksums */
+int writeSyntheticDb(const std::string& fileName, unsigned int tilesPerSide, uint32_t tileBytes, uint64_t& checksum)
+{
+  std::remove(fileName.c_str());
+  sqlite3* db = nullptr;
+  if (sqlite3_open_v2(fileName.c_str(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK)
+  {
+    std::cerr << "Unable to create " << fileName << "\n";
+    sqlite3_close(db);
+    return 1;
+  }
+  sqlite3_exec(db, "CREATE TABLE \"default\" (id BLOB PRIMARY KEY, data BLOB); BEGIN;", nullptr, nullptr, nullptr);
+
+  sqlite3_stmt* stmt = nullptr;
+  sqlite3_prepare_v2(db, "INSERT INTO \"default\" VALUES (?, ?)", -1, &stmt, nullptr);
+  std::vector<TextureDataType> tile(tileBytes);
+  uint32_t seed = 12345;
+  checksum = 0;
+  for (unsigned int y = 0; y < tilesPerSide; ++y)
+  {
+    for (unsigned int x = 0; x < tilesPerSide; ++x)
+    {
+      for (uint32_t k = 0; k < tileBytes; ++k)
+      {
+        seed = seed * 1103515245 + 12345;
+        tile[k] = static_cast<TextureDataType>(seed >> 16);
+      }
+      checksum += decodeTile(tile.data(), tileBytes);
+      const std::string tileId = SQLiteTileReader::packTileId(0, tileNodeId(x, y, tilesPerSide));
+      sqlite3_bind_blob(stmt, 1, tileId.data(), static_cast<int>(tileId.size()), SQLITE_STATIC);
+      sqlite3_bind_blob(stmt, 2, tile.data(), static_cast<int>(tileBytes), SQLITE_STATIC);
+      sqlite3_step(stmt);
+      sqlite3_reset(stmt);
+    }
+  }
+  sqlite3_finalize(stmt);
+  const int rv = sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+  sqlite3_close(db);
+  return (rv == SQLITE_OK) ? 0 : 1;
+}
+
+/** Reports the rate for a pass and whether its checksum matches the written tiles */
+int report(const std::string& name, double elapsedSeconds, size_t numTiles, uint64_t checksum, uint64_t expectedChecksum)
+{
+  std::cout << "  " << name << ": " << static_cast<size_t>(numTiles / elapsedSeconds) << " tiles/s ("
+    << elapsedSeconds * 1000.0 << " ms)";
+  if (checksum != expectedChecksum)
+  {
+    std::cout << " CHECKSUM MISMATCH" << std::endl;
+    return 1;
+  }
+  std::cout << std::endl;
+  return 0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  simCore::checkVersionThrow();
+
+  std::string fileName = "dbtilebenchmark.db";
+  unsigned int tilesPerSide = 64;
+  uint32_t tileBytes = 16384;
+  unsigned int numThreads = 4;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--tiles" && i + 1 < argc)
+      tilesPerSide = static_cast<unsigned int>(std::stoul(argv[++i]));
+    else if (arg == "--tile-bytes" && i + 1 < argc)
+      tileBytes = static_cast<uint32_t>(std::stoul(argv[++i]));
+    else if (arg == "--threads" && i + 1 < argc)
+      numThreads = static_cast<unsigned int>(std::stoul(argv[++i]));
+    else if (arg == "--file" && i + 1 < argc)
+      fileName = argv[++i];
+    else
+    {
+      std::cout << "USAGE: example_dbtilebenchmark [--file <dbfile>] [--tiles <tiles per side>] [--tile-bytes <bytes>] [--threads <count>]" << std::endl;
+      return 1;
+    }
+  }
+
+  uint64_t expectedChecksum = 0;
+  if (tilesPerSide == 0 || tileBytes == 0 || writeSyntheticDb(fileName, tilesPerSide, tileBytes, expectedChecksum) != 0)
+    return 1;
+  const size_t numTiles = static_cast<size_t>(tilesPerSide) * tilesPerSide;
+  std::cout << "Reading " << numTiles << " tiles of " << tileBytes << " bytes from " << fileName << std::endl;
+
+  std::vector<unsigned int> threadCounts(1, 1);
+  if (numThreads > 1)
+    threadCounts.push_back(numThreads);
+
+  int rv = 0;
+  for (unsigned int threads : threadCounts)
+  {
+    std::cout << threads << " thread(s):" << std::endl;
+    simCore::ThreadPool pool(threads);
+    std::vector<uint64_t> sums(threads);
+
+    // Baseline: statement prepared, data copied and statement finalized for each tile, on one shared connection
+    {
+      SQLiteDataBaseReadUtil dbUtil;
+      sqlite3* db = nullptr;
+      dbUtil.openDatabaseFile(fileName, &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX);
+      std::fill(sums.begin(), sums.end(), 0);
+      const double startTime = simCore::getSystemTime();
+      size_t chunk = 0;
+      std::mutex chunkMutex;
+      pool.parallelFor(numTiles, [&](size_t beginIndex, size_t endIndex) {
+        size_t myChunk;
+        {
+          std::lock_guard<std::mutex> lock(chunkMutex);
+          myChunk = chunk++;
+        }
+        TextureDataType* buffer = nullptr;
+        uint32_t bufferSize = 0;
+        for (size_t k = beginIndex; k < endIndex; ++k)
+        {
+          uint32_t rasterSize = 0;
+          const unsigned int x = static_cast<unsigned int>(k % tilesPerSide);
+          const unsigned int y = static_cast<unsigned int>(k / tilesPerSide);
+          if (dbUtil.readDataBuffer(db, fileName, "default", 0, tileNodeId(x, y, tilesPerSide), &buffer, &bufferSize, &rasterSize, false) == QS_IS_OK)
+            sums[myChunk] += decodeTile(buffer, rasterSize);
+        }
+        delete[] buffer;
+      });
+      uint64_t checksum = 0;
+      for (uint64_t sum : sums)
+        checksum += sum;
+      rv += report("readDataBuffer", simCore::getSystemTime() - startTime, numTiles, checksum, expectedChecksum);
+      sqlite3_close(db);
+    }
+
+    // Per-thread connections with prepared statements, decoding in place; with and without neighbor prefetch
+    for (int withPrefetch = 0; withPrefetch < 2; ++withPrefetch)
+    {
+      SQLiteTileReader reader(fileName, "default");
+      if (withPrefetch)
+        reader.setPrefetchCacheSize(64 * 1024 * 1024);
+      std::fill(sums.begin(), sums.end(), 0);
+      const double startTime = simCore::getSystemTime();
+      size_t chunk = 0;
+      std::mutex chunkMutex;
+      pool.parallelFor(numTiles, [&](size_t beginIndex, size_t endIndex) {
+        size_t myChunk;
+        {
+          std::lock_guard<std::mutex> lock(chunkMutex);
+          myChunk = chunk++;
+        }
+        for (size_t k = beginIndex; k < endIndex; ++k)
+        {
+          const unsigned int x = static_cast<unsigned int>(k % tilesPerSide);
+          const unsigned int y = static_cast<unsigned int>(k / tilesPerSide);
+          reader.readTile(0, tileNodeId(x, y, tilesPerSide), [&](const TextureDataType* data, uint32_t dataSize) {
+            sums[myChunk] += decodeTile(data, dataSize);
+          });
+          // Sweeping row by row, the tiles ahead on this row and the next row are needed next
+          if (withPrefetch)
+          {
+            if (x + 1 < tilesPerSide)
+              reader.prefetch(0, tileNodeId(x + 1, y, tilesPerSide));
+            if (y + 1 < tilesPerSide)
+              reader.prefetch(0, tileNodeId(x, y + 1, tilesPerSide));
+          }
+        }
+      });
+      uint64_t checksum = 0;
+      for (uint64_t sum : sums)
+        checksum += sum;
+      const std::string name = withPrefetch ? "SQLiteTileReader with prefetch" : "SQLiteTileReader";
+      rv += report(name, simCore::getSystemTime() - startTime, numTiles, checksum, expectedChecksum);
+      if (withPrefetch)
+        std::cout << "    prefetch hits: " << reader.numPrefetchHits() << std::endl;
+    }
+  }
+
+  std::remove(fileName.c_str());
+  return rv;
+}
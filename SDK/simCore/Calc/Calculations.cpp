@@ -25,6 +25,7 @@
 #include <iomanip>
 #include <iostream>
 #include <algorithm>
+#include <vector>
 #include <time.h>
 
 #include "simNotify/Notify.h"
@@ -34,6 +35,8 @@
 #include "simCore/Calc/CoordinateConverter.h"
 #include "simCore/Calc/CoordinateSystem.h"
 #include "simCore/Calc/Calculations.h"
+#include "simCore/Calc/CoordConvertSimd.h"
+#include "simCore/System/ThreadPool.h"
 
 namespace
 {
@@ -439,6 +442,155 @@ double calculateBearingRate(const Vec3 &fromLla, const Vec3 &fromOriLla, const V
     sin(bearing) / range;
 }
 
+/// Calculates relative geometry between every pair of from and to entities
+int calculateRelativeGeometry(size_t fromCount, const Vec3* fromLla, const Vec3* fromOriLla, const Vec3* fromVel,
+  size_t toCount, const Vec3* toLla, const Vec3* toOriLla, const Vec3* toVel,
+  const EarthModelCalculations model, const CoordinateConverter* coordConv, const RelativeGeometryOutputs& outputs, ThreadPool* pool)
+{
+  const bool needBody = (outputs.azim || outputs.elev || outputs.cmp || outputs.rangeRate);
+  if ((fromCount && !fromLla) || (toCount && !toLla) || (fromCount && needBody && !fromOriLla) ||
+    (outputs.rangeRate && ((fromCount && !fromVel) || (toCount && (!toOriLla || !toVel)))))
+  {
+    SIM_ERROR << "calculateRelativeGeometry, missing input arrays: " << __LINE__ << std::endl;
+    return 1;
+  }
+  if (model == FLAT_EARTH && (!coordConv || !coordConv->hasReferenceOrigin()))
+  {
+    SIM_WARN << "Could not calculate relative geometry, CoordinateConverter not set for FLAT_EARTH: " << __LINE__ << std::endl;
+    return 1;
+  }
+  if (model != WGS_84 && model != TANGENT_PLANE_WGS_84 && model != FLAT_EARTH)
+  {
+    SIM_WARN << "Could not calculate relative geometry, unsupported earth model: " << __LINE__ << std::endl;
+    return 1;
+  }
+  if (fromCount == 0 || toCount == 0)
+    return 0;
+
+  // Convert every position once into a common frame; ECEF for the WGS-84 models, ENU for flat earth
+  std::vector<double> fromX(fromCount), fromY(fromCount), fromZ(fromCount);
+  std::vector<double> toX(toCount), toY(toCount), toZ(toCount);
+  const auto toCommonFrame = [model, coordConv](size_t count, const Vec3* lla, double* x, double* y, double* z) {
+    if (model == FLAT_EARTH)
+    {
+      Coordinate enu;
+      for (size_t k = 0; k < count; ++k)
+      {
+        if (coordConv->convert(Coordinate(COORD_SYS_LLA, lla[k]), enu, COORD_SYS_ENU) != 0)
+          return 1;
+        x[k] = enu.x();
+        y[k] = enu.y();
+        z[k] = enu.z();
+      }
+      return 0;
+    }
+    for (size_t k = 0; k < count; ++k)
+    {
+      x[k] = lla[k].lat();
+      y[k] = lla[k].lon();
+      z[k] = lla[k].alt();
+    }
+    CoordinateConverter::convertGeodeticPosToEcef(count, x, y, z, x, y, z);
+    return 0;
+  };
+  if (toCommonFrame(fromCount, fromLla, fromX.data(), fromY.data(), fromZ.data()) != 0 ||
+    toCommonFrame(toCount, toLla, toX.data(), toY.data(), toZ.data()) != 0)
+  {
+    SIM_ERROR << "calculateRelativeGeometry, unable to convert positions: " << __LINE__ << std::endl;
+    return 1;
+  }
+
+  // Per-source frames: common frame to local ENU, then ENU to NED, then NED to body
+  std::vector<RelativeGeometryFrame> frames(fromCount);
+  for (size_t i = 0; i < fromCount; ++i)
+  {
+    RelativeGeometryFrame& frame = frames[i];
+    frame.origin[0] = fromX[i];
+    frame.origin[1] = fromY[i];
+    frame.origin[2] = fromZ[i];
+
+    // Same ENU rotation as the X-East tangent plane in CoordinateConverter::setReferenceOrigin()
+    double enu[3][3] = { { 1., 0., 0. }, { 0., 1., 0. }, { 0., 0., 1. } };
+    if (model != FLAT_EARTH)
+    {
+      const double sinLat = sin(fromLla[i].lat());
+      const double cosLat = cos(fromLla[i].lat());
+      const double sinLon = sin(fromLla[i].lon());
+      const double cosLon = cos(fromLla[i].lon());
+      const double rotation[3][3] = {
+        { -sinLon, cosLon, 0. },
+        { -sinLat * cosLon, -sinLat * sinLon, cosLat },
+        { cosLat * cosLon, cosLat * sinLon, sinLat } };
+      std::copy(&rotation[0][0], &rotation[0][0] + 9, &enu[0][0]);
+    }
+    std::copy(&enu[0][0], &enu[0][0] + 6, &frame.toLocal[0][0]);
+
+    double dcm[3][3] = { { 1., 0., 0. }, { 0., 1., 0. }, { 0., 0., 1. } };
+    if (needBody)
+      d3EulertoDCM(fromOriLla[i], dcm);
+    const double ned[3][3] = {
+      { enu[1][0], enu[1][1], enu[1][2] },
+      { enu[0][0], enu[0][1], enu[0][2] },
+      { -enu[2][0], -enu[2][1], -enu[2][2] } };
+    d3MMmult(dcm, ned, frame.toBody);
+    // calculateRelAng() points along north for coincident positions
+    frame.boresight[0] = dcm[0][0];
+    frame.boresight[1] = dcm[1][0];
+    frame.boresight[2] = dcm[2][0];
+
+    const double speed = outputs.rangeRate ? fromVel[i].length() : 0.;
+    frame.velCos = needBody ? speed * cos(fromOriLla[i].yaw()) : 0.;
+    frame.velSin = needBody ? speed * sin(fromOriLla[i].yaw()) : 0.;
+  }
+
+  std::vector<double> toVelCos;
+  std::vector<double> toVelSin;
+  if (outputs.rangeRate)
+  {
+    toVelCos.resize(toCount);
+    toVelSin.resize(toCount);
+    for (size_t j = 0; j < toCount; ++j)
+    {
+      const double speed = toVel[j].length();
+      toVelCos[j] = speed * cos(toOriLla[j].yaw());
+      toVelSin[j] = speed * sin(toOriLla[j].yaw());
+    }
+  }
+
+  // Work is split into blocks of 'to' entities, so that few sources still spread across threads
+  const size_t BLOCK_SIZE = 1024;
+  const size_t blocksPerRow = (toCount + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  const CoordConvertKernels& kernels = activeCoordConvertKernels();
+  // WGS-84 ground distance is geodesic, not a tangent plane distance
+  double* const kernelGround = (model == WGS_84) ? nullptr : outputs.ground;
+  const auto evaluateBlocks = [&](size_t beginBlock, size_t endBlock) {
+    for (size_t block = beginBlock; block < endBlock; ++block)
+    {
+      const size_t i = block / blocksPerRow;
+      const size_t j = (block % blocksPerRow) * BLOCK_SIZE;
+      const size_t count = std::min(BLOCK_SIZE, toCount - j);
+      const size_t offset = i * toCount + j;
+      const auto at = [offset](double* out) { return out ? out + offset : nullptr; };
+      kernels.relativeGeometry(frames[i], count, &toX[j], &toY[j], &toZ[j],
+        outputs.rangeRate ? &toVelCos[j] : nullptr, outputs.rangeRate ? &toVelSin[j] : nullptr,
+        at(outputs.azim), at(outputs.elev), at(outputs.cmp), at(outputs.slant), at(kernelGround), at(outputs.rangeRate));
+
+      if (outputs.ground && !kernelGround)
+      {
+        for (size_t k = 0; k < count; ++k)
+          outputs.ground[offset + k] = sodanoInverse(fromLla[i][0], fromLla[i][1], 0., toLla[j + k][0], toLla[j + k][1]);
+      }
+    }
+  };
+
+  const size_t numBlocks = fromCount * blocksPerRow;
+  if (pool)
+    pool->parallelFor(numBlocks, evaluateBlocks);
+  else
+    evaluateBlocks(0, numBlocks);
+  return 0;
+}
+
 /**
 * Calculates the aspect angle between two objects in space in the given coordinate system.  Aspect angle is the angle between
 * the line of sight of the 'from' entity to the 'to' entity and the longitudinal axis of the 'to' entity.
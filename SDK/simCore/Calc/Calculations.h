@@ -36,6 +36,8 @@
 
 namespace simCore
 {
+  class ThreadPool;
+
   /**
   * @brief Calculates the relative azimuth, elevation, and composite angles between two entities
   *
@@ -211,6 +213,54 @@ namespace simCore
   */
   SDKCORE_EXPORT double calculateBearingRate(const Vec3 &fromLla, const Vec3 &fromOriLla, const Vec3 &toLla, const Vec3 &toOriLla, const EarthModelCalculations model, const CoordinateConverter* coordConv, const Vec3 &fromVel, const Vec3 &toVel);
 
+  /**
+  * Output arrays for calculateRelativeGeometry().  Each non-null array holds fromCount * toCount
+  * values in row major order, so the result for from[i] and to[j] is at index i * toCount + j.
+  * Outputs that are nullptr are not calculated.
+  */
+  struct RelativeGeometryOutputs
+  {
+    double* azim = nullptr;       ///< Relative azimuth along the from's line of sight, as in calculateRelAzEl()
+    double* elev = nullptr;       ///< Relative elevation along the from's line of sight, as in calculateRelAzEl()
+    double* cmp = nullptr;        ///< Composite angle along the from's line of sight, as in calculateRelAzEl()
+    double* slant = nullptr;      ///< Slant distance, as in calculateSlant()
+    double* ground = nullptr;     ///< Ground distance, as in calculateGroundDist()
+    double* rangeRate = nullptr;  ///< Range rate, as in calculateRangeRate()
+  };
+
+  /**
+  * @brief Calculates relative geometry between every pair of a set of 'from' and a set of 'to' entities
+  *
+  * Batch form of calculateRelAzEl(), calculateSlant(), calculateGroundDist() and calculateRangeRate() for
+  * fromCount * toCount pairs.  Each position is converted once rather than once per pair, the per-source
+  * tangent plane and body rotation are set up once per 'from' entity, and pairs are evaluated with SIMD
+  * instructions over the 'to' entities.  Ground distance on WGS_84 uses sodanoInverse() for each pair,
+  * exactly as calculateGroundDist() does.
+  *
+  * Results match the single pair functions to within 1e-9 radians for azimuth and elevation, 1e-7 radians
+  * for the composite angle (the single pair function loses precision near boresight), 1e-6 meters for
+  * distances and 1e-6 m/sec for range rate.  Tangent plane offsets on coordConv are ignored for
+  * TANGENT_PLANE_WGS_84, and PERFECT_SPHERE is not supported.  For FLAT_EARTH, range rate uses the
+  * bearing in coordConv's frame, the same as azim; calculateRangeRate() instead uses a flat earth
+  * referenced to the 'from' position.
+  * @param[in ] fromCount Number of 'from' entities
+  * @param[in ] fromLla Array of fromCount 'from' positions in latitude, longitude, and altitude
+  * @param[in ] fromOriLla Array of fromCount 'from' yaw, pitch, roll; required for angles and range rate
+  * @param[in ] fromVel Array of fromCount 'from' velocities in m/s in an LLA frame; required for range rate
+  * @param[in ] toCount Number of 'to' entities
+  * @param[in ] toLla Array of toCount 'to' positions in latitude, longitude, and altitude
+  * @param[in ] toOriLla Array of toCount 'to' yaw, pitch, roll; required for range rate
+  * @param[in ] toVel Array of toCount 'to' velocities in m/s in an LLA frame; required for range rate
+  * @param[in ] model Earth model to perform the calculation in
+  * @param[in ] coordConv If model is flat earth, then this must point to an initialized CoordinateConverter structure with a reference origin set. Ignored for WGS84 models
+  * @param[out] outputs Arrays to fill in; see RelativeGeometryOutputs
+  * @param[in ] pool If not nullptr, pairs are split across the threads of the pool
+  * @return 0 on success, non-zero if the model is not supported or a required input is missing
+  */
+  SDKCORE_EXPORT int calculateRelativeGeometry(size_t fromCount, const Vec3* fromLla, const Vec3* fromOriLla, const Vec3* fromVel,
+    size_t toCount, const Vec3* toLla, const Vec3* toOriLla, const Vec3* toVel,
+    const EarthModelCalculations model, const CoordinateConverter* coordConv, const RelativeGeometryOutputs& outputs, ThreadPool* pool = nullptr);
+
   /**
   * @brief Calculates the aspect angle between two entities
   *
@@ -0,0 +1,79 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include "simCore/Calc/CoordConvertSimd.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace simCore {
+
+namespace
+{
+
+/** Returns true if the processor and operating system support AVX2 and FMA */
+bool hasAvx2()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  const bool fma = (info[2] & (1 << 12)) != 0;
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  // Operating system must save the YMM registers
+  if (!fma || !osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+  return false;
+#endif
+}
+
+const CoordConvertKernels& selectCoordConvertKernels()
+{
+  const CoordConvertKernels* avx2 = avx2CoordConvertKernels();
+  if (avx2 && hasAvx2())
+    return *avx2;
+#ifdef SIMCORE_COORDCONVERT_SSE2
+  return makeCoordConvertKernels<F64x2>("SSE2");
+#else
+  return makeCoordConvertKernels<F64x1>("Scalar");
+#endif
+}
+
+}
+
+const CoordConvertKernels& activeCoordConvertKernels()
+{
+  static const CoordConvertKernels& kernels = selectCoordConvertKernels();
+  return kernels;
+}
+
+}
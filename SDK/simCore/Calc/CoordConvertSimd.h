@@ -0,0 +1,568 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_CALC_COORDCONVERTSIMD_H
+#define SIMCORE_CALC_COORDCONVERTSIMD_H
+
+// Private header for the batch coordinate conversion kernels in CoordinateConverter, and the batch
+// relative geometry kernel in Calculations.  The kernels
+// are written once against a small packed-double interface, and instantiated for plain doubles,
+// SSE2 and AVX2.  Everything here has internal linkage, because the AVX2 instantiation lives in a
+// translation unit compiled with different code generation flags; shared inline symbols could
+// otherwise resolve to AVX2 code on processors without AVX2.
+
+#include <cmath>
+#include <cstddef>
+#include "simCore/Calc/CoordinateSystem.h"
+#include "simCore/Calc/MathConstants.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMCORE_COORDCONVERT_SSE2
+#endif
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define SIMCORE_COORDCONVERT_AVX2
+#endif
+
+namespace simCore {
+
+/** Per-origin constants for the relativeGeometry kernel */
+struct RelativeGeometryFrame
+{
+  /** Origin position, in the frame of the points */
+  double origin[3];
+  /** Rotates an offset from the origin into the origin's body frame (X forward, Y right, Z down) */
+  double toBody[3][3];
+  /** Rotates an offset from the origin into the local east and north axes, for ground distance */
+  double toLocal[2][3];
+  /** Body frame direction used for points that coincide with the origin */
+  double boresight[3];
+  /** Origin speed times cos of its yaw */
+  double velCos;
+  /** Origin speed times sin of its yaw */
+  double velSin;
+};
+
+/** Table of batch conversion kernels for one instruction set; all arrays hold count values */
+struct CoordConvertKernels
+{
+  /** Name of the instruction set, for diagnostics */
+  const char* name;
+  /** Geodetic (rad, rad, m) to ECEF (m) */
+  void (*geodeticToEcef)(size_t count, const double* lat, const double* lon, const double* alt,
+    double* x, double* y, double* z, double semiMajor, double eccentricitySquared);
+  /** ECEF (m) to geodetic (rad, rad, m) on WGS-84 */
+  void (*ecefToGeodetic)(size_t count, const double* x, const double* y, const double* z,
+    double* lat, double* lon, double* alt);
+  /** Rotates about the Z axis by rate * time[i], as in ECI and ECEF conversions */
+  void (*rotateZ)(size_t count, const double* time, double rate, const double* x, const double* y,
+    double* outX, double* outY);
+  /**
+   * Relative angles and distances from one origin to count points, as in calculateRelAzEl(),
+   * calculateSlant(), calculateGroundDist() and calculateRangeRate().  Points are in the frame
+   * of the origin; velCos and velSin hold speed times cos and sin of each point's yaw.  Any
+   * output may be nullptr; velCos and velSin are only read when rangeRate is set.
+   */
+  void (*relativeGeometry)(const RelativeGeometryFrame& frame, size_t count, const double* x, const double* y, const double* z,
+    const double* velCos, const double* velSin, double* azim, double* elev, double* cmp, double* slant, double* ground, double* rangeRate);
+};
+
+/** Returns the best kernels supported by the processor; selected on first call */
+const CoordConvertKernels& activeCoordConvertKernels();
+/** Returns the AVX2 kernels if compiled in, else nullptr; does not check processor support */
+const CoordConvertKernels* avx2CoordConvertKernels();
+
+namespace {
+
+/** Packed double interface for plain scalar code */
+struct F64x1
+{
+  enum { WIDTH = 1 };
+  typedef bool Mask;
+  double v;
+
+  F64x1() : v(0.0) {}
+  F64x1(double d) : v(d) {}
+  static F64x1 load(const double* p) { return F64x1(*p); }
+  void store(double* p) const { *p = v; }
+};
+inline F64x1 operator+(F64x1 a, F64x1 b) { return a.v + b.v; }
+inline F64x1 operator-(F64x1 a, F64x1 b) { return a.v - b.v; }
+inline F64x1 operator*(F64x1 a, F64x1 b) { return a.v * b.v; }
+inline F64x1 operator/(F64x1 a, F64x1 b) { return a.v / b.v; }
+inline F64x1 operator-(F64x1 a) { return -a.v; }
+inline bool operator<(F64x1 a, F64x1 b) { return a.v < b.v; }
+inline bool operator>(F64x1 a, F64x1 b) { return a.v > b.v; }
+inline bool operator==(F64x1 a, F64x1 b) { return a.v == b.v; }
+inline F64x1 mulAdd(F64x1 a, F64x1 b, F64x1 c) { return a.v * b.v + c.v; }
+inline F64x1 vsqrt(F64x1 a) { return std::sqrt(a.v); }
+inline F64x1 vabs(F64x1 a) { return std::fabs(a.v); }
+inline F64x1 vround(F64x1 a) { return std::nearbyint(a.v); }
+inline F64x1 vselect(bool m, F64x1 a, F64x1 b) { return m ? a : b; }
+inline bool vany(bool m) { return m; }
+
+#ifdef SIMCORE_COORDCONVERT_SSE2
+/** Mask for F64x2, all bits set in true lanes */
+struct M64x2
+{
+  __m128d m;
+};
+inline M64x2 operator&(M64x2 a, M64x2 b) { return { _mm_and_pd(a.m, b.m) }; }
+inline M64x2 operator|(M64x2 a, M64x2 b) { return { _mm_or_pd(a.m, b.m) }; }
+inline M64x2 operator^(M64x2 a, M64x2 b) { return { _mm_xor_pd(a.m, b.m) }; }
+inline M64x2 operator!(M64x2 a) { return { _mm_xor_pd(a.m, _mm_castsi128_pd(_mm_set1_epi32(-1))) }; }
+inline bool vany(M64x2 a) { return _mm_movemask_pd(a.m) != 0; }
+
+/** Packed double interface for 2 lanes of SSE2 */
+struct F64x2
+{
+  enum { WIDTH = 2 };
+  typedef M64x2 Mask;
+  __m128d v;
+
+  F64x2() : v(_mm_setzero_pd()) {}
+  F64x2(double d) : v(_mm_set1_pd(d)) {}
+  F64x2(__m128d m) : v(m) {}
+  static F64x2 load(const double* p) { return _mm_loadu_pd(p); }
+  void store(double* p) const { _mm_storeu_pd(p, v); }
+};
+inline F64x2 operator+(F64x2 a, F64x2 b) { return _mm_add_pd(a.v, b.v); }
+inline F64x2 operator-(F64x2 a, F64x2 b) { return _mm_sub_pd(a.v, b.v); }
+inline F64x2 operator*(F64x2 a, F64x2 b) { return _mm_mul_pd(a.v, b.v); }
+inline F64x2 operator/(F64x2 a, F64x2 b) { return _mm_div_pd(a.v, b.v); }
+inline F64x2 operator-(F64x2 a) { return _mm_xor_pd(a.v, _mm_set1_pd(-0.0)); }
+inline M64x2 operator<(F64x2 a, F64x2 b) { return { _mm_cmplt_pd(a.v, b.v) }; }
+inline M64x2 operator>(F64x2 a, F64x2 b) { return { _mm_cmpgt_pd(a.v, b.v) }; }
+inline M64x2 operator==(F64x2 a, F64x2 b) { return { _mm_cmpeq_pd(a.v, b.v) }; }
+inline F64x2 mulAdd(F64x2 a, F64x2 b, F64x2 c) { return _mm_add_pd(_mm_mul_pd(a.v, b.v), c.v); }
+inline F64x2 vsqrt(F64x2 a) { return _mm_sqrt_pd(a.v); }
+inline F64x2 vabs(F64x2 a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a.v); }
+inline F64x2 vround(F64x2 a)
+{
+  // SSE2 has no rounding instruction; adding 1.5 * 2^52 rounds to nearest for |a| < 2^51
+  const __m128d magic = _mm_set1_pd(6755399441055744.0);
+  return _mm_sub_pd(_mm_add_pd(a.v, magic), magic);
+}
+inline F64x2 vselect(M64x2 m, F64x2 a, F64x2 b) { return _mm_or_pd(_mm_and_pd(m.m, a.v), _mm_andnot_pd(m.m, b.v)); }
+#endif
+
+#ifdef SIMCORE_COORDCONVERT_AVX2
+/** Mask for F64x4, all bits set in true lanes */
+struct M64x4
+{
+  __m256d m;
+};
+inline M64x4 operator&(M64x4 a, M64x4 b) { return { _mm256_and_pd(a.m, b.m) }; }
+inline M64x4 operator|(M64x4 a, M64x4 b) { return { _mm256_or_pd(a.m, b.m) }; }
+inline M64x4 operator^(M64x4 a, M64x4 b) { return { _mm256_xor_pd(a.m, b.m) }; }
+inline M64x4 operator!(M64x4 a) { return { _mm256_xor_pd(a.m, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))) }; }
+inline bool vany(M64x4 a) { return _mm256_movemask_pd(a.m) != 0; }
+
+/** Packed double interface for 4 lanes of AVX2, using fused multiply-add */
+struct F64x4
+{
+  enum { WIDTH = 4 };
+  typedef M64x4 Mask;
+  __m256d v;
+
+  F64x4() : v(_mm256_setzero_pd()) {}
+  F64x4(double d) : v(_mm256_set1_pd(d)) {}
+  F64x4(__m256d m) : v(m) {}
+  static F64x4 load(const double* p) { return _mm256_loadu_pd(p); }
+  void store(double* p) const { _mm256_storeu_pd(p, v); }
+};
+inline F64x4 operator+(F64x4 a, F64x4 b) { return _mm256_add_pd(a.v, b.v); }
+inline F64x4 operator-(F64x4 a, F64x4 b) { return _mm256_sub_pd(a.v, b.v); }
+inline F64x4 operator*(F64x4 a, F64x4 b) { return _mm256_mul_pd(a.v, b.v); }
+inline F64x4 operator/(F64x4 a, F64x4 b) { return _mm256_div_pd(a.v, b.v); }
+inline F64x4 operator-(F64x4 a) { return _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0)); }
+inline M64x4 operator<(F64x4 a, F64x4 b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ) }; }
+inline M64x4 operator>(F64x4 a, F64x4 b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ) }; }
+inline M64x4 operator==(F64x4 a, F64x4 b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ) }; }
+inline F64x4 mulAdd(F64x4 a, F64x4 b, F64x4 c) { return _mm256_fmadd_pd(a.v, b.v, c.v); }
+inline F64x4 vsqrt(F64x4 a) { return _mm256_sqrt_pd(a.v); }
+inline F64x4 vabs(F64x4 a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v); }
+inline F64x4 vround(F64x4 a) { return _mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+inline F64x4 vselect(M64x4 m, F64x4 a, F64x4 b) { return _mm256_blendv_pd(b.v, a.v, m.m); }
+#endif
+
+///////////////////////////////////////////////////////////////////////
+// Elementary functions.  Polynomials are from the Cephes library (S. Moshier), accurate to
+// about 1 ulp; branches are replaced with selects so that all lanes follow the same path.
+
+/// Largest |x| for which the pi/2 reduction in vsincos() is exact; callers fall back to std::sin/cos above this
+constexpr double SINCOS_MAX_ARG = 1.0e6;
+
+/** Computes sin(x) and cos(x) for |x| <= SINCOS_MAX_ARG */
+template <typename V>
+inline void vsincos(V x, V& s, V& c)
+{
+  // Cody-Waite reduction by pi/2; the first part has 33 bits, so q * PIO2_1 is exact for |q| < 2^20
+  const double PIO2_1 = 1.57079632673412561417e+00;
+  const double PIO2_2 = 6.07710050630396597660e-11;
+  const double PIO2_3 = 2.02226624871116645580e-21;
+  const V q = vround(x * V(M_2_PI));
+  const V r = ((x - q * V(PIO2_1)) - q * V(PIO2_2)) - q * V(PIO2_3);
+
+  // Polynomials valid for |r| <= pi/4
+  const V z = r * r;
+  V sp = mulAdd(V(1.58962301576546568060e-10), z, V(-2.50507477628578072866e-8));
+  sp = mulAdd(sp, z, V(2.75573136213857245213e-6));
+  sp = mulAdd(sp, z, V(-1.98412698295895385996e-4));
+  sp = mulAdd(sp, z, V(8.33333333332211858878e-3));
+  sp = mulAdd(sp, z, V(-1.66666666666666307295e-1));
+  const V sinR = mulAdd(r * z, sp, r);
+  V cp = mulAdd(V(-1.13585365213876817300e-11), z, V(2.08757008419747316778e-9));
+  cp = mulAdd(cp, z, V(-2.75573141792967388112e-7));
+  cp = mulAdd(cp, z, V(2.48015872888517045348e-5));
+  cp = mulAdd(cp, z, V(-1.38888888888730564116e-3));
+  cp = mulAdd(cp, z, V(4.16666666666665929218e-2));
+  const V cosR = mulAdd(z * z, cp, V(1.0) - V(0.5) * z);
+
+  // Quadrant is q mod 4, found here in the range [-2, 2]
+  const V k = q - V(4.0) * vround(q * V(0.25));
+  const typename V::Mask odd = (k == V(1.0)) | (k == V(-1.0));
+  const typename V::Mask half = (k == V(2.0)) | (k == V(-2.0));
+  const typename V::Mask negSin = half | (k == V(-1.0));
+  const typename V::Mask negCos = half | (k == V(1.0));
+  const V sinX = vselect(odd, cosR, sinR);
+  const V cosX = vselect(odd, sinR, cosR);
+  s = vselect(negSin, -sinX, sinX);
+  c = vselect(negCos, -cosX, cosX);
+}
+
+/** Computes atan(x) */
+template <typename V>
+inline V vatan(V x)
+{
+  const double T3P8 = 2.41421356237309504880;  // tan(3 * pi / 8)
+  const double MOREBITS = 6.123233995736765886130e-17;
+  const V a = vabs(x);
+  const typename V::Mask big = a > V(T3P8);
+  const typename V::Mask mid = (a > V(0.66)) & !big;
+  const V xr = vselect(big, V(-1.0) / a, vselect(mid, (a - V(1.0)) / (a + V(1.0)), a));
+  const V y0 = vselect(big, V(M_PI_2 + MOREBITS), vselect(mid, V(M_PI_4 + 0.5 * MOREBITS), V(0.0)));
+
+  const V z = xr * xr;
+  V p = mulAdd(V(-8.750608600031904122785e-1), z, V(-1.615753718733365076637e1));
+  p = mulAdd(p, z, V(-7.500855792314704667340e1));
+  p = mulAdd(p, z, V(-1.228866684490136173410e2));
+  p = mulAdd(p, z, V(-6.485021904942025371773e1));
+  V q = z + V(2.485846490142306297962e1);
+  q = mulAdd(q, z, V(1.650270098316988542046e2));
+  q = mulAdd(q, z, V(4.328810604912902668951e2));
+  q = mulAdd(q, z, V(4.853903996359136964868e2));
+  q = mulAdd(q, z, V(1.945506571482613964425e2));
+  const V r = y0 + mulAdd(xr * z, p / q, xr);
+  return vselect(x < V(0.0), -r, r);
+}
+
+/** Computes atan2(y, x), with the same results as std::atan2 for zero inputs */
+template <typename V>
+inline V vatan2(V y, V x)
+{
+  const V offset = vselect(x < V(0.0), vselect(y < V(0.0), V(-M_PI), V(M_PI)), V(0.0));
+  const V r = offset + vatan(y / x);
+  // Division by zero gives atan(+/-inf) for y != 0, but 0/0 needs special handling
+  const V onAxis = vselect(y > V(0.0), V(M_PI_2), vselect(y < V(0.0), V(-M_PI_2), V(0.0)));
+  return vselect(x == V(0.0), onAxis, r);
+}
+
+///////////////////////////////////////////////////////////////////////
+// Conversions for one pack; these follow the single point CoordinateConverter code.
+
+/** Geodetic to ECEF, from CoordinateConverter::convertGeodeticPosToEcef() */
+template <typename V>
+inline void vgeodeticToEcef(V lat, V lon, V alt, V semiMajor, V eccentricitySquared, V& x, V& y, V& z)
+{
+  V sLat, cLat, sLon, cLon;
+  vsincos(lat, sLat, cLat);
+  vsincos(lon, sLon, cLon);
+  const V rn = semiMajor / vsqrt(V(1.0) - eccentricitySquared * sLat * sLat);
+  const V horiz = (rn + alt) * cLat;
+  x = horiz * cLon;
+  y = horiz * sLon;
+  z = mulAdd(rn, V(1.0) - eccentricitySquared, alt) * sLat;
+}
+
+/** One step of Halley's method from Fukushima (2006), as in CoordinateConverter::convertEcefToGeodeticPos() */
+template <typename V>
+inline void vfukushimaStep(V pp, V zz, V& s, V& c)
+{
+  const V a = vsqrt(s * s + c * c);
+  const V a3 = a * a * a;
+  const V b = V(1.5 * WGS_ESQ) * s * c * c * ((pp * s - zz * c) * a - V(WGS_ESQ) * s * c);
+  const V d = zz * a3 + V(WGS_ESQ) * s * s * s;
+  const V f = pp * a3 - V(WGS_ESQ) * c * c * c;
+  s = d * f - b * s;
+  c = f * f - b * c;
+}
+
+/** ECEF to geodetic, from CoordinateConverter::convertEcefToGeodeticPos() */
+template <typename V>
+inline void vecefToGeodetic(V x, V y, V z, V& lat, V& lon, V& alt)
+{
+  const double eP = std::sqrt(WGS_ESQC);
+  const V absZ = vabs(z);
+  const V p = vsqrt(x * x + y * y);
+  const V pp = p / V(WGS_A);
+  const V zz = V(eP / WGS_A) * absZ;
+
+  // Single point code stops after one iteration when S and C*e' agree in sign; both are computed here
+  V s1 = zz;
+  V c1 = V(WGS_ESQC) * pp;
+  vfukushimaStep(pp, zz, s1, c1);
+  V s2 = s1;
+  V c2 = c1;
+  vfukushimaStep(pp, zz, s2, c2);
+  const typename V::Mask oneStep = (s1 == V(0.0)) | !((s1 < V(0.0)) ^ (c1 < V(0.0)));
+  const V s = vselect(oneStep, s1, s2);
+  const V c = vselect(oneStep, c1, c2);
+  const V cc = c * V(eP);
+
+  const V signZ = vselect(z > V(0.0), V(1.0), vselect(z < V(0.0), V(-1.0), V(0.0)));
+  const V geoLat = signZ * vatan(s / cc);
+  const V geoAlt = (cc * p + absZ * s - V(WGS_B) * vsqrt(c * c + s * s)) / vsqrt(cc * cc + s * s);
+
+  // Points on the Z axis are at a pole, or at the center of the earth
+  const typename V::Mask onAxis = (x == V(0.0)) & (y == V(0.0));
+  lon = vselect(onAxis, V(0.0), vatan2(y, x));
+  lat = vselect(onAxis, vselect(z < V(0.0), V(-M_PI_2), V(M_PI_2)), geoLat);
+  alt = vselect(onAxis, absZ - V(WGS_B), geoAlt);
+}
+
+///////////////////////////////////////////////////////////////////////
+// Array drivers.  Full packs are loaded directly; a partial pack at the end is padded through a
+// local buffer.  All inputs of a pack are loaded before outputs are stored, so outputs may alias inputs.
+
+/** Number of lanes in the pack starting at index i */
+template <typename V>
+inline size_t packSize(size_t count, size_t i)
+{
+  return (count - i < static_cast<size_t>(V::WIDTH)) ? count - i : static_cast<size_t>(V::WIDTH);
+}
+
+/** Loads up to WIDTH values, padding with the given value */
+template <typename V>
+inline V loadPartial(const double* p, size_t n, double pad)
+{
+  double buf[V::WIDTH];
+  for (size_t k = 0; k < static_cast<size_t>(V::WIDTH); ++k)
+    buf[k] = (k < n) ? p[k] : pad;
+  return V::load(buf);
+}
+
+/** Stores the first n lanes */
+template <typename V>
+inline void storePartial(V v, double* p, size_t n)
+{
+  double buf[V::WIDTH];
+  v.store(buf);
+  for (size_t k = 0; k < n; ++k)
+    p[k] = buf[k];
+}
+
+template <typename V>
+void geodeticToEcefArray(size_t count, const double* lat, const double* lon, const double* alt,
+  double* x, double* y, double* z, double semiMajor, double eccentricitySquared)
+{
+  const V a(semiMajor);
+  const V esq(eccentricitySquared);
+  V outX, outY, outZ;
+  for (size_t i = 0; i < count; i += V::WIDTH)
+  {
+    const size_t n = packSize<V>(count, i);
+    if (n == static_cast<size_t>(V::WIDTH))
+    {
+      vgeodeticToEcef(V::load(lat + i), V::load(lon + i), V::load(alt + i), a, esq, outX, outY, outZ);
+      outX.store(x + i);
+      outY.store(y + i);
+      outZ.store(z + i);
+    }
+    else
+    {
+      vgeodeticToEcef(loadPartial<V>(lat + i, n, 0.0), loadPartial<V>(lon + i, n, 0.0), loadPartial<V>(alt + i, n, 0.0), a, esq, outX, outY, outZ);
+      storePartial(outX, x + i, n);
+      storePartial(outY, y + i, n);
+      storePartial(outZ, z + i, n);
+    }
+  }
+}
+
+template <typename V>
+void ecefToGeodeticArray(size_t count, const double* x, const double* y, const double* z,
+  double* lat, double* lon, double* alt)
+{
+  V outLat, outLon, outAlt;
+  for (size_t i = 0; i < count; i += V::WIDTH)
+  {
+    const size_t n = packSize<V>(count, i);
+    if (n == static_cast<size_t>(V::WIDTH))
+    {
+      vecefToGeodetic(V::load(x + i), V::load(y + i), V::load(z + i), outLat, outLon, outAlt);
+      outLat.store(lat + i);
+      outLon.store(lon + i);
+      outAlt.store(alt + i);
+    }
+    else
+    {
+      // Pad with a point on the equator, which is well conditioned
+      vecefToGeodetic(loadPartial<V>(x + i, n, WGS_A), loadPartial<V>(y + i, n, 0.0), loadPartial<V>(z + i, n, 0.0), outLat, outLon, outAlt);
+      storePartial(outLat, lat + i, n);
+      storePartial(outLon, lon + i, n);
+      storePartial(outAlt, alt + i, n);
+    }
+  }
+}
+
+template <typename V>
+void rotateZArray(size_t count, const double* time, double rate, const double* x, const double* y,
+  double* outX, double* outY)
+{
+  for (size_t i = 0; i < count; i += V::WIDTH)
+  {
+    const size_t n = packSize<V>(count, i);
+    const bool full = (n == static_cast<size_t>(V::WIDTH));
+    const V angle = (full ? V::load(time + i) : loadPartial<V>(time + i, n, 0.0)) * V(rate);
+    const V inX = full ? V::load(x + i) : loadPartial<V>(x + i, n, 0.0);
+    const V inY = full ? V::load(y + i) : loadPartial<V>(y + i, n, 0.0);
+
+    V s, c;
+    if (!vany(vabs(angle) > V(SINCOS_MAX_ARG)))
+      vsincos(angle, s, c);
+    else
+    {
+      // Very long elapsed times; use the library functions with full range reduction
+      double angles[V::WIDTH];
+      double sines[V::WIDTH];
+      double cosines[V::WIDTH];
+      angle.store(angles);
+      for (size_t k = 0; k < static_cast<size_t>(V::WIDTH); ++k)
+      {
+        sines[k] = std::sin(angles[k]);
+        cosines[k] = std::cos(angles[k]);
+      }
+      s = V::load(sines);
+      c = V::load(cosines);
+    }
+
+    // Same rotation as CoordinateConverter::convertEciEcef_()
+    const V rotX = c * inX - s * inY;
+    const V rotY = c * inY + s * inX;
+    if (full)
+    {
+      rotX.store(outX + i);
+      rotY.store(outY + i);
+    }
+    else
+    {
+      storePartial(rotX, outX + i, n);
+      storePartial(rotY, outY + i, n);
+    }
+  }
+}
+
+template <typename V>
+void relativeGeometryArray(const RelativeGeometryFrame& frame, size_t count, const double* x, const double* y, const double* z,
+  const double* velCos, const double* velSin, double* azim, double* elev, double* cmp, double* slant, double* ground, double* rangeRate)
+{
+  const double (&b)[3][3] = frame.toBody;
+  const double (&l)[2][3] = frame.toLocal;
+  const bool needBody = (azim || elev || cmp || rangeRate);
+  for (size_t i = 0; i < count; i += V::WIDTH)
+  {
+    const size_t n = packSize<V>(count, i);
+    const bool full = (n == static_cast<size_t>(V::WIDTH));
+    const V dx = (full ? V::load(x + i) : loadPartial<V>(x + i, n, 0.0)) - V(frame.origin[0]);
+    const V dy = (full ? V::load(y + i) : loadPartial<V>(y + i, n, 0.0)) - V(frame.origin[1]);
+    const V dz = (full ? V::load(z + i) : loadPartial<V>(z + i, n, 0.0)) - V(frame.origin[2]);
+    const V range = vsqrt(dx * dx + dy * dy + dz * dz);
+    V out[6];
+    out[3] = range;
+    if (ground)
+    {
+      const V east = V(l[0][0]) * dx + V(l[0][1]) * dy + V(l[0][2]) * dz;
+      const V north = V(l[1][0]) * dx + V(l[1][1]) * dy + V(l[1][2]) * dz;
+      out[4] = vsqrt(east * east + north * north);
+    }
+    if (needBody)
+    {
+      // Unit pointing vector in body axes, as in calculateRelAng()
+      const typename V::Mask coincident = (range == V(0.0));
+      const V inv = V(1.0) / vselect(coincident, V(1.0), range);
+      const V b0 = vselect(coincident, V(frame.boresight[0]), (V(b[0][0]) * dx + V(b[0][1]) * dy + V(b[0][2]) * dz) * inv);
+      const V b1 = vselect(coincident, V(frame.boresight[1]), (V(b[1][0]) * dx + V(b[1][1]) * dy + V(b[1][2]) * dz) * inv);
+      const V b2 = vselect(coincident, V(frame.boresight[2]), (V(b[2][0]) * dx + V(b[2][1]) * dy + V(b[2][2]) * dz) * inv);
+
+      // Same gimbal lock handling as calculateYawPitchFromBodyUnitX()
+      const typename V::Mask lockDown = vabs(b2 - V(1.0)) < V(1.0e-6);
+      const typename V::Mask lockUp = vabs(b2 + V(1.0)) < V(1.0e-6);
+      const typename V::Mask locked = lockDown | lockUp;
+      const V horiz = vsqrt(b0 * b0 + b1 * b1);
+      out[0] = vselect(locked, V(0.0), vatan2(b1, b0));
+      out[1] = vselect(lockDown, V(-M_PI_2), vselect(lockUp, V(M_PI_2), vatan2(-b2, horiz)));
+      // Angle to the body X axis; atan2 keeps precision near boresight, where acos does not
+      out[2] = vatan2(vsqrt(b1 * b1 + b2 * b2), b0);
+      if (rangeRate)
+      {
+        const V invHoriz = V(1.0) / vselect(locked, V(1.0), horiz);
+        const V cosAz = vselect(locked, V(1.0), b0 * invHoriz);
+        const V sinAz = vselect(locked, V(0.0), b1 * invHoriz);
+        const V toCos = full ? V::load(velCos + i) : loadPartial<V>(velCos + i, n, 0.0);
+        const V toSin = full ? V::load(velSin + i) : loadPartial<V>(velSin + i, n, 0.0);
+        out[5] = (V(frame.velCos) * cosAz + V(frame.velSin) * sinAz) - (toCos * cosAz + toSin * sinAz);
+      }
+    }
+
+    double* const dest[6] = { azim, elev, cmp, slant, ground, rangeRate };
+    for (size_t k = 0; k < 6; ++k)
+    {
+      if (!dest[k])
+        continue;
+      if (full)
+        out[k].store(dest[k] + i);
+      else
+        storePartial(out[k], dest[k] + i, n);
+    }
+  }
+}
+
+/** Returns the kernel table for the pack type V */
+template <typename V>
+const CoordConvertKernels& makeCoordConvertKernels(const char* name)
+{
+  static const CoordConvertKernels kernels = {
+    name,
+    &geodeticToEcefArray<V>,
+    &ecefToGeodeticArray<V>,
+    &rotateZArray<V>,
+    &relativeGeometryArray<V>
+  };
+  return kernels;
+}
+
+}
+
+}
+
+#endif /* SIMCORE_CALC_COORDCONVERTSIMD_H */
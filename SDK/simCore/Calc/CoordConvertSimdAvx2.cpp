@@ -0,0 +1,39 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+
+// This file is compiled with AVX2 and FMA code generation enabled.  Its kernels are only called
+// after activeCoordConvertKernels() confirms processor support.
+#include "simCore/Calc/CoordConvertSimd.h"
+
+namespace simCore {
+
+const CoordConvertKernels* avx2CoordConvertKernels()
+{
+#ifdef SIMCORE_COORDCONVERT_AVX2
+  return &makeCoordConvertKernels<F64x4>("AVX2");
+#else
+  return nullptr;
+#endif
+}
+
+}
@@ -20,6 +20,7 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 #include <cassert>
@@ -29,6 +30,7 @@
 #include "simCore/Calc/Angle.h"
 #include "simCore/Calc/Math.h"
 #include "simCore/Calc/CoordinateConverter.h"
+#include "simCore/Calc/CoordConvertSimd.h"
 
 namespace simCore
 {
@@ -2186,6 +2188,88 @@ void CoordinateConverter::convertGeodeticPosToEcef(const Vec3 &llaPos, Vec3 &ece
     (Rn * (1.0-eccentricitySquared) + llaPos.alt()) * sLat);
 }
 
+void CoordinateConverter::convertGeodeticPosToEcef(size_t count, const double* lat, const double* lon, const double* alt,
+  double* x, double* y, double* z, double semiMajor, double eccentricitySquared)
+{
+  activeCoordConvertKernels().geodeticToEcef(count, lat, lon, alt, x, y, z, semiMajor, eccentricitySquared);
+}
+
+void CoordinateConverter::convertEcefToGeodeticPos(size_t count, const double* x, const double* y, const double* z,
+  double* lat, double* lon, double* alt)
+{
+  activeCoordConvertKernels().ecefToGeodetic(count, x, y, z, lat, lon, alt);
+}
+
+void CoordinateConverter::convertEciToEcefPos(size_t count, const double* elapsedEciTime, const double* x, const double* y, const double* z,
+  double* outX, double* outY, double* outZ)
+{
+  activeCoordConvertKernels().rotateZ(count, elapsedEciTime, -EARTH_ROTATION_RATE, x, y, outX, outY);
+  // z component is unchanged in a z-axis rotation
+  if (outZ != z)
+    std::copy(z, z + count, outZ);
+}
+
+void CoordinateConverter::convertEcefToEciPos(size_t count, const double* elapsedEciTime, const double* x, const double* y, const double* z,
+  double* outX, double* outY, double* outZ)
+{
+  activeCoordConvertKernels().rotateZ(count, elapsedEciTime, EARTH_ROTATION_RATE, x, y, outX, outY);
+  if (outZ != z)
+    std::copy(z, z + count, outZ);
+}
+
+int CoordinateConverter::convertEcefToXEastPos(size_t count, const double* x, const double* y, const double* z,
+  double* east, double* north, double* up) const
+{
+  if (!hasReferenceOrigin())
+  {
+    SIM_ERROR << "convertEcefToXEastPos, reference origin not set: " << __LINE__ << std::endl;
+    return 1;
+  }
+
+  // Same translation and rotation as convertEcefToXEast_(); no trig, so the compiler vectorizes this well
+  const double (&m)[3][3] = rotationMatrixENU_;
+  const Vec3& t = tangentPlaneTranslation_;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const double dx = x[i] - t.x();
+    const double dy = y[i] - t.y();
+    const double dz = z[i] - t.z();
+    east[i] = m[0][0] * dx + m[0][1] * dy + m[0][2] * dz;
+    north[i] = m[1][0] * dx + m[1][1] * dy + m[1][2] * dz;
+    up[i] = m[2][0] * dx + m[2][1] * dy + m[2][2] * dz;
+  }
+  return 0;
+}
+
+int CoordinateConverter::convertXEastToEcefPos(size_t count, const double* east, const double* north, const double* up,
+  double* x, double* y, double* z) const
+{
+  if (!hasReferenceOrigin())
+  {
+    SIM_ERROR << "convertXEastToEcefPos, reference origin not set: " << __LINE__ << std::endl;
+    return 1;
+  }
+
+  // Same rotation and translation as convertXEastToEcef_()
+  const double (&m)[3][3] = rotationMatrixENU_;
+  const Vec3& t = tangentPlaneTranslation_;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const double e = east[i];
+    const double n = north[i];
+    const double u = up[i];
+    x[i] = m[0][0] * e + m[1][0] * n + m[2][0] * u + t.x();
+    y[i] = m[0][1] * e + m[1][1] * n + m[2][1] * u + t.y();
+    z[i] = m[0][2] * e + m[1][2] * n + m[2][2] * u + t.z();
+  }
+  return 0;
+}
+
+const char* CoordinateConverter::batchInstructionSet()
+{
+  return activeCoordConvertKernels().name;
+}
+
 /// Converts an Earth Centered Earth Fixed (ECEF) velocity to geodetic
 void CoordinateConverter::convertEcefToGeodeticVel(const Vec3 &llaPos, const Vec3 &ecefVel, Vec3 &llaVel, LocalLevelFrame localLevelFrame)
 {
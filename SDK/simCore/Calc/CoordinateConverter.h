@@ -510,6 +510,115 @@ namespace simCore
     */
     static void convertEcefToGeodeticAccel(const Vec3 &llaPos, const Vec3 &ecefAcc, Vec3 &llaAcc, LocalLevelFrame localLevelFrame = LOCAL_LEVEL_FRAME_NED);
 
+    //------------------------------------------------------------------------
+    // Batch position conversions over arrays of separate X, Y, Z (or lat, lon, alt) values.
+    // These use SSE2 or AVX2 instructions when the processor supports them, and match the
+    // single point functions to within floating point round-off.  Each output array may be
+    // the same as an input array.
+
+    /**
+    * @brief Converts arrays of geodetic positions to Earth Centered Earth Fixed (ECEF) positions
+    *
+    * Batch equivalent of convertGeodeticPosToEcef(const Vec3&, Vec3&, double, double)
+    * @param[in ] count Number of positions
+    * @param[in ] lat Latitudes (rad)
+    * @param[in ] lon Longitudes (rad)
+    * @param[in ] alt Altitudes (m)
+    * @param[out] x ECEF X values (m)
+    * @param[out] y ECEF Y values (m)
+    * @param[out] z ECEF Z values (m)
+    * @param[in ] semiMajor semi major Earth radius
+    * @param[in ] eccentricitySquared Earth eccentricity, squared
+    */
+    static void convertGeodeticPosToEcef(size_t count, const double* lat, const double* lon, const double* alt,
+      double* x, double* y, double* z, double semiMajor = WGS_A, double eccentricitySquared = WGS_ESQ);
+
+    /**
+    * @brief Converts arrays of Earth Centered Earth Fixed (ECEF) positions to geodetic positions
+    *
+    * Batch equivalent of convertEcefToGeodeticPos(const Vec3&, Vec3&)
+    * @param[in ] count Number of positions
+    * @param[in ] x ECEF X values (m)
+    * @param[in ] y ECEF Y values (m)
+    * @param[in ] z ECEF Z values (m)
+    * @param[out] lat Latitudes (rad)
+    * @param[out] lon Longitudes (rad)
+    * @param[out] alt Altitudes (m)
+    */
+    static void convertEcefToGeodeticPos(size_t count, const double* x, const double* y, const double* z,
+      double* lat, double* lon, double* alt);
+
+    /**
+    * @brief Converts arrays of ECI positions to ECEF positions
+    *
+    * Rotates each position about the Z axis by the earth rotation over its elapsed ECI time
+    * @param[in ] count Number of positions
+    * @param[in ] elapsedEciTime Elapsed ECI time of each position (s)
+    * @param[in ] x ECI X values (m)
+    * @param[in ] y ECI Y values (m)
+    * @param[in ] z ECI Z values (m)
+    * @param[out] outX ECEF X values (m)
+    * @param[out] outY ECEF Y values (m)
+    * @param[out] outZ ECEF Z values (m)
+    */
+    static void convertEciToEcefPos(size_t count, const double* elapsedEciTime, const double* x, const double* y, const double* z,
+      double* outX, double* outY, double* outZ);
+
+    /**
+    * @brief Converts arrays of ECEF positions to ECI positions
+    *
+    * Rotates each position about the Z axis by the earth rotation over its elapsed ECI time
+    * @param[in ] count Number of positions
+    * @param[in ] elapsedEciTime Elapsed ECI time of each position (s)
+    * @param[in ] x ECEF X values (m)
+    * @param[in ] y ECEF Y values (m)
+    * @param[in ] z ECEF Z values (m)
+    * @param[out] outX ECI X values (m)
+    * @param[out] outY ECI Y values (m)
+    * @param[out] outZ ECI Z values (m)
+    */
+    static void convertEcefToEciPos(size_t count, const double* elapsedEciTime, const double* x, const double* y, const double* z,
+      double* outX, double* outY, double* outZ);
+
+    /**
+    * @brief Converts arrays of ECEF positions to X-East tangent plane (ENU) positions
+    *
+    * Uses the tangent plane at the reference origin; tangent plane offsets and rotation are not applied
+    * @param[in ] count Number of positions
+    * @param[in ] x ECEF X values (m)
+    * @param[in ] y ECEF Y values (m)
+    * @param[in ] z ECEF Z values (m)
+    * @param[out] east East values (m)
+    * @param[out] north North values (m)
+    * @param[out] up Up values (m)
+    * @return 0 on success, !0 if the reference origin is not set
+    */
+    int convertEcefToXEastPos(size_t count, const double* x, const double* y, const double* z,
+      double* east, double* north, double* up) const;
+
+    /**
+    * @brief Converts arrays of X-East tangent plane (ENU) positions to ECEF positions
+    *
+    * Uses the tangent plane at the reference origin; tangent plane offsets and rotation are not applied
+    * @param[in ] count Number of positions
+    * @param[in ] east East values (m)
+    * @param[in ] north North values (m)
+    * @param[in ] up Up values (m)
+    * @param[out] x ECEF X values (m)
+    * @param[out] y ECEF Y values (m)
+    * @param[out] z ECEF Z values (m)
+    * @return 0 on success, !0 if the reference origin is not set
+    */
+    int convertXEastToEcefPos(size_t count, const double* east, const double* north, const double* up,
+      double* x, double* y, double* z) const;
+
+    /**
+    * @brief Returns the name of the instruction set used by the batch conversions
+    *
+    * @return "AVX2", "SSE2" or "Scalar"
+    */
+    static const char* batchInstructionSet();
+
   private: // data
     double latRadius_;                   /// radius of earth at reference  latitude (m)
     double lonRadius_;                   /// radius of earth at reference longitude (m)
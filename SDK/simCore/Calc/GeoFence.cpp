@@ -20,7 +20,11 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <limits>
+#include <numeric>
 #include "simCore/Calc/Coordinate.h"
 #include "simCore/Calc/CoordinateConverter.h"
 #include "simCore/Calc/CoordinateSystem.h"
@@ -50,6 +54,125 @@ inline constexpr size_t TEST_POINTS_SIZE_2 = 3;
  * fences, but also negative for false positives.
  */
 inline constexpr double POLYTOPE_HULL_SCALE = 4.;
+/** Maximum number of items in a leaf of the bounding box hierarchy */
+inline constexpr uint32_t BVH_LEAF_SIZE = 4;
+/** Maximum depth of the bounding box hierarchy; median splits keep depth near log2(n) */
+inline constexpr size_t BVH_MAX_DEPTH = 64;
+/** Padding added to triangle bounding boxes (m), so that edge intersections are never culled */
+inline constexpr double TRIANGLE_BOX_PADDING = 1.;
+/** Padding added to the bounding cone half angle (rad), so that points on the fence edge are never culled */
+inline constexpr double CONE_ANGLE_PADDING = 1e-6;
+
+namespace {
+
+/** Bounds of a single item to insert into the bounding box hierarchy */
+struct ItemBounds
+{
+  simCore::Vec3 minBound;
+  simCore::Vec3 maxBound;
+  simCore::Vec3 center;
+};
+
+/** Recursively builds the node for items order[begin, end), returning the node depth */
+size_t buildBvhNode(const std::vector<ItemBounds>& items, std::vector<uint32_t>& order, uint32_t begin, uint32_t end, std::vector<GeoFenceBvhNode>& nodes)
+{
+  const size_t nodeIndex = nodes.size();
+  nodes.emplace_back();
+
+  simCore::Vec3 minBound = items[order[begin]].minBound;
+  simCore::Vec3 maxBound = items[order[begin]].maxBound;
+  simCore::Vec3 minCenter = items[order[begin]].center;
+  simCore::Vec3 maxCenter = minCenter;
+  for (uint32_t k = begin + 1; k < end; ++k)
+  {
+    const ItemBounds& item = items[order[k]];
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+      minBound[axis] = std::min(minBound[axis], item.minBound[axis]);
+      maxBound[axis] = std::max(maxBound[axis], item.maxBound[axis]);
+      minCenter[axis] = std::min(minCenter[axis], item.center[axis]);
+      maxCenter[axis] = std::max(maxCenter[axis], item.center[axis]);
+    }
+  }
+  nodes[nodeIndex].minBound = minBound;
+  nodes[nodeIndex].maxBound = maxBound;
+
+  // Split along the axis with the largest spread of centers
+  const simCore::Vec3& spread = maxCenter - minCenter;
+  size_t splitAxis = 0;
+  if (spread[1] > spread[splitAxis])
+    splitAxis = 1;
+  if (spread[2] > spread[splitAxis])
+    splitAxis = 2;
+  if (end - begin <= BVH_LEAF_SIZE || spread[splitAxis] <= 0.)
+  {
+    nodes[nodeIndex].offset = begin;
+    nodes[nodeIndex].count = end - begin;
+    return 1;
+  }
+
+  const uint32_t middle = begin + (end - begin) / 2;
+  std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+    [&items, splitAxis](uint32_t left, uint32_t right) { return items[left].center[splitAxis] < items[right].center[splitAxis]; });
+  const size_t firstDepth = buildBvhNode(items, order, begin, middle, nodes);
+  nodes[nodeIndex].offset = static_cast<uint32_t>(nodes.size());
+  const size_t secondDepth = buildBvhNode(items, order, middle, end, nodes);
+  return 1 + std::max(firstDepth, secondDepth);
+}
+
+/** Builds a bounding box hierarchy over the items, filling in the nodes and the order of items referenced by leaves */
+void buildBvh(const std::vector<ItemBounds>& items, std::vector<GeoFenceBvhNode>& nodes, std::vector<uint32_t>& order)
+{
+  nodes.clear();
+  order.resize(items.size());
+  std::iota(order.begin(), order.end(), 0);
+  if (items.empty())
+    return;
+  nodes.reserve(2 * items.size());
+  const size_t depth = buildBvhNode(items, order, 0, static_cast<uint32_t>(items.size()), nodes);
+  // Median splits cannot exceed the limit for any 32-bit item count
+  assert(depth < BVH_MAX_DEPTH);
+  (void)depth;
+}
+
+/** Returns true if the ray, with precomputed inverse direction, hits the node's box */
+bool rayIntersectsNode(const Ray& ray, const simCore::Vec3& inverseDirection, const GeoFenceBvhNode& node)
+{
+  double tMin = 0.;
+  double tMax = std::numeric_limits<double>::max();
+  for (size_t axis = 0; axis < 3; ++axis)
+  {
+    if (ray.direction[axis] == 0.)
+    {
+      // Parallel to the slab; must start inside it
+      if (ray.origin[axis] < node.minBound[axis] || ray.origin[axis] > node.maxBound[axis])
+        return false;
+      continue;
+    }
+    double t1 = (node.minBound[axis] - ray.origin[axis]) * inverseDirection[axis];
+    double t2 = (node.maxBound[axis] - ray.origin[axis]) * inverseDirection[axis];
+    if (t1 > t2)
+      std::swap(t1, t2);
+    tMin = std::max(tMin, t1);
+    tMax = std::min(tMax, t2);
+    if (tMin > tMax)
+      return false;
+  }
+  return true;
+}
+
+/** Returns true if the point is inside the node's box */
+bool pointInNode(const simCore::Vec3& point, const GeoFenceBvhNode& node)
+{
+  for (size_t axis = 0; axis < 3; ++axis)
+  {
+    if (point[axis] < node.minBound[axis] || point[axis] > node.maxBound[axis])
+      return false;
+  }
+  return true;
+}
+
+}
 
 //////////////////////////////////////////////////////////
 
@@ -104,6 +227,25 @@ void GeoFence::setPointsEcef_(const std::vector<simCore::Vec3>& ptsEcef)
   }
   triangles_ = calculatePolytopeHull_(points_);
   backfacePlane_ = calculateBackfacePlane_(points_);
+  calculateBoundingCone_(points_);
+
+  std::vector<ItemBounds> bounds;
+  bounds.reserve(triangles_.size());
+  const simCore::Vec3 padding(TRIANGLE_BOX_PADDING, TRIANGLE_BOX_PADDING, TRIANGLE_BOX_PADDING);
+  for (const auto& triangle : triangles_)
+  {
+    ItemBounds item;
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+      item.minBound[axis] = std::min({ triangle.a[axis], triangle.b[axis], triangle.c[axis] });
+      item.maxBound[axis] = std::max({ triangle.a[axis], triangle.b[axis], triangle.c[axis] });
+    }
+    item.minBound -= padding;
+    item.maxBound += padding;
+    item.center = (triangle.a + triangle.b + triangle.c) / 3.;
+    bounds.push_back(item);
+  }
+  buildBvh(bounds, triangleBvh_, triangleOrder_);
 }
 
 bool GeoFence::contains(const simCore::Coordinate& coord) const
@@ -118,18 +260,40 @@ bool GeoFence::contains(const simCore::Coordinate& coord) const
 
 bool GeoFence::contains(const simCore::Vec3& ecef) const
 {
-  std::vector<Ray> notUsed;
-  return contains(ecef, notUsed);
+  return contains_(ecef, nullptr);
 }
 
 bool GeoFence::contains(const simCore::Vec3& ecef, std::vector<Ray>& raysTested) const
 {
-  raysTested.clear();
+  return contains_(ecef, &raysTested);
+}
+
+void GeoFence::contains(std::span<const simCore::Vec3> ecef, std::vector<bool>& results) const
+{
+  results.assign(ecef.size(), false);
+  // No triangles means not inside anything (fence not well defined)
+  if (triangles_.empty())
+    return;
+  for (size_t k = 0; k < ecef.size(); ++k)
+  {
+    if (contains_(ecef[k], nullptr))
+      results[k] = true;
+  }
+}
+
+bool GeoFence::contains_(const simCore::Vec3& ecef, std::vector<Ray>* raysTested) const
+{
+  if (raysTested)
+    raysTested->clear();
   // No triangles means not inside anything (fence not well defined)
   if (triangles_.empty())
     return false;
 
   const auto& ecefNormalized = ecef.normalize();
+  // Points outside the cone around the fence cannot be inside it
+  if (ecefNormalized.dot(coneAxis_) < coneCosHalfAngle_)
+    return false;
+
   const auto& onSurface = ecefNormalized * simCore::WGS_A;
 
   // Test a ray against the plane first. If it intersects, then we do not contain
@@ -137,7 +301,8 @@ bool GeoFence::contains(const simCore::Vec3& ecef, std::vector<Ray>& raysTested)
   const auto& backfaceIsect = simCore::rayIntersectsPlane(planeRay, backfacePlane_);
   if (backfaceIsect.value_or(1.) >= 0.)
   {
-    raysTested = { planeRay };
+    if (raysTested)
+      *raysTested = { planeRay };
     return false;
   }
 
@@ -150,7 +315,8 @@ bool GeoFence::contains(const simCore::Vec3& ecef, std::vector<Ray>& raysTested)
     // which will create odd issues with intersection rays cast outside expected range.
 
     const simCore::Ray ray{ onSurface, (targetPoint - onSurface).normalize() };
-    raysTested.push_back(ray);
+    if (raysTested)
+      raysTested->push_back(ray);
     if (rayOriginatesInShape_(ray))
       ++numInside;
     else
@@ -171,7 +337,7 @@ bool GeoFence::valid() const
 bool GeoFence::rayOriginatesInShape_(const Ray& ray) const
 {
   // https://en.wikipedia.org/wiki/Point_in_polygon
-  return countIntersections_(ray, triangles_) % 2 == 1;
+  return countIntersections_(ray) % 2 == 1;
 }
 
 std::vector<Triangle> GeoFence::calculatePolytopeHull_(const std::vector<simCore::Vec3>& pts) const
@@ -200,18 +366,38 @@ std::vector<Triangle> GeoFence::calculatePolytopeHull_(const std::vector<simCore
   return rv;
 }
 
-int GeoFence::countIntersections_(const Ray& ray, const std::vector<Triangle>& triangles) const
+int GeoFence::countIntersections_(const Ray& ray) const
 {
+  if (triangleBvh_.empty())
+    return 0;
+
+  const simCore::Vec3 inverseDirection(1. / ray.direction.x(), 1. / ray.direction.y(), 1. / ray.direction.z());
+  uint32_t stack[BVH_MAX_DEPTH];
+  size_t stackSize = 0;
+  stack[stackSize++] = 0;
+
   int rv = 0;
-  for (const auto& triangle : triangles)
+  while (stackSize > 0)
   {
-    // Intersect testing, with inclusive edge testing enabled. This might mean that corners
-    // get counted twice.
-    const auto& results = rayIntersectsTriangle(ray, triangle, true);
-    // If the resulting intersection is greater than the radius of earth, ignore it.
-    // Give a little wiggle room
-    if (results.intersects)
-      ++rv;
+    const uint32_t nodeIndex = stack[--stackSize];
+    const GeoFenceBvhNode& node = triangleBvh_[nodeIndex];
+    if (!rayIntersectsNode(ray, inverseDirection, node))
+      continue;
+    if (node.count == 0)
+    {
+      stack[stackSize++] = node.offset;
+      stack[stackSize++] = nodeIndex + 1;
+      continue;
+    }
+
+    for (uint32_t k = node.offset; k < node.offset + node.count; ++k)
+    {
+      // Intersect testing, with inclusive edge testing enabled. This might mean that corners
+      // get counted twice.
+      const auto& results = rayIntersectsTriangle(ray, triangles_[triangleOrder_[k]], true);
+      if (results.intersects)
+        ++rv;
+    }
   }
   return rv;
 }
@@ -236,6 +422,38 @@ simCore::Plane GeoFence::calculateBackfacePlane_(const std::vector<simCore::Vec3
   return simCore::Plane(centerUnitVec, simCore::WGS_A * POLYTOPE_HULL_SCALE);
 }
 
+void GeoFence::calculateBoundingCone_(const std::vector<simCore::Vec3>& pts)
+{
+  // Disabled by default; cones of 90 degrees or more are not convex
+  coneAxis_.zero();
+  coneCosHalfAngle_ = -2.;
+  coneMinBound_.set(-1., -1., -1.);
+  coneMaxBound_.set(1., 1., 1.);
+  if (pts.size() < 3)
+    return;
+
+  simCore::Vec3 axis;
+  for (const auto& pt : pts)
+    axis += pt.normalize();
+  axis = axis.normalize();
+  double cosHalfAngle = 1.;
+  for (const auto& pt : pts)
+    cosHalfAngle = std::min(cosHalfAngle, pt.normalize().dot(axis));
+  const double halfAngle = std::acos(std::clamp(cosHalfAngle, -1., 1.)) + CONE_ANGLE_PADDING;
+  if (axis.length() == 0. || halfAngle >= M_PI_2)
+    return;
+
+  coneAxis_ = axis;
+  coneCosHalfAngle_ = std::cos(halfAngle);
+  for (size_t k = 0; k < 3; ++k)
+  {
+    // Extents of the cone along each axis, from the angle between the cone axis and that axis
+    const double axisAngle = std::acos(std::clamp(axis[k], -1., 1.));
+    coneMinBound_[k] = std::cos(std::min(M_PI, axisAngle + halfAngle)) - CONE_ANGLE_PADDING;
+    coneMaxBound_[k] = std::cos(std::max(0., axisAngle - halfAngle)) + CONE_ANGLE_PADDING;
+  }
+}
+
 std::vector<Triangle> GeoFence::triangles() const
 {
   return triangles_;
@@ -246,4 +464,108 @@ std::vector<simCore::Vec3> GeoFence::points() const
   return points_;
 }
 
+//////////////////////////////////////////////////////////
+
+GeoFenceSet::GeoFenceSet()
+{
+}
+
+GeoFenceSet::GeoFenceSet(const std::vector<std::shared_ptr<GeoFence> >& fences)
+{
+  set(fences);
+}
+
+void GeoFenceSet::set(const std::vector<std::shared_ptr<GeoFence> >& fences)
+{
+  // Null fences keep their slot so indices match the input, but stay out of the hierarchy
+  fences_ = fences;
+  std::vector<ItemBounds> bounds;
+  std::vector<uint32_t> fenceIndices;
+  for (size_t k = 0; k < fences_.size(); ++k)
+  {
+    const auto& fence = fences_[k];
+    if (!fence)
+      continue;
+    ItemBounds item;
+    item.minBound = fence->coneMinBound_;
+    item.maxBound = fence->coneMaxBound_;
+    item.center = (item.minBound + item.maxBound) / 2.;
+    bounds.push_back(item);
+    fenceIndices.push_back(static_cast<uint32_t>(k));
+  }
+  buildBvh(bounds, fenceBvh_, fenceOrder_);
+  // Leaves reference items in bounds; point them at the fences instead
+  for (auto& index : fenceOrder_)
+    index = fenceIndices[index];
+}
+
+void GeoFenceSet::clear()
+{
+  fences_.clear();
+  fenceBvh_.clear();
+  fenceOrder_.clear();
+}
+
+size_t GeoFenceSet::size() const
+{
+  return fences_.size();
+}
+
+std::shared_ptr<GeoFence> GeoFenceSet::fence(size_t index) const
+{
+  if (index >= fences_.size())
+    return nullptr;
+  return fences_[index];
+}
+
+template <typename Func>
+void GeoFenceSet::visitCandidates_(const simCore::Vec3& unitVec, Func fn) const
+{
+  if (fenceBvh_.empty())
+    return;
+
+  uint32_t stack[BVH_MAX_DEPTH];
+  size_t stackSize = 0;
+  stack[stackSize++] = 0;
+  while (stackSize > 0)
+  {
+    const uint32_t nodeIndex = stack[--stackSize];
+    const GeoFenceBvhNode& node = fenceBvh_[nodeIndex];
+    if (!pointInNode(unitVec, node))
+      continue;
+    if (node.count == 0)
+    {
+      stack[stackSize++] = node.offset;
+      stack[stackSize++] = nodeIndex + 1;
+      continue;
+    }
+    for (uint32_t k = node.offset; k < node.offset + node.count; ++k)
+    {
+      if (!fn(fenceOrder_[k]))
+        return;
+    }
+  }
+}
+
+void GeoFenceSet::containing(const simCore::Vec3& ecef, std::vector<size_t>& indices) const
+{
+  indices.clear();
+  visitCandidates_(ecef.normalize(), [this, &ecef, &indices](uint32_t index) {
+    if (fences_[index]->contains(ecef))
+      indices.push_back(index);
+    return true;
+  });
+  std::sort(indices.begin(), indices.end());
+}
+
+bool GeoFenceSet::anyContains(const simCore::Vec3& ecef) const
+{
+  bool found = false;
+  visitCandidates_(ecef.normalize(), [this, &ecef, &found](uint32_t index) {
+    found = fences_[index]->contains(ecef);
+    return !found;
+  });
+  return found;
+}
+
 }
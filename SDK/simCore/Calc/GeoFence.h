@@ -23,6 +23,9 @@
 #ifndef SIMCORE_CALC_GEOFENCE_H
 #define SIMCORE_CALC_GEOFENCE_H
 
+#include <cstdint>
+#include <memory>
+#include <span>
 #include <vector>
 #include "simCore/Common/Common.h"
 #include "simCore/Calc/CoordinateSystem.h"
@@ -34,6 +37,23 @@ namespace simCore
 
 class Coordinate;
 
+/**
+ * Node in the axis-aligned bounding box hierarchy used to accelerate GeoFence and
+ * GeoFenceSet queries. Nodes are stored depth first, so the first child of an
+ * interior node immediately follows it.
+ */
+struct GeoFenceBvhNode
+{
+  /** Minimum corner of the box enclosing all items under this node */
+  simCore::Vec3 minBound;
+  /** Maximum corner of the box enclosing all items under this node */
+  simCore::Vec3 maxBound;
+  /** Leaf nodes: index of the first item in the item order; interior nodes: index of the second child */
+  uint32_t offset = 0;
+  /** Number of items in a leaf node; 0 for interior nodes */
+  uint32_t count = 0;
+};
+
 /**
  * Representation of a geo-fence in ECEF format. The geo-fence is defined by three or
  * more ECEF points. The fence works by doing a 3-D version of the ray casting algorithm.
@@ -46,6 +66,10 @@ class Coordinate;
  * the even/odd intersection rules to determine whether the ray originates in the given
  * shape. Edges of the fence are extruded up slightly to account for tests of points
  * above the earth surface. Winding of the fence makes no difference.
+ *
+ * Points outside a cone bounding the fence are rejected without casting rays, and rays
+ * are only tested against triangles whose bounding boxes they hit, so large fences and
+ * far away points remain cheap to test.
  */
 class SDKCORE_EXPORT GeoFence
 {
@@ -70,6 +94,13 @@ public:
   bool contains(const simCore::Vec3& ecef) const;
   /** Returns true if the given ECEF XYZ is inside the fence, returning the rays tested e.g. for demo/testing purposes */
   bool contains(const simCore::Vec3& ecef, std::vector<Ray>& rays) const;
+  /**
+   * Tests many ECEF XYZ points against the fence. Results are identical to calling
+   * contains() on each point, without the per-call overhead.
+   * @param ecef Points to test, in ECEF coordinates
+   * @param results Resized to match ecef; results[k] is true if ecef[k] is inside the fence
+   */
+  void contains(std::span<const simCore::Vec3> ecef, std::vector<bool>& results) const;
 
   /** Returns all triangles that represent the hull or "coffee filter" shape */
   std::vector<Triangle> triangles() const;
@@ -80,6 +111,11 @@ public:
   bool valid() const;
 
 private:
+  friend class GeoFenceSet;
+
+  /** Implementation of contains() for ECEF points; rays may be nullptr */
+  bool contains_(const simCore::Vec3& ecef, std::vector<Ray>* rays) const;
+
   /** Sets the points in ECEF coordinates */
   void setPointsEcef_(const std::vector<simCore::Vec3>& ptsEcef);
 
@@ -93,10 +129,10 @@ private:
   std::vector<Triangle> calculatePolytopeHull_(const std::vector<simCore::Vec3>& pts) const;
 
   /**
-   * Given a ray and series of triangles, returns the number of triangles that the
-   * ray intersects.
+   * Given a ray, returns the number of hull triangles that the ray intersects. Only
+   * triangles whose bounding boxes are hit by the ray are tested.
    */
-  int countIntersections_(const Ray& ray, const std::vector<Triangle>& triangles) const;
+  int countIntersections_(const Ray& ray) const;
 
   /**
    * Returns true if the given ray intersects the configured triangles vector. Note that
@@ -111,11 +147,77 @@ private:
   /** Calculates the backface plane given all the data points */
   simCore::Plane calculateBackfacePlane_(const std::vector<simCore::Vec3>& pts) const;
 
+  /**
+   * Calculates the cone around the fence points. Points whose direction from the
+   * earth center falls outside the cone are rejected without any ray casting.
+   */
+  void calculateBoundingCone_(const std::vector<simCore::Vec3>& pts);
+
   std::vector<simCore::Vec3> points_;
   std::vector<Triangle> triangles_;
+  /** Bounding box hierarchy over triangles_ */
+  std::vector<GeoFenceBvhNode> triangleBvh_;
+  /** Indices into triangles_, in the order referenced by triangleBvh_ leaves */
+  std::vector<uint32_t> triangleOrder_;
 
   /** The plane helps detect/reject erroneous intersections through the earth. */
   simCore::Plane backfacePlane_;
+
+  /** Unit vector along the axis of the bounding cone */
+  simCore::Vec3 coneAxis_;
+  /** Cosine of the bounding cone half angle; less than -1 when the cone cannot reject points */
+  double coneCosHalfAngle_ = -2.;
+  /** Bounds of the unit vectors inside the bounding cone, used by GeoFenceSet */
+  simCore::Vec3 coneMinBound_;
+  /** Bounds of the unit vectors inside the bounding cone, used by GeoFenceSet */
+  simCore::Vec3 coneMaxBound_;
+};
+
+/**
+ * Collection of GeoFences indexed by the direction of each fence from the earth center,
+ * such that finding the fences that contain a point only tests fences near that point.
+ * Fences are shared with the caller; the set must be reset with set() if a fence changes.
+ */
+class SDKCORE_EXPORT GeoFenceSet
+{
+public:
+  /** Initializes an empty set */
+  GeoFenceSet();
+  /** Initializes the set with the given fences */
+  explicit GeoFenceSet(const std::vector<std::shared_ptr<GeoFence> >& fences);
+
+  /**
+   * Replaces the fences in the set and rebuilds the spatial index. Indices match the positions in
+   * the input vector; null fences keep their index but never contain a point.
+   */
+  void set(const std::vector<std::shared_ptr<GeoFence> >& fences);
+  /** Removes all fences */
+  void clear();
+
+  /** Returns the number of fences in the set, including null fences */
+  size_t size() const;
+  /** Returns the fence at the given index, or nullptr if out of range or the fence is null */
+  std::shared_ptr<GeoFence> fence(size_t index) const;
+
+  /**
+   * Finds the fences that contain the given ECEF point.
+   * @param ecef Point to test, in ECEF coordinates
+   * @param indices Filled with the indices of the containing fences, in ascending order
+   */
+  void containing(const simCore::Vec3& ecef, std::vector<size_t>& indices) const;
+  /** Returns true if any fence in the set contains the given ECEF point */
+  bool anyContains(const simCore::Vec3& ecef) const;
+
+private:
+  /** Calls fn(index) for each fence whose bounding cone may contain the unit vector; stops when fn returns false */
+  template <typename Func>
+  void visitCandidates_(const simCore::Vec3& unitVec, Func fn) const;
+
+  std::vector<std::shared_ptr<GeoFence> > fences_;
+  /** Bounding box hierarchy over the cone bounds of each fence */
+  std::vector<GeoFenceBvhNode> fenceBvh_;
+  /** Indices into fences_, in the order referenced by fenceBvh_ leaves */
+  std::vector<uint32_t> fenceOrder_;
 };
 
 } // namespace simCore
@@ -20,7 +20,12 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
 #include <string.h>
+#include <vector>
 #include "simNotify/Notify.h"
 #include "simCore/Calc/Vec3.h"
 #include "simCore/Calc/Angle.h"
@@ -54,7 +59,7 @@ static const double K_COEFF[13][13]=
 static const double FN_COEFF[13] = {0, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13};
 static const double FM_COEFF[13] = {0, 1, 2, 3, 4, 5, 6, 7, 8,  9, 10, 11, 12};
 
-static double SNORM_COEFF[169] =
+static const double SNORM_COEFF[169] =
 {
   1, 1, 1.5, 2.5, 4.375, 7.875, 14.4375, 26.8125, 50.2734375, 94.9609375, 180.42578125, 344.44921875, 660.1943359375,
   0, 1, 1.732050807568877, 3.061862178478973, 5.533985905294664, 10.16658128379447, 18.90312474169284, 35.46960351395967,
@@ -406,6 +411,8 @@ public:
     memset(sp_, 0, 13 * sizeof(double));
     memset(cp_, 0, 13 * sizeof(double));
     memset(pp_, 0, 13 * sizeof(double));
+    // Legendre terms are updated in place, so each instance needs its own copy
+    memcpy(snorm_, SNORM_COEFF, 169 * sizeof(double));
     cp_[0] = 1.0;
     pp_[0] = 1.0;
   }
@@ -423,6 +430,7 @@ private:
   // WORLD MAGNETIC MODEL SPHERICAL HARMONIC COEFFICIENTS
   double tc_[13][13];
   double dp_[13][13];
+  double snorm_[169];
   double sp_[13];
   double cp_[13];
   double pp_[13];
@@ -432,10 +440,10 @@ private:
   int oyear_;
 
   /** Track if we've issued a warning about the WMM bounds */
-  static bool tooLateWarned_;
+  static std::atomic<bool> tooLateWarned_;
 };
 
-bool WorldMagneticModel::GeoMag::tooLateWarned_ = false;
+std::atomic<bool> WorldMagneticModel::GeoMag::tooLateWarned_ = false;
 
 // // // // // // // // // // // // // // // // // // // // // // //
 
@@ -529,9 +537,8 @@ int WorldMagneticModel::GeoMag::calculateVariance(const simCore::Vec3& lla, int
   const auto maxYear = (epochYear_ + 5);
   if (refYear > maxYear || (refYear == maxYear && ordinalDay > 0))
   {
-    if (!tooLateWarned_)
+    if (!tooLateWarned_.exchange(true))
     {
-      tooLateWarned_ = true;
       SIM_ERROR << "calculateVariance encountered a date (" << ordinalDay << " " << refYear << ") which is more than 5 years beyond the last available WMM (" <<
         epochYear_ << "). Proceeding with date clamped to: 00 " << maxYear << std::endl;
     }
@@ -560,7 +567,7 @@ int WorldMagneticModel::GeoMag::calculateVariance(const simCore::Vec3& lla, int
     return 0;
   }
 
-  double *p = SNORM_COEFF;
+  double *p = snorm_;
   const double srlon = sin(lla.lon());
   const double srlat = sin(lla.lat());
   const double crlon = cos(lla.lon());
@@ -777,4 +784,177 @@ int WorldMagneticModel::calculateTrueBearing(const simCore::Vec3& lla, const sim
   return 1;
 }
 
+////////////////////////////////////////////////////////////////
+
+/** Number of grid cells along each side of a MagneticVarianceGrid tile */
+static const size_t GRID_TILE_CELLS = 8;
+/** Number of samples along each side of a MagneticVarianceGrid tile, including the shared far edge */
+static const size_t GRID_TILE_SAMPLES = GRID_TILE_CELLS + 1;
+
+/** Block of variance samples, computed on first use */
+struct MagneticVarianceGrid::Tile
+{
+  std::once_flag computed;
+  /** Samples indexed by [altitude layer][latitude][longitude], GRID_TILE_SAMPLES on each horizontal side */
+  std::vector<double> values;
+};
+
+MagneticVarianceGrid::MagneticVarianceGrid(int ordinalDay, int year, double latStepRad, double lonStepRad, double maxAltitude, double altStep)
+  : ordinalDay_(ordinalDay),
+    year_(year)
+{
+  if (!(latStepRad > 0.))
+    latStepRad = simCore::DEG2RAD;
+  if (!(lonStepRad > 0.))
+    lonStepRad = simCore::DEG2RAD;
+  latIntervals_ = std::max(static_cast<size_t>(1), static_cast<size_t>(std::ceil(M_PI / latStepRad)));
+  lonIntervals_ = std::max(static_cast<size_t>(2), static_cast<size_t>(std::ceil(M_TWOPI / lonStepRad)));
+  latStep_ = M_PI / latIntervals_;
+  lonStep_ = M_TWOPI / lonIntervals_;
+
+  if (maxAltitude > 0. && altStep > 0.)
+  {
+    const size_t altIntervals = std::max(static_cast<size_t>(1), static_cast<size_t>(std::ceil(maxAltitude / altStep)));
+    altLayers_ = altIntervals + 1;
+    altStep_ = maxAltitude / altIntervals;
+  }
+  else
+  {
+    altLayers_ = 1;
+    altStep_ = 0.;
+  }
+
+  latTiles_ = (latIntervals_ + GRID_TILE_CELLS - 1) / GRID_TILE_CELLS;
+  lonTiles_ = (lonIntervals_ + GRID_TILE_CELLS - 1) / GRID_TILE_CELLS;
+  tiles_.reset(new Tile[latTiles_ * lonTiles_]);
+}
+
+MagneticVarianceGrid::~MagneticVarianceGrid()
+{
+}
+
+int MagneticVarianceGrid::calculateMagneticVariance(const simCore::Vec3& lla, double& varianceRad) const
+{
+  if (!std::isfinite(lla.lat()) || !std::isfinite(lla.lon()) || !std::isfinite(lla.alt()))
+    return 1;
+
+  // Latitude is clamped at the poles; longitude wraps, with PI and -PI sharing the first column
+  const double latPos = std::clamp((lla.lat() + M_PI_2) / latStep_, 0., static_cast<double>(latIntervals_));
+  const double lonPos = (simCore::angFixPI(lla.lon()) + M_PI) / lonStep_;
+  const size_t latIndex = std::min(static_cast<size_t>(latPos), latIntervals_ - 1);
+  const size_t lonIndex = std::min(static_cast<size_t>(lonPos), lonIntervals_ - 1);
+  const double latFrac = latPos - latIndex;
+  const double lonFrac = std::min(lonPos - lonIndex, 1.);
+
+  size_t altIndex = 0;
+  double altFrac = 0.;
+  if (altLayers_ > 1)
+  {
+    const double altPos = std::clamp(lla.alt() / altStep_, 0., static_cast<double>(altLayers_ - 1));
+    altIndex = std::min(static_cast<size_t>(altPos), altLayers_ - 2);
+    altFrac = altPos - altIndex;
+  }
+
+  const Tile& tile = tile_(latIndex / GRID_TILE_CELLS, lonIndex / GRID_TILE_CELLS);
+  const size_t localLat = latIndex % GRID_TILE_CELLS;
+  const size_t localLon = lonIndex % GRID_TILE_CELLS;
+  const double* layer = &tile.values[(altIndex * GRID_TILE_SAMPLES + localLat) * GRID_TILE_SAMPLES + localLon];
+
+  // Variance wraps at +/-PI near the magnetic poles, so interpolate offsets from the first sample
+  const double reference = layer[0];
+  const auto bilinear = [reference, latFrac, lonFrac](const double* cell) {
+    const double v00 = simCore::angFixPI(cell[0] - reference);
+    const double v01 = simCore::angFixPI(cell[1] - reference);
+    const double v10 = simCore::angFixPI(cell[GRID_TILE_SAMPLES] - reference);
+    const double v11 = simCore::angFixPI(cell[GRID_TILE_SAMPLES + 1] - reference);
+    const double low = v00 + lonFrac * (v01 - v00);
+    const double high = v10 + lonFrac * (v11 - v10);
+    return low + latFrac * (high - low);
+  };
+
+  double offset = bilinear(layer);
+  if (altFrac > 0.)
+    offset += altFrac * (bilinear(layer + GRID_TILE_SAMPLES * GRID_TILE_SAMPLES) - offset);
+  varianceRad = simCore::angFixPI(reference + offset);
+  return 0;
+}
+
+int MagneticVarianceGrid::calculateMagneticBearing(const simCore::Vec3& lla, double& bearingRad) const
+{
+  double variance = 0.0;
+  if (calculateMagneticVariance(lla, variance) == 0)
+  {
+    bearingRad = simCore::angFix2PI(bearingRad - variance);
+    return 0;
+  }
+  return 1;
+}
+
+int MagneticVarianceGrid::calculateTrueBearing(const simCore::Vec3& lla, double& bearingRad) const
+{
+  double variance = 0.0;
+  if (calculateMagneticVariance(lla, variance) == 0)
+  {
+    bearingRad = simCore::angFix2PI(bearingRad + variance);
+    return 0;
+  }
+  return 1;
+}
+
+void MagneticVarianceGrid::computeAll() const
+{
+  for (size_t latTile = 0; latTile < latTiles_; ++latTile)
+  {
+    for (size_t lonTile = 0; lonTile < lonTiles_; ++lonTile)
+      tile_(latTile, lonTile);
+  }
+}
+
+size_t MagneticVarianceGrid::numComputedTiles() const
+{
+  return numComputedTiles_;
+}
+
+size_t MagneticVarianceGrid::numTiles() const
+{
+  return latTiles_ * lonTiles_;
+}
+
+const MagneticVarianceGrid::Tile& MagneticVarianceGrid::tile_(size_t latTile, size_t lonTile) const
+{
+  Tile& tile = tiles_[latTile * lonTiles_ + lonTile];
+  std::call_once(tile.computed, [this, &tile, latTile, lonTile]() { computeTile_(tile, latTile, lonTile); });
+  return tile;
+}
+
+void MagneticVarianceGrid::computeTile_(Tile& tile, size_t latTile, size_t lonTile) const
+{
+  tile.values.assign(altLayers_ * GRID_TILE_SAMPLES * GRID_TILE_SAMPLES, 0.);
+
+  // Each tile uses its own model, since the model caches intermediate values between calls.
+  // Longitude varies fastest so that the model can reuse its latitude terms.
+  WorldMagneticModel wmm;
+  for (size_t altLayer = 0; altLayer < altLayers_; ++altLayer)
+  {
+    const double alt = altLayer * altStep_;
+    for (size_t localLat = 0; localLat < GRID_TILE_SAMPLES; ++localLat)
+    {
+      const size_t latIndex = latTile * GRID_TILE_CELLS + localLat;
+      if (latIndex > latIntervals_)
+        break;
+      const double lat = (latIndex == latIntervals_) ? M_PI_2 : (-M_PI_2 + latIndex * latStep_);
+      double* row = &tile.values[(altLayer * GRID_TILE_SAMPLES + localLat) * GRID_TILE_SAMPLES];
+      for (size_t localLon = 0; localLon < GRID_TILE_SAMPLES; ++localLon)
+      {
+        const size_t lonIndex = lonTile * GRID_TILE_CELLS + localLon;
+        if (lonIndex > lonIntervals_)
+          break;
+        const double lon = -M_PI + lonIndex * lonStep_;
+        wmm.calculateMagneticVariance(simCore::Vec3(lat, lon, alt), ordinalDay_, year_, row[localLon]);
+      }
+    }
+  }
+  ++numComputedTiles_;
+}
+
 }
@@ -23,7 +23,10 @@
 #ifndef SIMCORE_CALC_MAGNETICVARIANCE_H
 #define SIMCORE_CALC_MAGNETICVARIANCE_H
 
+#include <atomic>
+#include <memory>
 #include "simCore/Common/Common.h"
+#include "simCore/Calc/Angle.h"
 
 namespace simCore {
 
@@ -91,6 +94,88 @@ private:
   GeoMag* geomag_ = nullptr;
 };
 
+/**
+ * Precomputed table of WMM magnetic variance for a single date, so that variance and bearing
+ * conversions are a table lookup instead of a full spherical harmonic evaluation. Samples are
+ * spaced evenly in latitude, longitude and optionally altitude, and are interpolated bilinearly
+ * (single altitude layer) or trilinearly. The table is split into tiles that are computed the
+ * first time a position inside them is queried; queries are safe to make from multiple threads.
+ *
+ * Variance changes rapidly near the magnetic and geographic poles, so interpolation error
+ * depends on the distance to the nearest pole. With the default 1 degree spacing, the maximum
+ * error against WorldMagneticModel is 0.25 degrees beyond 1000 km from any pole, 0.1 degrees
+ * beyond 1500 km, and 0.02 degrees beyond 3000 km. Error shrinks roughly with the square of
+ * the spacing. Altitudes are clamped to the altitude range of the grid.
+ */
+class SDKCORE_EXPORT MagneticVarianceGrid
+{
+public:
+  /**
+   * Initializes the grid; no samples are computed until queried.
+   * @param ordinalDay Ordinal day of year (e.g. 0 for January 1st, 365 for December 31 on most years)
+   * @param year Year value, with the same bounds as WorldMagneticModel
+   * @param latStepRad Maximum latitude spacing of samples in radians; rounded down to divide 180 degrees evenly
+   * @param lonStepRad Maximum longitude spacing of samples in radians; rounded down to divide 360 degrees evenly
+   * @param maxAltitude Top of the altitude range in meters; 0 for a single layer at sea level
+   * @param altStep Maximum altitude spacing of samples in meters; ignored for a single layer
+   */
+  MagneticVarianceGrid(int ordinalDay, int year, double latStepRad = simCore::DEG2RAD, double lonStepRad = simCore::DEG2RAD,
+    double maxAltitude = 0., double altStep = 0.);
+  virtual ~MagneticVarianceGrid();
+
+  SDK_DISABLE_COPY_MOVE(MagneticVarianceGrid);
+
+  /**
+   * Interpolates the magnetic variance at the given position.
+   * @param lla Geodetic position in radians and meters.
+   * @param varianceRad Radian value of the magnetic variance at the position, in [-PI,PI].
+   * @return 0 on success, non-zero on error
+   */
+  int calculateMagneticVariance(const simCore::Vec3& lla, double& varianceRad) const;
+  /**
+   * Converts a true bearing to a magnetic bearing at the given position.
+   * @param lla Geodetic position in radians and meters.
+   * @param bearingRad On input, a true bearing value in radians.  On output, a magnetic bearing in radians.
+   * @return 0 on success, non-zero on error
+   */
+  int calculateMagneticBearing(const simCore::Vec3& lla, double& bearingRad) const;
+  /**
+   * Converts a magnetic bearing to a true bearing at the given position.
+   * @param lla Geodetic position in radians and meters.
+   * @param bearingRad On input, a magnetic bearing value in radians.  On output, a true bearing in radians.
+   * @return 0 on success, non-zero on error
+   */
+  int calculateTrueBearing(const simCore::Vec3& lla, double& bearingRad) const;
+
+  /** Computes all tiles immediately, e.g. from a background thread before the grid is needed */
+  void computeAll() const;
+  /** Returns the number of tiles computed so far, out of numTiles() */
+  size_t numComputedTiles() const;
+  /** Returns the total number of tiles in the grid */
+  size_t numTiles() const;
+
+private:
+  struct Tile;
+
+  /** Returns the tile at the given tile indices, computing it if needed */
+  const Tile& tile_(size_t latTile, size_t lonTile) const;
+  /** Fills in the samples of a tile from the WMM */
+  void computeTile_(Tile& tile, size_t latTile, size_t lonTile) const;
+
+  int ordinalDay_;
+  int year_;
+  size_t latIntervals_;
+  size_t lonIntervals_;
+  size_t altLayers_;
+  double latStep_;
+  double lonStep_;
+  double altStep_;
+  size_t latTiles_;
+  size_t lonTiles_;
+  std::unique_ptr<Tile[]> tiles_;
+  mutable std::atomic<size_t> numComputedTiles_ = 0;
+};
+
 }
 
 #endif /* SIMCORE_CALC_MAGNETICVARIANCE_H */
@@ -20,6 +20,8 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <fstream>
 #include <string>
@@ -3436,4 +3438,147 @@ int AntennaPatternXFDTD::readPat(const std::string& inFileName)
   return st;
 }
 
+// ----------------------------------------------------------------------------
+/// AntennaGainGrid methods
+
+namespace
+{
+  /**
+  * Locates the grid cell containing the given angles, for AntennaGainGrid lookups
+  * @param[in ] azim Azimuth (rad)
+  * @param[in ] elev Elevation (rad)
+  * @param[in ] azimCount Number of grid points in azimuth
+  * @param[in ] elevCount Number of grid points in elevation
+  * @param[in ] invAzimStep Inverse of azimuth spacing (1/rad)
+  * @param[in ] invElevStep Inverse of elevation spacing (1/rad)
+  * @param[out] index Index of the lower left grid point of the cell
+  * @param[out] azimFrac Fractional azimuth position within the cell, [0,1]
+  * @param[out] elevFrac Fractional elevation position within the cell, [0,1]
+  */
+  inline void locateGridCell(float azim, float elev, size_t azimCount, size_t elevCount, float invAzimStep, float invElevStep,
+    size_t& index, float& azimFrac, float& elevFrac)
+  {
+    const float azimIntervals = static_cast<float>(azimCount - 1);
+    const float elevIntervals = static_cast<float>(elevCount - 1);
+
+    // Wrap azimuth, measured in grid steps from -PI, into [0, azimIntervals); also maps NaN to 0
+    float a = (azim + static_cast<float>(M_PI)) * invAzimStep;
+    a -= azimIntervals * std::floor(a / azimIntervals);
+    a = (a >= 0.f && a < azimIntervals) ? a : 0.f;
+    // Clamp elevation, measured in grid steps from -PI/2
+    float e = (elev + static_cast<float>(M_PI_2)) * invElevStep;
+    e = (e > 0.f) ? std::min(e, elevIntervals) : 0.f;
+
+    // Points on the last grid row use the cell below
+    const size_t i = static_cast<size_t>(a);
+    const size_t j = std::min(static_cast<size_t>(e), elevCount - 2);
+    index = j * azimCount + i;
+    azimFrac = a - static_cast<float>(i);
+    elevFrac = e - static_cast<float>(j);
+  }
+
+  /** Bilinear interpolation within the grid cell whose lower left point is at gains[0] */
+  inline float interpolateGridCell(const float* gains, size_t azimCount, float azimFrac, float elevFrac)
+  {
+    const float* upper = gains + azimCount;
+    const float low = gains[0] + azimFrac * (gains[1] - gains[0]);
+    const float high = upper[0] + azimFrac * (upper[1] - upper[0]);
+    return low + elevFrac * (high - low);
+  }
+}
+
+AntennaGainGrid::AntennaGainGrid()
+  : azimCount_(0),
+  elevCount_(0),
+  invAzimStep_(0.f),
+  invElevStep_(0.f),
+  minGain_(-SMALL_DB_VAL),
+  maxGain_(SMALL_DB_VAL)
+{
+}
+
+int AntennaGainGrid::build(AntennaPattern& pattern, const AntennaGainParameters& params, float azimStep, float elevStep)
+{
+  gains_.clear();
+  azimCount_ = 0;
+  elevCount_ = 0;
+  minGain_ = -SMALL_DB_VAL;
+  maxGain_ = SMALL_DB_VAL;
+  if (!pattern.valid() || !(azimStep > 0.f) || !(elevStep > 0.f))
+    return 1;
+
+  // Small tolerance keeps float rounding of a step like 0.5 degrees from adding an extra interval
+  const size_t azimIntervals = std::max(static_cast<size_t>(2), static_cast<size_t>(std::ceil(2.0 * M_PI / azimStep - 1e-3)));
+  const size_t elevIntervals = std::max(static_cast<size_t>(1), static_cast<size_t>(std::ceil(M_PI / elevStep - 1e-3)));
+  const double azimSpacing = 2.0 * M_PI / azimIntervals;
+  const double elevSpacing = M_PI / elevIntervals;
+  azimCount_ = azimIntervals + 1;
+  elevCount_ = elevIntervals + 1;
+  invAzimStep_ = static_cast<float>(1.0 / azimSpacing);
+  invElevStep_ = static_cast<float>(1.0 / elevSpacing);
+  gains_.resize(azimCount_ * elevCount_);
+
+  AntennaGainParameters sample(params);
+  for (size_t j = 0; j < elevCount_; ++j)
+  {
+    sample.elev_ = static_cast<float>(-M_PI_2 + j * elevSpacing);
+    float* row = &gains_[j * azimCount_];
+    for (size_t i = 0; i < azimIntervals; ++i)
+    {
+      sample.azim_ = static_cast<float>(-M_PI + i * azimSpacing);
+      row[i] = pattern.gain(sample);
+      minGain_ = sdkMin(minGain_, row[i]);
+      maxGain_ = sdkMax(maxGain_, row[i]);
+    }
+    // -PI and PI are the same direction
+    row[azimIntervals] = row[0];
+  }
+  return 0;
+}
+
+float AntennaGainGrid::gain(float azim, float elev) const
+{
+  if (gains_.empty())
+    return SMALL_DB_VAL;
+  size_t index;
+  float azimFrac;
+  float elevFrac;
+  locateGridCell(azim, elev, azimCount_, elevCount_, invAzimStep_, invElevStep_, index, azimFrac, elevFrac);
+  return interpolateGridCell(&gains_[index], azimCount_, azimFrac, elevFrac);
+}
+
+void AntennaGainGrid::gain(size_t count, const float* azim, const float* elev, float* gains) const
+{
+  if (gains_.empty())
+  {
+    std::fill(gains, gains + count, static_cast<float>(SMALL_DB_VAL));
+    return;
+  }
+
+  // Cells for a block are located in one branch free pass that the compiler can vectorize,
+  // then gathered and interpolated in a second pass
+  const size_t BLOCK_SIZE = 256;
+  size_t indices[BLOCK_SIZE];
+  float azimFracs[BLOCK_SIZE];
+  float elevFracs[BLOCK_SIZE];
+  const float* grid = gains_.data();
+  for (size_t begin = 0; begin < count; begin += BLOCK_SIZE)
+  {
+    const size_t blockCount = std::min(BLOCK_SIZE, count - begin);
+    for (size_t k = 0; k < blockCount; ++k)
+      locateGridCell(azim[begin + k], elev[begin + k], azimCount_, elevCount_, invAzimStep_, invElevStep_, indices[k], azimFracs[k], elevFracs[k]);
+    for (size_t k = 0; k < blockCount; ++k)
+      gains[begin + k] = interpolateGridCell(grid + indices[k], azimCount_, azimFracs[k], elevFracs[k]);
+  }
+}
+
+void AntennaGainGrid::minMaxGain(float* min, float* max) const
+{
+  assert(min && max);
+  if (!min || !max)
+    return;
+  *min = minGain_;
+  *max = maxGain_;
+}
+
 }
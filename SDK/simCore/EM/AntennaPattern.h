@@ -28,6 +28,7 @@
 #include <iosfwd>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "simCore/Common/Common.h"
 #include "simCore/LUT/InterpTable.h"
@@ -784,6 +785,77 @@ protected:
   int readPat_(std::istream& fp);
 };
 
+// ----------------------------------------------------------------------------
+
+/**
+* Uniform azimuth/elevation grid of gains sampled from an AntennaPattern.  AntennaPattern::gain()
+* is not const and table based patterns search their data on every call, so the grid is built once,
+* typically when a pattern is loaded or its antenna parameters change.  Lookups use bilinear
+* interpolation through const methods, and may be called concurrently from any number of threads.
+*/
+class SDKCORE_EXPORT AntennaGainGrid
+{
+public:
+  AntennaGainGrid();
+  virtual ~AntennaGainGrid() {}
+
+  /**
+  * Samples the pattern over azimuth [-PI,PI] and elevation [-PI/2,PI/2].  Steps are reduced as
+  * needed to divide each range evenly.  All antenna parameters other than the angles are fixed.
+  * @param[in ] pattern Pattern to sample
+  * @param[in ] params Antenna parameters for the pattern; azim_ and elev_ are ignored
+  * @param[in ] azimStep Maximum azimuth spacing of grid points (rad), default 0.5 degrees
+  * @param[in ] elevStep Maximum elevation spacing of grid points (rad), default 0.5 degrees
+  * @return 0 on success, non-zero if the pattern is not valid or a step is not positive
+  */
+  int build(AntennaPattern& pattern, const AntennaGainParameters& params, float azimStep = 0.00872664626f, float elevStep = 0.00872664626f);
+
+  /**
+  * This method returns the validity status of the grid
+  * @return true once build() has succeeded
+  */
+  bool valid() const { return !gains_.empty(); }
+
+  /**
+  * Interpolates the gain at the given angles.  Azimuth wraps, and elevation is clamped to [-PI/2,PI/2].
+  * @param[in ] azim Relative azimuth angle, referenced to host antenna (rad)
+  * @param[in ] elev Relative elevation angle, referenced to host antenna (rad)
+  * @return antenna pattern gain (dB), or SMALL_DB_VAL if the grid is not valid
+  */
+  float gain(float azim, float elev) const;
+
+  /**
+  * Interpolates the gains at count pairs of angles; results are identical to the single angle gain().
+  * @param[in ] count Number of angles
+  * @param[in ] azim Array of count relative azimuth angles (rad)
+  * @param[in ] elev Array of count relative elevation angles (rad)
+  * @param[out] gains Array of count gains (dB)
+  */
+  void gain(size_t count, const float* azim, const float* elev, float* gains) const;
+
+  /**
+  * This method returns the minimum and maximum gains of the grid points
+  * @param[out] min Minimum gain value to retrieve (dB)
+  * @param[out] max Maximum gain value to retrieve (dB)
+  * @pre min and max valid params
+  */
+  void minMaxGain(float* min, float* max) const;
+
+  /** Number of grid points in azimuth, including both -PI and PI */
+  size_t azimCount() const { return azimCount_; }
+  /** Number of grid points in elevation, including both -PI/2 and PI/2 */
+  size_t elevCount() const { return elevCount_; }
+
+private:
+  std::vector<float> gains_;  ///< Gains (dB), rows of constant elevation from -PI/2 up
+  size_t azimCount_;          ///< Number of grid points in azimuth
+  size_t elevCount_;          ///< Number of grid points in elevation
+  float invAzimStep_;         ///< Inverse of azimuth spacing (1/rad)
+  float invElevStep_;         ///< Inverse of elevation spacing (1/rad)
+  float minGain_;             ///< Minimum gain value (dB)
+  float maxGain_;             ///< Maximum gain value (dB)
+};
+
 } // namespace simCore
 
 #endif /* SIMCORE_EM_ANTENNA_PATTERN_H */
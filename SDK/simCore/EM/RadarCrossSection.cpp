@@ -20,14 +20,24 @@
  * disclose, or release this software.
  *
  */
+#ifdef WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 #include <algorithm>
+#include <atomic>
 #include <string>
 #include <cassert>
 #include <cstring>
 #include <cstdlib>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <cfloat>
 #include <limits>
@@ -39,6 +49,7 @@
 #include "simCore/String/ValidNumber.h"
 #include "simCore/Calc/Interpolation.h"
 #include "simCore/Calc/Angle.h"
+#include "simCore/System/File.h"
 #include "simNotify/Notify.h"
 #include "simCore/EM/Decibel.h"
 #include "simCore/EM/RadarCrossSection.h"
@@ -102,6 +113,75 @@ namespace
     return rv;
   }
 
+  /** Identifies RCS binary cache files */
+  const char RCS_CACHE_MAGIC[8] = { 'S', 'I', 'M', 'R', 'C', 'S', 'B', '\0' };
+  /** Increment when the layout of the binary cache changes */
+  const uint32_t RCS_CACHE_VERSION = 1;
+  /** Written in native byte order; caches from platforms of different endianness are rejected */
+  const uint32_t RCS_CACHE_BYTE_ORDER = 0x01020304;
+  /** Extension added to RCS file names for their binary cache */
+  const char* const RCS_CACHE_EXTENSION = ".rcsbin";
+
+  /** Writes a value in native byte order to a binary cache */
+  template <typename T>
+  void writeCacheValue(std::ostream& os, const T& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  /** Reads a value written by writeCacheValue(), returning false on failure */
+  template <typename T>
+  bool readCacheValue(std::istream& is, T& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+
+  /** Writes the size and contents of a vector to a binary cache */
+  template <typename T>
+  void writeCacheVector(std::ostream& os, const std::vector<T>& vec)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    writeCacheValue(os, static_cast<uint64_t>(vec.size()));
+    os.write(reinterpret_cast<const char*>(vec.data()), vec.size() * sizeof(T));
+  }
+
+  /** Reads a vector written by writeCacheVector() in large blocks, returning false on failure */
+  template <typename T>
+  bool readCacheVector(std::istream& is, std::vector<T>& vec)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    uint64_t size = 0;
+    if (!readCacheValue(is, size) || size > std::numeric_limits<uint32_t>::max())
+      return false;
+    // grow in blocks, so that a corrupt size fails at the end of the stream instead of allocating it all up front
+    const size_t BLOCK_SIZE = 1 << 20;
+    vec.clear();
+    while (vec.size() < size)
+    {
+      const size_t begin = vec.size();
+      vec.resize(begin + std::min(BLOCK_SIZE, static_cast<size_t>(size) - begin));
+      if (!is.read(reinterpret_cast<char*>(vec.data() + begin), (vec.size() - begin) * sizeof(T)))
+        return false;
+    }
+    return true;
+  }
+
+  /** Returns a name next to the given file that no other process or thread is writing */
+  std::string uniqueTempName(const std::string& fileName)
+  {
+    static std::atomic<unsigned int> count(0);
+#ifdef WIN32
+    const int pid = _getpid();
+#else
+    const int pid = static_cast<int>(getpid());
+#endif
+    std::ostringstream os;
+    os << fileName << "." << pid << "." << ++count << ".tmp";
+    return os.str();
+  }
+
 }
 
 namespace simCore {
@@ -212,16 +292,8 @@ RCSLUT::RCSLUT()
   mean_(0.),
   median_(SMALL_DB_VAL),
   min_(std::numeric_limits<float>::max()),
-  max_(-std::numeric_limits<float>::max()),
-  lastFreq_(-std::numeric_limits<float>::max()),
-  lastPolarity_(POLARITY_UNKNOWN)
+  max_(-std::numeric_limits<float>::max())
 {
-  for (unsigned int i = 0; i < 2; ++i)
-  {
-    lastElev_[i] = std::numeric_limits<float>::max();
-    loTable_[i] = nullptr;
-    hiTable_[i] = nullptr;
-  }
 }
 
 RCSLUT::~RCSLUT()
@@ -300,179 +372,151 @@ RCSTable *RCSLUT::getTable_(float freq, float elev, PolarityType pol, bool creat
   return rcsTable;
 }
 
-float RCSLUT::calcTableRCS_(float freq, double azim, double elev, PolarityType pol)
+float RCSLUT::calcTableRCS_(float freq, double azim, double elev, PolarityType pol) const
 {
-  float final_rcs = SMALL_RCS_SM;
+  if (flatPolarities_.empty())
+    return SMALL_RCS_SM;
 
-  if (rcsMap_.empty())
+  // find tables for polarity
+  const FlatPolarity* polTables = nullptr;
+  if (pol == POLARITY_UNKNOWN)
   {
-    return final_rcs;
+    // unknown polarity, grab first one
+    polTables = &flatPolarities_.front();
   }
-
-  RCSTable *rcstabLo = nullptr;
-  RCSTable *rcstabHi = nullptr;
-  bool foundInCache = false;
-  if (simCore::areEqual(lastFreq_, freq, 0.1) && pol == lastPolarity_)
-  {
-    if (lastElev_[0] != std::numeric_limits<float>::max() && simCore::areAnglesEqual(elev, lastElev_[0], 1.0e-11))
-    {
-      rcstabLo = loTable_[0];
-      rcstabHi = hiTable_[0];
-      foundInCache = true;
-    }
-    else if (lastElev_[1] != std::numeric_limits<float>::max() && simCore::areAnglesEqual(elev, lastElev_[1], 1.0e-11))
-    {
-      // note, not promoting this to primary cache
-      rcstabLo = loTable_[1];
-      rcstabHi = hiTable_[1];
-      foundInCache = true;
-    }
-  }
-
-  if (!foundInCache)
+  else
   {
-    // find tables in map
-    POLARITY_FREQ_ELEV_MAP::const_iterator pfeiter;
-    if (pol == POLARITY_UNKNOWN)
+    for (const FlatPolarity& flatPol : flatPolarities_)
     {
-      // unknown polarity, grab first one
-      pfeiter = rcsMap_.begin();
-    }
-    else
-    {
-      pfeiter = rcsMap_.find(pol);
-      if (pfeiter == rcsMap_.end())
+      if (flatPol.polarity == pol)
       {
-        return final_rcs;
+        polTables = &flatPol;
+        break;
       }
     }
+    if (!polTables)
+      return SMALL_RCS_SM;
+  }
 
-    // look for selected frequency
-    FREQMAP* fm = pfeiter->second;
-    FREQ_ELEV_MAP::const_iterator feiter = fm->freqMap.find(freq);
-
-    // choose closest
-    if (feiter == fm->freqMap.end())
-    {
-      feiter = fm->freqMap.lower_bound(freq);
-      if (feiter == fm->freqMap.end())
-      {
-        // grab the last one
-        --feiter;
-      }
-      else if (feiter != fm->freqMap.begin())
-      {
-        float maxFreq = feiter->first;
-        --feiter;
-        float minFreq = feiter->first;
-        if (fabs(freq-minFreq) > fabs(maxFreq-freq))
-        {
-          // max freq is closer to requested freq
-          ++feiter;
-        }
-      }
-    }
+  // look for closest frequency, favoring the lower frequency on ties
+  const FlatFreq* freqBegin = flatFreqs_.data() + polTables->begin;
+  const FlatFreq* freqEnd = flatFreqs_.data() + polTables->end;
+  const FlatFreq* freqIter = std::lower_bound(freqBegin, freqEnd, freq,
+    [](const FlatFreq& flatFreq, float val) { return flatFreq.freq < val; });
+  if (freqIter == freqEnd)
+  {
+    // grab the last one
+    --freqIter;
+  }
+  else if (freqIter != freqBegin && freqIter->freq != freq)
+  {
+    const float maxFreq = freqIter->freq;
+    const float minFreq = (freqIter - 1)->freq;
+    if (fabs(freq - minFreq) <= fabs(maxFreq - freq))
+      --freqIter;
+  }
 
-    // look for selected elev
-    ELEVMAP* emap = feiter->second;
-    ELEV_RCSTABLE_MAP::const_iterator eiter;
-    if (emap->eMap.size() == 1)
-    {
-      eiter = emap->eMap.begin();
-      rcstabLo = eiter->second;
-      rcstabHi = rcstabLo;
-    }
-    else
+  // look for selected elev
+  const FlatElev* elevBegin = flatElevs_.data() + freqIter->begin;
+  const FlatElev* elevEnd = flatElevs_.data() + freqIter->end;
+  const FlatElev* tableLo = elevBegin;
+  const FlatElev* tableHi = elevBegin;
+  if (elevEnd - elevBegin > 1)
+  {
+    // only exact key matches skip interpolation; values close to a key, e.g. elev=30.00001, are interpolated
+    const float elevKey = static_cast<float>(elev);
+    const FlatElev* elevIter = std::lower_bound(elevBegin, elevEnd, elevKey,
+      [](const FlatElev& flatElev, float val) { return flatElev.elev < val; });
+    if (elevIter == elevEnd)
     {
-      // using find here assumes that requests will not be made for elev values close to but not equal to key values, e.g. elev=30.00001
-      // such values will be interpolated; a comparison that uses simCore::areAnglesEqual could be better in such cases.
-      eiter = emap->eMap.find(static_cast<float>(elev));
-      if (eiter != emap->eMap.end())
-      {
-        // exact match found
-        rcstabLo = eiter->second;
-        rcstabHi = rcstabLo;
-      }
-      else
-      {
-        eiter = emap->eMap.lower_bound(static_cast<float>(elev));
-        if (eiter == emap->eMap.end())
-        {
-          // after last table, use rbegin
-          ELEV_RCSTABLE_MAP::const_reverse_iterator riter = emap->eMap.rbegin();
-          rcstabLo = riter->second;
-          rcstabHi = rcstabLo;
-        }
-        else if (eiter == emap->eMap.begin())
-        {
-          // before first table
-          rcstabLo = eiter->second;
-          rcstabHi = rcstabLo;
-        }
-        else
-        {
-          // in between two tables, need to interpolate
-          rcstabHi = eiter->second;
-          --eiter;
-          rcstabLo = eiter->second;
-        }
-      }
+      // after last table
+      tableLo = elevEnd - 1;
+      tableHi = tableLo;
     }
-
-    // cache two elev/table combinations, to support calling pattern used by 3D rcs calculation
-    if (simCore::areEqual(lastFreq_, freq, 0.1) && pol == lastPolarity_)
+    else if (elevIter == elevBegin || elevIter->elev == elevKey)
     {
-      // cache backup elev/table cache
-      loTable_[1] = loTable_[0];
-      hiTable_[1] = hiTable_[0];
-      lastElev_[1] = lastElev_[0];
+      // before first table, or exact match found
+      tableLo = elevIter;
+      tableHi = tableLo;
     }
     else
     {
-      // freq or polarization changed, cached elev/table values are no longer valid
-      loTable_[1] = nullptr;
-      hiTable_[1] = nullptr;
-      lastElev_[1] = std::numeric_limits<float>::max();
+      // in between two tables, need to interpolate
+      tableLo = elevIter - 1;
+      tableHi = elevIter;
     }
-
-    // update cached primary freq/polarity/elev/table combination
-    loTable_[0] = rcstabLo;
-    hiTable_[0] = rcstabHi;
-    lastFreq_ = freq;
-    lastElev_[0] = static_cast<float>(elev);
-    lastPolarity_ = pol;
   }
 
-  // either both tables are null, or both are non-null
-  assert((rcstabLo == nullptr && rcstabHi == nullptr) || (rcstabLo && rcstabHi));
+  if (tableLo == tableHi)
+    return flatTableRCS_(*tableLo, azim);
+  return linearInterpolate(flatTableRCS_(*tableLo, azim), flatTableRCS_(*tableHi, azim), tableLo->elev, elev, tableHi->elev);
+}
 
-  if (rcstabLo == nullptr && rcstabHi == nullptr)
+float RCSLUT::flatTableRCS_(const FlatElev& table, double azim) const
+{
+  const size_t count = table.end - table.begin;
+  if (count == 0)
+    return static_cast<float>(SMALL_RCS_SM);
+  const float* rcs = flatRcs_.data() + table.begin;
+  if (count == 1)
+    return rcs[0];
+
+  const float* azimBegin = flatAzims_.data() + table.begin;
+  const float* azimEnd = azimBegin + count;
+  const float azimKey = static_cast<float>(azim);
+  // branch free lower bound, since azimuths change unpredictably between calls
+  const float* azimIter = azimBegin;
+  for (size_t remaining = count; remaining > 1; )
   {
-    // we didn't find any matching tables
-    final_rcs = dB2Linear(mean_);
+    const size_t half = remaining / 2;
+    azimIter = (azimIter[half] < azimKey) ? azimIter + half : azimIter;
+    remaining -= half;
   }
-  else if (rcstabLo == rcstabHi)
+  azimIter += (*azimIter < azimKey) ? 1 : 0;
+  if (azimIter == azimEnd)
   {
-    // only found one table
-    final_rcs = rcstabLo->RCS(azim);
+    // after last azimuth
+    return rcs[count - 1];
   }
-  else if (rcstabLo && rcstabHi)
+  const size_t index = azimIter - azimBegin;
+  if (index == 0 || *azimIter == azimKey)
+    return rcs[index];
+  return linearInterpolate(rcs[index - 1], rcs[index], azimBegin[index - 1], azim, azimBegin[index]);
+}
+
+void RCSLUT::flattenTables_()
+{
+  flatPolarities_.clear();
+  flatFreqs_.clear();
+  flatElevs_.clear();
+  flatAzims_.clear();
+  flatRcs_.clear();
+
+  for (const auto& polEntry : rcsMap_)
   {
-    // we need to interpolate
-    // we are pretty sure that the two tables cannot have different freqs
-    assert(rcstabLo->freq() == rcstabHi->freq());
-    // we are pretty sure that the elev does not match table values
-    assert(elev > rcstabLo->elev());
-    assert(elev < rcstabHi->elev());
-    final_rcs = linearInterpolate(rcstabLo->RCS(azim), rcstabHi->RCS(azim), rcstabLo->elev(), elev, rcstabHi->elev());
+    flatPolarities_.push_back({ static_cast<int32_t>(polEntry.first), static_cast<uint32_t>(flatFreqs_.size()), 0 });
+    for (const auto& freqEntry : polEntry.second->freqMap)
+    {
+      flatFreqs_.push_back({ freqEntry.first, static_cast<uint32_t>(flatElevs_.size()), 0 });
+      for (const auto& elevEntry : freqEntry.second->eMap)
+      {
+        flatElevs_.push_back({ elevEntry.first, static_cast<uint32_t>(flatAzims_.size()), 0 });
+        for (const auto& azimEntry : elevEntry.second->azimuthMap())
+        {
+          flatAzims_.push_back(azimEntry.first);
+          flatRcs_.push_back(azimEntry.second);
+        }
+        flatElevs_.back().end = static_cast<uint32_t>(flatAzims_.size());
+      }
+      flatFreqs_.back().end = static_cast<uint32_t>(flatElevs_.size());
+    }
+    flatPolarities_.back().end = static_cast<uint32_t>(flatFreqs_.size());
   }
-  // these cases should not occur, assert is above
-  else if (rcstabLo)
-    final_rcs = rcstabLo->RCS(azim);
-  else if (rcstabHi)
-    final_rcs = rcstabHi->RCS(azim);
 
-  return final_rcs;
+  // parsed tables are no longer needed
+  for (const auto& polEntry : rcsMap_)
+    delete polEntry.second;
+  rcsMap_.clear();
 }
 
 float RCSLUT::RCSdB(float freq, double azim, double elev, PolarityType pol)
@@ -532,6 +576,35 @@ float RCSLUT::RCSsm(float freq, double azim, double elev, PolarityType pol)
   return SMALL_RCS_SM;
 }
 
+float RCSLUT::lookupRCSdB(float freq, double azim, double elev, PolarityType pol) const
+{
+  return linear2dB(lookupRCSsm(freq, azim, elev, pol));
+}
+
+float RCSLUT::lookupRCSsm(float freq, double azim, double elev, PolarityType pol) const
+{
+  // convert incoming azimuth & elevation to correct units & limits
+  azim = angFix2PI(azim);
+  elev = angFixPI(elev);
+
+  switch (tableType_)
+  {
+  case RCS_LUT_TYPE:
+    return calcTableRCS_(freq, azim, elev, pol);
+
+  case RCS_SYM_LUT_TYPE:
+    return calcTableRCS_(freq, fabs(angFixPI(azim)), elev, pol);
+
+  case RCS_DISTRIBUTION_FUNC_TYPE:
+  default:
+    {
+      // random distributions are not applied, only the scintillation
+      const double rcs = calcTableRCS_(freq, azim, elev, pol);
+      return static_cast<float>(rcs + modulation_);
+    }
+  }
+}
+
 int RCSLUT::loadXPATCHRCSFile_(std::istream &inFile)
 {
   int rv = 1;
@@ -1284,14 +1357,11 @@ void RCSLUT::reset_()
   tableType_ = RCS_LUT_TYPE;
   functionType_ = RCS_MEAN_FUNC;
   modulation_ = 1.f;
-  lastFreq_ = -std::numeric_limits<float>::max();
-  lastPolarity_ = POLARITY_UNKNOWN;
-  for (unsigned int i = 0; i < 2; ++i)
-  {
-    lastElev_[i] = std::numeric_limits<float>::max();
-    loTable_[i] = nullptr;
-    hiTable_[i] = nullptr;
-  }
+  flatPolarities_.clear();
+  flatFreqs_.clear();
+  flatElevs_.clear();
+  flatAzims_.clear();
+  flatRcs_.clear();
   mean_ = 0.;
   median_ = SMALL_DB_VAL;
   min_ = std::numeric_limits<float>::max();
@@ -1308,6 +1378,30 @@ int RCSLUT::loadRCSFile(const std::string& fname)
     return st;
   }
 
+  // identify the version of the file, for validating the binary cache
+  CacheStamp stamp;
+  bool useCache = false;
+  if (binaryCacheEnabled_)
+  {
+    std::error_code err;
+    stamp.fileSize = static_cast<uint64_t>(std::filesystem::file_size(fname, err));
+    if (!err)
+      stamp.modTime = static_cast<int64_t>(std::filesystem::last_write_time(fname, err).time_since_epoch().count());
+    useCache = !err;
+  }
+
+  const std::string cacheFile = useCache ? cacheFileName_(fname) : "";
+  if (useCache)
+  {
+    std::ifstream cacheStream(simCore::streamFixUtf8(cacheFile), std::ios::in | std::ios::binary);
+    if (cacheStream.is_open() && loadBinaryCache_(cacheStream, &stamp) == 0)
+    {
+      setFilename(fname);
+      SIM_INFO << "Loading RCS File: " << simCore::toNativeSeparators(fname) << " from cache" << std::endl;
+      return 0;
+    }
+  }
+
   // find file
   std::fstream inFile;
   inFile.open(simCore::streamFixUtf8(fname), std::ios::in);
@@ -1324,29 +1418,164 @@ int RCSLUT::loadRCSFile(const std::string& fname)
     return st;
   }
 
+  if (st == 0 && useCache)
+  {
+    // write to a temporary file first, so that other readers never see a partial cache; the name
+    // is unique so that concurrent writers of the same cache do not write into each other's file
+    const std::string tempFile = uniqueTempName(cacheFile);
+    std::ofstream cacheStream(simCore::streamFixUtf8(tempFile), std::ios::out | std::ios::binary | std::ios::trunc);
+    bool written = cacheStream.is_open() && saveBinaryCache_(cacheStream, stamp) == 0;
+    cacheStream.close();
+    std::error_code err;
+    if (written)
+    {
+      std::filesystem::rename(tempFile, cacheFile, err);
+      written = !err;
+    }
+    if (!written)
+    {
+      std::filesystem::remove(tempFile, err);
+      SIM_DEBUG << "Could not write RCS cache file: " << simCore::toNativeSeparators(cacheFile) << std::endl;
+    }
+  }
+
   return st;
 }
 
 int RCSLUT::loadRCSFile(std::istream& istream)
 {
+  int rv = 1;
   RCSType rcsType = getRCSType(istream);
   switch (rcsType)
   {
   case RCS_LUT:
-    return loadRcsLutFile_(istream);
+    rv = loadRcsLutFile_(istream);
+    break;
   case RCS_XPATCH:
-    return loadXPATCHRCSFile_(istream);
+    rv = loadXPATCHRCSFile_(istream);
+    break;
   case RCS_SADM:
-    return loadSADMRCSFile_(istream);
+    rv = loadSADMRCSFile_(istream);
+    break;
   case NO_RCS:
   case RCS_BLOOM:
   case RCS_RTS:
     // Not handled
     break;
   }
-  return 1;
+
+  if (rv == 0)
+    flattenTables_();
+  return rv;
+}
+
+void RCSLUT::setBinaryCache(bool enabled, const std::string& cacheDir)
+{
+  binaryCacheEnabled_ = enabled;
+  binaryCacheDir_ = cacheDir;
+}
+
+std::string RCSLUT::cacheFileName_(const std::string& fname) const
+{
+  if (binaryCacheDir_.empty())
+    return fname + RCS_CACHE_EXTENSION;
+
+  // files of the same name from different directories may share a cache directory, so add a hash of the full path
+  std::error_code err;
+  std::string fullPath = std::filesystem::absolute(fname, err).string();
+  if (err)
+    fullPath = fname;
+  // FNV-1a, which unlike std::hash is the same on every platform
+  uint64_t hash = 14695981039346656037ull;
+  for (const char c : fullPath)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  std::ostringstream os;
+  os << simCore::FileInfo(fname).fileName() << "." << std::hex << std::setw(16) << std::setfill('0') << hash << RCS_CACHE_EXTENSION;
+  return simCore::pathJoin({ binaryCacheDir_, os.str() });
+}
+
+int RCSLUT::saveBinaryCache(std::ostream& os) const
+{
+  return saveBinaryCache_(os, CacheStamp());
 }
 
+int RCSLUT::loadBinaryCache(std::istream& is)
+{
+  return loadBinaryCache_(is, nullptr);
+}
+
+int RCSLUT::saveBinaryCache_(std::ostream& os, const CacheStamp& stamp) const
+{
+  os.write(RCS_CACHE_MAGIC, sizeof(RCS_CACHE_MAGIC));
+  writeCacheValue(os, RCS_CACHE_VERSION);
+  writeCacheValue(os, RCS_CACHE_BYTE_ORDER);
+  writeCacheValue(os, stamp.fileSize);
+  writeCacheValue(os, stamp.modTime);
+
+  writeCacheValue(os, static_cast<int32_t>(tableType_));
+  writeCacheValue(os, static_cast<int32_t>(functionType_));
+  writeCacheValue(os, modulation_);
+  writeCacheValue(os, mean_);
+  writeCacheValue(os, median_);
+  writeCacheValue(os, min_);
+  writeCacheValue(os, max_);
+  writeCacheVector(os, std::vector<char>(description_.begin(), description_.end()));
+
+  writeCacheVector(os, flatPolarities_);
+  writeCacheVector(os, flatFreqs_);
+  writeCacheVector(os, flatElevs_);
+  writeCacheVector(os, flatAzims_);
+  writeCacheVector(os, flatRcs_);
+  return os.good() ? 0 : 1;
+}
+
+int RCSLUT::loadBinaryCache_(std::istream& is, const CacheStamp* stamp)
+{
+  char magic[sizeof(RCS_CACHE_MAGIC)] = { 0 };
+  uint32_t version = 0;
+  uint32_t byteOrder = 0;
+  CacheStamp fileStamp;
+  is.read(magic, sizeof(magic));
+  if (!readCacheValue(is, version) || !readCacheValue(is, byteOrder) || !readCacheValue(is, fileStamp.fileSize) || !readCacheValue(is, fileStamp.modTime))
+    return 1;
+  // caches from other versions or platforms are rebuilt from the source file, and are not an error
+  if (memcmp(magic, RCS_CACHE_MAGIC, sizeof(magic)) != 0 || version != RCS_CACHE_VERSION || byteOrder != RCS_CACHE_BYTE_ORDER)
+    return 1;
+  if (stamp && (stamp->fileSize != fileStamp.fileSize || stamp->modTime != fileStamp.modTime))
+    return 1;
+
+  reset_();
+  int32_t tableType = 0;
+  int32_t functionType = 0;
+  std::vector<char> description;
+  bool valid = readCacheValue(is, tableType) && readCacheValue(is, functionType) && readCacheValue(is, modulation_) &&
+    readCacheValue(is, mean_) && readCacheValue(is, median_) && readCacheValue(is, min_) && readCacheValue(is, max_) &&
+    readCacheVector(is, description) && readCacheVector(is, flatPolarities_) && readCacheVector(is, flatFreqs_) &&
+    readCacheVector(is, flatElevs_) && readCacheVector(is, flatAzims_) && readCacheVector(is, flatRcs_);
+  description_.assign(description.begin(), description.end());
+  tableType_ = static_cast<RCSTableType>(tableType);
+  functionType_ = static_cast<RCSFuncType>(functionType);
+
+  // verify that all ranges are valid; polarities and frequencies must not be empty
+  valid = valid && tableType >= RCS_DISTRIBUTION_FUNC_TYPE && tableType <= RCS_SYM_LUT_TYPE &&
+    functionType >= RCS_MEAN_FUNC && functionType <= RCS_LOG_NORMAL_FUNC && flatAzims_.size() == flatRcs_.size();
+  for (size_t k = 0; valid && k < flatPolarities_.size(); ++k)
+    valid = flatPolarities_[k].begin < flatPolarities_[k].end && flatPolarities_[k].end <= flatFreqs_.size();
+  for (size_t k = 0; valid && k < flatFreqs_.size(); ++k)
+    valid = flatFreqs_[k].begin < flatFreqs_[k].end && flatFreqs_[k].end <= flatElevs_.size();
+  for (size_t k = 0; valid && k < flatElevs_.size(); ++k)
+    valid = flatElevs_[k].begin <= flatElevs_[k].end && flatElevs_[k].end <= flatAzims_.size();
+  if (!valid)
+  {
+    SIM_WARN << "Ignoring invalid RCS cache data" << std::endl;
+    reset_();
+    return 1;
+  }
+  return 0;
+}
 
 /* ************************************************************************ */
 /* RcsFileParser Methods                                                    */
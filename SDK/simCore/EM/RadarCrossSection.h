@@ -23,6 +23,8 @@
 #ifndef SIMCORE_EM_RADAR_CROSS_SECTION_H
 #define SIMCORE_EM_RADAR_CROSS_SECTION_H
 
+#include <cstdint>
+#include <istream>
 #include <ostream>
 #include <map>
 #include <memory>
@@ -167,6 +169,12 @@ namespace simCore
     */
     void setPolarity(PolarityType val) { polarity_ = val; }
 
+    /**
+    * This method retrieves the RCS data of this RCSTable
+    * @return RCS data (sqm) keyed on host body azimuth (rad)
+    */
+    const AZIM_RCS_MAP& azimuthMap() const { return azMap_; }
+
   protected:
     float freq_;              ///< RCS measured frequency (MHz)
     float elev_;              ///< elevation angle (rad)
@@ -215,6 +223,11 @@ namespace simCore
    * Elevation and azimuth values are interpolated, if the data allows.  This class also has the
    * ability to perform various types of distributions on the RCSTable data.  Currently Gaussian,
    * Rayleigh and Log normal distributions are supported.
+   *
+   * Once loaded, the sub-tables are flattened into contiguous sorted arrays.  Lookups through
+   * lookupRCSsm() and lookupRCSdB() do not modify the object and may be made concurrently from
+   * multiple threads.  Parsed files can optionally be stored in a binary cache to speed up later
+   * loads of the same file; see setBinaryCache().
    */
   class SDKCORE_EXPORT RCSLUT : public RadarCrossSection
   {
@@ -264,6 +277,52 @@ namespace simCore
     */
     virtual float RCSdB(float freq, double azim, double elev, PolarityType pol=POLARITY_UNKNOWN);
 
+    /**
+    * Const version of RCSsm() that is safe to call concurrently from multiple threads.  Table values
+    * are interpolated exactly as in RCSsm().  Random distribution functions are not applied; for
+    * distribution function tables the modulation is added to the table value, as with RCS_MEAN_FUNC.
+    * @param[in ] freq Frequency of radar in MHz
+    * @param[in ] azim Relative azimuth angle, referenced to host platform (rad)
+    * @param[in ] elev Relative elevation angle, referenced to host platform (rad)
+    * @param[in ] pol Radar polarity
+    * @return RCS value (square meters)
+    */
+    float lookupRCSsm(float freq, double azim, double elev, PolarityType pol=POLARITY_UNKNOWN) const;
+
+    /**
+    * Const version of RCSdB(); see lookupRCSsm()
+    * @param[in ] freq Frequency of radar in MHz
+    * @param[in ] azim Relative azimuth angle, referenced to host platform (rad)
+    * @param[in ] elev Relative elevation angle, referenced to host platform (rad)
+    * @param[in ] pol Radar polarity
+    * @return RCS value (dB)
+    */
+    float lookupRCSdB(float freq, double azim, double elev, PolarityType pol=POLARITY_UNKNOWN) const;
+
+    /**
+    * Enables a binary cache for loadRCSFile(const std::string&).  When enabled, successfully parsed
+    * files are written to a cache file, and later loads of the same file read the cache instead of
+    * parsing the text.  A cache file is ignored and rewritten if the size or modification time of the
+    * source file changes, or if it was written with a different cache format version.  Disabled by default.
+    * @param[in ] enabled True to read and write cache files
+    * @param[in ] cacheDir Directory for cache files; if empty, cache files are written next to the source file
+    */
+    void setBinaryCache(bool enabled, const std::string& cacheDir = "");
+
+    /**
+    * This method writes the loaded RCS data to a binary stream, for reading with loadBinaryCache()
+    * @param[in ] os Output stream, opened in binary mode
+    * @return 0 on success
+    */
+    int saveBinaryCache(std::ostream& os) const;
+
+    /**
+    * This method replaces the RCS data with data written by saveBinaryCache().  The data is reset on failure.
+    * @param[in ] is Input stream, opened in binary mode
+    * @return 0 on success
+    */
+    int loadBinaryCache(std::istream& is);
+
     /**
     * This method sets the radar cross section modulation value
     * @param[in ] mod Radar cross section modulation value (sq meters)
@@ -310,13 +369,7 @@ namespace simCore
     float median_;                      ///< median cross section (dBsm) center or midpoint of sorted RCS
     float min_;                         ///< min cross section (dBsm)
     float max_;                         ///< max cross section (dBsm)
-    POLARITY_FREQ_ELEV_MAP rcsMap_;     ///< RCS data
-
-    float lastFreq_;                    ///< last frequency used for look up
-    float lastElev_[2];                 ///< two last elevations used for look up
-    PolarityType lastPolarity_;         ///< last polarity used for look up
-    RCSTable *loTable_[2];              ///< pointers to two last accessed lo tables
-    RCSTable *hiTable_[2];              ///< pointers to two last accessed hi tables
+    POLARITY_FREQ_ELEV_MAP rcsMap_;     ///< RCS data while parsing; moved to the flattened tables by flattenTables_()
 
     /**
     * This method returns an azimuth based RCSTable
@@ -336,7 +389,13 @@ namespace simCore
     * @param[in ] pol Radar polarity
     * @return RCS value in square meters.
     */
-    float calcTableRCS_(float freq, double azim, double elev, PolarityType pol);
+    float calcTableRCS_(float freq, double azim, double elev, PolarityType pol) const;
+
+    /**
+    * This method moves the parsed RCS data from rcsMap_ into the flattened tables used for look up.
+    * Called after a file is loaded successfully.
+    */
+    void flattenTables_();
 
     /**
     * This method parses and loads a RCS table file (RCS_LUT type)
@@ -378,6 +437,59 @@ namespace simCore
     * medianVec must not be empty
     */
     void computeStatistics_(std::vector<float>* medianVec);
+
+  private:
+    /** Identifies the version of a source file stored in a binary cache */
+    struct CacheStamp
+    {
+      uint64_t fileSize = 0;   ///< size of the source file (bytes)
+      int64_t modTime = 0;     ///< modification time of the source file, in file clock ticks
+    };
+
+    /** Range of flatFreqs_ entries for one polarity */
+    struct FlatPolarity
+    {
+      int32_t polarity;    ///< PolarityType of the tables
+      uint32_t begin;      ///< index of the first frequency
+      uint32_t end;        ///< index past the last frequency
+    };
+
+    /** Range of flatElevs_ entries for one frequency */
+    struct FlatFreq
+    {
+      float freq;          ///< RCS measured frequency (MHz)
+      uint32_t begin;      ///< index of the first elevation
+      uint32_t end;        ///< index past the last elevation
+    };
+
+    /** Range of flatAzims_ and flatRcs_ entries for one elevation table */
+    struct FlatElev
+    {
+      float elev;          ///< elevation angle (rad)
+      uint32_t begin;      ///< index of the first azimuth
+      uint32_t end;        ///< index past the last azimuth
+    };
+
+    /** Returns the RCS value (sq meter) of a flattened table, interpolated on azimuth like RCSTable::RCS() */
+    float flatTableRCS_(const FlatElev& table, double azim) const;
+
+    /** Writes the binary cache, including the stamp of its source file */
+    int saveBinaryCache_(std::ostream& os, const CacheStamp& stamp) const;
+
+    /** Reads the binary cache, failing if stamp is not nullptr and does not match the stored stamp */
+    int loadBinaryCache_(std::istream& is, const CacheStamp* stamp);
+
+    /** Returns the name of the cache file for the given RCS file */
+    std::string cacheFileName_(const std::string& fname) const;
+
+    std::vector<FlatPolarity> flatPolarities_;  ///< tables by polarity, sorted on polarity
+    std::vector<FlatFreq> flatFreqs_;           ///< tables by frequency, sorted on frequency within each polarity
+    std::vector<FlatElev> flatElevs_;           ///< tables by elevation, sorted on elevation within each frequency
+    std::vector<float> flatAzims_;              ///< azimuth (rad) of each RCS value, sorted within each table
+    std::vector<float> flatRcs_;                ///< RCS values (sq meter)
+
+    bool binaryCacheEnabled_ = false;           ///< true to read and write binary caches in loadRCSFile()
+    std::string binaryCacheDir_;                ///< directory for binary caches; empty to write next to the source file
   };
 
   /** @brief Contains static methods for loading RCS data files. */
@@ -22,11 +22,24 @@
  */
 #include <algorithm>
 #include <cassert>
+#include <filesystem>
+#include <limits>
+#include "simCore/String/Constants.h"
 #include "simCore/String/Format.h"
 #include "simCore/String/Tokenizer.h"
+#include "simCore/String/UtfUtils.h"
 #include "simCore/String/Utils.h"
 #include "simCore/String/CsvReader.h"
 
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace simCore
 {
 
@@ -314,6 +327,479 @@ int CsvReader::readLineTrimmed(std::vector<std::string>& tokens, bool skipEmptyL
 
 /////////////////////////////////////////////////////////////////
 
+/** Read-only memory mapping of a whole file */
+class MappedCsvReader::FileMapping
+{
+public:
+  FileMapping() = default;
+  SDK_DISABLE_COPY_MOVE(FileMapping);
+
+  ~FileMapping()
+  {
+    if (!data_)
+      return;
+#ifdef WIN32
+    UnmapViewOfFile(data_);
+#else
+    munmap(const_cast<char*>(data_), size_);
+#endif
+  }
+
+  /** Maps the file, returning 0 on success.  Empty files succeed with empty text. */
+  int open(const std::string& filename)
+  {
+#ifdef WIN32
+    const std::filesystem::path path(simCore::streamFixUtf8(filename));
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+      return 1;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || static_cast<uint64_t>(fileSize.QuadPart) > std::numeric_limits<size_t>::max())
+    {
+      CloseHandle(file);
+      return 1;
+    }
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+    if (size_ == 0)
+    {
+      CloseHandle(file);
+      return 0;
+    }
+    // The view keeps the file open after its handles are closed
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping)
+    {
+      data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+      CloseHandle(mapping);
+    }
+    CloseHandle(file);
+#else
+    const int fd = ::open(simCore::streamFixUtf8(filename).c_str(), O_RDONLY);
+    if (fd < 0)
+      return 1;
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || static_cast<uint64_t>(fileStat.st_size) > std::numeric_limits<size_t>::max())
+    {
+      ::close(fd);
+      return 1;
+    }
+    size_ = static_cast<size_t>(fileStat.st_size);
+    if (size_ == 0)
+    {
+      ::close(fd);
+      return 0;
+    }
+    // The mapping keeps the file open after the descriptor is closed
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data != MAP_FAILED)
+      data_ = static_cast<const char*>(data);
+#endif
+    if (!data_)
+    {
+      size_ = 0;
+      return 1;
+    }
+    return 0;
+  }
+
+  /** Returns the contents of the mapped file */
+  std::string_view text() const
+  {
+    return std::string_view(data_, size_);
+  }
+
+private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+MappedCsvReader::MappedCsvReader()
+{
+}
+
+MappedCsvReader::MappedCsvReader(std::string_view text)
+  : text_(text)
+{
+}
+
+MappedCsvReader::~MappedCsvReader()
+{
+}
+
+int MappedCsvReader::open(const std::string& filename)
+{
+  auto mapping = std::make_shared<FileMapping>();
+  if (mapping->open(filename) != 0)
+    return 1;
+
+  mapping_ = mapping;
+  text_ = mapping_->text();
+  pos_ = 0;
+  physicalLineStart_ = 0;
+  lineBegin_ = 0;
+  newlineAppended_ = false;
+  lineNumber_ = 0;
+  linesFoundInRead_ = 1;
+  ranges_.clear();
+  storage_.clear();
+  return 0;
+}
+
+std::string_view MappedCsvReader::text() const
+{
+  return text_;
+}
+
+void MappedCsvReader::setCommentChar(char commentChar)
+{
+  commentChar_ = commentChar;
+}
+
+void MappedCsvReader::setDelimiterChar(char delim)
+{
+  delimiter_ = delim;
+}
+
+void MappedCsvReader::setQuoteChar(char quote)
+{
+  quote_ = quote;
+}
+
+void MappedCsvReader::setLimitReadToSingleLine(bool singleLine)
+{
+  limitToSingleLine_ = singleLine;
+}
+
+void MappedCsvReader::setAllowMidlineComments(bool allow)
+{
+  allowMidlineComments_ = allow;
+}
+
+size_t MappedCsvReader::lineNumber() const
+{
+  return lineNumber_;
+}
+
+std::string_view MappedCsvReader::lineText() const
+{
+  return text_.substr(lineBegin_, pos_ - lineBegin_);
+}
+
+bool MappedCsvReader::readNext_(char& ch, size_t& rawPos, size_t& rawLen)
+{
+  const size_t size = text_.size();
+  if (pos_ >= size)
+  {
+    // CsvReader reads lines with std::getline(), so the last line always ends in a newline
+    if (newlineAppended_ || size == 0 || text_[size - 1] == '\n' || text_[size - 1] == '\r')
+      return false;
+    newlineAppended_ = true;
+    ch = '\n';
+    rawPos = size;
+    rawLen = 0;
+    return true;
+  }
+
+  rawPos = pos_;
+  rawLen = 1;
+  ch = text_[pos_++];
+  // A carriage return ending a line is read as the newline, like CsvReader
+  if (ch == '\r' && (pos_ == size || text_[pos_] == '\n'))
+  {
+    ch = '\n';
+    if (pos_ < size)
+    {
+      ++pos_;
+      rawLen = 2;
+    }
+  }
+  if (ch == '\n')
+    physicalLineStart_ = pos_;
+  return true;
+}
+
+template <bool StoreTokens>
+int MappedCsvReader::readLineImpl_()
+{
+  if constexpr (StoreTokens)
+  {
+    ranges_.clear();
+    storage_.clear();
+  }
+  size_t numTokens = 0;
+  lineBegin_ = pos_;
+
+  char ch = '\0';
+  size_t rawPos = 0;
+  size_t rawLen = 0;
+  bool valid = readNext_(ch, rawPos, rawLen);
+  // Skip linefeed characters
+  while (valid && ch == '\r')
+    valid = readNext_(ch, rawPos, rawLen);
+  // Invalid read, done
+  if (!valid)
+    return 1;
+  lineNumber_ += linesFoundInRead_;
+  // reset lines found in read now that new read is starting
+  linesFoundInRead_ = 1;
+
+  // Tokens refer to text_ until they differ from it, then are copied to storage_
+  TokenRange token;
+  const auto append = [this, &token](char tokenCh, size_t tokenPos, size_t tokenLen) {
+    if constexpr (StoreTokens)
+    {
+      if (!token.stored)
+      {
+        const bool sameAsText = (tokenLen == 1 && text_[tokenPos] == tokenCh);
+        if (sameAsText && token.size == 0)
+          token.begin = tokenPos;
+        if (sameAsText && tokenPos == token.begin + token.size)
+        {
+          ++token.size;
+          return;
+        }
+        token.stored = true;
+        const size_t storedBegin = storage_.size();
+        storage_.append(text_.substr(token.begin, token.size));
+        token.begin = storedBegin;
+      }
+      storage_ += tokenCh;
+    }
+    ++token.size;
+  };
+  // Appends the characters from pos_ up to end, which must not need conversion, and moves pos_ to end
+  const auto appendRun = [this, &token](size_t end) {
+    if constexpr (StoreTokens)
+    {
+      if (token.stored)
+        storage_.append(text_.substr(pos_, end - pos_));
+      else
+        assert(token.begin + token.size == pos_);
+    }
+    token.size += end - pos_;
+    pos_ = end;
+  };
+  const auto endToken = [this, &token, &numTokens]() {
+    if constexpr (StoreTokens)
+      ranges_.push_back(token);
+    token = TokenRange();
+    ++numTokens;
+  };
+
+  // Same state machine as CsvReader::readLineImpl_()
+  bool wholeTokenQuoted = false;
+  bool insideQuote = false;
+  bool started = false;
+
+  while (valid)
+  {
+    if (insideQuote)
+    {
+      assert(wholeTokenQuoted);
+
+      if (ch == '\n')
+      {
+        if (limitToSingleLine_)
+          break;
+        ++linesFoundInRead_;
+      }
+
+      started = true;
+      if (ch == quote_)
+        insideQuote = false;
+      else
+      {
+        append(ch, rawPos, rawLen);
+        // Quoted text continues to the next quote or line ending
+        size_t end = pos_;
+        while (end < text_.size() && text_[end] != quote_ && text_[end] != '\n' && text_[end] != '\r')
+          ++end;
+        appendRun(end);
+      }
+      valid = readNext_(ch, rawPos, rawLen);
+      continue;
+    }
+
+    if (wholeTokenQuoted && ch != quote_)
+      wholeTokenQuoted = false;
+
+    if (ch == quote_)
+    {
+      if (token.size == 0)
+        wholeTokenQuoted = true;
+
+      if (wholeTokenQuoted)
+      {
+        insideQuote = true;
+        // Handle double quote inside
+        if (started)
+          append(ch, rawPos, rawLen);
+      }
+      else
+        append(ch, rawPos, rawLen);
+    }
+    else if (ch == delimiter_)
+    {
+      endToken();
+      started = false;
+      wholeTokenQuoted = false;
+    }
+    else if (ch == '\r')
+    {
+      // noop
+    }
+    else if (ch == '\n')
+    {
+      // end of line, break out of loop
+      break;
+    }
+    else if (ch == commentChar_)
+    {
+      // Mid-line comment characters are kept if mid-line comments are not allowed
+      if (rawPos > physicalLineStart_ && !allowMidlineComments_)
+      {
+        append(ch, rawPos, rawLen);
+        valid = readNext_(ch, rawPos, rawLen);
+        continue;
+      }
+
+      // Treat like end of line, and read until end of line
+      while (valid && ch != '\n')
+        valid = readNext_(ch, rawPos, rawLen);
+      break;
+    }
+    else // save character
+    {
+      append(ch, rawPos, rawLen);
+      // Consume the rest of the run of characters without special meaning at once
+      size_t end = pos_;
+      while (end < text_.size() && text_[end] != delimiter_ && text_[end] != quote_ && text_[end] != '\n' &&
+        text_[end] != '\r' && text_[end] != commentChar_)
+        ++end;
+      appendRun(end);
+    }
+    valid = readNext_(ch, rawPos, rawLen);
+  }
+
+  // Only save empty token, if ending in a delimiter
+  if (token.size != 0 || numTokens != 0)
+    endToken();
+  return 0;
+}
+
+void MappedCsvReader::fillTokens_(std::vector<std::string_view>& tokens) const
+{
+  tokens.clear();
+  const std::string_view stored(storage_);
+  for (const TokenRange& range : ranges_)
+    tokens.push_back((range.stored ? stored : text_).substr(range.begin, range.size));
+}
+
+int MappedCsvReader::readLine(std::vector<std::string_view>& tokens, bool skipEmptyLines)
+{
+  int rv = readLineImpl_<true>();
+  while (rv == 0 && skipEmptyLines && ranges_.empty())
+    rv = readLineImpl_<true>();
+  if (rv != 0)
+    ranges_.clear();
+  fillTokens_(tokens);
+  return rv;
+}
+
+int MappedCsvReader::readLineTrimmed(std::vector<std::string_view>& tokens, bool skipEmptyLines)
+{
+  while (1)
+  {
+    const int rv = readLine(tokens, skipEmptyLines);
+    if (rv != 0)
+      return rv;
+
+    // Remove leading and trailing whitespace from all tokens
+    for (std::string_view& token : tokens)
+    {
+      const size_t firstPos = token.find_first_not_of(STR_WHITE_SPACE_CHARS);
+      if (firstPos == std::string_view::npos)
+        token = std::string_view();
+      else
+        token = token.substr(firstPos, 1 + token.find_last_not_of(STR_WHITE_SPACE_CHARS) - firstPos);
+    }
+
+    // If there is only one token and it's empty, we need to clear the token
+    if (tokens.size() == 1 && tokens[0].empty())
+      tokens.clear();
+    // If we skip empty lines, and this was an empty line, then we keep going
+    if (!skipEmptyLines || !tokens.empty())
+      break;
+  }
+  return 0;
+}
+
+std::vector<MappedCsvReader> MappedCsvReader::split(size_t maxChunks) const
+{
+  std::vector<MappedCsvReader> chunks;
+  if (pos_ >= text_.size())
+    return chunks;
+
+  // Every newline ends a record unless quoted text can span lines
+  const bool newlinesEndRecords = limitToSingleLine_ || text_.find(quote_, pos_) == std::string_view::npos;
+
+  // Scanner advances through the text to find record boundaries, tracking line numbers
+  MappedCsvReader scanner(*this);
+  chunks.push_back(*this);
+  const size_t remaining = text_.size() - pos_;
+  for (size_t k = 1; k < maxChunks; ++k)
+  {
+    const size_t target = pos_ + remaining * k / maxChunks;
+    if (target <= scanner.pos_)
+      continue;
+
+    if (newlinesEndRecords)
+    {
+      const size_t newline = text_.find('\n', target - 1);
+      if (newline == std::string_view::npos)
+        break;
+      const size_t numLines = std::count(text_.begin() + scanner.pos_, text_.begin() + newline + 1, '\n');
+      scanner.lineNumber_ += scanner.linesFoundInRead_ + numLines - 1;
+      scanner.linesFoundInRead_ = 1;
+      scanner.pos_ = newline + 1;
+    }
+    else
+    {
+      while (scanner.pos_ < target && scanner.readLineImpl_<false>() == 0)
+      {
+      }
+    }
+    if (scanner.pos_ >= text_.size())
+      break;
+
+    MappedCsvReader chunk(*this);
+    chunk.pos_ = scanner.pos_;
+    chunk.physicalLineStart_ = scanner.pos_;
+    chunk.lineBegin_ = scanner.pos_;
+    chunk.lineNumber_ = scanner.lineNumber_;
+    chunk.linesFoundInRead_ = scanner.linesFoundInRead_;
+    chunks.push_back(chunk);
+  }
+
+  // Each chunk ends where the next one begins, and its text starts at its first record
+  for (size_t k = 0; k < chunks.size(); ++k)
+  {
+    MappedCsvReader& chunk = chunks[k];
+    const size_t begin = (k == 0) ? 0 : chunk.pos_;
+    const size_t end = (k + 1 < chunks.size()) ? chunks[k + 1].pos_ : text_.size();
+    chunk.text_ = text_.substr(begin, end - begin);
+    chunk.pos_ -= begin;
+    chunk.physicalLineStart_ -= begin;
+    chunk.lineBegin_ -= begin;
+    chunk.ranges_.clear();
+    chunk.storage_.clear();
+  }
+  return chunks;
+}
+
+/////////////////////////////////////////////////////////////////
+
 RowReader::RowReader(simCore::CsvReader& reader)
   : reader_(reader)
 {
@@ -28,6 +28,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "simCore/Common/Common.h"
 
@@ -141,6 +142,150 @@ private:
   std::unique_ptr<BufferedReader> buffer_;
 };
 
+/**
+ * CSV reader for large files, reading directly from memory instead of a stream.  Files are
+ * memory mapped with open(), or text already in memory can be passed to the constructor.
+ * Parsing rules, including quotes, comments, and line numbers, match CsvReader.
+ *
+ * Tokens are returned as std::string_view.  Most tokens refer directly to the file contents and
+ * remain valid while the file is open.  Tokens that differ from the file text, such as tokens with
+ * doubled quotes or quoted line endings, refer to storage in the reader that remains valid until
+ * the next read.
+ *
+ * Large files can be read in parallel with split(), which divides the remaining text at record
+ * boundaries into separate readers, one per thread:
+ * <code>
+ * simCore::MappedCsvReader reader;
+ * if (reader.open(filename) != 0)
+ *   return 1;
+ * std::vector<simCore::MappedCsvReader> chunks = reader.split(pool.numThreads());
+ * pool.parallelFor(chunks.size(), [&chunks](size_t beginIndex, size_t endIndex) {
+ *   std::vector<std::string_view> tokens;
+ *   for (size_t k = beginIndex; k < endIndex; ++k)
+ *   {
+ *     while (chunks[k].readLine(tokens) == 0)
+ *       processTokens(tokens, chunks[k].lineNumber());
+ *   }
+ * });
+ * </code>
+ */
+class SDKCORE_EXPORT MappedCsvReader
+{
+public:
+  /** Creates a reader with no text; call open() to read a file */
+  MappedCsvReader();
+  /** Creates a reader over text in memory.  The text must remain valid while this reader, and readers split from it, are in use */
+  explicit MappedCsvReader(std::string_view text);
+  virtual ~MappedCsvReader();
+
+  /**
+   * Memory maps the file and resets the reader to read from its start.  The mapping is
+   * shared with readers returned by split(), and is released when the last of them is destroyed.
+   * @param filename UTF-8 name of the file to read
+   * @return 0 on success, non-zero on error
+   */
+  int open(const std::string& filename);
+
+  /** Returns all text of this reader, e.g. the contents of the mapped file */
+  std::string_view text() const;
+
+  /** Sets the char that denotes a comment line. Defaults to '#'. */
+  void setCommentChar(char commentChar);
+  /** Sets the delimiter between tokens, typically comma */
+  void setDelimiterChar(char delim);
+  /** Sets the quote character; see CsvReader::setQuoteChar() */
+  void setQuoteChar(char quote);
+  /** Limits quoted text to a single line; see CsvReader::setLimitReadToSingleLine() */
+  void setLimitReadToSingleLine(bool singleLine);
+  /** Sets whether a comment character mid-line ends the line; see CsvReader::setAllowMidlineComments() */
+  void setAllowMidlineComments(bool allow);
+
+  /** Gets the line number of the most recently read line; see CsvReader::lineNumber() */
+  size_t lineNumber() const;
+  /** Gets the text of the most recently read CSV line, as it appears in the file, including line endings */
+  std::string_view lineText() const;
+
+  /**
+   * Reads the next line into the given vector, as with CsvReader::readLine()
+   * @param[out] tokens  Vector filled with tokens from the next line
+   * @param[in] skipEmptyLines  If true, will skip empty and commented-out lines when reading.
+   *    If false, will break on empty lines and return 0 with an empty tokens vector.
+   * @return 0 on successful line read, 1 when the end of the text is reached
+   */
+  int readLine(std::vector<std::string_view>& tokens, bool skipEmptyLines = true);
+
+  /**
+   * Reads the next line into the given vector, trimming leading and trailing whitespace from
+   * each token, as with CsvReader::readLineTrimmed()
+   * @param[out] tokens  Vector filled with tokens from the next line
+   * @param[in] skipEmptyLines  If true, will skip empty and commented-out lines when reading.
+   *    If false, will break on empty lines and return 0 with an empty tokens vector.
+   * @return 0 on successful line read, 1 when the end of the text is reached
+   */
+  int readLineTrimmed(std::vector<std::string_view>& tokens, bool skipEmptyLines = true);
+
+  /**
+   * Divides the unread text into at most maxChunks readers of similar size, for reading in
+   * parallel.  Each chunk starts at the beginning of a CSV record, so that reading all chunks in
+   * order returns the same lines and line numbers as reading this reader.  Chunks use the current
+   * settings of this reader.  This reader is not modified.  Finding record boundaries requires a
+   * sequential scan of the text if it contains quotes that may span multiple lines.
+   * @param maxChunks Maximum number of readers to return
+   * @return Readers over consecutive parts of the unread text; empty if no text remains
+   */
+  std::vector<MappedCsvReader> split(size_t maxChunks) const;
+
+private:
+  class FileMapping;
+
+  /** Location of a token, in either text_ or storage_ */
+  struct TokenRange
+  {
+    bool stored = false;
+    size_t begin = 0;
+    size_t size = 0;
+  };
+
+  /**
+   * Reads a character, converting line endings the same way as CsvReader, and appending a
+   * line ending to text that does not end in one.
+   * @param[out] ch Character read
+   * @param[out] rawPos Position of the character in text_
+   * @param[out] rawLen Number of characters of text_ consumed; 2 for CRLF, 0 for an appended line ending
+   * @return false at end of text
+   */
+  bool readNext_(char& ch, size_t& rawPos, size_t& rawLen);
+
+  /**
+   * Reads a CSV line with the same rules as CsvReader::readLineImpl_().  Tokens are stored in
+   * ranges_ if StoreTokens is true, else the line is skipped.
+   * @return 0 on success, non-zero at end of text
+   */
+  template <bool StoreTokens>
+  int readLineImpl_();
+
+  /** Fills tokens from ranges_ */
+  void fillTokens_(std::vector<std::string_view>& tokens) const;
+
+  std::shared_ptr<const FileMapping> mapping_;
+  std::string_view text_;
+  size_t pos_ = 0;
+  size_t physicalLineStart_ = 0;
+  size_t lineBegin_ = 0;
+  bool newlineAppended_ = false;
+
+  char commentChar_ = '#';
+  char delimiter_ = ',';
+  char quote_ = '"';
+  bool allowMidlineComments_ = true;
+  bool limitToSingleLine_ = false;
+  size_t lineNumber_ = 0;
+  size_t linesFoundInRead_ = 1;
+
+  std::vector<TokenRange> ranges_;
+  std::string storage_;
+};
+
 /** Convenience interface into a CsvReader that can read headers and reference fields by header name */
 class SDKCORE_EXPORT RowReader
 {
@@ -0,0 +1,154 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include "simCore/System/ThreadPool.h"
+
+namespace simCore {
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+{
+  if (numThreads == 0)
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  // Calling thread counts as one of the threads
+  for (unsigned int k = 1; k < numThreads; ++k)
+    workers_.emplace_back([this]() { run_(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+  }
+  taskReady_.notify_all();
+  for (auto& worker : workers_)
+    worker.join();
+
+  // Workers drain the queue before exiting, but a pool without workers may have nothing to drain
+  while (runPendingTask_())
+  {
+  }
+}
+
+unsigned int ThreadPool::numThreads() const
+{
+  return static_cast<unsigned int>(workers_.size() + 1);
+}
+
+void ThreadPool::execute(const std::function<void()>& task)
+{
+  if (workers_.empty())
+  {
+    task();
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(task);
+  }
+  taskReady_.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t beginIndex, size_t endIndex)>& fn)
+{
+  if (count == 0)
+    return;
+
+  const size_t numChunks = std::min(count, static_cast<size_t>(numThreads()));
+  if (numChunks == 1)
+  {
+    fn(0, count);
+    return;
+  }
+
+  // Spread the remainder over the first chunks so that sizes differ by at most 1
+  const size_t chunkSize = count / numChunks;
+  const size_t remainder = count % numChunks;
+  size_t remaining = numChunks - 1;
+
+  size_t beginIndex = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t k = 0; k < numChunks - 1; ++k)
+    {
+      const size_t endIndex = beginIndex + chunkSize + (k < remainder ? 1 : 0);
+      tasks_.push_back([this, &fn, &remaining, beginIndex, endIndex]() {
+        fn(beginIndex, endIndex);
+        std::lock_guard<std::mutex> lock(mutex_);
+        --remaining;
+        taskDone_.notify_all();
+      });
+      beginIndex = endIndex;
+    }
+  }
+  taskReady_.notify_all();
+
+  // Last chunk is processed on the calling thread
+  fn(beginIndex, count);
+
+  // Help with queued work while waiting, to avoid deadlock when called from inside a task
+  while (true)
+  {
+    if (runPendingTask_())
+      continue;
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (remaining == 0)
+      break;
+    if (tasks_.empty())
+      taskDone_.wait(lock, [this, &remaining]() { return remaining == 0 || !tasks_.empty(); });
+  }
+}
+
+void ThreadPool::run_()
+{
+  while (true)
+  {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      taskReady_.wait(lock, [this]() { return done_ || !tasks_.empty(); });
+      if (tasks_.empty())
+        return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+bool ThreadPool::runPendingTask_()
+{
+  std::function<void()> task;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tasks_.empty())
+      return false;
+    task = std::move(tasks_.front());
+    tasks_.pop_front();
+  }
+  task();
+  return true;
+}
+
+}
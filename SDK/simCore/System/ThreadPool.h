@@ -0,0 +1,95 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMCORE_SYSTEM_THREADPOOL_H
+#define SIMCORE_SYSTEM_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "simCore/Common/Common.h"
+
+namespace simCore {
+
+/**
+ * Fixed size pool of worker threads.  Tasks are executed in FIFO order by the first available
+ * worker.  The pool counts the calling thread as one of its threads, so a pool of N threads
+ * starts N-1 workers; the calling thread contributes work inside parallelFor().
+ *
+ * Tasks must not throw.  Outstanding tasks are executed before the destructor returns.
+ */
+class SDKCORE_EXPORT ThreadPool
+{
+public:
+  /**
+   * Creates the pool.
+   * @param numThreads Total number of threads, including the calling thread.  A value of 0
+   *   uses std::thread::hardware_concurrency().
+   */
+  explicit ThreadPool(unsigned int numThreads = 0);
+  /** Drains outstanding tasks and joins all workers */
+  virtual ~ThreadPool();
+
+  SDK_DISABLE_COPY_MOVE(ThreadPool);
+
+  /** Total number of threads used by parallelFor(), including the calling thread; always at least 1 */
+  unsigned int numThreads() const;
+
+  /**
+   * Queues a task for asynchronous execution on a worker.  If the pool has no workers,
+   * the task is executed immediately on the calling thread.
+   * @param task Function to execute
+   */
+  void execute(const std::function<void()>& task);
+
+  /**
+   * Splits the range [0, count) into at most numThreads() contiguous sub-ranges and calls
+   * fn(beginIndex, endIndex) once for each sub-range.  Blocks until all sub-ranges complete.
+   * The calling thread processes one sub-range itself, and will help with queued tasks while
+   * waiting, so it is safe to call parallelFor() from inside a task.
+   * @param count Number of items to process
+   * @param fn Function to call on each sub-range; endIndex is exclusive
+   */
+  void parallelFor(size_t count, const std::function<void(size_t beginIndex, size_t endIndex)>& fn);
+
+private:
+  /** Worker thread loop */
+  void run_();
+  /** Pops and runs a single task if one is available; returns false if the queue was empty */
+  bool runPendingTask_();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()> > tasks_;
+  std::mutex mutex_;
+  /** Signaled when a task is queued or the pool is shutting down */
+  std::condition_variable taskReady_;
+  /** Signaled when a task completes, for parallelFor() waiters */
+  std::condition_variable taskDone_;
+  bool done_ = false;
+};
+
+}
+
+#endif /* SIMCORE_SYSTEM_THREADPOOL_H */
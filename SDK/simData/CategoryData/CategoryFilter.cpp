@@ -306,6 +306,11 @@ const CategoryFilter::CategoryCheck& CategoryFilter::getCategoryFilter() const
   return categoryCheck_;
 }
 
+const CategoryFilter::CategoryRegExp& CategoryFilter::getCategoryRegExp() const
+{
+  return categoryRegExp_;
+}
+
 simData::DataStore* CategoryFilter::getDataStore() const
 {
   return dataStore_;
@@ -210,6 +210,12 @@ public:
   */
   const CategoryCheck& getCategoryFilter() const;
 
+  /**
+  * Get a reference to the current regular expressions, by category name int
+  * @return Reference to the CategoryRegExp structure.  Category checks for names with a regular expression are ignored.
+  */
+  const CategoryRegExp& getCategoryRegExp() const;
+
   /**
   * Get pointer to this CategoryFilter's data store.
   * @return Data store associated with the filter.  Data stores are required for filters to support matching and to
@@ -0,0 +1,290 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include "simData/CategoryData/CategoryData.h"
+#include "simData/CategoryData/CategoryNameManager.h"
+#include "simData/CategoryData/CategoryValueIndex.h"
+
+namespace simData {
+
+namespace
+{
+  /** Minimum number of pending changes before an ID set merges them */
+  const size_t MIN_PENDING_CHANGES = 32;
+
+  /** Orders name/value pairs by name int */
+  bool lessName(const std::pair<int, int>& lhs, const std::pair<int, int>& rhs)
+  {
+    return lhs.first < rhs.first;
+  }
+
+  /** Removes the value from an unsorted vector if present; returns true if it was removed */
+  bool eraseUnsorted(std::vector<ObjectId>& vec, ObjectId id)
+  {
+    auto iter = std::find(vec.begin(), vec.end(), id);
+    if (iter == vec.end())
+      return false;
+    *iter = vec.back();
+    vec.pop_back();
+    return true;
+  }
+}
+
+void CategoryValueIndex::IdSet::insert(ObjectId id)
+{
+  // An entity removed since the last merge is still in ids_
+  if (eraseUnsorted(removed_, id))
+    return;
+  added_.push_back(id);
+  // Merge cost is linear in the set size, so larger sets hold more pending changes
+  if (added_.size() + removed_.size() > std::max(MIN_PENDING_CHANGES, ids_.size() / 256))
+    merge_();
+}
+
+void CategoryValueIndex::IdSet::erase(ObjectId id)
+{
+  if (eraseUnsorted(added_, id))
+    return;
+  removed_.push_back(id);
+  if (added_.size() + removed_.size() > std::max(MIN_PENDING_CHANGES, ids_.size() / 256))
+    merge_();
+}
+
+size_t CategoryValueIndex::IdSet::size() const
+{
+  return ids_.size() + added_.size() - removed_.size();
+}
+
+void CategoryValueIndex::IdSet::appendIds(std::vector<ObjectId>& ids) const
+{
+  // Pending changes are few, so combining them with a copy of ids_ is cheap; leave the set alone for other readers
+  const size_t start = ids.size();
+  if (removed_.empty())
+    ids.insert(ids.end(), ids_.begin(), ids_.end());
+  else
+  {
+    std::vector<ObjectId> removed = removed_;
+    std::sort(removed.begin(), removed.end());
+    std::set_difference(ids_.begin(), ids_.end(), removed.begin(), removed.end(), std::back_inserter(ids));
+  }
+  if (!added_.empty())
+  {
+    const size_t middle = ids.size();
+    ids.insert(ids.end(), added_.begin(), added_.end());
+    std::sort(ids.begin() + middle, ids.end());
+    std::inplace_merge(ids.begin() + start, ids.begin() + middle, ids.end());
+  }
+}
+
+void CategoryValueIndex::IdSet::merge_()
+{
+  if (!removed_.empty())
+  {
+    std::sort(removed_.begin(), removed_.end());
+    auto removedIter = removed_.begin();
+    ids_.erase(std::remove_if(ids_.begin(), ids_.end(), [this, &removedIter](ObjectId id) {
+      while (removedIter != removed_.end() && *removedIter < id)
+        ++removedIter;
+      return removedIter != removed_.end() && *removedIter == id;
+    }), ids_.end());
+    removed_.clear();
+  }
+  if (!added_.empty())
+  {
+    std::sort(added_.begin(), added_.end());
+    const size_t oldSize = ids_.size();
+    ids_.insert(ids_.end(), added_.begin(), added_.end());
+    std::inplace_merge(ids_.begin(), ids_.begin() + oldSize, ids_.end());
+    added_.clear();
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+CategoryValueIndex::CategoryValueIndex()
+{
+}
+
+CategoryValueIndex::~CategoryValueIndex()
+{
+}
+
+bool CategoryValueIndex::update(ObjectId id, const CategoryDataSlice& slice)
+{
+  values_.clear();
+  slice.allInts(values_);
+  return update(id, values_);
+}
+
+bool CategoryValueIndex::update(ObjectId id, const std::vector<std::pair<int, int> >& nameValues)
+{
+  if (&nameValues != &values_)
+    values_ = nameValues;
+  std::sort(values_.begin(), values_.end(), lessName);
+
+  auto currentIter = current_.find(id);
+  if (currentIter == current_.end())
+  {
+    if (values_.empty())
+      return false;
+    for (const auto& nameValue : values_)
+      setValue_(id, nameValue.first, CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME, nameValue.second);
+    current_[id] = values_;
+    return true;
+  }
+
+  // Walk both sorted lists, moving the entity for each name whose value changed
+  bool changed = false;
+  const std::vector<std::pair<int, int> >& oldValues = currentIter->second;
+  auto oldIter = oldValues.begin();
+  auto newIter = values_.begin();
+  while (oldIter != oldValues.end() || newIter != values_.end())
+  {
+    if (newIter == values_.end() || (oldIter != oldValues.end() && oldIter->first < newIter->first))
+    {
+      setValue_(id, oldIter->first, oldIter->second, CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME);
+      ++oldIter;
+      changed = true;
+    }
+    else if (oldIter == oldValues.end() || newIter->first < oldIter->first)
+    {
+      setValue_(id, newIter->first, CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME, newIter->second);
+      ++newIter;
+      changed = true;
+    }
+    else
+    {
+      if (oldIter->second != newIter->second)
+      {
+        setValue_(id, newIter->first, oldIter->second, newIter->second);
+        changed = true;
+      }
+      ++oldIter;
+      ++newIter;
+    }
+  }
+
+  if (values_.empty())
+    current_.erase(currentIter);
+  else if (changed)
+    currentIter->second = values_;
+  return changed;
+}
+
+void CategoryValueIndex::remove(ObjectId id)
+{
+  auto currentIter = current_.find(id);
+  if (currentIter == current_.end())
+    return;
+  for (const auto& nameValue : currentIter->second)
+    setValue_(id, nameValue.first, nameValue.second, CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME);
+  current_.erase(currentIter);
+}
+
+void CategoryValueIndex::clear()
+{
+  index_.clear();
+  current_.clear();
+}
+
+void CategoryValueIndex::entities(int nameInt, int valueInt, std::vector<ObjectId>& ids) const
+{
+  ids.clear();
+  auto nameIter = index_.find(nameInt);
+  if (nameIter == index_.end())
+    return;
+  auto valueIter = nameIter->second.find(valueInt);
+  if (valueIter != nameIter->second.end())
+    valueIter->second.appendIds(ids);
+}
+
+void CategoryValueIndex::entities(int nameInt, std::vector<ObjectId>& ids) const
+{
+  ids.clear();
+  auto nameIter = index_.find(nameInt);
+  if (nameIter == index_.end())
+    return;
+  // An entity has one value per name, so the value sets are disjoint
+  for (const auto& valueSet : nameIter->second)
+    valueSet.second.appendIds(ids);
+  std::sort(ids.begin(), ids.end());
+}
+
+size_t CategoryValueIndex::count(int nameInt, int valueInt) const
+{
+  auto nameIter = index_.find(nameInt);
+  if (nameIter == index_.end())
+    return 0;
+  auto valueIter = nameIter->second.find(valueInt);
+  return (valueIter == nameIter->second.end()) ? 0 : valueIter->second.size();
+}
+
+void CategoryValueIndex::valueCounts(int nameInt, std::map<int, size_t>& counts) const
+{
+  counts.clear();
+  auto nameIter = index_.find(nameInt);
+  if (nameIter == index_.end())
+    return;
+  for (const auto& valueSet : nameIter->second)
+    counts[valueSet.first] = valueSet.second.size();
+}
+
+int CategoryValueIndex::value(ObjectId id, int nameInt) const
+{
+  auto currentIter = current_.find(id);
+  if (currentIter == current_.end())
+    return CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME;
+  auto iter = std::lower_bound(currentIter->second.begin(), currentIter->second.end(), std::make_pair(nameInt, 0), lessName);
+  if (iter == currentIter->second.end() || iter->first != nameInt)
+    return CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME;
+  return iter->second;
+}
+
+size_t CategoryValueIndex::numEntities() const
+{
+  return current_.size();
+}
+
+void CategoryValueIndex::setValue_(ObjectId id, int nameInt, int oldValue, int newValue)
+{
+  std::map<int, IdSet>& values = index_[nameInt];
+  if (oldValue != CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME)
+  {
+    auto oldIter = values.find(oldValue);
+    assert(oldIter != values.end());
+    if (oldIter != values.end())
+    {
+      oldIter->second.erase(id);
+      if (oldIter->second.size() == 0)
+        values.erase(oldIter);
+    }
+  }
+  if (newValue != CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME)
+    values[newValue].insert(id);
+  if (values.empty())
+    index_.erase(nameInt);
+}
+
+}
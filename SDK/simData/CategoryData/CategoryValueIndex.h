@@ -0,0 +1,154 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_CATEGORYDATA_CATEGORYVALUEINDEX_H
+#define SIMDATA_CATEGORYDATA_CATEGORYVALUEINDEX_H
+
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "simCore/Common/Common.h"
+#include "simData/ObjectId.h"
+
+namespace simData {
+
+class CategoryDataSlice;
+
+/**
+ * Inverted index of current category data, from category name and value ints to the entities that
+ * currently have that value.  Answers questions like "which entities have Category X = Y" and
+ * "how many entities have each value of X" without visiting every entity's slice.
+ *
+ * MemoryDataStore keeps an index of its entities current as of the last update(); entities appear
+ * in the index only for names for which they have a value at the update time.  ID lists are kept
+ * sorted, so callers can combine them with std::set_intersection(), std::set_union(), and
+ * std::set_difference().
+ *
+ * Const methods do not modify the index, so any number of threads may read it at once, provided
+ * no thread calls update(), remove(), or clear() at the same time.
+ */
+class SDKDATA_EXPORT CategoryValueIndex
+{
+public:
+  CategoryValueIndex();
+  virtual ~CategoryValueIndex();
+
+  SDK_DISABLE_COPY_MOVE(CategoryValueIndex);
+
+  /**
+   * Replaces the entity's indexed values with the slice's current values
+   * @param id Entity that owns the slice
+   * @param slice Category data at the current time
+   * @return True if any indexed value changed
+   */
+  bool update(ObjectId id, const CategoryDataSlice& slice);
+
+  /**
+   * Replaces the entity's indexed values
+   * @param id Entity to index
+   * @param nameValues Current name and value ints, in any order; each name must appear at most once
+   * @return True if any indexed value changed
+   */
+  bool update(ObjectId id, const std::vector<std::pair<int, int> >& nameValues);
+
+  /** Removes the entity from the index */
+  void remove(ObjectId id);
+
+  /** Removes all entities from the index */
+  void clear();
+
+  /**
+   * Retrieves the entities that currently have the given value
+   * @param nameInt Category name int
+   * @param valueInt Category value int
+   * @param ids Filled with the entity IDs, in ascending order
+   */
+  void entities(int nameInt, int valueInt, std::vector<ObjectId>& ids) const;
+
+  /**
+   * Retrieves the entities that currently have any value for the given name
+   * @param nameInt Category name int
+   * @param ids Filled with the entity IDs, in ascending order
+   */
+  void entities(int nameInt, std::vector<ObjectId>& ids) const;
+
+  /** Returns the number of entities that currently have the given value */
+  size_t count(int nameInt, int valueInt) const;
+
+  /**
+   * Retrieves the number of entities with each current value of the name.  Values without entities are not included.
+   * @param nameInt Category name int
+   * @param counts Filled with value int to number of entities
+   */
+  void valueCounts(int nameInt, std::map<int, size_t>& counts) const;
+
+  /**
+   * Returns the indexed value of the entity for the given name
+   * @return Value int, or CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME if the entity has no value
+   */
+  int value(ObjectId id, int nameInt) const;
+
+  /** Returns the number of entities with at least one indexed value */
+  size_t numEntities() const;
+
+private:
+  /**
+   * Sorted ID list that absorbs changes into small unsorted lists, so that moving a single
+   * entity between values of a popular category does not shift the whole list.  Pending
+   * changes are merged into the sorted list once enough of them accumulate; reads combine
+   * them with the sorted list without modifying the set.
+   */
+  class IdSet
+  {
+  public:
+    void insert(ObjectId id);
+    void erase(ObjectId id);
+    size_t size() const;
+    /** Appends the IDs to the vector, in ascending order */
+    void appendIds(std::vector<ObjectId>& ids) const;
+
+  private:
+    /** Merges pending changes into ids_ */
+    void merge_();
+
+    std::vector<ObjectId> ids_;
+    /// Not in ids_
+    std::vector<ObjectId> added_;
+    /// In ids_
+    std::vector<ObjectId> removed_;
+  };
+
+  /** Changes the entity's value for the name, moving it between value sets */
+  void setValue_(ObjectId id, int nameInt, int oldValue, int newValue);
+
+  /// Name int to value int to entities with that value
+  std::unordered_map<int, std::map<int, IdSet> > index_;
+  /// Entity to its current name and value ints, sorted by name
+  std::unordered_map<ObjectId, std::vector<std::pair<int, int> > > current_;
+  /// Scratch space for reading slices
+  std::vector<std::pair<int, int> > values_;
+};
+
+}
+
+#endif /* SIMDATA_CATEGORYDATA_CATEGORYVALUEINDEX_H */
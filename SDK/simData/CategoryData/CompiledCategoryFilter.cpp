@@ -0,0 +1,322 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include "simData/DataStore.h"
+#include "simData/CategoryData/CategoryData.h"
+#include "simData/CategoryData/CategoryNameManager.h"
+#include "simData/CategoryData/CompiledCategoryFilter.h"
+
+namespace simData {
+
+namespace
+{
+  /** Offset from value int to table index, covering the special values down to UNLISTED_CATEGORY_VALUE */
+  const int VALUE_OFFSET = -simData::CategoryNameManager::UNLISTED_CATEGORY_VALUE;
+
+  /** Records the slot of the name int, growing the table as needed */
+  void setSlot(std::vector<int>& slots, int nameInt, size_t index)
+  {
+    if (nameInt < 0)
+      return;
+    if (static_cast<size_t>(nameInt) >= slots.size())
+      slots.resize(nameInt + 1, -1);
+    slots[nameInt] = static_cast<int>(index);
+  }
+}
+
+CompiledCategoryFilter::CompiledCategoryFilter()
+  : pass_(0),
+    nameManager_(nullptr)
+{
+}
+
+CompiledCategoryFilter::CompiledCategoryFilter(const CategoryFilter& filter)
+  : pass_(0),
+    nameManager_(nullptr)
+{
+  compile(filter);
+}
+
+CompiledCategoryFilter::~CompiledCategoryFilter()
+{
+}
+
+void CompiledCategoryFilter::compile(const CategoryFilter& filter)
+{
+  categories_.clear();
+  regExps_.clear();
+  categorySlots_.clear();
+  regExpSlots_.clear();
+  nameManager_ = nullptr;
+
+  const CategoryFilter::CategoryRegExp& regExps = filter.getCategoryRegExp();
+  for (auto checksIter = filter.getCategoryFilter().begin(); checksIter != filter.getCategoryFilter().end(); ++checksIter)
+  {
+    // Same rules as CategoryFilter::matchData(): names with a valid regular expression, the
+    // special no-name value, and unchecked names do not contribute
+    auto regIter = regExps.find(checksIter->first);
+    if (regIter != regExps.end() && regIter->second && !regIter->second->pattern().empty())
+      continue;
+    if (checksIter->first == CategoryNameManager::NO_CATEGORY_NAME || !checksIter->second.first)
+      continue;
+
+    const CategoryFilter::ValuesCheck& values = checksIter->second.second;
+    Category category;
+    category.nameInt = checksIter->first;
+
+    auto unlisted = values.find(CategoryNameManager::UNLISTED_CATEGORY_VALUE);
+    category.unlistedAccepted = (unlisted != values.end() && unlisted->second);
+    auto noValue = values.find(CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME);
+    category.noValueAccepted = (noValue != values.end() && noValue->second);
+
+    // Values below the table are never listed, so they take the unlisted state like values past the end
+    if (!values.empty() && values.rbegin()->first >= -VALUE_OFFSET)
+    {
+      category.accepted.resize(static_cast<size_t>(values.rbegin()->first + VALUE_OFFSET) + 1, category.unlistedAccepted ? 1 : 0);
+      for (auto valueIter = values.lower_bound(-VALUE_OFFSET); valueIter != values.end(); ++valueIter)
+        category.accepted[valueIter->first + VALUE_OFFSET] = valueIter->second ? 1 : 0;
+    }
+    setSlot(categorySlots_, category.nameInt, categories_.size());
+    categories_.push_back(std::move(category));
+  }
+
+  // Regular expressions need the name manager to convert values to strings
+  if (filter.getDataStore() != nullptr)
+  {
+    for (auto regIter = regExps.begin(); regIter != regExps.end(); ++regIter)
+    {
+      if (!regIter->second || regIter->second->pattern().empty())
+        continue;
+      RegExpCategory regExp;
+      regExp.nameInt = regIter->first;
+      regExp.regExp = regIter->second;
+      regExp.noValueMatches = regExp.regExp->match("");
+      setSlot(regExpSlots_, regExp.nameInt, regExps_.size());
+      regExps_.push_back(std::move(regExp));
+    }
+    if (!regExps_.empty())
+      nameManager_ = &filter.getDataStore()->categoryNameManager();
+  }
+
+  categorySeen_.assign(categories_.size(), 0);
+  regExpSeen_.assign(regExps_.size(), 0);
+  pass_ = 0;
+}
+
+bool CompiledCategoryFilter::isEmpty() const
+{
+  return categories_.empty() && regExps_.empty();
+}
+
+bool CompiledCategoryFilter::match(const simData::DataStore& dataStore, uint64_t entityId)
+{
+  if (isEmpty())
+    return true;
+
+  values_.clear();
+  const CategoryDataSlice* slice = dataStore.categoryDataSlice(entityId);
+  if (slice)
+    slice->allInts(values_);
+  return matchData(values_);
+}
+
+bool CompiledCategoryFilter::matchData(const std::vector<std::pair<int, int> >& nameValues)
+{
+  if (isEmpty())
+    return true;
+
+  // Seen flags are stamped with the pass number instead of being cleared for each entity
+  if (++pass_ == 0)
+  {
+    std::fill(categorySeen_.begin(), categorySeen_.end(), 0);
+    std::fill(regExpSeen_.begin(), regExpSeen_.end(), 0);
+    pass_ = 1;
+  }
+
+  for (const auto& nameValue : nameValues)
+  {
+    const int categoryIndex = slot_(categorySlots_, nameValue.first);
+    if (categoryIndex >= 0)
+    {
+      Category& category = categories_[categoryIndex];
+      const int index = nameValue.second + VALUE_OFFSET;
+      const bool accepted = (index >= 0 && static_cast<size_t>(index) < category.accepted.size()) ?
+        (category.accepted[index] != 0) : category.unlistedAccepted;
+      if (!accepted)
+        return false;
+      categorySeen_[categoryIndex] = pass_;
+    }
+
+    const int regExpIndex = slot_(regExpSlots_, nameValue.first);
+    if (regExpIndex >= 0)
+    {
+      if (!matchRegExp_(regExps_[regExpIndex], nameValue.second))
+        return false;
+      regExpSeen_[regExpIndex] = pass_;
+    }
+  }
+
+  // Names without a value for this entity
+  for (size_t k = 0; k < categories_.size(); ++k)
+  {
+    if (categorySeen_[k] != pass_ && !categories_[k].noValueAccepted)
+      return false;
+  }
+  for (size_t k = 0; k < regExps_.size(); ++k)
+  {
+    if (regExpSeen_[k] != pass_ && !regExps_[k].noValueMatches)
+      return false;
+  }
+  return true;
+}
+
+int CompiledCategoryFilter::slot_(const std::vector<int>& slots, int nameInt)
+{
+  return (nameInt >= 0 && static_cast<size_t>(nameInt) < slots.size()) ? slots[nameInt] : -1;
+}
+
+bool CompiledCategoryFilter::matchRegExp_(RegExpCategory& category, int valueInt)
+{
+  assert(nameManager_);
+  const int index = valueInt + VALUE_OFFSET;
+  if (index < 0)
+    return category.regExp->match(nameManager_->valueIntToString(valueInt));
+
+  if (static_cast<size_t>(index) >= category.results.size())
+    category.results.resize(index + 1, 0);
+  uint8_t& result = category.results[index];
+  if (result == 0)
+    result = category.regExp->match(nameManager_->valueIntToString(valueInt)) ? 2 : 1;
+  return result == 2;
+}
+
+// ----------------------------------------------------------------------------
+
+/** Records the entities that need to be re-tested */
+class CategoryFilterResults::Listener : public simData::DataStore::DefaultListener
+{
+public:
+  explicit Listener(CategoryFilterResults& parent)
+    : parent_(parent)
+  {
+  }
+
+  virtual void onAddEntity(DataStore* source, ObjectId newId, simData::ObjectType ot) override
+  {
+    parent_.dirtyIds_.push_back(newId);
+  }
+
+  virtual void onPostRemoveEntity(DataStore* source, ObjectId removedId, simData::ObjectType ot) override
+  {
+    parent_.results_.erase(removedId);
+  }
+
+  virtual void onCategoryDataChange(DataStore* source, ObjectId changedId, simData::ObjectType ot) override
+  {
+    parent_.dirtyIds_.push_back(changedId);
+  }
+
+  virtual void onFlush(DataStore* source, ObjectId flushedId) override
+  {
+    // Flushing can remove category data; an ID of 0 flushes all entities
+    if (flushedId == 0)
+      parent_.allDirty_ = true;
+    else
+      parent_.dirtyIds_.push_back(flushedId);
+  }
+
+  virtual void onScenarioDelete(DataStore* source) override
+  {
+    parent_.results_.clear();
+    parent_.dirtyIds_.clear();
+    parent_.allDirty_ = true;
+  }
+
+private:
+  CategoryFilterResults& parent_;
+};
+
+CategoryFilterResults::CategoryFilterResults(simData::DataStore& dataStore)
+  : dataStore_(dataStore),
+    allDirty_(true)
+{
+  listener_ = std::make_shared<Listener>(*this);
+  dataStore_.addListener(listener_);
+}
+
+CategoryFilterResults::~CategoryFilterResults()
+{
+  dataStore_.removeListener(listener_);
+}
+
+void CategoryFilterResults::setFilter(const CategoryFilter& filter)
+{
+  filter_.compile(filter);
+  allDirty_ = true;
+}
+
+size_t CategoryFilterResults::evaluate(std::vector<uint64_t>* changedIds)
+{
+  if (changedIds)
+    changedIds->clear();
+
+  if (allDirty_)
+  {
+    dirtyIds_.clear();
+    dataStore_.idList(&dirtyIds_);
+    allDirty_ = false;
+  }
+  else
+  {
+    std::sort(dirtyIds_.begin(), dirtyIds_.end());
+    dirtyIds_.erase(std::unique(dirtyIds_.begin(), dirtyIds_.end()), dirtyIds_.end());
+  }
+
+  size_t tested = 0;
+  for (uint64_t id : dirtyIds_)
+  {
+    // Entities removed since they were marked have no result to update
+    if (dataStore_.objectType(id) == simData::NONE)
+      continue;
+    ++tested;
+    const bool match = filter_.match(dataStore_, id);
+    auto inserted = results_.insert(std::make_pair(id, match));
+    if (inserted.second || inserted.first->second != match)
+    {
+      inserted.first->second = match;
+      if (changedIds)
+        changedIds->push_back(id);
+    }
+  }
+  dirtyIds_.clear();
+  return tested;
+}
+
+bool CategoryFilterResults::matches(uint64_t entityId) const
+{
+  auto iter = results_.find(entityId);
+  return iter == results_.end() || iter->second;
+}
+
+}
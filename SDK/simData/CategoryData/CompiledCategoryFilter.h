@@ -0,0 +1,165 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_CATEGORYDATA_COMPILEDCATEGORYFILTER_H
+#define SIMDATA_CATEGORYDATA_COMPILEDCATEGORYFILTER_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "simCore/Common/Common.h"
+#include "simData/CategoryData/CategoryFilter.h"
+
+namespace simData {
+
+class CategoryNameManager;
+
+/**
+ * Compiled form of a CategoryFilter, for testing many entities against the same filter.  Each
+ * category that contributes to the filter is reduced to a dense table of accepted value ints, and
+ * regular expression results are cached per value, so a match costs one table lookup per category.
+ * The results are identical to CategoryFilter::match().
+ *
+ * The compiled filter is a snapshot; compile again after changing the CategoryFilter.  The
+ * regular expression cache is filled on demand, so match() is not const and not thread safe.
+ */
+class SDKDATA_EXPORT CompiledCategoryFilter
+{
+public:
+  /** Constructs a filter that matches all entities */
+  CompiledCategoryFilter();
+  /** Constructs a compiled copy of the given filter */
+  explicit CompiledCategoryFilter(const CategoryFilter& filter);
+  virtual ~CompiledCategoryFilter();
+
+  /** Replaces the contents with a compiled copy of the given filter */
+  void compile(const CategoryFilter& filter);
+
+  /** Returns true if the filter matches all entities */
+  bool isEmpty() const;
+
+  /**
+   * Tests the entity's current category data against the filter
+   * @param dataStore Data store containing the entity
+   * @param entityId Entity to test
+   * @return True if the entity passes the filter
+   */
+  bool match(const simData::DataStore& dataStore, uint64_t entityId);
+
+  /**
+   * Tests category data against the filter
+   * @param nameValues Current name and value ints of an entity, in any order
+   * @return True if the data passes the filter
+   */
+  bool matchData(const std::vector<std::pair<int, int> >& nameValues);
+
+private:
+  /** Accepted values for one category name */
+  struct Category
+  {
+    int nameInt = 0;
+    /// Indexed by value int offset so that UNLISTED_CATEGORY_VALUE is 0; values outside the table use unlistedAccepted
+    std::vector<uint8_t> accepted;
+    bool unlistedAccepted = false;
+    /// Result for entities without a value for this category
+    bool noValueAccepted = false;
+  };
+
+  /** Regular expression for one category name, with results cached by value int */
+  struct RegExpCategory
+  {
+    int nameInt = 0;
+    RegExpFilterPtr regExp;
+    /// Indexed like Category::accepted: 0 for unknown, 1 for no match, 2 for match
+    std::vector<uint8_t> results;
+    /// Result for entities without a value for this category
+    bool noValueMatches = false;
+  };
+
+  /** Returns true if the value passes the regular expression, caching the result */
+  bool matchRegExp_(RegExpCategory& category, int valueInt);
+  /** Returns the slot for the name int, or -1 if the name does not contribute */
+  static int slot_(const std::vector<int>& slots, int nameInt);
+
+  std::vector<Category> categories_;
+  std::vector<RegExpCategory> regExps_;
+  /// Indexed by name int, giving the index into categories_ or -1
+  std::vector<int> categorySlots_;
+  /// Indexed by name int, giving the index into regExps_ or -1
+  std::vector<int> regExpSlots_;
+  /// Per category and per regular expression, the pass in which the entity had a value for the name
+  std::vector<unsigned int> categorySeen_;
+  std::vector<unsigned int> regExpSeen_;
+  /// Incremented on each test, so the seen flags do not need to be cleared
+  unsigned int pass_;
+  /// Converts value ints to strings for the regular expressions; null if no regular expressions apply
+  const CategoryNameManager* nameManager_;
+  /// Scratch space for the current values of the entity being tested
+  std::vector<std::pair<int, int> > values_;
+};
+
+/**
+ * Maintains CategoryFilter results for all entities in a data store.  After the initial evaluation,
+ * evaluate() only re-tests entities that were added or whose category data changed, unless the filter
+ * itself changed.  Intended for views that re-filter large scenarios when the user changes a filter.
+ */
+class SDKDATA_EXPORT CategoryFilterResults
+{
+public:
+  /** Attaches to the data store, which must outlive this object */
+  explicit CategoryFilterResults(simData::DataStore& dataStore);
+  virtual ~CategoryFilterResults();
+
+  SDK_DISABLE_COPY_MOVE(CategoryFilterResults);
+
+  /** Compiles the filter, and marks all entities for re-evaluation on the next evaluate() */
+  void setFilter(const CategoryFilter& filter);
+
+  /**
+   * Re-tests the entities that need it: all entities after setFilter(), otherwise only entities that
+   * were added or had category data changes since the last call.
+   * @param changedIds If not null, filled with the entities whose result changed, including new entities
+   * @return Number of entities tested
+   */
+  size_t evaluate(std::vector<uint64_t>* changedIds = nullptr);
+
+  /** Returns the result of the last evaluation for the entity; true for unknown entities */
+  bool matches(uint64_t entityId) const;
+
+private:
+  class Listener;
+
+  simData::DataStore& dataStore_;
+  std::shared_ptr<Listener> listener_;
+  CompiledCategoryFilter filter_;
+  std::unordered_map<uint64_t, bool> results_;
+  /// Entities to re-test on the next evaluate(); may contain duplicates
+  std::vector<uint64_t> dirtyIds_;
+  /// True if every entity needs to be re-tested
+  bool allDirty_;
+};
+
+}
+
+#endif /* SIMDATA_CATEGORYDATA_COMPILEDCATEGORYFILTER_H */
@@ -0,0 +1,744 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include "simCore/Calc/Math.h"
+#include "simData/DataSliceUpdaters.h"
+#include "simData/Interpolator.h"
+#include "simData/ColumnarPlatformUpdateSlice.h"
+
+namespace simData
+{
+
+namespace
+{
+/// Spare chunks beyond this count are freed instead of kept for reuse
+constexpr size_t MAX_SPARE_CHUNKS = 2;
+}
+
+/** Iterates over the slice by index, materializing points into alternating buffers */
+class ColumnarPlatformUpdateSlice::ColumnIterator : public IteratorImpl
+{
+public:
+  ColumnIterator(const ColumnarPlatformUpdateSlice* slice, size_t nextIndex)
+    : slice_(slice),
+      nextIndex_(nextIndex),
+      buffer_(0)
+  {
+  }
+
+  virtual const PlatformUpdate* const next() override
+  {
+    if (!hasNext())
+      return nullptr;
+    return materialize_(nextIndex_++);
+  }
+
+  virtual const PlatformUpdate* const peekNext() const override
+  {
+    if (!hasNext())
+      return nullptr;
+    return materialize_(nextIndex_);
+  }
+
+  virtual const PlatformUpdate* const previous() override
+  {
+    if (!hasPrevious())
+      return nullptr;
+    return materialize_(--nextIndex_);
+  }
+
+  virtual const PlatformUpdate* const peekPrevious() const override
+  {
+    if (!hasPrevious())
+      return nullptr;
+    return materialize_(nextIndex_ - 1);
+  }
+
+  virtual void toFront() override { nextIndex_ = 0; }
+  virtual void toBack() override { nextIndex_ = slice_->numItems(); }
+  virtual bool hasNext() const override { return nextIndex_ < slice_->numItems(); }
+  virtual bool hasPrevious() const override { return nextIndex_ > 0 && nextIndex_ <= slice_->numItems(); }
+
+  virtual IteratorImpl* clone() const override
+  {
+    return new ColumnIterator(slice_, nextIndex_);
+  }
+
+private:
+  const PlatformUpdate* materialize_(size_t index) const
+  {
+    buffer_ = 1 - buffer_;
+    slice_->at(index, &values_[buffer_]);
+    return &values_[buffer_];
+  }
+
+  const ColumnarPlatformUpdateSlice* slice_;
+  size_t nextIndex_;
+  /// Two buffers, so that a pair of bounding points can be held at once
+  mutable PlatformUpdate values_[2];
+  mutable int buffer_;
+};
+
+//----------------------------------------------------------------------------
+ColumnarPlatformUpdateSlice::ColumnarPlatformUpdateSlice()
+  : head_(0),
+    size_(0),
+    hasChanged_(false),
+    dirty_(false),
+    interpolated_(false),
+    currentState_(CurrentState::NONE),
+    currentIndex_(NO_INDEX),
+    fastIndex_(0)
+{
+}
+
+ColumnarPlatformUpdateSlice::~ColumnarPlatformUpdateSlice()
+{
+  for (Chunk* chunk : chunks_)
+    delete chunk;
+  for (Chunk* chunk : spareChunks_)
+    delete chunk;
+}
+
+void ColumnarPlatformUpdateSlice::flush(bool keepStatic)
+{
+  // don't flush static entities
+  if (!keepStatic || size_ != 1 || timeAt(0) != -1.0)
+  {
+    erase_(0, size_);
+    currentState_ = CurrentState::NONE;
+  }
+  dirty_ = true;
+  notify_();
+}
+
+void ColumnarPlatformUpdateSlice::flush(double startTime, double endTime)
+{
+  const size_t beginIndex = lowerBound_(startTime, size_);
+  if (beginIndex != size_ && timeAt(beginIndex) < endTime)
+  {
+    // endTime is non-inclusive
+    erase_(beginIndex, lowerBound_(endTime, size_));
+    currentState_ = CurrentState::NONE;
+  }
+  dirty_ = true;
+  notify_();
+}
+
+PlatformUpdateSlice::Iterator ColumnarPlatformUpdateSlice::lower_bound(double timeValue) const
+{
+  return Iterator(new ColumnIterator(this, lowerBound_(timeValue, fastIndex_)));
+}
+
+PlatformUpdateSlice::Iterator ColumnarPlatformUpdateSlice::upper_bound(double timeValue) const
+{
+  return Iterator(new ColumnIterator(this, upperBound_(timeValue, fastIndex_)));
+}
+
+size_t ColumnarPlatformUpdateSlice::numItems() const
+{
+  return size_;
+}
+
+bool ColumnarPlatformUpdateSlice::hasChanged() const
+{
+  return hasChanged_;
+}
+
+bool ColumnarPlatformUpdateSlice::isDirty() const
+{
+  return dirty_;
+}
+
+const PlatformUpdate* ColumnarPlatformUpdateSlice::current() const
+{
+  switch (currentState_)
+  {
+  case CurrentState::NONE:
+    break;
+  case CurrentState::STORED:
+  case CurrentState::EXTERNAL:
+    return &current_;
+  case CurrentState::INTERPOLATED:
+    return &currentInterpolated_;
+  }
+  return nullptr;
+}
+
+void ColumnarPlatformUpdateSlice::visit(Visitor* visitor) const
+{
+  PlatformUpdate update;
+  for (size_t k = 0; k < size_; ++k)
+  {
+    at(k, &update);
+    (*visitor)(&update);
+  }
+}
+
+void ColumnarPlatformUpdateSlice::modify(Modifier* modifier)
+{
+  // Implement when/if needed
+  assert(0);
+}
+
+bool ColumnarPlatformUpdateSlice::isInterpolated() const
+{
+  return interpolated_;
+}
+
+PlatformUpdateSlice::Bounds ColumnarPlatformUpdateSlice::interpolationBounds() const
+{
+  if (!interpolated_)
+    return Bounds(static_cast<PlatformUpdate*>(nullptr), static_cast<PlatformUpdate*>(nullptr));
+  return Bounds(&lowBound_, &highBound_);
+}
+
+double ColumnarPlatformUpdateSlice::firstTime() const
+{
+  if (size_ == 0)
+    return std::numeric_limits<double>::max();
+  return timeAt(0);
+}
+
+double ColumnarPlatformUpdateSlice::lastTime() const
+{
+  if (size_ == 0)
+    return -std::numeric_limits<double>::max();
+  return timeAt(size_ - 1);
+}
+
+double ColumnarPlatformUpdateSlice::deltaTime(double time) const
+{
+  if (size_ == 0 || time < 0.0)
+    return -1.0;
+
+  size_t index = lowerBound_(time, fastIndex_);
+  if (index != size_)
+  {
+    if (timeAt(index) == time)
+      return 0.0;
+    if (index == 0)
+      return -1.0;
+  }
+  --index;
+
+  // Check for static point
+  if (timeAt(index) < 0.0)
+    return -1.0;
+
+  return time - timeAt(index);
+}
+
+void ColumnarPlatformUpdateSlice::clearChanged()
+{
+  hasChanged_ = false;
+}
+
+void ColumnarPlatformUpdateSlice::setChanged()
+{
+  hasChanged_ = true;
+}
+
+void ColumnarPlatformUpdateSlice::setCurrent(const PlatformUpdate* current)
+{
+  if (current == nullptr)
+  {
+    setCurrentIndex_(NO_INDEX);
+    return;
+  }
+  current_ = *current;
+  currentState_ = CurrentState::EXTERNAL;
+  hasChanged_ = true;
+}
+
+void ColumnarPlatformUpdateSlice::update(double time)
+{
+  // start by marking as unchanged, new hasChanged status is outcome of this update
+  clearChanged();
+
+  // early out when there are no changes to this slice
+  if (isCurrentAt_(time))
+    return;
+
+  dirty_ = false;
+  interpolated_ = false;
+
+  // Current update is the last point at or before the time
+  size_t index = NO_INDEX;
+  if (size_ != 0)
+  {
+    const size_t lower = lowerBound_(time, fastIndex_);
+    if (lower == size_)
+      index = size_ - 1;
+    else if (time < timeAt(lower))
+      index = (lower != 0) ? lower - 1 : NO_INDEX;
+    else
+      index = lower;
+  }
+  fastIndex_ = (index == NO_INDEX) ? size_ : index;
+  setCurrentIndex_(index);
+}
+
+void ColumnarPlatformUpdateSlice::update(double time, std::optional<double>& startTime, std::optional<double>& endTime)
+{
+  // start by marking as unchanged, new hasChanged status is outcome of this update
+  clearChanged();
+
+  // assume entire range then narrow down
+  startTime = 0;
+  endTime = std::numeric_limits<double>::max();
+
+  // early out when there are no changes to this slice
+  if (isCurrentAt_(time))
+    return;
+
+  dirty_ = false;
+  interpolated_ = false;
+
+  if (size_ == 0)
+  {
+    setCurrentIndex_(NO_INDEX);
+    return;
+  }
+
+  size_t index = lowerBound_(time, size_);
+  if (index == size_)
+  {
+    // The given time is greater than all points, so the time span is the last point to the end of time
+    startTime = timeAt(size_ - 1);
+    index = size_ - 1;
+  }
+  else if (timeAt(index) == time)
+  {
+    // The point matches the given time so the time range is from time to the time of the next point, if any
+    startTime = time;
+    if (index + 1 < size_)
+      endTime = timeAt(index + 1);
+  }
+  else if (index == 0)
+  {
+    // The first point is greater than the given time so the time range is from 0 to the time of the first point
+    endTime = timeAt(0);
+    index = NO_INDEX;
+  }
+  else
+  {
+    // The time falls between two points
+    endTime = timeAt(index);
+    --index;
+    startTime = timeAt(index);
+  }
+
+  setCurrentIndex_(index);
+}
+
+void ColumnarPlatformUpdateSlice::update(double time, Interpolator* interpolator)
+{
+  assert(interpolator);
+  // start by marking as unchanged, new hasChanged status is outcome of this update
+  clearChanged();
+
+  // early out when there are no changes to this slice
+  if (isCurrentAt_(time))
+    return;
+
+  // update is processing the changes to the slice, clear the flag
+  dirty_ = false;
+  interpolated_ = false;
+
+  if (size_ == 0)
+  {
+    setCurrentIndex_(NO_INDEX);
+    return;
+  }
+
+  const size_t upper = upperBound_(time, fastIndex_);
+  if (upper == size_)
+  {
+    // Closest update is the last point
+    fastIndex_ = size_ - 1;
+    setCurrentIndex_(fastIndex_);
+    return;
+  }
+
+  fastIndex_ = (upper == 0) ? 0 : upper - 1;
+  if (upper == 0)
+  {
+    // time is before the first point
+    setCurrentIndex_(NO_INDEX);
+    return;
+  }
+
+  if (simCore::areEqual(time, timeAt(fastIndex_)))
+  {
+    setCurrentIndex_(fastIndex_);
+    return;
+  }
+
+  at(fastIndex_, &lowBound_);
+  at(upper, &highBound_);
+  interpolator->interpolate(time, lowBound_, highBound_, &currentInterpolated_);
+  currentState_ = CurrentState::INTERPOLATED;
+  interpolated_ = true;
+  // Every new interpolated value is a change
+  hasChanged_ = true;
+}
+
+void ColumnarPlatformUpdateSlice::installNotifier(const std::function<void()>& fn)
+{
+  notifierFn_ = fn;
+}
+
+void ColumnarPlatformUpdateSlice::insert(PlatformUpdate* data)
+{
+  insert(*data);
+  delete data;
+}
+
+void ColumnarPlatformUpdateSlice::insert(const PlatformUpdate& data)
+{
+  notify_();
+
+  size_t index = size_;
+  if (size_ != 0 && timeAt(size_ - 1) >= data.time())
+  {
+    index = lowerBound_(data.time(), size_);
+    if (timeAt(index) == data.time())
+    {
+      // clear current if replacing the point it refers to; current will become valid upon update
+      if (currentState_ == CurrentState::STORED && currentIndex_ == index)
+        setCurrentIndex_(NO_INDEX);
+      store_(index, data);
+      dirty_ = true;
+      return;
+    }
+  }
+
+  grow_();
+  for (size_t k = size_ - 1; k > index; --k)
+    copy_(k, k - 1);
+  store_(index, data);
+
+  if (currentState_ == CurrentState::STORED && currentIndex_ != NO_INDEX && currentIndex_ >= index)
+    ++currentIndex_;
+  fastIndex_ = size_;
+  dirty_ = true;
+}
+
+void ColumnarPlatformUpdateSlice::limitByTime(double timeWindow)
+{
+  if (timeWindow < 0.0 || size_ == 0)
+    return;
+
+  // always leave one point
+  const size_t newFirst = std::min(upperBound_(lastTime() - timeWindow, size_), size_ - 1);
+  if (newFirst == 0)
+    return;
+
+  erase_(0, newFirst);
+  fastIndex_ = size_;
+  notify_();
+}
+
+void ColumnarPlatformUpdateSlice::limitByPoints(uint32_t limitPoints)
+{
+  // zero is special case for "no limit"
+  if (limitPoints == 0 || size_ <= limitPoints)
+    return;
+
+  erase_(0, size_ - limitPoints);
+  fastIndex_ = size_;
+  notify_();
+}
+
+void ColumnarPlatformUpdateSlice::limitByPrefs(const CommonPrefs& prefs)
+{
+  limitByPoints(prefs.datalimitpoints());
+  limitByTime(prefs.datalimittime());
+}
+
+PlatformUpdate* ColumnarPlatformUpdateSlice::currentInterpolated()
+{
+  return &currentInterpolated_;
+}
+
+void ColumnarPlatformUpdateSlice::at(size_t index, PlatformUpdate* update) const
+{
+  assert(index < size_);
+  size_t offset = 0;
+  const Chunk& chunk = chunk_(index, offset);
+  update->set_time(chunk.time[offset]);
+  update->set_x(chunk.x[offset]);
+  update->set_y(chunk.y[offset]);
+  update->set_z(chunk.z[offset]);
+  update->set_psi(chunk.psi[offset]);
+  update->set_theta(chunk.theta[offset]);
+  update->set_phi(chunk.phi[offset]);
+  update->set_vx(chunk.vx[offset]);
+  update->set_vy(chunk.vy[offset]);
+  update->set_vz(chunk.vz[offset]);
+}
+
+double ColumnarPlatformUpdateSlice::timeAt(size_t index) const
+{
+  assert(index < size_);
+  size_t offset = 0;
+  return chunk_(index, offset).time[offset];
+}
+
+size_t ColumnarPlatformUpdateSlice::memoryUsage() const
+{
+  return (chunks_.size() + spareChunks_.size()) * sizeof(Chunk) +
+    (chunks_.capacity() + spareChunks_.capacity()) * sizeof(Chunk*);
+}
+
+PlatformUpdateSlice::IteratorImpl* ColumnarPlatformUpdateSlice::iterator_() const
+{
+  return new ColumnIterator(this, 0);
+}
+
+ColumnarPlatformUpdateSlice::Chunk& ColumnarPlatformUpdateSlice::chunk_(size_t index, size_t& offset) const
+{
+  const size_t position = head_ + index;
+  offset = position % CHUNK_SIZE;
+  return *chunks_[position / CHUNK_SIZE];
+}
+
+void ColumnarPlatformUpdateSlice::store_(size_t index, const PlatformUpdate& value)
+{
+  size_t offset = 0;
+  Chunk& chunk = chunk_(index, offset);
+  chunk.time[offset] = value.time();
+  chunk.x[offset] = value.x();
+  chunk.y[offset] = value.y();
+  chunk.z[offset] = value.z();
+  // Orientation and velocity are stored as floats by PlatformUpdate, so the round trip is exact
+  chunk.psi[offset] = static_cast<float>(value.psi());
+  chunk.theta[offset] = static_cast<float>(value.theta());
+  chunk.phi[offset] = static_cast<float>(value.phi());
+  chunk.vx[offset] = static_cast<float>(value.vx());
+  chunk.vy[offset] = static_cast<float>(value.vy());
+  chunk.vz[offset] = static_cast<float>(value.vz());
+}
+
+void ColumnarPlatformUpdateSlice::copy_(size_t to, size_t from)
+{
+  size_t toOffset = 0;
+  size_t fromOffset = 0;
+  Chunk& toChunk = chunk_(to, toOffset);
+  const Chunk& fromChunk = chunk_(from, fromOffset);
+  toChunk.time[toOffset] = fromChunk.time[fromOffset];
+  toChunk.x[toOffset] = fromChunk.x[fromOffset];
+  toChunk.y[toOffset] = fromChunk.y[fromOffset];
+  toChunk.z[toOffset] = fromChunk.z[fromOffset];
+  toChunk.psi[toOffset] = fromChunk.psi[fromOffset];
+  toChunk.theta[toOffset] = fromChunk.theta[fromOffset];
+  toChunk.phi[toOffset] = fromChunk.phi[fromOffset];
+  toChunk.vx[toOffset] = fromChunk.vx[fromOffset];
+  toChunk.vy[toOffset] = fromChunk.vy[fromOffset];
+  toChunk.vz[toOffset] = fromChunk.vz[fromOffset];
+}
+
+void ColumnarPlatformUpdateSlice::grow_()
+{
+  if (head_ + size_ == chunks_.size() * CHUNK_SIZE)
+  {
+    if (spareChunks_.empty())
+      chunks_.push_back(new Chunk);
+    else
+    {
+      chunks_.push_back(spareChunks_.back());
+      spareChunks_.pop_back();
+    }
+  }
+  ++size_;
+}
+
+void ColumnarPlatformUpdateSlice::erase_(size_t beginIndex, size_t endIndex)
+{
+  assert(beginIndex <= endIndex && endIndex <= size_);
+  const size_t count = endIndex - beginIndex;
+  if (count == 0)
+    return;
+
+  if (beginIndex == 0)
+    head_ += count;
+  else
+  {
+    for (size_t k = endIndex; k < size_; ++k)
+      copy_(k - count, k);
+  }
+  size_ -= count;
+
+  if (currentState_ == CurrentState::STORED && currentIndex_ != NO_INDEX && currentIndex_ >= beginIndex)
+    currentIndex_ = (currentIndex_ >= endIndex) ? currentIndex_ - count : NO_INDEX;
+
+  // Release chunks that no longer hold points, from the front and from the back
+  size_t frontChunks = chunks_.size();
+  size_t usedChunks = 0;
+  if (size_ == 0)
+    head_ = 0;
+  else
+  {
+    frontChunks = head_ / CHUNK_SIZE;
+    head_ -= frontChunks * CHUNK_SIZE;
+    usedChunks = (head_ + size_ + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  }
+  std::vector<Chunk*> released(chunks_.begin(), chunks_.begin() + frontChunks);
+  released.insert(released.end(), chunks_.begin() + frontChunks + usedChunks, chunks_.end());
+  chunks_.erase(chunks_.begin() + frontChunks + usedChunks, chunks_.end());
+  chunks_.erase(chunks_.begin(), chunks_.begin() + frontChunks);
+
+  for (Chunk* chunk : released)
+  {
+    if (spareChunks_.size() < MAX_SPARE_CHUNKS)
+      spareChunks_.push_back(chunk);
+    else
+      delete chunk;
+  }
+}
+
+size_t ColumnarPlatformUpdateSlice::lowerBound_(double time, size_t hint) const
+{
+  // Look near the hint first, which is fast when moving sequentially through time
+  if (hint < size_)
+  {
+    size_t index = hint;
+    if (timeAt(index) <= time)
+    {
+      for (size_t ii = 0; ii < FastSearchWidth && index != size_; ++ii, ++index)
+      {
+        if (timeAt(index) >= time)
+          return index;
+      }
+      if (index == size_)
+        return size_;
+    }
+    else
+    {
+      for (size_t ii = 0; ii < FastSearchWidth && index != 0; ++ii, --index)
+      {
+        if (timeAt(index) < time)
+          return index + 1;
+      }
+    }
+  }
+
+  size_t first = 0;
+  size_t count = size_;
+  while (count > 0)
+  {
+    const size_t step = count / 2;
+    if (timeAt(first + step) < time)
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+      count = step;
+  }
+  return first;
+}
+
+size_t ColumnarPlatformUpdateSlice::upperBound_(double time, size_t hint) const
+{
+  // Look near the hint first, which is fast when moving sequentially through time
+  if (hint < size_)
+  {
+    size_t index = hint;
+    if (timeAt(index) <= time)
+    {
+      for (size_t ii = 0; ii < FastSearchWidth && index != size_; ++ii, ++index)
+      {
+        if (timeAt(index) > time)
+          return index;
+      }
+      if (index == size_)
+        return size_;
+    }
+    else
+    {
+      for (size_t ii = 0; ii < FastSearchWidth && index != 0; ++ii, --index)
+      {
+        if (timeAt(index) <= time)
+          return index + 1;
+      }
+      // avoid the binary search when before or at the first time
+      if (index == 0)
+        return (timeAt(0) <= time) ? 1 : 0;
+    }
+  }
+
+  size_t first = 0;
+  size_t count = size_;
+  while (count > 0)
+  {
+    const size_t step = count / 2;
+    if (!(time < timeAt(first + step)))
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+      count = step;
+  }
+  return first;
+}
+
+void ColumnarPlatformUpdateSlice::setCurrentIndex_(size_t index)
+{
+  if (index == NO_INDEX)
+  {
+    if (currentState_ != CurrentState::NONE)
+    {
+      hasChanged_ = true;
+      currentState_ = CurrentState::NONE;
+    }
+    return;
+  }
+
+  // Same stored point is not a change
+  if (currentState_ == CurrentState::STORED && currentIndex_ == index)
+    return;
+
+  hasChanged_ = true;
+  currentState_ = CurrentState::STORED;
+  currentIndex_ = index;
+  at(index, &current_);
+}
+
+bool ColumnarPlatformUpdateSlice::isCurrentAt_(double time) const
+{
+  const PlatformUpdate* cur = current();
+  return !dirty_ && cur != nullptr && (cur->time() == time || cur->time() == -1.0);
+}
+
+void ColumnarPlatformUpdateSlice::notify_() const
+{
+  if (notifierFn_)
+    notifierFn_();
+}
+
+}
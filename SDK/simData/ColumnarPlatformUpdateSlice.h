@@ -0,0 +1,213 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_COLUMNARPLATFORMUPDATESLICE_H
+#define SIMDATA_COLUMNARPLATFORMUPDATESLICE_H
+
+#include <functional>
+#include <optional>
+#include <vector>
+#include "simData/DataSlice.h"
+#include "simData/DataTypes.h"
+
+namespace simData
+{
+
+class Interpolator;
+
+/**
+ * Platform update slice that stores its points as columns (time, position, orientation and velocity)
+ * in fixed size chunks, instead of as individually allocated PlatformUpdate objects.  Chunks freed by
+ * data limiting are kept for reuse, so a live slice with a data limit reaches a steady state without
+ * further allocation.  Provides the same interface as MemoryDataSlice<PlatformUpdate>.
+ *
+ * Points are materialized into PlatformUpdate objects on demand.  Pointers returned by current() and
+ * interpolationBounds() remain valid until the next update, insert, or removal.  An iterator keeps only
+ * its two most recently returned points valid, and pointers passed to a Visitor are only valid for the
+ * duration of the call.
+ */
+class SDKDATA_EXPORT ColumnarPlatformUpdateSlice : public PlatformUpdateSlice
+{
+public:
+  ColumnarPlatformUpdateSlice();
+  virtual ~ColumnarPlatformUpdateSlice();
+
+  SDK_DISABLE_COPY_MOVE(ColumnarPlatformUpdateSlice);
+
+  /// remove all data in the slice
+  void flush(bool keepStatic = true);
+  /// remove points in the given time range; up to but not including endTime
+  void flush(double startTime, double endTime);
+
+  /** Returns an iterator pointing to the first update whose timestamp is greater than or equal to (>=) the timeValue */
+  virtual Iterator lower_bound(double timeValue) const override;
+  /** Returns an iterator pointing to the first update whose timestamp is greater than (>) the timeValue */
+  virtual Iterator upper_bound(double timeValue) const override;
+  /** Total number of items in this data slice */
+  virtual size_t numItems() const override;
+  /** Current update changed during the last DataStore::update */
+  virtual bool hasChanged() const override;
+  /** Returns true if the slice has been modified since the last DataStore::update */
+  virtual bool isDirty() const override;
+  /** Retrieve the current update */
+  virtual const PlatformUpdate* current() const override;
+  /** Visits each update in time order */
+  virtual void visit(Visitor* visitor) const override;
+  /** Not supported, as with MemoryDataSlice */
+  virtual void modify(Modifier* modifier) override;
+  /** Returns true if the current update was interpolated from its bounds */
+  virtual bool isInterpolated() const override;
+  /** Retrieve the bounds used to compute the interpolated value */
+  virtual Bounds interpolationBounds() const override;
+  /** Retrieves the earliest time stored in this slice */
+  virtual double firstTime() const override;
+  /** Retrieves the latest time stored in this slice */
+  virtual double lastTime() const override;
+  /** The time delta between the given time and the data point before the given time; return -1 if no previous point */
+  virtual double deltaTime(double time) const override;
+
+  /** Clear the marker that indicates if the "current" update contains new data */
+  void clearChanged();
+  /** Set the marker that indicates if the "current" update contains new data */
+  void setChanged();
+  /** Sets the current update to a copy of the given value, or clears it if nullptr */
+  void setCurrent(const PlatformUpdate* current);
+
+  /** Perform a time update, finding the state data whose time matches or is the lower bound of the specified time */
+  void update(double time);
+  /** Perform a time update, also returning the time span over which the current update does not change */
+  void update(double time, std::optional<double>& startTime, std::optional<double>& endTime);
+  /** Perform a time update, interpolating between the bounding points if needed */
+  void update(double time, Interpolator* interpolator);
+
+  /** A function that is called every time the slice is modified */
+  void installNotifier(const std::function<void()>& fn);
+
+  /**
+   * Insert the specified data in time-based sorted order.  Takes ownership of the data, which is
+   * copied into the columns and deleted, for compatibility with MemoryDataSlice::insert().
+   */
+  void insert(PlatformUpdate* data);
+  /** Insert a copy of the specified data in time-based sorted order */
+  void insert(const PlatformUpdate& data);
+
+  /// reduce the slice to only have points within the given 'timeWindow' (negative for no limit)
+  void limitByTime(double timeWindow);
+  /// reduce the slice to only have 'limitPoints' points (0 is no limit)
+  void limitByPoints(uint32_t limitPoints);
+  /** Performs both point and time limiting based on the settings in prefs */
+  void limitByPrefs(const CommonPrefs& prefs);
+
+  /** Retrieves the current interpolated value */
+  PlatformUpdate* currentInterpolated();
+
+  /** Materializes the point at the given index, which must be less than numItems() */
+  void at(size_t index, PlatformUpdate* update) const;
+  /** Time of the point at the given index, which must be less than numItems() */
+  double timeAt(size_t index) const;
+  /** Bytes allocated for point storage, including spare chunks */
+  size_t memoryUsage() const;
+
+protected:
+  /// Helper function to return an iterator to the first index
+  virtual IteratorImpl* iterator_() const override;
+
+private:
+  class ColumnIterator;
+
+  /// Number of points in each chunk; a power of two
+  static constexpr size_t CHUNK_SIZE = 256;
+  /// Marks a state that does not refer to a stored point
+  static constexpr size_t NO_INDEX = static_cast<size_t>(-1);
+
+  /** Structure of arrays for CHUNK_SIZE points */
+  struct Chunk
+  {
+    double time[CHUNK_SIZE];
+    double x[CHUNK_SIZE];
+    double y[CHUNK_SIZE];
+    double z[CHUNK_SIZE];
+    float psi[CHUNK_SIZE];
+    float theta[CHUNK_SIZE];
+    float phi[CHUNK_SIZE];
+    float vx[CHUNK_SIZE];
+    float vy[CHUNK_SIZE];
+    float vz[CHUNK_SIZE];
+  };
+
+  /** Identifies what the current update refers to, for change detection */
+  enum class CurrentState
+  {
+    NONE,
+    STORED,
+    INTERPOLATED,
+    EXTERNAL
+  };
+
+  /** Returns the chunk and offset holding the given index */
+  Chunk& chunk_(size_t index, size_t& offset) const;
+  /** Writes the value into the point at the given index */
+  void store_(size_t index, const PlatformUpdate& value);
+  /** Copies the point at index 'from' over the point at index 'to' */
+  void copy_(size_t to, size_t from);
+  /** Appends an uninitialized point, allocating a chunk if needed */
+  void grow_();
+  /** Removes the points [beginIndex, endIndex) */
+  void erase_(size_t beginIndex, size_t endIndex);
+
+  /** Index of the first point with time >= the given time, starting the search near the hint */
+  size_t lowerBound_(double time, size_t hint) const;
+  /** Index of the first point with time > the given time, starting the search near the hint */
+  size_t upperBound_(double time, size_t hint) const;
+
+  /** Makes the point at the given index current, or clears the current update for NO_INDEX */
+  void setCurrentIndex_(size_t index);
+  /** Returns true if the early out in update() applies */
+  bool isCurrentAt_(double time) const;
+  /** Calls the notifier, if any */
+  void notify_() const;
+
+  std::vector<Chunk*> chunks_;
+  /// Chunks released by removal, kept for reuse by later inserts
+  std::vector<Chunk*> spareChunks_;
+  /// Offset of the first point within chunks_.front()
+  size_t head_;
+  size_t size_;
+
+  bool hasChanged_;
+  bool dirty_;
+  bool interpolated_;
+  CurrentState currentState_;
+  /// Index of the current point when currentState_ is STORED
+  size_t currentIndex_;
+  PlatformUpdate current_;
+  PlatformUpdate currentInterpolated_;
+  PlatformUpdate lowBound_;
+  PlatformUpdate highBound_;
+  /// Index near the last update, used to speed up sequential time updates
+  size_t fastIndex_;
+  std::function<void()> notifierFn_;
+};
+
+}
+
+#endif /* SIMDATA_COLUMNARPLATFORMUPDATESLICE_H */
@@ -39,6 +39,7 @@ namespace simData
 {
 class CategoryDataSlice;
 class CategoryNameManager;
+class CategoryValueIndex;
 class GenericDataSlice;
 class DataTableManager;
 class DataTable;
@@ -250,6 +251,16 @@ public:
 
     /// New update was added for the entity ID provided, at the time provided.  Query the data store for the contents of the update.
     virtual void onEntityUpdate(simData::DataStore* source, simData::ObjectId id, double dataTime) = 0;
+    /**
+     * A batch of updates spanning [firstTime, lastTime] was added for the entity ID provided, through
+     * addPlatformUpdates().  Default implementation calls onEntityUpdate() for the first and last times.
+     */
+    virtual void onEntityUpdates(simData::DataStore* source, simData::ObjectId id, double firstTime, double lastTime)
+    {
+      onEntityUpdate(source, id, firstTime);
+      if (lastTime != firstTime)
+        onEntityUpdate(source, id, lastTime);
+    }
     /// New table row was added for the entity ID provided, at the time provided.  Query the data table for contents of the row.
     virtual void onNewRowData(simData::DataStore* source, simData::DataTable& table, simData::ObjectId id, double dataTime) = 0;
     /// Notification of flush, which may interleave other entity updates.  @see simData::DataStore::Listener::onFlush()
@@ -304,6 +315,19 @@ public: // methods
   /// returns the last value sent to update(double), relative to current reference year
   virtual double updateTime() const = 0;
 
+  /**
+   * Retrieves the IDs of entities that may have changed in the most recent call to update(double).
+   * This includes entities whose current update was re-evaluated (e.g. new data or interpolation),
+   * whose preferences, name or category data changed, and entities added since the previous update.
+   * Generic data and data tables are not evaluated by update(), so their changes are not reported;
+   * consumers of generic data or data tables must check those slices and tables for every entity.
+   * Intended to let per-frame consumers visit only the entities that need attention.
+   * @param[out] ids Sorted list of changed entity IDs, without duplicates
+   * @return true if the implementation tracks changes; false if not, in which case callers must
+   *   treat every entity as changed
+   */
+  virtual bool changedEntities(IdList* ids) const = 0;
+
   /// data store reference year (without transaction cost); intended to be cached locally for performance.
   virtual int referenceYear() const = 0;
 
@@ -642,6 +666,17 @@ public: // methods
   //virtual        TableData*        addTableData(ObjectId id, Transaction *transaction) = 0;
   ///@}
 
+  /**
+   * Adds a batch of platform updates in one operation.  Equivalent to calling addPlatformUpdate() for
+   * each update, except that data limiting is applied once for the batch and each NewUpdatesListener
+   * is notified once through onEntityUpdates().  An update replaces an earlier update with the same time.
+   * @param id Platform that receives the updates
+   * @param updates Updates sorted by nondecreasing time
+   * @param count Number of updates
+   * @return 0 on success, non-zero if the platform does not exist or the updates are not sorted
+   */
+  virtual int addPlatformUpdates(ObjectId id, const PlatformUpdate* updates, size_t count) = 0;
+
   /**@name Retrieving read-only data slices
    * @note No locking performed for read-only update slice objects
    * @{
@@ -719,6 +754,13 @@ public: // methods
   virtual CategoryNameManager& categoryNameManager() const = 0;
   ///@}
 
+  /**
+   * Retrieves the inverted index of current category data, for finding and counting the entities
+   * with a given category value without visiting every entity.  Current as of the last update().
+   * @return Reference to the category value index.
+   */
+  virtual const CategoryValueIndex& categoryValueIndex() const = 0;
+
   /**
    * Retrieves a reference to the data table manager associated with this data store.
    * The data table manager can be used to create data tables associated with entities,
@@ -74,6 +74,9 @@ public: // methods
   /// returns the last value sent to update(double), relative to current reference year
   virtual double updateTime() const override {return dataStore_->updateTime();}
 
+  /// retrieves the IDs of entities that may have changed in the most recent update
+  virtual bool changedEntities(IdList* ids) const override {return dataStore_->changedEntities(ids);}
+
   /// data store reference year (without transaction cost); intended to be cached locally for performance.
   virtual int referenceYear() const override {return dataStore_->referenceYear();}
 
@@ -290,6 +293,7 @@ public: // methods
    * @{
    */
   virtual  PlatformUpdate *   addPlatformUpdate(ObjectId id, Transaction *transaction) override {return dataStore_->addPlatformUpdate(id, transaction);}
+  virtual int addPlatformUpdates(ObjectId id, const PlatformUpdate* updates, size_t count) override {return dataStore_->addPlatformUpdates(id, updates, count);}
   virtual      BeamUpdate *   addBeamUpdate(ObjectId id, Transaction *transaction) override {return dataStore_->addBeamUpdate(id, transaction);}
   virtual      BeamCommand*   addBeamCommand(ObjectId id, Transaction *transaction) override {return dataStore_->addBeamCommand(id, transaction);}
   virtual      GateUpdate *   addGateUpdate(ObjectId id, Transaction *transaction) override {return dataStore_->addGateUpdate(id, transaction);}
@@ -366,6 +370,9 @@ public: // methods
   virtual CategoryNameManager& categoryNameManager() const override { return dataStore_->categoryNameManager(); }
   ///@}
 
+  /// Retrieves the inverted index of current category data
+  virtual const CategoryValueIndex& categoryValueIndex() const override { return dataStore_->categoryValueIndex(); }
+
   /**
    * Retrieves a reference to the data table manager associated with this data store.
    * The data table manager can be used to create data tables associated with entities,
@@ -24,6 +24,7 @@
 #define SIMDATA_DATATABLE_H
 
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 #include <deque>
@@ -419,6 +420,19 @@ public:
    */
   virtual void accept(ColumnVisitor& visitor) const = 0;
 
+  /**
+   * Reads the values of a single column after beginTime (inclusive) until endTime (exclusive),
+   * converted to double.  This is much faster than row visitation when only one column is needed,
+   * since values are copied in contiguous runs without creating a TableRow per time.
+   * @param columnId Column to read
+   * @param beginTime Inclusive time at which to start reading values
+   * @param endTime Exclusive time at which to stop reading values
+   * @param times Cleared, then filled with the time of each value in time order
+   * @param values Cleared, then filled with the column values, one per entry in times
+   * @return Status indicating success, or error if the column does not exist
+   */
+  virtual TableStatus readColumn(TableColumnId columnId, double beginTime, double endTime, std::vector<double>& times, std::vector<double>& values) const = 0;
+
   /**
    * Adds a data table row to the table.
    * @param row Row to add to the table.
@@ -568,6 +582,33 @@ public:
     virtual double interpolate(const TableColumn* column, double lowVal, double highVal, double tLow, double tVal, double tHigh) const = 0;
   };
 
+  /**
+   * Visitor for contiguous runs of values in a column, used by accept().  Only the overload that
+   * matches the column's variableType() is called.  Each call provides the time values and the
+   * stored values for one run of entries, in time order.  The spans refer to internal storage and
+   * are only valid for the duration of the call.
+   */
+  class RunVisitor
+  {
+  public:
+    virtual ~RunVisitor() {}
+
+    ///@{
+    /** Visits a run of time values and the matching column values; both spans are the same size. */
+    virtual void visit(std::span<const double> times, std::span<const uint8_t> values) = 0;
+    virtual void visit(std::span<const double> times, std::span<const int8_t> values) = 0;
+    virtual void visit(std::span<const double> times, std::span<const uint16_t> values) = 0;
+    virtual void visit(std::span<const double> times, std::span<const int16_t> values) = 0;
+    virtual void visit(std::span<const double> times, std::span<const uint32_t> values) = 0;
+    virtual void visit(std::span<const double> times, std::span<const int32_t> values) = 0;
+    virtual void visit(std::span<const double> times, std::span<const uint64_t> values) = 0;
+    virtual void visit(std::span<const double> times, std::span<const int64_t> values) = 0;
+    virtual void visit(std::span<const double> times, std::span<const float> values) = 0;
+    virtual void visit(std::span<const double> times, std::span<const double> values) = 0;
+    virtual void visit(std::span<const double> times, std::span<const std::string> values) = 0;
+    ///@}
+  };
+
   /** Retrieves the ID of the table that owns this column. */
   virtual TableId tableId() const = 0;
 
@@ -663,6 +704,15 @@ public:
    */
   virtual int getTimeRange(double& begin, double& end) const = 0;
   /// @}
+
+  /**
+   * Performs visitation of the values after beginTime (inclusive) until endTime (exclusive) in
+   * contiguous runs, avoiding per-entry virtual calls and type conversions.
+   * @param beginTime Inclusive time at which to start visiting values
+   * @param endTime Exclusive time at which to stop visiting values
+   * @param visitor Visitor to receive the runs, in time order
+   */
+  virtual void accept(double beginTime, double endTime, RunVisitor& visitor) const = 0;
 };
 
 /// Forward declare a cell class to be used internally by TableRow
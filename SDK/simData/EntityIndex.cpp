@@ -0,0 +1,141 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include "simData/EntityIndex.h"
+
+namespace simData {
+
+namespace
+{
+/// Bucket count for an empty index; must be a power of two
+constexpr size_t INITIAL_BUCKETS = 16;
+/// 2^64 divided by the golden ratio, for Fibonacci hashing of sequential IDs
+constexpr uint64_t FIBONACCI_MULTIPLIER = 0x9e3779b97f4a7c15ull;
+}
+
+EntityIndex::EntityIndex()
+  : buckets_(INITIAL_BUCKETS),
+    size_(0),
+    shift_(60)
+{
+}
+
+EntityIndex::~EntityIndex()
+{
+}
+
+const EntityIndex::Record* EntityIndex::find(ObjectId id) const
+{
+  const Record& record = buckets_[probe_(id)];
+  return (record.slot == EMPTY_SLOT) ? nullptr : &record;
+}
+
+void EntityIndex::set(ObjectId id, ObjectType type, uint32_t slot)
+{
+  assert(slot != EMPTY_SLOT);
+  // Keep the load factor at or below one half
+  if ((size_ + 1) * 2 > buckets_.size())
+    rehash_(buckets_.size() * 2);
+
+  Record& record = buckets_[probe_(id)];
+  if (record.slot == EMPTY_SLOT)
+    ++size_;
+  record.id = id;
+  record.type = type;
+  record.slot = slot;
+}
+
+bool EntityIndex::erase(ObjectId id)
+{
+  size_t hole = probe_(id);
+  if (buckets_[hole].slot == EMPTY_SLOT)
+    return false;
+
+  // Shift later members of the cluster back into the hole, rather than leaving a tombstone
+  const size_t mask = buckets_.size() - 1;
+  size_t next = hole;
+  while (true)
+  {
+    next = (next + 1) & mask;
+    if (buckets_[next].slot == EMPTY_SLOT)
+      break;
+    // Move only if the hole lies between the record's home bucket and its current bucket
+    const size_t home = bucket_(buckets_[next].id);
+    if (((next - home) & mask) >= ((next - hole) & mask))
+    {
+      buckets_[hole] = buckets_[next];
+      hole = next;
+    }
+  }
+  buckets_[hole] = Record();
+  --size_;
+  return true;
+}
+
+void EntityIndex::clear()
+{
+  std::fill(buckets_.begin(), buckets_.end(), Record());
+  size_ = 0;
+}
+
+size_t EntityIndex::size() const
+{
+  return size_;
+}
+
+size_t EntityIndex::bucket_(ObjectId id) const
+{
+  return static_cast<size_t>((id * FIBONACCI_MULTIPLIER) >> shift_);
+}
+
+size_t EntityIndex::probe_(ObjectId id) const
+{
+  const size_t mask = buckets_.size() - 1;
+  size_t index = bucket_(id);
+  while (buckets_[index].slot != EMPTY_SLOT && buckets_[index].id != id)
+    index = (index + 1) & mask;
+  return index;
+}
+
+void EntityIndex::rehash_(size_t numBuckets)
+{
+  std::vector<Record> oldBuckets(numBuckets);
+  oldBuckets.swap(buckets_);
+  shift_ = 64;
+  for (size_t k = numBuckets; k > 1; k >>= 1)
+    --shift_;
+
+  const size_t mask = numBuckets - 1;
+  for (const Record& record : oldBuckets)
+  {
+    if (record.slot == EMPTY_SLOT)
+      continue;
+    size_t index = bucket_(record.id);
+    while (buckets_[index].slot != EMPTY_SLOT)
+      index = (index + 1) & mask;
+    buckets_[index] = record;
+  }
+}
+
+}
@@ -0,0 +1,190 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_ENTITYINDEX_H
+#define SIMDATA_ENTITYINDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "simData/ObjectId.h"
+
+namespace simData {
+
+/**
+ * Open addressing hash index from an ObjectId to the entity's type and its slot in a dense array.
+ * Uses linear probing with backward shift deletion, so lookups stay short after many removals.
+ * Several EntityMap instances can share one index, so that a single probe answers both the
+ * type of an ID and the location of its entry.
+ */
+class SDKDATA_EXPORT EntityIndex
+{
+public:
+  /** Slot value that marks an unused bucket */
+  static constexpr uint32_t EMPTY_SLOT = 0xffffffff;
+
+  /** Indexed location of a single ID */
+  struct Record
+  {
+    ObjectId id = 0;
+    ObjectType type = NONE;
+    uint32_t slot = EMPTY_SLOT;
+  };
+
+  EntityIndex();
+  virtual ~EntityIndex();
+
+  /** Returns the record for the given ID, or nullptr if the ID is not indexed */
+  const Record* find(ObjectId id) const;
+  /** Adds the ID, or replaces its type and slot if already indexed */
+  void set(ObjectId id, ObjectType type, uint32_t slot);
+  /** Removes the ID; returns false if the ID was not indexed */
+  bool erase(ObjectId id);
+  /** Removes all IDs */
+  void clear();
+  /** Number of indexed IDs */
+  size_t size() const;
+
+private:
+  /** Returns the home bucket for the ID */
+  size_t bucket_(ObjectId id) const;
+  /** Returns the bucket holding the ID, or the empty bucket that ends its probe sequence */
+  size_t probe_(ObjectId id) const;
+  /** Resizes the bucket array to the given power of two and reinserts all records */
+  void rehash_(size_t numBuckets);
+
+  std::vector<Record> buckets_;
+  size_t size_;
+  /** Right shift applied to the hashed ID; 64 minus log2 of the bucket count */
+  unsigned int shift_;
+};
+
+/**
+ * Map of ObjectId to value, with the values stored contiguously and located through an EntityIndex.
+ * Provides the subset of the std::map interface used by the data store.  Erasing moves the last
+ * value into the erased position, so iteration order is insertion order only until the first erase,
+ * and erasing invalidates iterators to the last element.
+ */
+template <typename T>
+class EntityMap
+{
+public:
+  typedef std::pair<ObjectId, T> value_type;
+  typedef typename std::vector<value_type>::iterator iterator;
+  typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+  /** Creates a map with its own private index */
+  EntityMap()
+    : ownIndex_(new EntityIndex),
+      index_(ownIndex_.get()),
+      type_(NONE)
+  {
+  }
+
+  /** Creates a map that records its IDs in a shared index under the given type; the index must outlive the map */
+  EntityMap(EntityIndex& index, ObjectType type)
+    : index_(&index),
+      type_(type)
+  {
+  }
+
+  SDK_DISABLE_COPY_MOVE(EntityMap);
+
+  iterator begin() { return values_.begin(); }
+  iterator end() { return values_.end(); }
+  const_iterator begin() const { return values_.begin(); }
+  const_iterator end() const { return values_.end(); }
+  size_t size() const { return values_.size(); }
+  bool empty() const { return values_.empty(); }
+
+  /** Returns the value for the ID, or end() if the ID is not in this map */
+  iterator find(ObjectId id)
+  {
+    const EntityIndex::Record* record = index_->find(id);
+    return (record != nullptr && record->type == type_) ? values_.begin() + record->slot : values_.end();
+  }
+
+  /** Returns the value for the ID, or end() if the ID is not in this map */
+  const_iterator find(ObjectId id) const
+  {
+    const EntityIndex::Record* record = index_->find(id);
+    return (record != nullptr && record->type == type_) ? values_.begin() + record->slot : values_.end();
+  }
+
+  /** Returns the value for the ID, inserting a value initialized entry if needed */
+  T& operator[](ObjectId id)
+  {
+    iterator it = find(id);
+    if (it != values_.end())
+      return it->second;
+    index_->set(id, type_, static_cast<uint32_t>(values_.size()));
+    values_.emplace_back(id, T());
+    return values_.back().second;
+  }
+
+  /** Removes the value at the given position */
+  void erase(iterator it)
+  {
+    const size_t slot = static_cast<size_t>(it - values_.begin());
+    index_->erase(it->first);
+    if (slot + 1 != values_.size())
+    {
+      values_[slot] = std::move(values_.back());
+      index_->set(values_[slot].first, type_, static_cast<uint32_t>(slot));
+    }
+    values_.pop_back();
+  }
+
+  /** Removes the value for the ID, returning the number of values removed */
+  size_t erase(ObjectId id)
+  {
+    iterator it = find(id);
+    if (it == values_.end())
+      return 0;
+    erase(it);
+    return 1;
+  }
+
+  /** Removes all values, and their IDs from the index */
+  void clear()
+  {
+    if (ownIndex_)
+      ownIndex_->clear();
+    else
+    {
+      for (const auto& value : values_)
+        index_->erase(value.first);
+    }
+    values_.clear();
+  }
+
+private:
+  std::unique_ptr<EntityIndex> ownIndex_;
+  EntityIndex* index_;
+  ObjectType type_;
+  std::vector<value_type> values_;
+};
+
+}
+
+#endif /* SIMDATA_ENTITYINDEX_H */
@@ -0,0 +1,600 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <typeinfo>
+#include "simData/DataTable.h"
+#include "simData/IngestQueue.h"
+
+namespace simData {
+
+namespace
+{
+/// High bit marks an ID as a placeholder; data stores do not generate IDs this large
+constexpr uint64_t PLACEHOLDER_FLAG = 1ull << 63;
+/// Placeholders hold the producer index above this bit, and a per-producer counter below it
+constexpr int PLACEHOLDER_INDEX_SHIFT = 32;
+/// Smallest size of the placeholder map at which drain() trims it
+constexpr size_t MIN_PLACEHOLDER_TRIM_SIZE = 1024;
+}
+
+/**
+ * Queued item; applied to the data store by IngestQueue::drain().  Each subclass has a set()
+ * taking its constructor arguments, which Producer::emplace_() uses to reuse an item in place.
+ */
+class IngestQueue::Item
+{
+public:
+  virtual ~Item() {}
+
+  /** Applies the item to the queue's data store; returns false on failure */
+  virtual bool apply(IngestQueue& queue) = 0;
+
+  /** Returns the update and sets the platform ID if this is a platform update, for batching */
+  virtual const PlatformUpdate* platformUpdate(ObjectId& id) const { return nullptr; }
+
+  /** Time the item was pushed on the producer thread */
+  std::chrono::steady_clock::time_point pushTime;
+
+protected:
+  /** Data store of the given queue */
+  static DataStore& dataStore_(IngestQueue& queue) { return queue.dataStore_; }
+  /** Records the real ID for a placeholder */
+  static void setPlaceholder_(IngestQueue& queue, ObjectId placeholder, ObjectId id) { queue.placeholders_[placeholder] = id; }
+};
+
+namespace
+{
+
+/** Host ID resolution for entity properties; platforms have no host */
+inline bool resolveHost(const IngestQueue& queue, PlatformProperties& props)
+{
+  return true;
+}
+
+template <typename PropsT>
+bool resolveHost(const IngestQueue& queue, PropsT& props)
+{
+  const ObjectId hostId = queue.resolve(props.hostid());
+  if (hostId == 0)
+    return false;
+  props.set_hostid(hostId);
+  return true;
+}
+
+/** Creates an entity, then applies the optional prefs */
+template <typename PropsT, typename PrefsT>
+class EntityItem : public IngestQueue::Item
+{
+public:
+  typedef PropsT* (DataStore::*AddFn)(DataStore::Transaction*);
+  typedef PrefsT* (DataStore::*PrefsFn)(ObjectId, DataStore::Transaction*, DataStore::CommitResult*);
+
+  EntityItem(AddFn addFn, PrefsFn prefsFn, ObjectId placeholder, const PropsT& props, const PrefsT* prefs)
+  {
+    set(addFn, prefsFn, placeholder, props, prefs);
+  }
+
+  void set(AddFn addFn, PrefsFn prefsFn, ObjectId placeholder, const PropsT& props, const PrefsT* prefs)
+  {
+    addFn_ = addFn;
+    prefsFn_ = prefsFn;
+    placeholder_ = placeholder;
+    props_ = props;
+    hasPrefs_ = (prefs != nullptr);
+    if (prefs)
+      prefs_ = *prefs;
+    else
+      prefs_.Clear();
+  }
+
+  virtual bool apply(IngestQueue& queue) override
+  {
+    if (!resolveHost(queue, props_))
+      return false;
+
+    DataStore& ds = dataStore_(queue);
+    DataStore::Transaction txn;
+    PropsT* props = (ds.*addFn_)(&txn);
+    if (!props)
+      return false;
+    const ObjectId id = props->id();
+    *props = props_;
+    props->set_id(id);
+    txn.commit();
+    setPlaceholder_(queue, placeholder_, id);
+
+    if (hasPrefs_)
+    {
+      DataStore::Transaction prefsTxn;
+      PrefsT* prefs = (ds.*prefsFn_)(id, &prefsTxn, nullptr);
+      if (!prefs)
+        return false;
+      prefs->MergeFrom(prefs_);
+      prefsTxn.commit();
+    }
+    return true;
+  }
+
+private:
+  AddFn addFn_ = nullptr;
+  PrefsFn prefsFn_ = nullptr;
+  ObjectId placeholder_ = 0;
+  PropsT props_;
+  PrefsT prefs_;
+  bool hasPrefs_ = false;
+};
+
+/** Adds an update or command to an entity */
+template <typename T>
+class DataItem : public IngestQueue::Item
+{
+public:
+  typedef T* (DataStore::*AddFn)(ObjectId, DataStore::Transaction*);
+
+  DataItem(AddFn addFn, ObjectId id, const T& data)
+  {
+    set(addFn, id, data);
+  }
+
+  void set(AddFn addFn, ObjectId id, const T& data)
+  {
+    addFn_ = addFn;
+    id_ = id;
+    data_ = data;
+  }
+
+  virtual bool apply(IngestQueue& queue) override
+  {
+    const ObjectId id = queue.resolve(id_);
+    if (id == 0)
+      return false;
+    DataStore::Transaction txn;
+    T* data = (dataStore_(queue).*addFn_)(id, &txn);
+    if (!data)
+      return false;
+    *data = data_;
+    txn.commit();
+    return true;
+  }
+
+protected:
+  AddFn addFn_ = nullptr;
+  ObjectId id_ = 0;
+  T data_;
+};
+
+/** Platform updates are applied in batches by drain() */
+class PlatformUpdateItem : public DataItem<PlatformUpdate>
+{
+public:
+  PlatformUpdateItem(ObjectId id, const PlatformUpdate& update)
+    : DataItem<PlatformUpdate>(&DataStore::addPlatformUpdate, id, update)
+  {
+  }
+
+  void set(ObjectId id, const PlatformUpdate& update)
+  {
+    DataItem<PlatformUpdate>::set(&DataStore::addPlatformUpdate, id, update);
+  }
+
+  virtual const PlatformUpdate* platformUpdate(ObjectId& id) const override
+  {
+    id = id_;
+    return &data_;
+  }
+};
+
+/** Adds a row to a data table */
+class TableRowItem : public IngestQueue::Item
+{
+public:
+  TableRowItem(ObjectId ownerId, const std::string& tableName, const TableRow& row)
+    : ownerId_(ownerId),
+      tableName_(tableName),
+      row_(row)
+  {
+  }
+
+  void set(ObjectId ownerId, const std::string& tableName, const TableRow& row)
+  {
+    ownerId_ = ownerId;
+    tableName_ = tableName;
+    row_ = row;
+  }
+
+  virtual bool apply(IngestQueue& queue) override
+  {
+    // Owner 0 is the scenario, which is not a placeholder and resolves to itself
+    const ObjectId ownerId = queue.resolve(ownerId_);
+    if (ownerId == 0 && ownerId_ != 0)
+      return false;
+    DataTable* table = dataStore_(queue).dataTableManager().findTable(ownerId, tableName_);
+    return table != nullptr && table->addRow(row_).isSuccess();
+  }
+
+private:
+  ObjectId ownerId_;
+  std::string tableName_;
+  TableRow row_;
+};
+
+/** Rounds up to a power of 2, with a minimum of 2 */
+size_t ringSize(size_t capacity)
+{
+  size_t size = 2;
+  while (size < capacity)
+    size <<= 1;
+  return size;
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////
+
+IngestQueue::IngestQueue(DataStore& dataStore, size_t capacity)
+  : dataStore_(dataStore),
+    capacity_(ringSize(capacity)),
+    placeholderTrimSize_(MIN_PLACEHOLDER_TRIM_SIZE),
+    drained_(0),
+    failed_(0),
+    droppedByReleased_(0),
+    pushedByReleased_(0),
+    lastDrainSeconds_(0.0),
+    maxLatencySeconds_(0.0),
+    meanLatencySeconds_(0.0)
+{
+}
+
+IngestQueue::~IngestQueue()
+{
+  // Producers may outlive the queue; they keep their items, which are deleted with the producer
+}
+
+DataStore& IngestQueue::dataStore() const
+{
+  return dataStore_;
+}
+
+std::shared_ptr<IngestQueue::Producer> IngestQueue::createProducer()
+{
+  std::lock_guard<std::mutex> lock(producersMutex_);
+  std::shared_ptr<Producer> producer(new Producer(capacity_, nextProducerIndex_++));
+  producers_.push_back(producer);
+  return producer;
+}
+
+size_t IngestQueue::drain()
+{
+  const auto startTime = std::chrono::steady_clock::now();
+  std::vector<std::shared_ptr<Producer> > producers;
+  {
+    std::lock_guard<std::mutex> lock(producersMutex_);
+    producers = producers_;
+  }
+
+  size_t numDrained = 0;
+  uint64_t numFailed = 0;
+  double totalLatency = 0.0;
+  double maxLatency = 0.0;
+  std::vector<PlatformUpdate>& batch = platformBatch_;
+  ObjectId batchId = 0;
+  for (const auto& producer : producers)
+  {
+    // Only drain items present at the start, so that busy producers cannot stall the data store thread
+    for (size_t remaining = producer->queueDepth(); remaining > 0; --remaining)
+    {
+      // Item stays in its slot, for the producer to reuse, until popFront_() below
+      Item* item = producer->front_();
+      if (!item)
+        break;
+      ++numDrained;
+      const double latency = std::chrono::duration<double>(startTime - item->pushTime).count();
+      totalLatency += latency;
+      maxLatency = std::max(maxLatency, latency);
+
+      ObjectId rawId = 0;
+      const PlatformUpdate* update = item->platformUpdate(rawId);
+      if (update)
+      {
+        const ObjectId id = resolve(rawId);
+        // Batch must be for one platform and sorted by time
+        if (!batch.empty() && (id != batchId || update->time() < batch.back().time()))
+          numFailed += flushPlatformUpdates_(batchId, batch);
+        if (id == 0)
+          ++numFailed;
+        else
+        {
+          batchId = id;
+          batch.push_back(*update);
+        }
+      }
+      else
+      {
+        numFailed += flushPlatformUpdates_(batchId, batch);
+        if (!item->apply(*this))
+          ++numFailed;
+      }
+      producer->popFront_();
+    }
+    numFailed += flushPlatformUpdates_(batchId, batch);
+  }
+  producers.clear();
+
+  // Forget producers released by their owners, once empty; nothing else can push to them
+  {
+    std::lock_guard<std::mutex> lock(producersMutex_);
+    auto newEnd = std::remove_if(producers_.begin(), producers_.end(), [this](const std::shared_ptr<Producer>& producer) {
+      if (producer.use_count() != 1 || producer->queueDepth() != 0)
+        return false;
+      pushedByReleased_ += producer->pushed();
+      droppedByReleased_ += producer->dropped();
+      return true;
+    });
+    producers_.erase(newEnd, producers_.end());
+  }
+
+  // Amortized: trim only once the map doubles in size since the last trim
+  if (placeholders_.size() >= placeholderTrimSize_)
+    trimPlaceholders_();
+
+  drained_ += numDrained;
+  failed_ += numFailed;
+  lastDrainSeconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+  maxLatencySeconds_ = maxLatency;
+  meanLatencySeconds_ = (numDrained == 0) ? 0.0 : totalLatency / numDrained;
+  return numDrained;
+}
+
+void IngestQueue::update(double time)
+{
+  drain();
+  dataStore_.update(time);
+}
+
+ObjectId IngestQueue::resolve(ObjectId id) const
+{
+  if ((id & PLACEHOLDER_FLAG) == 0)
+    return id;
+  auto iter = placeholders_.find(id);
+  return (iter == placeholders_.end()) ? 0 : iter->second;
+}
+
+IngestQueue::Stats IngestQueue::stats() const
+{
+  Stats rv;
+  rv.pushed = pushedByReleased_;
+  rv.dropped = droppedByReleased_;
+  {
+    std::lock_guard<std::mutex> lock(producersMutex_);
+    for (const auto& producer : producers_)
+    {
+      rv.queueDepth += producer->queueDepth();
+      rv.pushed += producer->pushed();
+      rv.dropped += producer->dropped();
+    }
+  }
+  rv.drained = drained_;
+  rv.failed = failed_;
+  rv.lastDrainSeconds = lastDrainSeconds_;
+  rv.maxLatencySeconds = maxLatencySeconds_;
+  rv.meanLatencySeconds = meanLatencySeconds_;
+  return rv;
+}
+
+size_t IngestQueue::flushPlatformUpdates_(ObjectId id, std::vector<PlatformUpdate>& batch)
+{
+  if (batch.empty())
+    return 0;
+  const size_t numFailed = (dataStore_.addPlatformUpdates(id, batch.data(), batch.size()) == 0) ? 0 : batch.size();
+  batch.clear();
+  return numFailed;
+}
+
+void IngestQueue::trimPlaceholders_()
+{
+  // Data store IDs are not reused, so a removed entity's placeholder can never resolve to a live entity
+  for (auto iter = placeholders_.begin(); iter != placeholders_.end();)
+  {
+    if (dataStore_.objectType(iter->second) == simData::NONE)
+      iter = placeholders_.erase(iter);
+    else
+      ++iter;
+  }
+  placeholderTrimSize_ = std::max(MIN_PLACEHOLDER_TRIM_SIZE, 2 * placeholders_.size());
+}
+
+///////////////////////////////////////////////////////////////////////
+
+IngestQueue::Producer::Producer(size_t capacity, uint64_t index)
+  : ring_(capacity),
+    mask_(capacity - 1),
+    head_(0),
+    tail_(0),
+    pushed_(0),
+    dropped_(0),
+    index_(index)
+{
+}
+
+IngestQueue::Producer::~Producer()
+{
+}
+
+template <typename ItemT, typename... Args>
+bool IngestQueue::Producer::emplace_(Args&&... args)
+{
+  const size_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail - head_.load(std::memory_order_acquire) > mask_)
+  {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  // The consumer is done with this slot's old item; reuse it if it is the same kind
+  std::unique_ptr<Item>& slot = ring_[tail & mask_];
+  if (slot && typeid(*slot) == typeid(ItemT))
+    static_cast<ItemT&>(*slot).set(std::forward<Args>(args)...);
+  else
+    slot.reset(new ItemT(std::forward<Args>(args)...));
+  slot->pushTime = std::chrono::steady_clock::now();
+  tail_.store(tail + 1, std::memory_order_release);
+  pushed_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+ObjectId IngestQueue::Producer::addPlatform(const PlatformProperties& props, const PlatformPrefs* prefs)
+{
+  const ObjectId placeholder = nextPlaceholder_();
+  return emplace_<EntityItem<PlatformProperties, PlatformPrefs> >(&DataStore::addPlatform, &DataStore::mutable_platformPrefs, placeholder, props, prefs) ? placeholder : 0;
+}
+
+ObjectId IngestQueue::Producer::addBeam(const BeamProperties& props, const BeamPrefs* prefs)
+{
+  const ObjectId placeholder = nextPlaceholder_();
+  return emplace_<EntityItem<BeamProperties, BeamPrefs> >(&DataStore::addBeam, &DataStore::mutable_beamPrefs, placeholder, props, prefs) ? placeholder : 0;
+}
+
+ObjectId IngestQueue::Producer::addGate(const GateProperties& props, const GatePrefs* prefs)
+{
+  const ObjectId placeholder = nextPlaceholder_();
+  return emplace_<EntityItem<GateProperties, GatePrefs> >(&DataStore::addGate, &DataStore::mutable_gatePrefs, placeholder, props, prefs) ? placeholder : 0;
+}
+
+ObjectId IngestQueue::Producer::addLaser(const LaserProperties& props, const LaserPrefs* prefs)
+{
+  const ObjectId placeholder = nextPlaceholder_();
+  return emplace_<EntityItem<LaserProperties, LaserPrefs> >(&DataStore::addLaser, &DataStore::mutable_laserPrefs, placeholder, props, prefs) ? placeholder : 0;
+}
+
+ObjectId IngestQueue::Producer::addProjector(const ProjectorProperties& props, const ProjectorPrefs* prefs)
+{
+  const ObjectId placeholder = nextPlaceholder_();
+  return emplace_<EntityItem<ProjectorProperties, ProjectorPrefs> >(&DataStore::addProjector, &DataStore::mutable_projectorPrefs, placeholder, props, prefs) ? placeholder : 0;
+}
+
+ObjectId IngestQueue::Producer::addLobGroup(const LobGroupProperties& props, const LobGroupPrefs* prefs)
+{
+  const ObjectId placeholder = nextPlaceholder_();
+  return emplace_<EntityItem<LobGroupProperties, LobGroupPrefs> >(&DataStore::addLobGroup, &DataStore::mutable_lobGroupPrefs, placeholder, props, prefs) ? placeholder : 0;
+}
+
+bool IngestQueue::Producer::addPlatformUpdate(ObjectId id, const PlatformUpdate& update)
+{
+  return emplace_<PlatformUpdateItem>(id, update);
+}
+
+bool IngestQueue::Producer::addBeamUpdate(ObjectId id, const BeamUpdate& update)
+{
+  return emplace_<DataItem<BeamUpdate> >(&DataStore::addBeamUpdate, id, update);
+}
+
+bool IngestQueue::Producer::addGateUpdate(ObjectId id, const GateUpdate& update)
+{
+  return emplace_<DataItem<GateUpdate> >(&DataStore::addGateUpdate, id, update);
+}
+
+bool IngestQueue::Producer::addLaserUpdate(ObjectId id, const LaserUpdate& update)
+{
+  return emplace_<DataItem<LaserUpdate> >(&DataStore::addLaserUpdate, id, update);
+}
+
+bool IngestQueue::Producer::addProjectorUpdate(ObjectId id, const ProjectorUpdate& update)
+{
+  return emplace_<DataItem<ProjectorUpdate> >(&DataStore::addProjectorUpdate, id, update);
+}
+
+bool IngestQueue::Producer::addLobGroupUpdate(ObjectId id, const LobGroupUpdate& update)
+{
+  return emplace_<DataItem<LobGroupUpdate> >(&DataStore::addLobGroupUpdate, id, update);
+}
+
+bool IngestQueue::Producer::addPlatformCommand(ObjectId id, const PlatformCommand& command)
+{
+  return emplace_<DataItem<PlatformCommand> >(&DataStore::addPlatformCommand, id, command);
+}
+
+bool IngestQueue::Producer::addBeamCommand(ObjectId id, const BeamCommand& command)
+{
+  return emplace_<DataItem<BeamCommand> >(&DataStore::addBeamCommand, id, command);
+}
+
+bool IngestQueue::Producer::addGateCommand(ObjectId id, const GateCommand& command)
+{
+  return emplace_<DataItem<GateCommand> >(&DataStore::addGateCommand, id, command);
+}
+
+bool IngestQueue::Producer::addLaserCommand(ObjectId id, const LaserCommand& command)
+{
+  return emplace_<DataItem<LaserCommand> >(&DataStore::addLaserCommand, id, command);
+}
+
+bool IngestQueue::Producer::addProjectorCommand(ObjectId id, const ProjectorCommand& command)
+{
+  return emplace_<DataItem<ProjectorCommand> >(&DataStore::addProjectorCommand, id, command);
+}
+
+bool IngestQueue::Producer::addLobGroupCommand(ObjectId id, const LobGroupCommand& command)
+{
+  return emplace_<DataItem<LobGroupCommand> >(&DataStore::addLobGroupCommand, id, command);
+}
+
+bool IngestQueue::Producer::addTableRow(ObjectId ownerId, const std::string& tableName, const TableRow& row)
+{
+  return emplace_<TableRowItem>(ownerId, tableName, row);
+}
+
+size_t IngestQueue::Producer::queueDepth() const
+{
+  // Read head first; tail never decreases, so the difference cannot underflow
+  const size_t head = head_.load(std::memory_order_acquire);
+  return tail_.load(std::memory_order_acquire) - head;
+}
+
+uint64_t IngestQueue::Producer::pushed() const
+{
+  return pushed_.load(std::memory_order_relaxed);
+}
+
+uint64_t IngestQueue::Producer::dropped() const
+{
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+IngestQueue::Item* IngestQueue::Producer::front_() const
+{
+  const size_t head = head_.load(std::memory_order_relaxed);
+  if (head == tail_.load(std::memory_order_acquire))
+    return nullptr;
+  return ring_[head & mask_].get();
+}
+
+void IngestQueue::Producer::popFront_()
+{
+  head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+ObjectId IngestQueue::Producer::nextPlaceholder_()
+{
+  return PLACEHOLDER_FLAG | (index_ << PLACEHOLDER_INDEX_SHIFT) | ++placeholderCount_;
+}
+
+}
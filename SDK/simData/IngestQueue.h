@@ -0,0 +1,244 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_INGESTQUEUE_H
+#define SIMDATA_INGESTQUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "simCore/Common/Common.h"
+#include "simData/DataStore.h"
+
+namespace simData {
+
+class TableRow;
+
+/**
+ * Thread safe front end for adding data to a DataStore.  The DataStore requires that all writes
+ * happen on the thread that calls update().  IngestQueue lets any number of producer threads
+ * queue entity creations, updates, commands and table rows without blocking; the queued data is
+ * applied to the DataStore in bulk by drain() or update() on the DataStore thread.
+ *
+ * Each producer thread obtains its own Producer, which owns a bounded lock-free ring buffer.
+ * A Producer must only be used by one thread at a time.  Data from a single Producer is applied
+ * in the order it was pushed; there is no ordering between Producers.  When a ring is full the
+ * push fails and the item is counted as dropped.  Ring slots keep their item after it is drained,
+ * and a later push of the same kind into the slot reuses it, so steady traffic does not allocate.
+ *
+ * Entities created through a Producer are assigned a placeholder ID immediately, which may be
+ * used in place of the real ID for later pushes, including as the host ID of child entities.
+ * Placeholders are resolved to real IDs when the creation is drained; a placeholder created by
+ * one Producer can be used by another Producer only after the creation has been drained.
+ */
+class SDKDATA_EXPORT IngestQueue
+{
+public:
+  /** Queue usage counters, summed over all producers */
+  struct Stats
+  {
+    /// Number of items waiting to be drained
+    size_t queueDepth = 0;
+    /// Number of items successfully pushed
+    uint64_t pushed = 0;
+    /// Number of items rejected because a ring was full
+    uint64_t dropped = 0;
+    /// Number of items drained and applied to the data store
+    uint64_t drained = 0;
+    /// Number of drained items that could not be applied, e.g. because the entity does not exist
+    uint64_t failed = 0;
+    /// Wall clock time spent in the most recent drain, in seconds
+    double lastDrainSeconds = 0.0;
+    /// Largest time between push and apply for items in the most recent drain, in seconds
+    double maxLatencySeconds = 0.0;
+    /// Average time between push and apply for items in the most recent drain, in seconds
+    double meanLatencySeconds = 0.0;
+  };
+
+  class Producer;
+
+  /**
+   * Creates a queue that writes into the given data store.
+   * @param dataStore Data store that receives the queued data; must outlive the queue
+   * @param capacity Number of items each producer ring can hold; rounded up to a power of 2
+   */
+  explicit IngestQueue(DataStore& dataStore, size_t capacity = 4096);
+  virtual ~IngestQueue();
+
+  SDK_DISABLE_COPY_MOVE(IngestQueue);
+
+  /** Data store that receives the queued data */
+  DataStore& dataStore() const;
+
+  /**
+   * Creates a new producer.  Thread safe.  The producer may be destroyed at any time; its
+   * queued data is still drained.
+   */
+  std::shared_ptr<Producer> createProducer();
+
+  /**
+   * Applies all queued data to the data store.  Must be called on the data store thread.
+   * Consecutive platform updates for the same platform are applied as one batch through
+   * DataStore::addPlatformUpdates().
+   * @return Number of items drained
+   */
+  size_t drain();
+
+  /** Drains the queues, then updates the data store to the given time.  Must be called on the data store thread. */
+  void update(double time);
+
+  /**
+   * Returns the real ID for a placeholder ID returned by a Producer.  IDs that are not placeholders
+   * are returned unchanged.  Returns 0 for placeholders that have not been drained yet, and may
+   * return 0 for placeholders of entities that have since been removed from the data store.
+   */
+  ObjectId resolve(ObjectId id) const;
+
+  /** Returns the current usage counters */
+  Stats stats() const;
+
+  /** Base class for a queued item */
+  class Item;
+
+private:
+  /** Applies and clears a batch of platform updates gathered by drain(); returns the number that failed */
+  size_t flushPlatformUpdates_(ObjectId id, std::vector<PlatformUpdate>& batch);
+  /** Forgets placeholders of entities that no longer exist in the data store */
+  void trimPlaceholders_();
+
+  DataStore& dataStore_;
+  const size_t capacity_;
+  /** Protects producers_ and nextProducerIndex_ */
+  mutable std::mutex producersMutex_;
+  std::vector<std::shared_ptr<Producer> > producers_;
+  uint64_t nextProducerIndex_ = 0;
+  /** Placeholder to real ID, for entities created through the queue */
+  std::unordered_map<ObjectId, ObjectId> placeholders_;
+  /** Size of placeholders_ at which drain() next trims it */
+  size_t placeholderTrimSize_;
+  /** Platform updates gathered by drain(); a member so that its storage is reused between drains */
+  std::vector<PlatformUpdate> platformBatch_;
+
+  /** Counters written only on the drain thread */
+  std::atomic<uint64_t> drained_;
+  std::atomic<uint64_t> failed_;
+  std::atomic<uint64_t> droppedByReleased_;
+  std::atomic<uint64_t> pushedByReleased_;
+  std::atomic<double> lastDrainSeconds_;
+  std::atomic<double> maxLatencySeconds_;
+  std::atomic<double> meanLatencySeconds_;
+};
+
+/**
+ * Queues data for an IngestQueue from a single thread.  Pushes never block; each returns false
+ * (or 0 for entity creation) and increments the drop counter when the ring is full.
+ */
+class SDKDATA_EXPORT IngestQueue::Producer
+{
+public:
+  virtual ~Producer();
+
+  SDK_DISABLE_COPY_MOVE(Producer);
+
+  /**@name Entity creation
+   * Queues a new entity.  The ID in the properties is ignored; a host ID may be a placeholder.
+   * Prefs, if provided, are merged into the default prefs after creation.
+   * @return Placeholder ID for the new entity, or 0 if the ring is full
+   * @{
+   */
+  ObjectId addPlatform(const PlatformProperties& props, const PlatformPrefs* prefs = nullptr);
+  ObjectId addBeam(const BeamProperties& props, const BeamPrefs* prefs = nullptr);
+  ObjectId addGate(const GateProperties& props, const GatePrefs* prefs = nullptr);
+  ObjectId addLaser(const LaserProperties& props, const LaserPrefs* prefs = nullptr);
+  ObjectId addProjector(const ProjectorProperties& props, const ProjectorPrefs* prefs = nullptr);
+  ObjectId addLobGroup(const LobGroupProperties& props, const LobGroupPrefs* prefs = nullptr);
+  ///@}
+
+  /**@name Entity data
+   * Queues an update or command for an entity, identified by real or placeholder ID
+   * @return False if the ring is full
+   * @{
+   */
+  bool addPlatformUpdate(ObjectId id, const PlatformUpdate& update);
+  bool addBeamUpdate(ObjectId id, const BeamUpdate& update);
+  bool addGateUpdate(ObjectId id, const GateUpdate& update);
+  bool addLaserUpdate(ObjectId id, const LaserUpdate& update);
+  bool addProjectorUpdate(ObjectId id, const ProjectorUpdate& update);
+  bool addLobGroupUpdate(ObjectId id, const LobGroupUpdate& update);
+  bool addPlatformCommand(ObjectId id, const PlatformCommand& command);
+  bool addBeamCommand(ObjectId id, const BeamCommand& command);
+  bool addGateCommand(ObjectId id, const GateCommand& command);
+  bool addLaserCommand(ObjectId id, const LaserCommand& command);
+  bool addProjectorCommand(ObjectId id, const ProjectorCommand& command);
+  bool addLobGroupCommand(ObjectId id, const LobGroupCommand& command);
+  ///@}
+
+  /**
+   * Queues a row for the named data table of the given owner.  The table must exist when the row is drained.
+   * @return False if the ring is full
+   */
+  bool addTableRow(ObjectId ownerId, const std::string& tableName, const TableRow& row);
+
+  /** Number of items waiting in this producer's ring */
+  size_t queueDepth() const;
+  /** Number of items pushed by this producer */
+  uint64_t pushed() const;
+  /** Number of items dropped by this producer because the ring was full */
+  uint64_t dropped() const;
+
+private:
+  friend class IngestQueue;
+  Producer(size_t capacity, uint64_t index);
+
+  /**
+   * Stores an ItemT built from the arguments in the next slot if there is room.  Nothing is
+   * allocated when the ring is full, or when the slot already holds an ItemT to reuse.
+   */
+  template <typename ItemT, typename... Args>
+  bool emplace_(Args&&... args);
+  /** Returns the oldest item, or nullptr if the ring is empty.  Consumer side only. */
+  Item* front_() const;
+  /** Returns the oldest item's slot to the producer, once the item is applied.  Consumer side only. */
+  void popFront_();
+  /** Returns a new placeholder ID */
+  ObjectId nextPlaceholder_();
+
+  /** Ring of items; size is a power of 2.  Drained slots keep their item for reuse. */
+  std::vector<std::unique_ptr<Item> > ring_;
+  const size_t mask_;
+  /** Next slot to read; written by consumer */
+  std::atomic<size_t> head_;
+  /** Next slot to write; written by producer */
+  std::atomic<size_t> tail_;
+  std::atomic<uint64_t> pushed_;
+  std::atomic<uint64_t> dropped_;
+  const uint64_t index_;
+  uint64_t placeholderCount_ = 0;
+};
+
+}
+
+#endif /* SIMDATA_INGESTQUEUE_H */
@@ -21,6 +21,9 @@
  *
  */
 #include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <vector>
 #include "simCore/Calc/Angle.h"
 #include "simCore/Calc/CoordinateConverter.h"
 #include "simCore/Calc/Interpolation.h"
@@ -28,115 +31,277 @@
 
 namespace simData {
 
-bool LinearInterpolator::interpolate(double time, const PlatformUpdate &prev, const PlatformUpdate &next, PlatformUpdate *result)
+namespace {
+
+/** Values of a platform update that the geodetic form of a bracket depends on */
+struct BracketValues
 {
-  // Test for same input/output -- this function cannot handle case of prev == result, or next == result
-  if (!result || &prev == result || &next == result)
+  /// time, x, y, z, psi, theta, phi, vx, vy, vz; orientation and velocity are 0 when not used
+  double values[10] = { 0. };
+  bool hasOrientation = false;
+  bool hasVelocity = false;
+
+  BracketValues()
   {
-    assert(0);
-    return false;
   }
-  // time must be within bounds for interpolation to work
-  assert(prev.time() <= time && time <= next.time());
 
-  // compute time ratio
-  double factor = simCore::getFactor(prev.time(), time, next.time());
+  BracketValues(const PlatformUpdate& update, bool useOrientation, bool useVelocity)
+    : hasOrientation(useOrientation),
+      hasVelocity(useVelocity)
+  {
+    values[0] = update.time();
+    values[1] = update.x();
+    values[2] = update.y();
+    values[3] = update.z();
+    if (useOrientation)
+    {
+      values[4] = update.psi();
+      values[5] = update.theta();
+      values[6] = update.phi();
+    }
+    if (useVelocity)
+    {
+      values[7] = update.vx();
+      values[8] = update.vy();
+      values[9] = update.vz();
+    }
+  }
+
+  bool operator==(const BracketValues& rhs) const
+  {
+    if (hasOrientation != rhs.hasOrientation || hasVelocity != rhs.hasVelocity)
+      return false;
+    for (size_t k = 0; k < 10; ++k)
+    {
+      if (values[k] != rhs.values[k])
+        return false;
+    }
+    return true;
+  }
+};
+
+/** Geodetic form of the prev and next updates of a bracket */
+struct GeodeticBracket
+{
+  simCore::Coordinate prevLla;
+  simCore::Coordinate nextLla;
+};
 
+/** Converts prev and next to geodetic; orientation and velocity are included only if both updates have them */
+void makeGeodeticBracket(const PlatformUpdate& prev, const PlatformUpdate& next, GeodeticBracket& out)
+{
   simCore::Coordinate prevEcef(simCore::COORD_SYS_ECEF, simCore::Vec3(prev.x(), prev.y(), prev.z()));
   if (prev.has_orientation() && next.has_orientation())
     prevEcef.setOrientation(simCore::Vec3(prev.psi(), prev.theta(), prev.phi()));
   if (prev.has_velocity() && next.has_velocity())
     prevEcef.setVelocity(simCore::Vec3(prev.vx(), prev.vy(), prev.vz()));
-
-  simCore::Coordinate prevLla;
-  simCore::CoordinateConverter::convertEcefToGeodetic(prevEcef, prevLla);
+  simCore::CoordinateConverter::convertEcefToGeodetic(prevEcef, out.prevLla);
 
   simCore::Coordinate nextEcef(simCore::COORD_SYS_ECEF, simCore::Vec3(next.x(), next.y(), next.z()));
   if (prev.has_orientation() && next.has_orientation())
     nextEcef.setOrientation(simCore::Vec3(next.psi(), next.theta(), next.phi()));
   if (prev.has_velocity() && next.has_velocity())
     nextEcef.setVelocity(simCore::Vec3(next.vx(), next.vy(), next.vz()));
-  simCore::Coordinate nextLla;
-  simCore::CoordinateConverter::convertEcefToGeodetic(nextEcef, nextLla);
+  simCore::CoordinateConverter::convertEcefToGeodetic(nextEcef, out.nextLla);
+}
 
+/** Interpolates an Euler angle assumed to be between 0 and 360, taking the short way around */
+double interpolateEulerAngle(double low, double high, double factor)
+{
+  const double delta = high - low;
+  if (delta == 0.)
+    return low;
+  if (std::abs(delta) < M_PI)
+    return low + factor * delta;
+  if (delta > 0)
+    return low - factor * (M_TWOPI - delta);
+  return low + factor * (M_TWOPI + delta);
+}
 
-  // do the interpolation in geocentric, this way the
-  // interpolation is correct at N/S and E/W transitions
-  simCore::Vec3 xyz(simCore::linearInterpolate(prev.x(), next.x(), factor),
-                    simCore::linearInterpolate(prev.y(), next.y(), factor),
-                    simCore::linearInterpolate(prev.z(), next.z(), factor));
+/**
+* Fills in the geodetic result from the interpolated latitude and longitude.  Uses interpolated
+* geodetic altitude to prevent short cuts through the earth.
+*/
+void interpolateGeodetic(double factor, double lat, double lon, const GeodeticBracket& bracket, simCore::Coordinate& resultsLla)
+{
+  const simCore::Coordinate& prevLla = bracket.prevLla;
+  const simCore::Coordinate& nextLla = bracket.nextLla;
+  resultsLla.setCoordinateSystem(simCore::COORD_SYS_LLA);
+  resultsLla.setPositionLLA(lat, lon, simCore::linearInterpolate(prevLla.z(), nextLla.z(), factor));
 
-  simCore::Vec3 lla;
-  simCore::CoordinateConverter::convertEcefToGeodeticPos(xyz, lla);
+  if (prevLla.hasOrientation() && nextLla.hasOrientation())
+  {
+    resultsLla.setOrientation(
+      interpolateEulerAngle(simCore::angFix2PI(prevLla.yaw()), simCore::angFix2PI(nextLla.yaw()), factor),
+      interpolateEulerAngle(simCore::angFix2PI(prevLla.pitch()), simCore::angFix2PI(nextLla.pitch()), factor),
+      interpolateEulerAngle(simCore::angFix2PI(prevLla.roll()), simCore::angFix2PI(nextLla.roll()), factor));
+  }
 
-  // Use interpolated geodetic altitude to prevent short cuts through the earth
-  simCore::Coordinate resultsLla;
-  resultsLla.setCoordinateSystem(simCore::COORD_SYS_LLA);
-  resultsLla.setPositionLLA(lla.lat(), lla.lon(), simCore::linearInterpolate(prevLla.z(), nextLla.z(), factor));
+  if (prevLla.hasVelocity() && nextLla.hasVelocity())
+  {
+    resultsLla.setVelocity(simCore::linearInterpolate(prevLla.vx(), nextLla.vx(), factor),
+                           simCore::linearInterpolate(prevLla.vy(), nextLla.vy(), factor),
+                           simCore::linearInterpolate(prevLla.vz(), nextLla.vz(), factor));
+  }
+}
 
-  if (prev.has_orientation() && next.has_orientation())
+/** Copies the orientation and velocity, if any, from the ECEF result */
+void setOrientationVelocity(const simCore::Coordinate& resultsEcef, PlatformUpdate* result)
+{
+  if (resultsEcef.hasVelocity())
   {
-    double l_yaw = (simCore::angFix2PI(prevLla.yaw()));
-    double l_pitch = (simCore::angFix2PI(prevLla.pitch()));
-    double l_roll = (simCore::angFix2PI(prevLla.roll()));
-    double h_yaw = (simCore::angFix2PI(nextLla.yaw()));
-    double h_pitch = (simCore::angFix2PI(nextLla.pitch()));
-    double h_roll = (simCore::angFix2PI(nextLla.roll()));
-
-    // orientations assumed to be between 0 and 360
-    double delta_yaw = (h_yaw - l_yaw);
-    double delta_pitch = (h_pitch - l_pitch);
-    double delta_roll = (h_roll - l_roll);
-
-    double yaw;
-    double pitch;
-    double roll;
-
-    if (delta_yaw == 0.)
-      yaw = l_yaw;
-    else if (std::abs(delta_yaw) < M_PI)
-      yaw = (l_yaw + factor * delta_yaw);
-    else
-    {
-      if (delta_yaw > 0)
-        yaw = (l_yaw - factor * (M_TWOPI - delta_yaw));
-      else
-        yaw = (l_yaw + factor * (M_TWOPI + delta_yaw));
-    }
+    result->set_vx(resultsEcef.vx());
+    result->set_vy(resultsEcef.vy());
+    result->set_vz(resultsEcef.vz());
+  }
 
-    if (delta_pitch == 0.)
-      pitch = l_pitch;
-    else if (std::abs(delta_pitch) < M_PI)
-      pitch = (l_pitch + factor * delta_pitch);
-    else
-    {
-      if (delta_pitch > 0)
-        pitch = (l_pitch - factor * (M_TWOPI - delta_pitch));
-      else
-        pitch = (l_pitch + factor * (M_TWOPI + delta_pitch));
-    }
+  if (resultsEcef.hasOrientation())
+  {
+    result->set_psi(resultsEcef.psi());
+    result->set_theta(resultsEcef.theta());
+    result->set_phi(resultsEcef.phi());
+  }
+}
 
-    if (delta_roll == 0.)
-      roll = l_roll;
-    else if (std::abs(delta_roll) < M_PI)
-      roll = (l_roll + factor * delta_roll);
-    else
+/** Returns true if the arguments are suitable for interpolation */
+bool validArguments(const PlatformUpdate* prev, const PlatformUpdate* next, const PlatformUpdate* result)
+{
+  // this function cannot handle case of prev == result, or next == result
+  return result && prev && next && prev != result && next != result;
+}
+
+}
+
+//----------------------------------------------------------------------------
+
+/**
+* Fixed size cache of geodetic brackets, indexed by the addresses of the prev and next updates.
+* Colliding brackets replace each other.  Slots are guarded by a set of striped locks so that
+* threads interpolating different platforms rarely contend.
+*/
+class LinearInterpolator::BracketCache
+{
+public:
+  BracketCache()
+    : slots_(NUM_SLOTS)
+  {
+  }
+
+  /** Fills in the geodetic form of the bracket, from the cache when the cached values still match */
+  void get(const PlatformUpdate& prev, const PlatformUpdate& next, GeodeticBracket& out)
+  {
+    const bool useOrientation = prev.has_orientation() && next.has_orientation();
+    const bool useVelocity = prev.has_velocity() && next.has_velocity();
+    const BracketValues prevValues(prev, useOrientation, useVelocity);
+    const BracketValues nextValues(next, useOrientation, useVelocity);
+
+    const size_t index = slotIndex_(&prev, &next);
+    std::mutex& lock = locks_[index % NUM_LOCKS];
     {
-      if (delta_roll > 0)
-        roll = (l_roll - factor * (M_TWOPI - delta_roll));
-      else
-        roll = (l_roll + factor * (M_TWOPI + delta_roll));
+      std::lock_guard<std::mutex> guard(lock);
+      const Slot& slot = slots_[index];
+      if (slot.prev == &prev && slot.next == &next && slot.prevValues == prevValues && slot.nextValues == nextValues)
+      {
+        out = slot.bracket;
+        return;
+      }
     }
 
-    resultsLla.setOrientation(yaw, pitch, roll);
+    // Convert outside of the lock
+    makeGeodeticBracket(prev, next, out);
+
+    std::lock_guard<std::mutex> guard(lock);
+    Slot& slot = slots_[index];
+    slot.prev = &prev;
+    slot.next = &next;
+    slot.prevValues = prevValues;
+    slot.nextValues = nextValues;
+    slot.bracket = out;
   }
 
-  if (prev.has_velocity() && next.has_velocity())
+private:
+  static const size_t NUM_SLOTS = 4096;
+  static const size_t NUM_LOCKS = 64;
+
+  struct Slot
   {
-    resultsLla.setVelocity(simCore::linearInterpolate(prevLla.vx(), nextLla.vx(), factor),
-                           simCore::linearInterpolate(prevLla.vy(), nextLla.vy(), factor),
-                           simCore::linearInterpolate(prevLla.vz(), nextLla.vz(), factor));
+    const PlatformUpdate* prev = nullptr;
+    const PlatformUpdate* next = nullptr;
+    BracketValues prevValues;
+    BracketValues nextValues;
+    GeodeticBracket bracket;
+  };
+
+  static size_t slotIndex_(const PlatformUpdate* prev, const PlatformUpdate* next)
+  {
+    // Updates are heap allocated, so the low bits of the addresses carry little information
+    const uint64_t a = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(prev)) >> 4;
+    const uint64_t b = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(next)) >> 4;
+    const uint64_t hash = (a * 0x9E3779B97F4A7C15ull) ^ (b * 0xC2B2AE3D27D4EB4Full);
+    return static_cast<size_t>(hash >> 32) % NUM_SLOTS;
+  }
+
+  std::vector<Slot> slots_;
+  std::mutex locks_[NUM_LOCKS];
+};
+
+//----------------------------------------------------------------------------
+
+LinearInterpolator::LinearInterpolator()
+  : bracketCache_(new BracketCache)
+{
+}
+
+LinearInterpolator::~LinearInterpolator()
+{
+}
+
+void LinearInterpolator::setBracketCacheEnabled(bool enabled)
+{
+  if (enabled == bracketCacheEnabled())
+    return;
+  if (enabled)
+    bracketCache_.reset(new BracketCache);
+  else
+    bracketCache_.reset();
+}
+
+bool LinearInterpolator::bracketCacheEnabled() const
+{
+  return bracketCache_ != nullptr;
+}
+
+bool LinearInterpolator::interpolate(double time, const PlatformUpdate &prev, const PlatformUpdate &next, PlatformUpdate *result)
+{
+  // Test for same input/output -- this function cannot handle case of prev == result, or next == result
+  if (!validArguments(&prev, &next, result))
+  {
+    assert(0);
+    return false;
   }
+  // time must be within bounds for interpolation to work
+  assert(prev.time() <= time && time <= next.time());
+
+  // compute time ratio
+  double factor = simCore::getFactor(prev.time(), time, next.time());
+
+  GeodeticBracket bracket;
+  if (bracketCache_)
+    bracketCache_->get(prev, next, bracket);
+  else
+    makeGeodeticBracket(prev, next, bracket);
+
+  // do the interpolation in geocentric, this way the
+  // interpolation is correct at N/S and E/W transitions
+  simCore::Vec3 xyz(simCore::linearInterpolate(prev.x(), next.x(), factor),
+                    simCore::linearInterpolate(prev.y(), next.y(), factor),
+                    simCore::linearInterpolate(prev.z(), next.z(), factor));
+
+  simCore::Vec3 lla;
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(xyz, lla);
+
+  simCore::Coordinate resultsLla;
+  interpolateGeodetic(factor, lla.lat(), lla.lon(), bracket, resultsLla);
 
   simCore::Coordinate resultsEcef;
   simCore::CoordinateConverter::convertGeodeticToEcef(resultsLla, resultsEcef);
@@ -147,21 +312,76 @@ bool LinearInterpolator::interpolate(double time, const PlatformUpdate &prev, co
   result->set_y(resultsEcef.y());
   result->set_z(resultsEcef.z());
 
-  if (resultsEcef.hasVelocity())
+  setOrientationVelocity(resultsEcef, result);
+
+  return true;
+}
+
+size_t LinearInterpolator::interpolate(double time, size_t count, const PlatformUpdate* const* prev, const PlatformUpdate* const* next, PlatformUpdate* const* results)
+{
+  // Gather the valid entries so that the position arrays are dense
+  std::vector<size_t> indices;
+  indices.reserve(count);
+  for (size_t k = 0; k < count; ++k)
   {
-    result->set_vx(resultsEcef.vx());
-    result->set_vy(resultsEcef.vy());
-    result->set_vz(resultsEcef.vz());
+    if (validArguments(prev[k], next[k], results[k]))
+    {
+      // time must be within bounds for interpolation to work
+      assert(prev[k]->time() <= time && time <= next[k]->time());
+      indices.push_back(k);
+    }
   }
-
-  if (resultsEcef.hasOrientation())
+  const size_t numValid = indices.size();
+  if (numValid == 0)
+    return 0;
+
+  std::vector<GeodeticBracket> brackets(numValid);
+  std::vector<double> factors(numValid);
+  std::vector<double> x(numValid), y(numValid), z(numValid);
+  std::vector<double> lat(numValid), lon(numValid), alt(numValid);
+  for (size_t i = 0; i < numValid; ++i)
   {
-    result->set_psi(resultsEcef.psi());
-    result->set_theta(resultsEcef.theta());
-    result->set_phi(resultsEcef.phi());
+    const PlatformUpdate& p = *prev[indices[i]];
+    const PlatformUpdate& n = *next[indices[i]];
+    factors[i] = simCore::getFactor(p.time(), time, n.time());
+    if (bracketCache_)
+      bracketCache_->get(p, n, brackets[i]);
+    else
+      makeGeodeticBracket(p, n, brackets[i]);
+
+    // do the interpolation in geocentric, this way the
+    // interpolation is correct at N/S and E/W transitions
+    x[i] = simCore::linearInterpolate(p.x(), n.x(), factors[i]);
+    y[i] = simCore::linearInterpolate(p.y(), n.y(), factors[i]);
+    z[i] = simCore::linearInterpolate(p.z(), n.z(), factors[i]);
   }
 
-  return true;
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(numValid, x.data(), y.data(), z.data(), lat.data(), lon.data(), alt.data());
+  // Use interpolated geodetic altitude to prevent short cuts through the earth
+  for (size_t i = 0; i < numValid; ++i)
+    alt[i] = simCore::linearInterpolate(brackets[i].prevLla.z(), brackets[i].nextLla.z(), factors[i]);
+  simCore::CoordinateConverter::convertGeodeticPosToEcef(numValid, lat.data(), lon.data(), alt.data(), x.data(), y.data(), z.data());
+
+  for (size_t i = 0; i < numValid; ++i)
+  {
+    PlatformUpdate* result = results[indices[i]];
+    result->set_time(time);
+    result->set_x(x[i]);
+    result->set_y(y[i]);
+    result->set_z(z[i]);
+
+    // Orientation and velocity depend on the local frame, and are converted one at a time
+    const GeodeticBracket& bracket = brackets[i];
+    if (bracket.prevLla.hasOrientation() || bracket.prevLla.hasVelocity())
+    {
+      simCore::Coordinate resultsLla;
+      interpolateGeodetic(factors[i], lat[i], lon[i], bracket, resultsLla);
+      simCore::Coordinate resultsEcef;
+      simCore::CoordinateConverter::convertGeodeticToEcef(resultsLla, resultsEcef);
+      setOrientationVelocity(resultsEcef, result);
+    }
+  }
+  return numValid;
 }
 
 bool LinearInterpolator::interpolate(double time, const BeamUpdate &prev, const BeamUpdate &next, BeamUpdate *result)
@@ -23,7 +23,8 @@
 #ifndef SIMDATA_LINEAR_INTERPOLATOR_H
 #define SIMDATA_LINEAR_INTERPOLATOR_H
 
-#include "simCore/Common/Export.h"
+#include <memory>
+#include "simCore/Common/Common.h"
 #include "simData/Interpolator.h"
 
 namespace simData
@@ -38,13 +39,42 @@ namespace simData
   * @param[out] result Interpolated data store update
   * @pre result valid, result cannot be the same data store structure as either prev or next
   * @return true if interpolation was a success
+  *
+  * Platform interpolation needs the geodetic form of prev and next.  By default those are cached for
+  * each prev/next bracket, so repeated interpolation inside the same bracket skips both ECEF to
+  * geodetic conversions.  The cache holds a fixed number of brackets and compares the cached update
+  * values on every lookup, so modified or deleted updates are never served stale.  It is safe to
+  * interpolate from multiple threads at once.
   */
   class SDKDATA_EXPORT LinearInterpolator : public Interpolator
   {
   public:
+    LinearInterpolator();
+    virtual ~LinearInterpolator();
+
+    SDK_DISABLE_COPY_MOVE(LinearInterpolator);
+
+    /** Enables or disables the platform bracket cache; enabled by default.  Disabling clears the cache. */
+    void setBracketCacheEnabled(bool enabled);
+    /** Returns true if the platform bracket cache is enabled */
+    bool bracketCacheEnabled() const;
 
     virtual bool interpolate(double time, const PlatformUpdate &prev, const PlatformUpdate &next, PlatformUpdate *result);
 
+    /**
+    * Batch form of interpolate() for platforms, interpolating each prev[k]/next[k] pair to the same time.
+    * Positions for all platforms are converted in one pass with the array forms of the CoordinateConverter
+    * functions, so results may differ from interpolate() by floating point rounding.
+    * @param[in ] time Time of requested update
+    * @param[in ] count Number of platforms
+    * @param[in ] prev Array of count previous (low bound) updates
+    * @param[in ] next Array of count next (high bound) updates
+    * @param[out] results Array of count interpolated updates; entries that are nullptr, or the same as
+    *   the corresponding prev or next, are skipped
+    * @return Number of platforms interpolated
+    */
+    size_t interpolate(double time, size_t count, const PlatformUpdate* const* prev, const PlatformUpdate* const* next, PlatformUpdate* const* results);
+
     virtual bool interpolate(double time, const BeamUpdate &prev, const BeamUpdate &next, BeamUpdate *result);
 
     virtual bool interpolate(double time, const GateUpdate &prev, const GateUpdate &next, GateUpdate *result);
@@ -52,6 +82,11 @@ namespace simData
     virtual bool interpolate(double time, const LaserUpdate &prev, const LaserUpdate &next, simData::LaserUpdate *result);
 
     virtual bool interpolate(double time, const ProjectorUpdate &prev, const ProjectorUpdate &next, simData::ProjectorUpdate *result);
+
+  private:
+    class BracketCache;
+    /// Geodetic form of platform brackets; nullptr when disabled
+    std::unique_ptr<BracketCache> bracketCache_;
   };
 
 }
@@ -535,6 +535,35 @@ void MemoryDataSlice<T>::insert(T *data)
   dirty_ = true;
 }
 
+template<typename T>
+void MemoryDataSlice<T>::insertSorted(const T* data, size_t count)
+{
+  if (count == 0)
+    return;
+
+  // Fall back to individual inserts when the batch overlaps existing data
+  if (!updates_.empty() && updates_.back()->time() >= data[0].time())
+  {
+    for (size_t k = 0; k < count; ++k)
+      insert(new T(data[k]));
+    return;
+  }
+
+  if (notifierFn_)
+    notifierFn_();
+
+  for (size_t k = 0; k < count; ++k)
+  {
+    // Points added by this batch cannot be current, so a repeated time is replaced in place
+    if (k > 0 && data[k].time() == data[k - 1].time())
+      *updates_.back() = data[k];
+    else
+      updates_.push_back(new T(data[k]));
+  }
+  fastUpdate_.invalidate();
+  dirty_ = true;
+}
+
 template<typename T>
 void MemoryDataSlice<T>::limitByTime(double timeWindow)
 {
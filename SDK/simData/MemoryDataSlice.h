@@ -257,6 +257,14 @@ public:
    */
   virtual void insert(T *data);
 
+  /**
+   * Insert copies of a batch of data, which must be sorted by nondecreasing time.  Appending after the
+   * last point is done without searching; data with an existing time replaces the existing point.
+   * @param data Array of data sorted by time
+   * @param count Number of items in the array
+   */
+  void insertSorted(const T* data, size_t count);
+
   /// reduce the data store to only have points within the given 'timeWindow'
   /// @param timeWindow amount of time to keep in window (negative for no limit)
   void limitByTime(double timeWindow);
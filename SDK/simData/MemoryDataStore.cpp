@@ -36,6 +36,7 @@
 #include "simCore/Calc/Interpolation.h"
 #include "simCore/Calc/MultiFrameCoordinate.h"
 #include "simCore/Common/Common.h"
+#include "simCore/System/ThreadPool.h"
 #include "simCore/Time/Clock.h"
 #include "simData/MemoryDataStore.h"
 #include "simData/DataEntry.h"
@@ -53,6 +54,8 @@ namespace simData
 
 /// If there are more than USE_THREAD_FOR_GENERIC_DATA entities, then use a worker thread for the update
 constexpr size_t USE_THREAD_FOR_GENERIC_DATA = 1000;
+/// Parallel platform updates are only worth the synchronization cost above this many platforms
+constexpr size_t MIN_PLATFORMS_FOR_PARALLEL_UPDATE = 256;
 
 //----------------------------------------------------------------------------
 // Functions local to compilation unit, for implementation of common operations
@@ -68,9 +71,9 @@ namespace
  * @param[in   ] deepDelete when true, also delete the object in the map
  */
 template<typename T>
-bool deleteFromMap(std::map<ObjectId, T*> &map, ObjectId id, bool deepDelete = true)
+bool deleteFromMap(EntityMap<T*> &map, ObjectId id, bool deepDelete = true)
 {
-  typename std::map<ObjectId, T*>::iterator i = map.find(id);
+  typename EntityMap<T*>::iterator i = map.find(id);
   if (i != map.end())
   {
     if (deepDelete)
@@ -95,7 +98,7 @@ template <typename EntryType,            // PlatformEntry, BeamEntry, GateEntry,
           typename TransactionImplType,  // Properties transaction implementation type
           typename ListenerListType,     // Type for list of "entry added" observer callbacks (such as the private MemoryDataStore::ListenerList)
           typename PrefType>             // Type for the adding the default pref values
-PropertiesType* addEntry(ObjectId id, std::map<ObjectId, EntryType*> *entries, MemoryDataStore *store, DataStore::Transaction *transaction, ListenerListType *listeners, PrefType *defaultPrefs)
+PropertiesType* addEntry(ObjectId id, EntityMap<EntryType*> *entries, MemoryDataStore *store, DataStore::Transaction *transaction, ListenerListType *listeners, PrefType *defaultPrefs)
 {
   assert(transaction);
 
@@ -153,10 +156,10 @@ EntryType* getEntry(ObjectId id, const EntryMapType *store, DataStore::Transacti
 * @param startTime The start time of the data to flush
 * @param endTime The end time of the data to flush (non-inclusive)
 */
-template <typename EntityMap>
-void flushEntityData(EntityMap& map, ObjectId id, bool flushUpdates, bool flushCommands, double startTime, double endTime)
+template <typename EntryMapType>
+void flushEntityData(EntryMapType& map, ObjectId id, bool flushUpdates, bool flushCommands, double startTime, double endTime)
 {
-  typename EntityMap::const_iterator i = map.find(id);
+  typename EntryMapType::const_iterator i = map.find(id);
   if (i != map.end())
   {
     if (flushUpdates)
@@ -442,6 +445,8 @@ public:
 
   virtual void onAddEntity(DataStore* source, ObjectId newId, simData::ObjectType ot) override
   {
+    pendingChanges_.push_back(newId);
+
     auto categoryIt = mds_.categoryData_.find(newId);
     if (categoryIt == mds_.categoryData_.end())
     {
@@ -473,6 +478,9 @@ public:
       }
       platformCache_[newId] = PlatformCache(it->second);
       platformCommandCache_[newId] = CommandCache(it->second->commands(), newId);
+      // Insertion can relocate cache entries
+      platformList_.clear();
+      platformChanged_.clear();
     }
     else if (ot == simData::CUSTOM_RENDERING)
     {
@@ -548,6 +556,8 @@ public:
     if (platformCache_.erase(removedId) == 1)
     {
       platformCommandCache_.erase(removedId);
+      platformList_.clear();
+      platformChanged_.clear();
       return;
     }
 
@@ -572,16 +582,25 @@ public:
 
   virtual void onPrefsChange(DataStore* source, ObjectId id) override
   {
+    pendingChanges_.push_back(id);
+
     // A preference change can affect how a TSPI point is process, so reset
     auto platformIt = platformCache_.find(id);
     if (platformIt != platformCache_.end())
       platformIt->second.resetPreferences();
   }
 
+  virtual void onNameChange(DataStore* source, ObjectId changeId) override
+  {
+    pendingChanges_.push_back(changeId);
+  }
+
   virtual void onScenarioDelete(DataStore* source) override
   {
     categoryCache_.clear();
     platformCache_.clear();
+    platformList_.clear();
+    platformChanged_.clear();
     platformCommandCache_.clear();
     customRenderingCommandCache_.clear();
     beamCommandCache_.clear();
@@ -589,6 +608,14 @@ public:
     laserCommandCache_.clear();
     lobCommandCache_.clear();
     projectorCommandCache_.clear();
+    pendingChanges_.clear();
+  }
+
+  /// Moves the IDs of entities added, renamed or with new preferences since the last call into ids
+  void takePendingChanges_(IdList& ids)
+  {
+    ids.insert(ids.end(), pendingChanges_.begin(), pendingChanges_.end());
+    pendingChanges_.clear();
   }
 
   /// Update category slices to the give time and return the ids slices that changed due to the update
@@ -634,8 +661,8 @@ public:
     updateCommands_(projectorCommandCache_, time, allResults);
   }
 
-  /// Update platforms to the given time and return the IDs of platforms with changes due to command processing
-  void updatePlatforms_(double time)
+  /// Update platforms to the given time, appending the IDs of platforms that may have changed; splits the work across the pool if provided and worthwhile
+  void updatePlatforms_(double time, simCore::ThreadPool* pool, IdList& changedIds)
   {
     auto interpolateEnabled = mds_.interpolatorState();
     if ((interpolateEnabled == InterpolatorState::EXTERNAL) && !mds_.interpolator())
@@ -643,12 +670,39 @@ public:
 
     const bool fileMode = isFileMode_();
 
+    // Each PlatformCache touches only its own slice, so the platforms can be updated independently
+    if (pool && (pool->numThreads() > 1) && (platformCache_.size() >= MIN_PLATFORMS_FOR_PARALLEL_UPDATE))
+    {
+      if (platformList_.empty())
+      {
+        platformList_.reserve(platformCache_.size());
+        for (auto it = platformCache_.begin(); it != platformCache_.end(); ++it)
+          platformList_.emplace_back(it->first, &it->second);
+      }
+
+      // Results are written per index and gathered afterwards so that changedIds keeps the serial order
+      platformChanged_.resize(platformList_.size());
+      pool->parallelFor(platformList_.size(), [this, interpolateEnabled, fileMode, time](size_t beginIndex, size_t endIndex) {
+        for (size_t k = beginIndex; k < endIndex; ++k)
+          platformChanged_[k] = platformList_[k].second->update(&mds_, platformList_[k].first, interpolateEnabled, fileMode, time);
+      });
+      for (size_t k = 0; k < platformList_.size(); ++k)
+      {
+        if (platformChanged_[k])
+          changedIds.push_back(platformList_[k].first);
+      }
+      return;
+    }
+
 #ifdef HAVE_ENTT
     for (const auto& [id, entry] : platformCache_)
 #else
     for (auto& [id, entry] : platformCache_)
 #endif
-      entry.update(&mds_, id, interpolateEnabled, fileMode, time);
+    {
+      if (entry.update(&mds_, id, interpolateEnabled, fileMode, time))
+        changedIds.push_back(id);
+    }
   }
 
   void resetPlatforms()
@@ -866,8 +920,9 @@ private:
      * @param interpolateState Type of interpolation, if any
      * @param fileMode True if the data store is in file mode
      * @param time The scenario time to update the slices to
+     * @return true if the update slice was re-evaluated or its current value changed; false if the cache kicked out early
      */
-    void update(simData::DataStore* ds, simData::ObjectId id, DataStore::InterpolatorState interpolateState, bool fileMode, double time)
+    bool update(simData::DataStore* ds, simData::ObjectId id, DataStore::InterpolatorState interpolateState, bool fileMode, double time)
     {
       // Set the slice time range
       if (!sliceStartTime_.has_value())
@@ -882,7 +937,7 @@ private:
       {
         // until we have datadraw, send nullptr; once we have datadraw, we'll immediately update with valid data
         entry_->updates()->setCurrent(nullptr);
-        return;
+        return entry_->updates()->hasChanged();
       }
 
       const bool isInterpolated = ((interpolateState != InterpolatorState::OFF) && interpolatePos_);
@@ -896,7 +951,7 @@ private:
           needToClear_ = false;
         }
 
-        return;
+        return false;
       }
 
       needToClear_ = true;
@@ -907,12 +962,11 @@ private:
         if (!isFileModePlatformActive_(time))
         {
           // Platform is not valid/off
-          if (needToSetToNull_)
-          {
-            entry_->updates()->setCurrent(nullptr);
-            needToSetToNull_ = false;
-          }
-          return;
+          if (!needToSetToNull_)
+            return false;
+          entry_->updates()->setCurrent(nullptr);
+          needToSetToNull_ = false;
+          return true;
         }
       }
 
@@ -929,6 +983,7 @@ private:
         if (fileMode && !isExtendedPlatform() && (updateEndTime_ > sliceEndTime_))
           updateEndTime_ = sliceEndTime_;
       }
+      return true;
     }
 
     /** Called when the slice is modified so that the next call to update will not kick out early */
@@ -1329,6 +1384,12 @@ private:
   std::map<simData::ObjectId, CommandCache<MemoryCommandSlice<LobGroupCommand, LobGroupPrefs>>> lobCommandCache_;
   std::map<simData::ObjectId, CommandCache<MemoryCommandSlice<ProjectorCommand, ProjectorPrefs>>> projectorCommandCache_;
 #endif
+  /// Flat view of platformCache_ for splitting across threads; rebuilt on demand after platforms are added or removed
+  std::vector<std::pair<simData::ObjectId, PlatformCache*>> platformList_;
+  /// Per platformList_ entry result of the last parallel update; char instead of bool so threads write separate bytes
+  std::vector<char> platformChanged_;
+  /// Entities added, renamed or with new preferences since the last update
+  IdList pendingChanges_;
 
 
 };
@@ -1445,6 +1506,13 @@ MemoryDataStore::MemoryDataStore()
   hasChanged_(false),
   interpolationEnabled_(InterpolatorState::OFF),
   interpolator_(nullptr),
+  platforms_(entityIndex_, PLATFORM),
+  beams_(entityIndex_, BEAM),
+  gates_(entityIndex_, GATE),
+  lasers_(entityIndex_, LASER),
+  projectors_(entityIndex_, PROJECTOR),
+  lobGroups_(entityIndex_, LOB_GROUP),
+  customRenderings_(entityIndex_, CUSTOM_RENDERING),
   dataLimiting_(false),
   categoryNameManager_(new CategoryNameManager),
   dataLimitsProvider_(nullptr),
@@ -1468,6 +1536,13 @@ MemoryDataStore::MemoryDataStore(const ScenarioProperties &properties)
   hasChanged_(false),
   interpolationEnabled_(InterpolatorState::OFF),
   interpolator_(nullptr),
+  platforms_(entityIndex_, PLATFORM),
+  beams_(entityIndex_, BEAM),
+  gates_(entityIndex_, GATE),
+  lasers_(entityIndex_, LASER),
+  projectors_(entityIndex_, PROJECTOR),
+  lobGroups_(entityIndex_, LOB_GROUP),
+  customRenderings_(entityIndex_, CUSTOM_RENDERING),
   dataLimiting_(false),
   categoryNameManager_(new CategoryNameManager),
   dataLimitsProvider_(nullptr),
@@ -1532,6 +1607,7 @@ void MemoryDataStore::clearMemory_()
     delete it->second;
   genericData_.clear();
   categoryData_.clear();
+  categoryValueIndex_.clear();
 
   // clear out the category name manager, since categories are scenario specific data
   categoryNameManager_->clear();
@@ -1624,6 +1700,24 @@ DataStore::InterpolatorState MemoryDataStore::interpolatorState() const
   return interpolationEnabled_;
 }
 
+void MemoryDataStore::setUpdateThreadCount(unsigned int numThreads)
+{
+  if (numThreads == 0)
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  if (numThreads == updateThreadCount())
+    return;
+
+  if (numThreads == 1)
+    updatePool_.reset();
+  else
+    updatePool_ = std::make_unique<simCore::ThreadPool>(numThreads);
+}
+
+unsigned int MemoryDataStore::updateThreadCount() const
+{
+  return updatePool_ ? updatePool_->numThreads() : 1;
+}
+
 void MemoryDataStore::updateTargetBeam_(ObjectId id, BeamEntry* beam, double time)
 {
   // Get the two platforms, if available
@@ -1704,6 +1798,9 @@ void MemoryDataStore::updateBeams_(double time)
       beamEntry->updates()->update(time, interpolator_);
     else
       beamEntry->updates()->update(time);
+
+    if (beamEntry->updates()->hasChanged())
+      changedIds_.push_back(iter->first);
   }
 }
 
@@ -1843,6 +1940,9 @@ void MemoryDataStore::updateGates_(double time)
         gateEntry->updates()->setChanged();
       }
     }
+
+    if (gateEntry->updates()->hasChanged())
+      changedIds_.push_back(iter->first);
   }
 }
 
@@ -1860,6 +1960,9 @@ void MemoryDataStore::updateLasers_(double time)
       laserEntry->updates()->update(time, interpolator_);
     else
       laserEntry->updates()->update(time);
+
+    if (laserEntry->updates()->hasChanged())
+      changedIds_.push_back(iter->first);
   }
 }
 
@@ -1873,6 +1976,9 @@ void MemoryDataStore::updateProjectors_(double time)
       projectorEntry->updates()->update(time, interpolator_);
     else
       projectorEntry->updates()->update(time);
+
+    if (projectorEntry->updates()->hasChanged())
+      changedIds_.push_back(iter->first);
   }
 }
 
@@ -1894,6 +2000,9 @@ void MemoryDataStore::updateLobGroups_(double time)
 
     // update the slice
     iter->second->updates()->update(time);
+
+    if (iter->second->updates()->hasChanged())
+      changedIds_.push_back(iter->first);
   }
 }
 
@@ -2071,6 +2180,7 @@ simData::PlatformPrefs MemoryDataStore::defaultPlatformPrefs() const
 ///Update internal data to show 'time' as current
 void MemoryDataStore::update(double time)
 {
+  changedIds_.clear();
   if (!hasChanged_ && time == lastUpdateTime_)
     return;
 
@@ -2083,14 +2193,29 @@ void MemoryDataStore::update(double time)
 
   std::vector<simData::ObjectId> ids;
   sliceCacheObserver_->updateCategoryData_(time, ids);
+  for (auto id : ids)
+  {
+    CategoryDataMap::const_iterator catIter = categoryData_.find(id);
+    if (catIter != categoryData_.end())
+      categoryValueIndex_.update(id, *catIter->second);
+  }
 
-  sliceCacheObserver_->updatePlatforms_(time);
+  // Platform slices may be refreshed in parallel; everything below depends on platform state and runs in order
+  sliceCacheObserver_->updatePlatforms_(time, updatePool_.get(), changedIds_);
   updateBeams_(time);
   updateGates_(time);
   updateLasers_(time);
   updateProjectors_(time);
   updateLobGroups_(time);
 
+  // Collect everything else that changed, for changedEntities()
+  for (const auto& idResult : results)
+    changedIds_.push_back(idResult.first);
+  changedIds_.insert(changedIds_.end(), ids.begin(), ids.end());
+  sliceCacheObserver_->takePendingChanges_(changedIds_);
+  std::sort(changedIds_.begin(), changedIds_.end());
+  changedIds_.erase(std::unique(changedIds_.begin(), changedIds_.end()), changedIds_.end());
+
   for (auto id : ids)
   {
     // send notification
@@ -2156,6 +2281,13 @@ double MemoryDataStore::updateTime() const
   return lastUpdateTime_;
 }
 
+bool MemoryDataStore::changedEntities(IdList* ids) const
+{
+  if (ids)
+    *ids = changedIds_;
+  return true;
+}
+
 int MemoryDataStore::referenceYear() const
 {
   return static_cast<int>(properties_.referenceyear());
@@ -2467,21 +2599,8 @@ void MemoryDataStore::idListForHost_(ObjectId hostid, simData::ObjectType inType
 ///Retrieves the ObjectType for a particular ID
 simData::ObjectType MemoryDataStore::objectType(ObjectId id) const
 {
-  if (platforms_.find(id) != platforms_.end())
-    return simData::PLATFORM;
-  if (beams_.find(id) != beams_.end())
-    return simData::BEAM;
-  if (gates_.find(id) != gates_.end())
-    return simData::GATE;
-  if (lasers_.find(id) != lasers_.end())
-    return simData::LASER;
-  if (projectors_.find(id) != projectors_.end())
-    return simData::PROJECTOR;
-  if (lobGroups_.find(id) != lobGroups_.end())
-    return simData::LOB_GROUP;
-  if (customRenderings_.find(id) != customRenderings_.end())
-    return simData::CUSTOM_RENDERING;
-  return simData::NONE;
+  const EntityIndex::Record* record = entityIndex_.find(id);
+  return (record != nullptr) ? record->type : simData::NONE;
 }
 
 ///Retrieves the host ID for an entity; returns 0 for platforms, or for not found
@@ -2661,14 +2780,16 @@ void MemoryDataStore::removeEntity(ObjectId id)
   // those pointers point into regions of the entity structure - not objects on the heap
   deleteFromMap(genericData_, id, false);
   deleteFromMap(categoryData_, id, false);
+  categoryValueIndex_.remove(id);
   dataTableManager().deleteTablesByOwner(id);
 
   IdList ids; // for things attached to this entity
 
   // once we've found the item in an entity-type list, we are done
 
-  Platforms::iterator pi = platforms_.find(id);
-  if (pi != platforms_.end())
+  // Removing the attached entities and notifying listeners can add or erase entities, which
+  // invalidates EntityMap iterators; the entry is looked up again before it is deleted
+  if (platforms_.find(id) != platforms_.end())
   {
     // also delete everything attached to the platform
     // we will need to send notifications and recurse on them as well...
@@ -2681,14 +2802,12 @@ void MemoryDataStore::removeEntity(ObjectId id)
     for (IdList::const_iterator i = ids.begin(); i != ids.end(); ++i)
       removeEntity(*i);
 
-    delete pi->second;
-    platforms_.erase(pi);
+    deleteFromMap(platforms_, id);
     fireOnPostRemoveEntity_(id, ot);
     return;
   }
 
-  Beams::iterator bi = beams_.find(id);
-  if (bi != beams_.end())
+  if (beams_.find(id) != beams_.end())
   {
     // also delete any gates or projectors; projectorIdListForHost adds to the list
     gateIdListForHost(id, &ids);
@@ -2697,8 +2816,7 @@ void MemoryDataStore::removeEntity(ObjectId id)
     for (IdList::const_iterator i = ids.begin(); i != ids.end(); ++i)
       removeEntity(*i);
 
-    delete bi->second;
-    beams_.erase(bi);
+    deleteFromMap(beams_, id);
     fireOnPostRemoveEntity_(id, ot);
     return;
   }
@@ -3076,54 +3194,54 @@ CustomRenderingPrefs* MemoryDataStore::mutable_customRenderingPrefs(ObjectId id,
 
 const CommonPrefs* MemoryDataStore::commonPrefs(ObjectId id, Transaction* transaction) const
 {
-  const PlatformPrefs* plat = platformPrefs(id, transaction);
-  if (plat != nullptr)
-    return &plat->commonprefs();
-  const BeamPrefs* beam = beamPrefs(id, transaction);
-  if (beam != nullptr)
-    return &beam->commonprefs();
-  const GatePrefs* gate = gatePrefs(id, transaction);
-  if (gate != nullptr)
-    return &gate->commonprefs();
-  const LaserPrefs* laser = laserPrefs(id, transaction);
-  if (laser != nullptr)
-    return &laser->commonprefs();
-  const LobGroupPrefs* lobGroup = lobGroupPrefs(id, transaction);
-  if (lobGroup != nullptr)
-    return &lobGroup->commonprefs();
-  const ProjectorPrefs* proj = projectorPrefs(id, transaction);
-  if (proj != nullptr)
-    return &proj->commonprefs();
-  const CustomRenderingPrefs* custom = customRenderingPrefs(id, transaction);
-  if (custom != nullptr)
-    return &custom->commonprefs();
+  switch (objectType(id))
+  {
+  case simData::PLATFORM:
+    return &platformPrefs(id, transaction)->commonprefs();
+  case simData::BEAM:
+    return &beamPrefs(id, transaction)->commonprefs();
+  case simData::GATE:
+    return &gatePrefs(id, transaction)->commonprefs();
+  case simData::LASER:
+    return &laserPrefs(id, transaction)->commonprefs();
+  case simData::LOB_GROUP:
+    return &lobGroupPrefs(id, transaction)->commonprefs();
+  case simData::PROJECTOR:
+    return &projectorPrefs(id, transaction)->commonprefs();
+  case simData::CUSTOM_RENDERING:
+    return &customRenderingPrefs(id, transaction)->commonprefs();
+  case simData::NONE:
+  case simData::ALL:
+    break;
+  }
 
+  assert(transaction);
+  *transaction = Transaction(new NullTransactionImpl());
   return nullptr;
 }
 
 CommonPrefs* MemoryDataStore::mutable_commonPrefs(ObjectId id, Transaction* transaction)
 {
-  PlatformPrefs* plat = mutable_platformPrefs(id, transaction);
-  if (plat != nullptr)
-    return plat->mutable_commonprefs();
-  BeamPrefs* beam = mutable_beamPrefs(id, transaction);
-  if (beam != nullptr)
-    return beam->mutable_commonprefs();
-  GatePrefs* gate = mutable_gatePrefs(id, transaction);
-  if (gate != nullptr)
-    return gate->mutable_commonprefs();
-  LaserPrefs* laser = mutable_laserPrefs(id, transaction);
-  if (laser != nullptr)
-    return laser->mutable_commonprefs();
-  LobGroupPrefs* lobGroup = mutable_lobGroupPrefs(id, transaction);
-  if (lobGroup != nullptr)
-    return lobGroup->mutable_commonprefs();
-  ProjectorPrefs* proj = mutable_projectorPrefs(id, transaction);
-  if (proj != nullptr)
-    return proj->mutable_commonprefs();
-  CustomRenderingPrefs* custom = mutable_customRenderingPrefs(id, transaction);
-  if (custom != nullptr)
-    return custom->mutable_commonprefs();
+  switch (objectType(id))
+  {
+  case simData::PLATFORM:
+    return mutable_platformPrefs(id, transaction)->mutable_commonprefs();
+  case simData::BEAM:
+    return mutable_beamPrefs(id, transaction)->mutable_commonprefs();
+  case simData::GATE:
+    return mutable_gatePrefs(id, transaction)->mutable_commonprefs();
+  case simData::LASER:
+    return mutable_laserPrefs(id, transaction)->mutable_commonprefs();
+  case simData::LOB_GROUP:
+    return mutable_lobGroupPrefs(id, transaction)->mutable_commonprefs();
+  case simData::PROJECTOR:
+    return mutable_projectorPrefs(id, transaction)->mutable_commonprefs();
+  case simData::CUSTOM_RENDERING:
+    return mutable_customRenderingPrefs(id, transaction)->mutable_commonprefs();
+  case simData::NONE:
+  case simData::ALL:
+    break;
+  }
   return nullptr;
 }
 
@@ -3147,6 +3265,32 @@ PlatformUpdate* MemoryDataStore::addPlatformUpdate(ObjectId id, Transaction *tra
   return update;
 }
 
+int MemoryDataStore::addPlatformUpdates(ObjectId id, const PlatformUpdate* updates, size_t count)
+{
+  PlatformEntry *entry = getEntry<PlatformEntry, Platforms>(id, &platforms_);
+  if (!entry)
+    return 1;
+  if (count == 0)
+    return 0;
+
+  for (size_t k = 1; k < count; ++k)
+  {
+    if (updates[k].time() < updates[k - 1].time())
+      return 1;
+  }
+
+  MemoryDataSlice<PlatformUpdate> *slice = entry->updates();
+  slice->insertSorted(updates, count);
+  if (dataLimiting())
+    slice->limitByPrefs(entry->preferences()->commonprefs());
+  hasChanged_ = true;
+
+  // One notification for the whole batch
+  for (const auto& listenerPtr : newUpdatesListeners_)
+    listenerPtr->onEntityUpdates(this, id, updates[0].time(), updates[count - 1].time());
+  return 0;
+}
+
 ///@return nullptr if platform for specified 'id' does not exist
 PlatformCommand *MemoryDataStore::addPlatformCommand(ObjectId id, Transaction *transaction)
 {
@@ -3659,6 +3803,11 @@ CategoryNameManager& MemoryDataStore::categoryNameManager() const
   return *categoryNameManager_;
 }
 
+const CategoryValueIndex& MemoryDataStore::categoryValueIndex() const
+{
+  return categoryValueIndex_;
+}
+
 DataTableManager& MemoryDataStore::dataTableManager() const
 {
   return *dataTableManager_;
@@ -3678,9 +3827,9 @@ void MemoryDataStore::deleteEntries_(EntryMapType *entries)
 }
 
 template <typename EntryMapType>
-void MemoryDataStore::dataLimit_(std::map<ObjectId, EntryMapType* >& entryMap, ObjectId id, const CommonPrefs* prefs)
+void MemoryDataStore::dataLimit_(EntityMap<EntryMapType*>& entryMap, ObjectId id, const CommonPrefs* prefs)
 {
-  typename std::map<ObjectId, EntryMapType *>::const_iterator iter = entryMap.find(id);
+  typename EntityMap<EntryMapType*>::const_iterator iter = entryMap.find(id);
   if (iter == entryMap.end())
     return;
   // limit updates and commands
@@ -3920,7 +4069,7 @@ void MemoryDataStore::NewEntryTransactionImpl<T, P>::commit()
     P* mutablePrefs = entry_->mutable_preferences();
     mutablePrefs->CopyFrom(*defaultPrefs_);
 
-    typename std::map<ObjectId, T*>::iterator i = entries_->find(entry_->properties()->id());
+    typename EntityMap<T*>::iterator i = entries_->find(entry_->properties()->id());
     if (i == entries_->end())
       (*entries_)[entry_->properties()->id()] = entry_;
     else
@@ -24,11 +24,14 @@
 #define SIMDATA_MEMORYDATASTORE_H
 
 #include <map>
+#include <memory>
 #include <string>
 #include "simData/MemoryDataEntry.h"
 #include "simData/DataStore.h"
+#include "simData/CategoryData/CategoryValueIndex.h"
+#include "simData/EntityIndex.h"
 
-namespace simCore { class Clock; }
+namespace simCore { class Clock; class ThreadPool; }
 
 namespace simData {
 
@@ -63,6 +66,9 @@ public:
   /// returns the last value sent to update(double), relative to current reference year
   virtual double updateTime() const override;
 
+  /// retrieves the IDs of entities that may have changed in the most recent update
+  virtual bool changedEntities(IdList* ids) const override;
+
   /// data store reference year (without transaction cost); intended to be cached locally for performance.
   virtual int referenceYear() const override;
 
@@ -126,6 +132,25 @@ public:
   /// Returns the interpolation state
   virtual InterpolatorState interpolatorState() const override;
 
+  /**@name Parallel update
+   *@{
+   */
+  /**
+   * Sets the number of threads used by update(double) to refresh platform slices.  A value of 1,
+   * the default, updates everything on the calling thread.  A value of 0 uses the hardware
+   * concurrency.  With more than one thread, platform slices are split across a worker pool;
+   * beams, gates and other entities that depend on platform state are then updated on the
+   * calling thread, and listeners are always notified on the calling thread in the same order
+   * as a single threaded update.
+   * @note While enabled, an external Interpolator may be called concurrently for different platforms.
+   * @param numThreads Total number of threads, including the calling thread
+   */
+  void setUpdateThreadCount(unsigned int numThreads);
+
+  /// Returns the number of threads used by update(double) for platform slices, including the calling thread
+  unsigned int updateThreadCount() const;
+  ///@}
+
   /**@name ID Lists
    * @{
    */
@@ -267,6 +292,7 @@ public:
    * @{
    */
   virtual PlatformUpdate *addPlatformUpdate(ObjectId id, Transaction *transaction) override;
+  virtual int addPlatformUpdates(ObjectId id, const PlatformUpdate* updates, size_t count) override;
   virtual BeamUpdate *addBeamUpdate(ObjectId id, Transaction *transaction) override;
   virtual BeamCommand *addBeamCommand(ObjectId id, Transaction *transaction) override;
   virtual GateUpdate  *addGateUpdate(ObjectId id, Transaction *transaction) override;
@@ -351,6 +377,9 @@ public:
   virtual CategoryNameManager& categoryNameManager() const override;
   ///@}
 
+  /// Retrieves the inverted index of current category data
+  virtual const CategoryValueIndex& categoryValueIndex() const override;
+
   /**
    * Retrieves a reference to the data table manager associated with this data store.
    * The data table manager can be used to create data tables associated with entities,
@@ -375,7 +404,7 @@ private:
   void applyDataLimiting_(ObjectId id);
 
   template <typename EntryMapType>
-  void dataLimit_(std::map<ObjectId, EntryMapType*>& entryMap, ObjectId id, const CommonPrefs* prefs);
+  void dataLimit_(EntityMap<EntryMapType*>& entryMap, ObjectId id, const CommonPrefs* prefs);
   ///@}
 
   /// Execute the onPostRemoveEntity callback
@@ -408,23 +437,23 @@ public:
   typedef MemoryDataEntry<CustomRenderingProperties,       CustomRenderingPrefs,       MemoryDataSlice<CustomRenderingUpdate>,       MemoryCommandSlice<CustomRenderingCommand, CustomRenderingPrefs> >     CustomRenderingEntry;
 
   /// Map of entity IDs to platform entries
-  typedef std::map<ObjectId, PlatformEntry*>           Platforms;
+  typedef EntityMap<PlatformEntry*>           Platforms;
   /// Map of entity IDs to beam entries
-  typedef std::map<ObjectId, BeamEntry*>               Beams;
+  typedef EntityMap<BeamEntry*>               Beams;
   /// Map of entity IDs to gate entries
-  typedef std::map<ObjectId, GateEntry*>               Gates;
+  typedef EntityMap<GateEntry*>               Gates;
   /// Map of entity IDs to laser entries
-  typedef std::map<ObjectId, LaserEntry*>              Lasers;
+  typedef EntityMap<LaserEntry*>              Lasers;
   /// Map of entity IDs to projector entries
-  typedef std::map<ObjectId, ProjectorEntry*>          Projectors;
+  typedef EntityMap<ProjectorEntry*>          Projectors;
   /// Map of entity IDs to LOB Group entries
-  typedef std::map<ObjectId, LobGroupEntry*>           LobGroups;
+  typedef EntityMap<LobGroupEntry*>           LobGroups;
   /// Map of entity IDs to custom entries
-  typedef std::map<ObjectId, CustomRenderingEntry*>    CustomRenderings;
+  typedef EntityMap<CustomRenderingEntry*>    CustomRenderings;
   /// Map of entity IDs to generic data entries
-  typedef std::map<ObjectId, MemoryGenericDataSlice*>  GenericDataMap;
+  typedef EntityMap<MemoryGenericDataSlice*>  GenericDataMap;
   /// Map of entity IDs to category data entries
-  typedef std::map<ObjectId, MemoryCategoryDataSlice*> CategoryDataMap;
+  typedef EntityMap<MemoryCategoryDataSlice*> CategoryDataMap;
 
 
 private:
@@ -546,7 +575,7 @@ private:
   class NewEntryTransactionImpl : public TransactionImpl
   {
   public:
-    NewEntryTransactionImpl(T *entry, std::map<ObjectId, T *> *entries, MemoryDataStore *store, ListenerList *listeners, const P *defaultPrefs, uint64_t initialId)
+    NewEntryTransactionImpl(T *entry, EntityMap<T *> *entries, MemoryDataStore *store, ListenerList *listeners, const P *defaultPrefs, uint64_t initialId)
       : committed_(false),
         notified_(false),
         entry_(entry),
@@ -573,7 +602,7 @@ private:
     bool committed_;                              // The entry has been added to the data structure
     bool notified_;                               // Observers have been notified for the new entry's commit
     T *entry_;                                    // Type such as PlatformEntry, BeamEntry, GateEntry, LaserEntry, ProjectorEntry, LobGroupEntry
-    std::map<ObjectId, T *> *entries_;            // Matches Platforms, Beams, Gates, Lasers, Projectors, or LobGroups internal typedef
+    EntityMap<T *> *entries_;                     // Matches Platforms, Beams, Gates, Lasers, Projectors, or LobGroups internal typedef
     MemoryDataStore *store_;                      // Data store which will receive the new entity on commit
     ListenerList *listeners_;                     // Listeners from the data store which need to be notified
     const P *defaultPrefs_;                       // Default prefs values for initializing prefs on entity creation
@@ -709,6 +738,7 @@ private:
   ObjectId baseId_;          // Used for unique ID generation
   double   lastUpdateTime_;  // Last time sent to update(double)
   bool     hasChanged_; // has something changed since last update
+  IdList   changedIds_; // Entities that may have changed in the last update(double)
 
   // interpolation
   InterpolatorState interpolationEnabled_ = InterpolatorState::OFF;
@@ -716,6 +746,7 @@ private:
 
   // all the data
   ScenarioProperties properties_;
+  EntityIndex        entityIndex_;  // Type and storage slot of every entity, shared by the entity maps below
   Platforms          platforms_;
   Beams              beams_;
   Gates              gates_;
@@ -725,6 +756,7 @@ private:
   CustomRenderings   customRenderings_;
   GenericDataMap     genericData_;  // Map to hold references for GenericData update slice contained by the DataEntry object with the associated id
   CategoryDataMap    categoryData_; // Map to hold references for CategoryData update slice contained by the DataEntry object with the associated id
+  CategoryValueIndex categoryValueIndex_; // Current category values of all entities, updated from categoryData_ in update()
 
   /// To improve performance keep track of children entities by host
   class HostChildCache;
@@ -791,6 +823,9 @@ private:
   /// Improve performance by caching the slice state
   std::shared_ptr<SliceCacheObserver> sliceCacheObserver_;
 
+  /// Worker pool for the platform slice updates; nullptr when updating on the calling thread only
+  std::unique_ptr<simCore::ThreadPool> updatePool_;
+
   /// Links together the TableManager::NewRowDataListener to our newUpdatesListener_
   std::shared_ptr<NewRowDataToNewUpdatesAdapter> newRowDataListener_;
 
@@ -0,0 +1,257 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDATA_MEMORYTABLE_CHUNKEDARRAY_H
+#define SIMDATA_MEMORYTABLE_CHUNKEDARRAY_H
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <deque>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+
+namespace simData { namespace MemoryTable {
+
+/**
+ * Array of values stored in fixed size chunks.  Like std::deque, appending and removing from the
+ * front are constant time, but unlike std::deque the chunk boundaries are known, so that callers
+ * can read contiguous runs of values through run().  Chunks hold about 4 KB of values.  Only
+ * stored values are constructed, and the first chunk starts small and doubles until it reaches
+ * full size, so that tables with many columns and few rows stay small.  Values move only while
+ * the first chunk grows.
+ */
+template <typename T>
+class ChunkedArray
+{
+public:
+  /// Number of values in each full chunk
+  static constexpr size_t CHUNK_SIZE = std::max<size_t>(16, std::bit_floor(4096 / sizeof(T)));
+  /// Number of values in the first chunk when it is allocated
+  static constexpr size_t INITIAL_CAPACITY = 4;
+
+  ChunkedArray() {}
+  ChunkedArray(const ChunkedArray& rhs)
+  {
+    for (size_t k = 0; k < rhs.size_; ++k)
+      push_back(rhs[k]);
+  }
+  ChunkedArray(ChunkedArray&& rhs) noexcept
+    : chunks_(std::move(rhs.chunks_)),
+      firstCapacity_(std::exchange(rhs.firstCapacity_, 0)),
+      front_(std::exchange(rhs.front_, 0)),
+      size_(std::exchange(rhs.size_, 0))
+  {
+    rhs.chunks_.clear();
+  }
+  ChunkedArray& operator=(ChunkedArray rhs) noexcept
+  {
+    std::swap(chunks_, rhs.chunks_);
+    std::swap(firstCapacity_, rhs.firstCapacity_);
+    std::swap(front_, rhs.front_);
+    std::swap(size_, rhs.size_);
+    return *this;
+  }
+  ~ChunkedArray() { clear(); }
+
+  /** Number of values in the array */
+  size_t size() const { return size_; }
+  /** True if the array holds no values */
+  bool empty() const { return size_ == 0; }
+  /** Number of values the allocated chunks can hold, including the unused space before the first value */
+  size_t capacity() const { return chunks_.empty() ? 0 : firstCapacity_ + (chunks_.size() - 1) * CHUNK_SIZE; }
+
+  /** Accesses the value at the given position, which must be less than size() */
+  T& operator[](size_t position)
+  {
+    assert(position < size_);
+    return *address_(front_ + position);
+  }
+  /** Accesses the value at the given position, which must be less than size() */
+  const T& operator[](size_t position) const
+  {
+    assert(position < size_);
+    return *address_(front_ + position);
+  }
+
+  /**
+   * Returns the contiguous values starting at position, up to count values.  The run ends early at
+   * a chunk boundary; call again from the end of the returned run to continue.
+   */
+  std::span<const T> run(size_t position, size_t count) const
+  {
+    if (position >= size_)
+      return std::span<const T>();
+    const size_t index = front_ + position;
+    const size_t length = std::min({ count, size_ - position, CHUNK_SIZE - index % CHUNK_SIZE });
+    return std::span<const T>(address_(index), length);
+  }
+
+  /** Appends a value */
+  void push_back(const T& value) { emplaceBack_(value); }
+  /** Appends a value */
+  void push_back(T&& value) { emplaceBack_(std::move(value)); }
+
+  /** Inserts a value before the given position; appends if position is at or past the end */
+  void insert(size_t position, const T& value)
+  {
+    push_back(value);
+    if (position >= size_ - 1)
+      return;
+    // Shift later values back by one; values are normally appended, so this is rare
+    for (size_t k = size_ - 1; k > position; --k)
+      std::swap((*this)[k], (*this)[k - 1]);
+  }
+
+  /** Removes the given number of values, starting at position */
+  void erase(size_t position, size_t number = 1)
+  {
+    if (position >= size_)
+      return;
+    number = std::min(number, size_ - position);
+    if (position == 0)
+    {
+      popFront_(number);
+      return;
+    }
+    // Shift later values forward, then destroy the values left at the end
+    for (size_t k = position; k + number < size_; ++k)
+      (*this)[k] = std::move((*this)[k + number]);
+    for (size_t k = size_ - number; k < size_; ++k)
+      std::destroy_at(&(*this)[k]);
+    size_ -= number;
+    // Release trailing chunks that no longer hold values
+    while (chunks_.size() > 1 && (front_ + size_) <= (chunks_.size() - 1) * CHUNK_SIZE)
+    {
+      deallocate_(chunks_.back(), CHUNK_SIZE);
+      chunks_.pop_back();
+    }
+  }
+
+  /** Removes the first value */
+  void pop_front()
+  {
+    if (size_ > 0)
+      popFront_(1);
+  }
+
+  /** Removes all values and releases all chunks */
+  void clear()
+  {
+    for (size_t k = 0; k < size_; ++k)
+      std::destroy_at(&(*this)[k]);
+    for (size_t k = 0; k < chunks_.size(); ++k)
+      deallocate_(chunks_[k], (k == 0) ? firstCapacity_ : CHUNK_SIZE);
+    chunks_.clear();
+    firstCapacity_ = 0;
+    front_ = 0;
+    size_ = 0;
+  }
+
+private:
+  /** Returns the address of the value at the given index from the start of the first chunk */
+  T* address_(size_t index) const
+  {
+    return chunks_[index / CHUNK_SIZE] + index % CHUNK_SIZE;
+  }
+
+  /** Constructs a value at the end of the array */
+  template <typename V>
+  void emplaceBack_(V&& value)
+  {
+    if (front_ + size_ < capacity())
+    {
+      ::new (static_cast<void*>(address_(front_ + size_))) T(std::forward<V>(value));
+      ++size_;
+      return;
+    }
+    // Growing the first chunk moves values, and value might be one of them
+    T local(std::forward<V>(value));
+    grow_();
+    ::new (static_cast<void*>(address_(front_ + size_))) T(std::move(local));
+    ++size_;
+  }
+
+  /** Adds room for at least one more value at the end */
+  void grow_()
+  {
+    if (chunks_.empty())
+    {
+      chunks_.push_back(allocate_(INITIAL_CAPACITY));
+      firstCapacity_ = INITIAL_CAPACITY;
+      return;
+    }
+    if (firstCapacity_ == CHUNK_SIZE)
+    {
+      chunks_.push_back(allocate_(CHUNK_SIZE));
+      return;
+    }
+    // Only the first chunk exists; move its values to the start of a larger one
+    const size_t newCapacity = std::min(2 * firstCapacity_, CHUNK_SIZE);
+    T* oldChunk = chunks_.front();
+    T* newChunk = allocate_(newCapacity);
+    for (size_t k = 0; k < size_; ++k)
+    {
+      ::new (static_cast<void*>(newChunk + k)) T(std::move(oldChunk[front_ + k]));
+      std::destroy_at(oldChunk + front_ + k);
+    }
+    deallocate_(oldChunk, firstCapacity_);
+    chunks_.front() = newChunk;
+    firstCapacity_ = newCapacity;
+    front_ = 0;
+  }
+
+  /** Removes number values from the front, which must not exceed size() */
+  void popFront_(size_t number)
+  {
+    for (size_t k = 0; k < number; ++k)
+      std::destroy_at(&(*this)[k]);
+    front_ += number;
+    size_ -= number;
+    // Only full size chunks can be passed over, since a smaller first chunk is the only chunk
+    while (front_ >= CHUNK_SIZE)
+    {
+      deallocate_(chunks_.front(), CHUNK_SIZE);
+      chunks_.pop_front();
+      front_ -= CHUNK_SIZE;
+    }
+    if (size_ == 0)
+      clear();
+  }
+
+  static T* allocate_(size_t capacity) { return std::allocator<T>().allocate(capacity); }
+  static void deallocate_(T* chunk, size_t capacity) { std::allocator<T>().deallocate(chunk, capacity); }
+
+  /// Raw storage; values are constructed only in positions [front_, front_ + size_)
+  std::deque<T*> chunks_;
+  /// Capacity of the first chunk; less than CHUNK_SIZE only while it is the only chunk
+  size_t firstCapacity_ = 0;
+  /// Offset of the first value in the first chunk
+  size_t front_ = 0;
+  size_t size_ = 0;
+};
+
+} }
+
+#endif /* SIMDATA_MEMORYTABLE_CHUNKEDARRAY_H */
@@ -20,11 +20,12 @@
  * disclose, or release this software.
  *
  */
-#include <deque>
 #include <cassert>
+#include <limits>
 #include "simCore/Calc/Interpolation.h"
 #include "simData/DataTable.h"
 #include "simData/TableCellTranslator.h"
+#include "simData/MemoryTable/ChunkedArray.h"
 #include "simData/MemoryTable/DataColumn.h"
 
 namespace simData { namespace MemoryTable {
@@ -227,14 +228,8 @@ public:
   /** Removes the entries starting at the given index */
   virtual void erase(size_t position, size_t number = 1)
   {
-    if (position < size())
-    {
-      // Performance optimization (SIMSDK-260): pop_front() when able
-      if ((position == 0) && (number == 1))
-        data_.pop_front();
-      else
-        data_.erase(data_.begin() + position, data_.begin() + position + number);
-    }
+    // Removal from the front is constant time (SIMSDK-260)
+    data_.erase(position, number);
   }
   /** Total size of the data structure */
   virtual size_t size() const { return data_.size(); }
@@ -242,25 +237,38 @@ public:
   virtual bool empty() const { return data_.empty(); }
   /** Removes all items from container */
   virtual void clear() { data_.clear(); }
+  /** Rearranges the items so that the item at position k moves from position sourcePositions[k] */
+  virtual void reorder(const std::vector<size_t>& sourcePositions)
+  {
+    // Assertion failure means the time container and data container are out of sync
+    assert(sourcePositions.size() == data_.size());
+    if (sourcePositions.size() != data_.size())
+      return;
+    ChunkedArray<T> reordered;
+    for (size_t source : sourcePositions)
+      reordered.push_back(std::move(data_[source]));
+    data_ = std::move(reordered);
+  }
+
+  /** Returns up to count contiguous values starting at position; may end early at a chunk boundary */
+  std::span<const T> run(size_t position, size_t count) const { return data_.run(position, count); }
 
 private:
   /**
-   * All data is stored in a deque.  Deque chosen for faster insertion
-   * (due to no need to double size on add, relative to vector), and faster
-   * removal (due to no need to shift all items every time).
+   * All data is stored in a chunked array.  Like a deque, it has fast insertion
+   * (due to no need to double size on add, relative to vector), and fast
+   * removal (due to no need to shift all items every time), and it also
+   * exposes contiguous runs of values for bulk access.
    */
-  typename std::deque<T> data_;
+  ChunkedArray<T> data_;
 
   /// Template implementation of insertion at position
   template <typename DataType>
   void insert_(size_t position, const DataType& value)
   {
-    typename std::deque<T>::iterator pos = data_.end();
-    if (position < size())
-      pos = data_.begin() + position;
     T localValue;
     TableCellTranslator::cast(value, localValue);
-    data_.insert(pos, localValue);
+    data_.insert(position, localValue);
   }
 
   /// Template implementation of replacement at position
@@ -269,7 +277,7 @@ private:
   {
     if (position >= size())
       return TableStatus::Error("Column replacement: invalid index.");
-    TableCellTranslator::cast(value, *(data_.begin() + position));
+    TableCellTranslator::cast(value, data_[position]);
     return TableStatus::Success();
   }
 
@@ -279,13 +287,59 @@ private:
   {
     if (position >= size())
       return TableStatus::Error("Column getValue: invalid index.");
-    TableCellTranslator::cast(*(data_.begin() + position), value);
+    TableCellTranslator::cast(data_[position], value);
     return TableStatus::Success();
   }
 };
 
 /////////////////////////////////////////////////////////////////
 
+namespace {
+
+/**
+ * Visits the values for the given time entries in runs.  Entries that are adjacent in time and
+ * adjacent in the same data container are passed to the visitor together.  Data containers must
+ * be of type DataContainerT<T>.
+ */
+template <typename T>
+void visitRuns(const std::vector<TimeContainer::IteratorData>& entries, const DataContainer* freshData,
+  const DataContainer* staleData, TableColumn::RunVisitor& visitor)
+{
+  const DataContainerT<T>* fresh = static_cast<const DataContainerT<T>*>(freshData);
+  const DataContainerT<T>* stale = static_cast<const DataContainerT<T>*>(staleData);
+  std::vector<double> times;
+  size_t begin = 0;
+  while (begin < entries.size())
+  {
+    // Find the end of the run of consecutive indices in the same container
+    const bool isFresh = entries[begin].isFreshBin();
+    const size_t firstIndex = entries[begin].index();
+    size_t end = begin + 1;
+    while (end < entries.size() && entries[end].isFreshBin() == isFresh && entries[end].index() == firstIndex + (end - begin))
+      ++end;
+
+    // Storage may split the run at chunk boundaries
+    const DataContainerT<T>* data = isFresh ? fresh : stale;
+    while (begin < end)
+    {
+      const std::span<const T> values = data->run(entries[begin].index(), end - begin);
+      // Assertion failure means the time container and data container are out of sync
+      assert(!values.empty());
+      if (values.empty())
+        return;
+      times.clear();
+      for (size_t k = 0; k < values.size(); ++k)
+        times.push_back(entries[begin + k].time());
+      visitor.visit(std::span<const double>(times), values);
+      begin += values.size();
+    }
+  }
+}
+
+}
+
+/////////////////////////////////////////////////////////////////
+
 /** Instantiates a new data column. */
 DataColumn::DataColumn(TimeContainer* timeContainer, const std::string& columnName, TableId tableId, TableColumnId columnId, VariableType storageType, UnitType unitType)
   : timeContainer_(timeContainer),
@@ -320,6 +374,11 @@ void DataColumn::erase(bool freshContainer, size_t position, size_t number)
   dataContainer_(freshContainer)->erase(position, number);
 }
 
+void DataColumn::reorder(bool freshContainer, const std::vector<size_t>& sourcePositions)
+{
+  dataContainer_(freshContainer)->reorder(sourcePositions);
+}
+
 size_t DataColumn::size() const
 {
   return freshData_->size() + staleData_->size();
@@ -396,32 +455,32 @@ TableStatus DataColumn::interpolate(double& value, double time, const Interpolat
 {
   if (timeContainer_->empty())
     return TableStatus::Error("No data.");
-  TimeContainer::Iterator lowerBound = timeContainer_->lower_bound(time);
-  if (!lowerBound.hasNext()) // Past the end?
+  const double INVALID_TIME = std::numeric_limits<double>::max();
+  TimeContainer::IteratorData before(INVALID_TIME, 0, true);
+  TimeContainer::IteratorData atOrAfter(INVALID_TIME, 0, true);
+  timeContainer_->bracket(time, before, atOrAfter);
+  if (atOrAfter.time() == INVALID_TIME) // Past the end?
   {
     // Assertion failure means either time container empty() (returned above), or logic error in time container
-    assert(lowerBound.hasPrevious());
-    TimeContainer::IteratorData prev = lowerBound.previous();
-    return getValue(prev.isFreshBin(), prev.index(), value);
+    assert(before.time() != INVALID_TIME);
+    return getValue(before.isFreshBin(), before.index(), value);
   }
 
   // Does the time match exactly?
-  TimeContainer::IteratorData atOrAfter(lowerBound.peekNext());
   if (atOrAfter.time() == time)
   {
     // Exact match
     return getValue(atOrAfter.isFreshBin(), atOrAfter.index(), value);
   }
-  // Assertion failure means this algorithm has a logic error in lower_bound usage
+  // Assertion failure means this algorithm has a logic error in bracket() usage
   assert(atOrAfter.time() > time);
 
-  if (!lowerBound.hasPrevious())
+  if (before.time() == INVALID_TIME)
   {
     // "time" is before the start time of the container; no extrapolation
     getValue(atOrAfter.isFreshBin(), atOrAfter.index(), value); // still return a valid value though
     return TableStatus::Error("Requested time before start of container.");
   }
-  TimeContainer::IteratorData before(lowerBound.previous());
   // Assertion failure means iterators are accessing out of order, or internal logic error
   assert(before.time() < atOrAfter.time());
 
@@ -489,6 +548,29 @@ TableColumn::Iterator DataColumn::findAtOrBeforeTime(double timeValue) const
   return Iterator(new ColumnIteratorImpl(freshData_, staleData_, timeContainer_->findTimeAtOrBeforeGivenTime(timeValue)));
 }
 
+void DataColumn::accept(double beginTime, double endTime, RunVisitor& visitor) const
+{
+  std::vector<TimeContainer::IteratorData> entries;
+  timeContainer_->getRange(beginTime, endTime, entries);
+  if (entries.empty())
+    return;
+
+  switch (variableType_)
+  {
+  case VT_UINT8: visitRuns<uint8_t>(entries, freshData_, staleData_, visitor); break;
+  case VT_INT8: visitRuns<int8_t>(entries, freshData_, staleData_, visitor); break;
+  case VT_UINT16: visitRuns<uint16_t>(entries, freshData_, staleData_, visitor); break;
+  case VT_INT16: visitRuns<int16_t>(entries, freshData_, staleData_, visitor); break;
+  case VT_UINT32: visitRuns<uint32_t>(entries, freshData_, staleData_, visitor); break;
+  case VT_INT32: visitRuns<int32_t>(entries, freshData_, staleData_, visitor); break;
+  case VT_UINT64: visitRuns<uint64_t>(entries, freshData_, staleData_, visitor); break;
+  case VT_INT64: visitRuns<int64_t>(entries, freshData_, staleData_, visitor); break;
+  case VT_FLOAT: visitRuns<float>(entries, freshData_, staleData_, visitor); break;
+  case VT_DOUBLE: visitRuns<double>(entries, freshData_, staleData_, visitor); break;
+  case VT_STRING: visitRuns<std::string>(entries, freshData_, staleData_, visitor); break;
+  }
+}
+
 DataContainer* DataColumn::newDataContainer_(simData::VariableType variableType) const
 {
   switch (variableType)
@@ -33,8 +33,8 @@ namespace simData { namespace MemoryTable {
 /**
  * Implementation of the table column.  Private inside the .cpp to prevent others from
  * accessing the internal public functions that aren't in the virtual interface.
- * This implementation holds onto data in a deque and lets the time container dictate
- * where values ought to be placed inside the deque.
+ * This implementation holds onto data in a chunked array and lets the time container dictate
+ * where values ought to be placed inside the array.
  */
 class DataColumn : public simData::TableColumn
 {
@@ -67,6 +67,8 @@ public:
 
   /** Removes entries from the data column based on position */
   void erase(bool freshContainer, size_t position, size_t number = 1);
+  /** Rearranges entries in a data container; see DataContainer::reorder() */
+  void reorder(bool freshContainer, const std::vector<size_t>& sourcePositions);
   /** Clears out the contents of the data container */
   simData::DelayedFlushContainerPtr flush();
   /** Retrieves the number of entries in the data column */
@@ -117,6 +119,9 @@ public:
    */
   virtual Iterator findAtOrBeforeTime(double timeValue) const;
 
+  /** Visits contiguous runs of values from beginTime (inclusive) until endTime (exclusive). */
+  virtual void accept(double beginTime, double endTime, RunVisitor& visitor) const;
+
   /// Fixes the time container, i.e. after a split.  Responsibility of SubTable to keep up to date
   void replaceTimeContainer(TimeContainer* newTimes);
 
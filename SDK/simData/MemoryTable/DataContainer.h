@@ -95,6 +95,11 @@ public:
   virtual bool empty() const = 0;
   /** Removes all items in the data container */
   virtual void clear() = 0;
+  /**
+   * Rearranges the items so that the item at position k moves from position sourcePositions[k].
+   * @param sourcePositions Permutation of [0, size()); no-op if the sizes do not match
+   */
+  virtual void reorder(const std::vector<size_t>& sourcePositions) = 0;
 };
 
 }}
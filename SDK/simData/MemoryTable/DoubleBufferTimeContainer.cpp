@@ -37,6 +37,9 @@ static const size_t BIN_STALE = 0;
 static const size_t BIN_FRESH = 1;
 static const size_t BIN_INVALID = 2; // invalid value for bins
 
+/// Number of deque entries per sample in the lookup index
+static const size_t SAMPLE_STRIDE = 32;
+
 /**
  * Comparison operator for lower_bound() and upper_bound operations.  Extra operations
  * added to permit pair-to-pair, double-to-pair, pair-to-double, and double-to-double
@@ -427,6 +430,8 @@ DoubleBufferTimeContainer::DoubleBufferTimeContainer(const DoubleBufferTimeConta
     times_[BIN_FRESH] = &timesA_;
     times_[BIN_STALE] = &timesB_;
   }
+  rebuildSamples_(timesA_);
+  rebuildSamples_(timesB_);
 }
 
 DoubleBufferTimeContainer::~DoubleBufferTimeContainer()
@@ -573,14 +578,92 @@ TimeContainer::Iterator DoubleBufferTimeContainer::findOrAddTime(double timeValu
   // performance testing, and to test the validity of iterator crossing containers
   //if (size() % 2 == 0)
   //  return newIterator_(BIN_STALE, staleDeq.insert(iterStale, itemToInsert), iterFresh);
-  return newIterator_(BIN_FRESH, iterStale, freshDeq.insert(iterFresh, itemToInsert));
+  const bool append = (iterFresh == freshDeq.end());
+  iterFresh = freshDeq.insert(iterFresh, itemToInsert);
+  // Appends leave the sampled positions unchanged
+  if (append)
+    extendSamples_(freshDeq);
+  else
+    rebuildSamples_(freshDeq);
+  return newIterator_(BIN_FRESH, iterStale, iterFresh);
+}
+
+void DoubleBufferTimeContainer::getRange(double beginTime, double endTime, std::vector<IteratorData>& entries) const
+{
+  entries.clear();
+  if (!(beginTime < endTime))
+    return;
+  TimeIndexDeque& staleDeq = staleTimes_();
+  TimeIndexDeque& freshDeq = freshTimes_();
+  LessThan lessThan;
+  TimeIndexDeque::const_iterator staleIter = std::lower_bound(staleDeq.cbegin(), staleDeq.cend(), beginTime, lessThan);
+  TimeIndexDeque::const_iterator staleEnd = std::lower_bound(staleIter, staleDeq.cend(), endTime, lessThan);
+  TimeIndexDeque::const_iterator freshIter = std::lower_bound(freshDeq.cbegin(), freshDeq.cend(), beginTime, lessThan);
+  TimeIndexDeque::const_iterator freshEnd = std::lower_bound(freshIter, freshDeq.cend(), endTime, lessThan);
+  entries.reserve((staleEnd - staleIter) + (freshEnd - freshIter));
+
+  // Merge the two bins by time; stale entries come first on equal times, matching the iterator
+  while (staleIter != staleEnd && freshIter != freshEnd)
+  {
+    if (freshIter->first < staleIter->first)
+      entries.push_back(IteratorData(*freshIter++, true));
+    else
+      entries.push_back(IteratorData(*staleIter++, false));
+  }
+  for (; staleIter != staleEnd; ++staleIter)
+    entries.push_back(IteratorData(*staleIter, false));
+  for (; freshIter != freshEnd; ++freshIter)
+    entries.push_back(IteratorData(*freshIter, true));
+}
+
+void DoubleBufferTimeContainer::bracket(double timeValue, IteratorData& before, IteratorData& atOrAfter)
+{
+  before = DoubleBufferIterator::INVALID_VALUE;
+  atOrAfter = DoubleBufferIterator::INVALID_VALUE;
+  // Fresh bin is searched second, so that it wins ties like in lower_bound()
+  for (size_t bin : { BIN_STALE, BIN_FRESH })
+  {
+    TimeIndexDeque& deq = *times_[bin];
+    TimeIndexDeque::iterator i = lowerBound_(deq, timeValue);
+    if (i != deq.end() && i->first <= atOrAfter.time())
+      atOrAfter = IteratorData(*i, bin == BIN_FRESH);
+    if (i == deq.begin())
+      continue;
+    --i;
+    if (before.time() == DoubleBufferIterator::INVALID_VALUE.time() || i->first > before.time())
+      before = IteratorData(*i, bin == BIN_FRESH);
+  }
+}
+
+void DoubleBufferTimeContainer::compact(const std::vector<DataColumn*>& columns)
+{
+  TimeIndexDeque& staleDeq = staleTimes_();
+  size_t position = 0;
+  while (position < staleDeq.size() && staleDeq[position].second == position)
+    ++position;
+  // Already stored in time order
+  if (position == staleDeq.size())
+    return;
+
+  std::vector<size_t> sourcePositions;
+  sourcePositions.reserve(staleDeq.size());
+  for (const auto& timeIndex : staleDeq)
+    sourcePositions.push_back(timeIndex.second);
+  for (auto* column : columns)
+    column->reorder(false, sourcePositions);
+  for (size_t k = 0; k < staleDeq.size(); ++k)
+    staleDeq[k].second = k;
 }
 
 void DoubleBufferTimeContainer::erase(TimeContainer::Iterator iter, TimeContainer::EraseBehavior eraseBehavior)
 {
   DoubleBufferIterator* dbIter = dynamic_cast<DoubleBufferIterator*>(iter.impl());
   if (dbIter != nullptr)
+  {
     dbIter->erase(eraseBehavior);
+    rebuildSamples_(timesA_);
+    rebuildSamples_(timesB_);
+  }
 }
 
 simData::DelayedFlushContainerPtr DoubleBufferTimeContainer::flush()
@@ -588,7 +671,10 @@ simData::DelayedFlushContainerPtr DoubleBufferTimeContainer::flush()
   // Optimize for case where both are empty (no memory allocation)
   if (timesA_.empty() && timesB_.empty())
     return DelayedFlushContainerPtr();
-  return DelayedFlushContainerPtr(new FlushContainer(timesA_, timesB_));
+  DelayedFlushContainerPtr rv(new FlushContainer(timesA_, timesB_));
+  rebuildSamples_(timesA_);
+  rebuildSamples_(timesB_);
+  return rv;
 }
 
 void DoubleBufferTimeContainer::flush(const std::vector<DataColumn*>& columns, double startTime, double endTime)
@@ -646,6 +732,7 @@ void DoubleBufferTimeContainer::flush_(TimeIndexDeque& deq, bool fresh, const st
 
   // Time is always in order so erase everything in one call
   deq.erase(start, end);
+  rebuildSamples_(deq);
 
   // Go in reverse order so pairs in "indexes" do not need to be adjusted on removal
   for (auto it = indexes.rbegin(); it != indexes.rend(); ++it)
@@ -682,8 +769,40 @@ void DoubleBufferTimeContainer::flush_(TimeIndexDeque& deq, bool fresh, const st
 DoubleBufferTimeContainer::TimeIndexDeque::iterator DoubleBufferTimeContainer::lowerBound_(
   DoubleBufferTimeContainer::TimeIndexDeque& deq, double timeValue, bool* exactMatch) const
 {
-  LessThan lessThan;
-  TimeIndexDeque::iterator i = std::lower_bound(deq.begin(), deq.end(), timeValue, lessThan);
+  const LookupIndex& index = lookupIndex_(deq);
+  const size_t size = deq.size();
+
+  // Position p is the lower bound if the time before it is less and the time at it is not
+  auto isLowerBound = [&deq, size, timeValue](size_t p) {
+    return (p == 0 || deq[p - 1].first < timeValue) && (p == size || !(deq[p].first < timeValue));
+  };
+
+  // Try the previous result, then the position after it, which covers repeated queries and playback
+  size_t position = std::min(index.cursor.load(std::memory_order_relaxed), size);
+  if (isLowerBound(position))
+  {
+    // Previous result still holds
+  }
+  else if (position < size && isLowerBound(position + 1))
+  {
+    ++position;
+  }
+  else
+  {
+    // The first sample at or after the time bounds the search to a single stride
+    const std::vector<double>& samples = index.samples;
+    // Assertion failure means samples were not updated after a change to the bin
+    assert(samples.size() == (size + SAMPLE_STRIDE - 1) / SAMPLE_STRIDE);
+    const size_t sample = std::lower_bound(samples.begin(), samples.end(), timeValue) - samples.begin();
+    const size_t low = (sample == 0) ? 0 : (sample - 1) * SAMPLE_STRIDE + 1;
+    const size_t high = (sample == samples.size()) ? size : std::min(size, sample * SAMPLE_STRIDE);
+    LessThan lessThan;
+    position = std::lower_bound(deq.begin() + low, deq.begin() + high, timeValue, lessThan) - deq.begin();
+    assert(isLowerBound(position));
+  }
+  index.cursor.store(position, std::memory_order_relaxed);
+
+  TimeIndexDeque::iterator i = deq.begin() + position;
   if (exactMatch != nullptr)
     *exactMatch = ((i != deq.end()) && (i->first == timeValue));
   return i;
@@ -692,11 +811,36 @@ DoubleBufferTimeContainer::TimeIndexDeque::iterator DoubleBufferTimeContainer::l
 DoubleBufferTimeContainer::TimeIndexDeque::iterator DoubleBufferTimeContainer::upperBound_(
   DoubleBufferTimeContainer::TimeIndexDeque& deq, double timeValue) const
 {
-  LessThan lessThan;
-  TimeIndexDeque::iterator i = std::upper_bound(deq.begin(), deq.end(), timeValue, lessThan);
+  // Times are unique within a bin, so the upper bound is normally at most one past the lower bound
+  TimeIndexDeque::iterator i = lowerBound_(deq, timeValue);
+  while (i != deq.end() && i->first == timeValue)
+    ++i;
   return i;
 }
 
+const DoubleBufferTimeContainer::LookupIndex& DoubleBufferTimeContainer::lookupIndex_(const TimeIndexDeque& deq) const
+{
+  return (&deq == &timesA_) ? lookupA_ : lookupB_;
+}
+
+DoubleBufferTimeContainer::LookupIndex& DoubleBufferTimeContainer::lookupIndex_(const TimeIndexDeque& deq)
+{
+  return (&deq == &timesA_) ? lookupA_ : lookupB_;
+}
+
+void DoubleBufferTimeContainer::extendSamples_(const TimeIndexDeque& deq)
+{
+  std::vector<double>& samples = lookupIndex_(deq).samples;
+  for (size_t k = samples.size() * SAMPLE_STRIDE; k < deq.size(); k += SAMPLE_STRIDE)
+    samples.push_back(deq[k].first);
+}
+
+void DoubleBufferTimeContainer::rebuildSamples_(const TimeIndexDeque& deq)
+{
+  lookupIndex_(deq).samples.clear();
+  extendSamples_(deq);
+}
+
 TimeContainer::Iterator DoubleBufferTimeContainer::newIterator_(size_t whichBin,
                                                                 DoubleBufferTimeContainer::TimeIndexDeque::iterator staleIter,
                                                                 DoubleBufferTimeContainer::TimeIndexDeque::iterator freshIter)
@@ -736,6 +880,7 @@ void DoubleBufferTimeContainer::swapFreshStaleData(DataTable* table, const std::
   times_[BIN_STALE] = times_[BIN_FRESH];
   times_[BIN_FRESH] = tmp;
   times_[BIN_FRESH]->clear();
+  rebuildSamples_(*times_[BIN_FRESH]);
 }
 
 void DoubleBufferTimeContainer::limitData(size_t maxPoints, double latestInvalidTime,
@@ -23,8 +23,10 @@
 #ifndef SIMDATA_MEMORYTABLE_DOUBLEBUFFERTIMECONTAINER_H
 #define SIMDATA_MEMORYTABLE_DOUBLEBUFFERTIMECONTAINER_H
 
+#include <atomic>
 #include <deque>
 #include <utility>
+#include <vector>
 #include "simCore/Common/Common.h"
 
 // DataTable.h required for the observer on removing rows
@@ -63,10 +65,19 @@ public:
   virtual TimeContainer::Iterator findTimeAtOrBeforeGivenTime(double timeValue);
   virtual TimeContainer::Iterator find(double timeValue);
   virtual TimeContainer::Iterator findOrAddTime(double timeValue, bool* exactMatch=nullptr);
+  virtual void getRange(double beginTime, double endTime, std::vector<IteratorData>& entries) const;
+  virtual void bracket(double timeValue, IteratorData& before, IteratorData& atOrAfter);
   virtual void erase(Iterator iter, EraseBehavior eraseBehavior);
   virtual DelayedFlushContainerPtr flush();
   virtual void flush(const std::vector<DataColumn*>& columns, double startTime, double endTime);
 
+  /**
+   * Reorders the stale bin and the columns' stale data so that indices match time order.  The stale
+   * bin does not receive inserts, so after compaction its values form a single contiguous block.
+   * Fast no-op if the stale bin is already in order; intended to be called at idle times.
+   */
+  virtual void compact(const std::vector<DataColumn*>& columns);
+
   /// @copydoc TimeContainer::limitData()
   virtual void limitData(size_t maxPoints, double latestInvalidTime, const std::vector<DataColumn*>& columns,
     DataTable* table, const std::vector<DataTable::TableObserverPtr>& observers);
@@ -87,8 +98,29 @@ private:
   typedef std::deque<RowTimeToIndex> TimeIndexDeque;
 
   void flush_(TimeIndexDeque& deq, bool fresh, const std::vector<DataColumn*>& columns, double startTime, double endTime);
+  /**
+   * Accelerates searches of one bin.  The position of the previous search lets repeated and slowly
+   * advancing searches (e.g. playback) complete in constant time.  Every SAMPLE_STRIDE'th time is
+   * copied into contiguous memory so that random searches touch only one stride of the deque.
+   * Searches only read the samples, which are updated by the methods that change the bin.
+   */
+  struct LookupIndex
+  {
+    /// Result of the previous search; only a hint, so concurrent const searches may overwrite it freely
+    mutable std::atomic<size_t> cursor = 0;
+    /// Time at each multiple of SAMPLE_STRIDE in the bin
+    std::vector<double> samples;
+  };
+
   TimeIndexDeque::iterator lowerBound_(TimeIndexDeque& deq, double timeValue, bool* exactMatch=nullptr) const;
   TimeIndexDeque::iterator upperBound_(TimeIndexDeque& deq, double timeValue) const;
+  /** Returns the lookup index for the given bin */
+  const LookupIndex& lookupIndex_(const TimeIndexDeque& deq) const;
+  LookupIndex& lookupIndex_(const TimeIndexDeque& deq);
+  /** Samples entries appended to the given bin since its samples were last updated */
+  void extendSamples_(const TimeIndexDeque& deq);
+  /** Resamples the given bin, after a change other than an append */
+  void rebuildSamples_(const TimeIndexDeque& deq);
   TimeContainer::Iterator newIterator_(size_t whichBin, TimeIndexDeque::iterator staleIter, TimeIndexDeque::iterator freshIter);
 
   TimeIndexDeque& freshTimes_() const;
@@ -97,6 +129,8 @@ private:
   TimeIndexDeque timesA_;
   TimeIndexDeque timesB_;
   TimeIndexDeque* times_[2];
+  LookupIndex lookupA_;
+  LookupIndex lookupB_;
   class DoubleBufferIterator;
   class FlushContainer;
 };
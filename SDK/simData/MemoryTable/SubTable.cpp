@@ -485,6 +485,11 @@ void SubTable::fillRow_(const TimeContainer::IteratorData& timeIdxData, TableRow
     (*i)->fillRow(timeIdxData, row);
 }
 
+void SubTable::compact()
+{
+  timeContainer_->compact(columns_);
+}
+
 void SubTable::limitData(size_t maxPoints, double latestInvalidTime, DataTable* table, const std::vector<DataTable::TableObserverPtr>& observers)
 {
   timeContainer_->limitData(maxPoints, latestInvalidTime, columns_, table, observers);
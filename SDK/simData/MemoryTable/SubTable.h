@@ -145,6 +145,9 @@ public:
   /** Remove rows in the given time range; up to but not including endTime */
   void flush(double startTime, double endTime);
 
+  /** Compacts data that no longer receives inserts; see TimeContainer::compact() */
+  void compact();
+
   /** Performs data limiting */
   void limitData(size_t maxPoints, double latestInvalidTime, DataTable* table, const std::vector<DataTable::TableObserverPtr>& observers);
 
@@ -345,9 +345,10 @@ class IteratorCollection
 {
 public:
   /// Instantiates an iterator collection based on subtables, between beginTime and endTime
-  IteratorCollection(const std::vector<SubTable*>& subTables, double beginTime, double endTime)
+  IteratorCollection(const std::vector<SubTable*>& subTables, size_t columnCount, double beginTime, double endTime)
     : minimumTime_(std::numeric_limits<double>::max()),
-      endTime_(endTime)
+      endTime_(endTime),
+      columnCount_(columnCount)
   {
     lowerBoundSubTables_(subTables, beginTime, endTime, subTables_, minimumTime_);
   }
@@ -359,6 +360,7 @@ public:
     while (minimumTime_ < endTime_)
     {
       TableRow row;
+      row.reserve(columnCount_);
       row.setTime(minimumTime_);
       double nextMinTime = fillRowsAtTime_(row, minimumTime_);
 
@@ -377,6 +379,8 @@ private:
   double minimumTime_;
   /// End time of iteration
   double endTime_;
+  /// Number of columns in the table, for reserving row space
+  size_t columnCount_;
   /// Current view into the requested subtables, using iterators
   std::vector<SubTable::Iterator> subTables_;
 
@@ -457,10 +461,61 @@ private:
 
 void Table::accept(double beginTime, double endTime, DataTable::RowVisitor& visitor) const
 {
-  IteratorCollection iterators(subtables_, beginTime, endTime);
+  IteratorCollection iterators(subtables_, columns_.size(), beginTime, endTime);
   iterators.accept(visitor);
 }
 
+/** Appends runs of column values to vectors of times and values, converting values to double */
+class ColumnReader : public TableColumn::RunVisitor
+{
+public:
+  /** Constructor */
+  ColumnReader(std::vector<double>& times, std::vector<double>& values)
+    : times_(times),
+      values_(values)
+  {
+  }
+
+  virtual void visit(std::span<const double> times, std::span<const uint8_t> values) { append_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const int8_t> values) { append_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const uint16_t> values) { append_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const int16_t> values) { append_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const uint32_t> values) { append_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const int32_t> values) { append_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const uint64_t> values) { append_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const int64_t> values) { append_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const float> values) { append_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const double> values) { append_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const std::string> values) { append_(times, values); }
+
+private:
+  /** Appends one run, converting the values with the TableCellTranslator */
+  template <typename T>
+  void append_(std::span<const double> times, std::span<const T> values)
+  {
+    times_.insert(times_.end(), times.begin(), times.end());
+    const size_t offset = values_.size();
+    values_.resize(offset + values.size());
+    for (size_t k = 0; k < values.size(); ++k)
+      TableCellTranslator::cast(values[k], values_[offset + k]);
+  }
+
+  std::vector<double>& times_;
+  std::vector<double>& values_;
+};
+
+TableStatus Table::readColumn(TableColumnId columnId, double beginTime, double endTime, std::vector<double>& times, std::vector<double>& values) const
+{
+  times.clear();
+  values.clear();
+  std::map<TableColumnId, TableToColumn>::const_iterator i = columns_.find(columnId);
+  if (i == columns_.end())
+    return TableStatus::Error("Column does not exist.");
+  ColumnReader reader(times, values);
+  i->second.second->accept(beginTime, endTime, reader);
+  return TableStatus::Success();
+}
+
 void Table::accept(DataTable::ColumnVisitor& visitor) const
 {
   for (std::map<TableColumnId, TableToColumn>::const_iterator i = columns_.begin(); i != columns_.end(); ++i)
@@ -549,6 +604,12 @@ void Table::flush(double startTime, double endTime)
   }
 }
 
+void Table::compact()
+{
+  for (auto subtable : subtables_)
+    subtable->compact();
+}
+
 void Table::addObserver(TableObserverPtr callback)
 {
   observers_.push_back(callback);
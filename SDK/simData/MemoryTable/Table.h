@@ -77,12 +77,19 @@ public:
   virtual void accept(double beginTime, double endTime, DataTable::RowVisitor& visitor) const;
   /** Visitor pattern to access all columns in the table. */
   virtual void accept(DataTable::ColumnVisitor& visitor) const;
+  /** Reads the values of a single column, converted to double, in time order. */
+  virtual TableStatus readColumn(TableColumnId columnId, double beginTime, double endTime, std::vector<double>& times, std::vector<double>& values) const;
   /** Adds a row to the table. */
   virtual TableStatus addRow(const TableRow& row);
   /** Clears data out of the given column or all columns if given -1 */
   virtual DelayedFlushContainerPtr flush(TableColumnId id = -1);
   /** Remove rows in the given time range; up to but not including endTime */
   virtual void flush(double startTime, double endTime);
+  /**
+   * Stores older data in time order, so that it can be read in long contiguous runs.  Inexpensive
+   * when there is nothing to compact; intended to be called periodically at idle times.
+   */
+  void compact();
   /** Add an observer for notification when rows or columns are added or removed */
   virtual void addObserver(TableObserverPtr callback);
   /** Remove an observer */
@@ -24,6 +24,7 @@
 #define SIMDATA_MEMORYTABLE_TIMECONTAINER_H
 
 #include <utility>
+#include <vector>
 #include "simCore/Common/Common.h"
 #include "simData/GenericIterator.h"
 #include "simData/DataTable.h"
@@ -158,6 +159,22 @@ public:
    * @param exactMatch If non-nullptr, will be set to false if added row, or true if found row
    */
   virtual Iterator findOrAddTime(double timeValue, bool* exactMatch=nullptr) = 0;
+  /**
+   * Retrieves all entries after beginTime (inclusive) until endTime (exclusive) in time order.
+   * Cheaper than iteration for bulk access, since no iterator implementation is allocated.
+   * @param beginTime Inclusive time at which to start
+   * @param endTime Exclusive time at which to stop
+   * @param entries Cleared, then filled with the entries in the time range
+   */
+  virtual void getRange(double beginTime, double endTime, std::vector<IteratorData>& entries) const = 0;
+  /**
+   * Retrieves the entries on either side of a time without creating an iterator.  Entries that do
+   * not exist are set to a time of std::numeric_limits<double>::max().
+   * @param timeValue Time to search for
+   * @param before Set to the last entry with a time less than timeValue
+   * @param atOrAfter Set to the first entry with a time at or after timeValue
+   */
+  virtual void bracket(double timeValue, IteratorData& before, IteratorData& atOrAfter) = 0;
 
   /**
    * Performs data limiting for the container and associated columns
@@ -184,6 +201,12 @@ public:
   virtual DelayedFlushContainerPtr flush() = 0;
   /** Remove entries in the given time range; up to but not including endTime */
   virtual void flush(const std::vector<DataColumn*>& columns, double startTime, double endTime) = 0;
+  /**
+   * Compacts data that no longer receives inserts, so that associated column values are stored in
+   * time order.  Does not change the times or values visible through the container.
+   * @param columns Associated data columns that also need updating to keep in sync
+   */
+  virtual void compact(const std::vector<DataColumn*>& columns) = 0;
 
   /**
    * Returns the begin and end time
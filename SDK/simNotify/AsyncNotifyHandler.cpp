@@ -0,0 +1,328 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <vector>
+#include "simNotify/AsyncNotifyHandler.h"
+
+namespace simNotify {
+
+namespace
+{
+  /// Message that a thread has started but not finished
+  struct PendingMessage
+  {
+    uint64_t handlerId = 0;
+    NotifySeverity severity = simNotify::NOTIFY_INFO;
+    bool prefix = false;
+    std::string text;
+  };
+  /// Messages in progress on this thread, one per handler
+  thread_local std::vector<PendingMessage> pendingMessages_;
+  /// Source of handler IDs
+  std::atomic<uint64_t> nextHandlerId_(1);
+
+  /// Returns this thread's message in progress for the given handler, or nullptr
+  PendingMessage* findPending(uint64_t handlerId)
+  {
+    auto i = std::find_if(pendingMessages_.begin(), pendingMessages_.end(),
+      [handlerId](const PendingMessage& pending) { return pending.handlerId == handlerId; });
+    return (i == pendingMessages_.end()) ? nullptr : &*i;
+  }
+
+  /// Longest time the consumer sleeps without checking for records; guards against a missed wake up
+  const std::chrono::milliseconds MAX_CONSUMER_WAIT(100);
+  /// Interval between checks while waiting in flush()
+  const std::chrono::milliseconds FLUSH_WAIT(10);
+}
+
+AsyncNotifyHandler::AsyncNotifyHandler(NotifyHandlerPtr target, size_t capacity, NotifySeverity blockingSeverity)
+  : target_(target),
+    blockingSeverity_(blockingSeverity),
+    id_(nextHandlerId_.fetch_add(1, std::memory_order_relaxed)),
+    pushPos_(0),
+    popPos_(0),
+    processed_(0),
+    dropped_(0),
+    consumerWaiting_(false)
+{
+  assert(target_ != nullptr);
+  size_t size = 2;
+  while (size < capacity)
+    size <<= 1;
+  mask_ = size - 1;
+  records_.reset(new Record[size]);
+  for (size_t k = 0; k < size; ++k)
+  {
+    records_[k].sequence.store(k, std::memory_order_relaxed);
+    records_[k].severity.store(simNotify::NOTIFY_INFO, std::memory_order_relaxed);
+  }
+
+  consumer_ = std::thread([this]() { run_(); });
+}
+
+AsyncNotifyHandler::~AsyncNotifyHandler()
+{
+  // Partial messages of other threads cannot be reached and are lost
+  queuePending_();
+  {
+    std::lock_guard<std::mutex> lock(waitMutex_);
+    done_ = true;
+  }
+  dataReady_.notify_one();
+  consumer_.join();
+}
+
+void AsyncNotifyHandler::notifyPrefix()
+{
+  // A message left without an end of line is complete once the next one starts
+  queuePending_();
+  PendingMessage pending;
+  pending.handlerId = id_;
+  pending.severity = severity();
+  pending.prefix = true;
+  pendingMessages_.push_back(std::move(pending));
+}
+
+void AsyncNotifyHandler::notify(const std::string &message)
+{
+  PendingMessage* pending = findPending(id_);
+  if (pending == nullptr)
+  {
+    // Text without a prefix; severity is captured once, at the start of the message
+    pendingMessages_.emplace_back();
+    pending = &pendingMessages_.back();
+    pending->handlerId = id_;
+    pending->severity = severity();
+  }
+  pending->text += message;
+  if (!pending->text.empty() && pending->text.back() == '\n')
+    queuePending_();
+}
+
+void AsyncNotifyHandler::flush()
+{
+  queuePending_();
+  if (std::this_thread::get_id() == consumer_.get_id())
+    return;
+
+  const uint64_t target = pushPos_.load(std::memory_order_acquire);
+  wakeConsumer_();
+  std::unique_lock<std::mutex> lock(waitMutex_);
+  while (processed_.load(std::memory_order_acquire) < target)
+    processedChanged_.wait_for(lock, FLUSH_WAIT);
+}
+
+uint64_t AsyncNotifyHandler::droppedCount() const
+{
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+void AsyncNotifyHandler::lockMutex_()
+{
+  streamMutex_.lock();
+}
+
+void AsyncNotifyHandler::unlockMutex_()
+{
+  streamMutex_.unlock();
+}
+
+void AsyncNotifyHandler::queuePending_()
+{
+  PendingMessage* pending = findPending(id_);
+  if (pending == nullptr)
+    return;
+  const NotifySeverity severity = pending->severity;
+  const bool prefix = pending->prefix;
+  std::string text;
+  text.swap(pending->text);
+  // Order of the messages in progress does not matter; each belongs to a different handler
+  std::swap(*pending, pendingMessages_.back());
+  pendingMessages_.pop_back();
+  if (!text.empty())
+    queue_(severity, prefix, text);
+}
+
+void AsyncNotifyHandler::queue_(NotifySeverity severity, bool prefix, std::string& text)
+{
+  // Messages from the target handler itself would wait on their own thread; write them directly
+  if (std::this_thread::get_id() == consumer_.get_id())
+  {
+    write_(severity, prefix, text);
+    return;
+  }
+
+  while (!tryPush_(severity, prefix, text))
+  {
+    if (severity <= blockingSeverity_)
+    {
+      // Important messages are never dropped; wait for the consumer to make room
+      wakeConsumer_();
+      std::this_thread::yield();
+    }
+    else if (!tryDropOldest_())
+    {
+      // Oldest message is important or being read; drop this one instead
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  }
+  wakeConsumer_();
+}
+
+// Bounded multi-producer ring; each slot's sequence number tells whether it is free for the
+// producer at a given position (sequence == position) or holds data for the reader at that
+// position (sequence == position + 1)
+bool AsyncNotifyHandler::tryPush_(NotifySeverity severity, bool prefix, std::string& text)
+{
+  uint64_t pos = pushPos_.load(std::memory_order_relaxed);
+  while (true)
+  {
+    Record& record = records_[pos & mask_];
+    const int64_t diff = static_cast<int64_t>(record.sequence.load(std::memory_order_acquire) - pos);
+    if (diff == 0)
+    {
+      if (pushPos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      {
+        record.severity.store(severity, std::memory_order_relaxed);
+        record.prefix = prefix;
+        record.text.swap(text);
+        record.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (diff < 0)
+      return false;
+    else
+      pos = pushPos_.load(std::memory_order_relaxed);
+  }
+}
+
+bool AsyncNotifyHandler::tryPop_(NotifySeverity& severity, bool& prefix, std::string& text)
+{
+  uint64_t pos = popPos_.load(std::memory_order_relaxed);
+  while (true)
+  {
+    Record& record = records_[pos & mask_];
+    const int64_t diff = static_cast<int64_t>(record.sequence.load(std::memory_order_acquire) - (pos + 1));
+    if (diff == 0)
+    {
+      if (popPos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      {
+        severity = record.severity.load(std::memory_order_relaxed);
+        prefix = record.prefix;
+        text.swap(record.text);
+        record.text.clear();
+        record.sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (diff < 0)
+      return false;
+    else
+      pos = popPos_.load(std::memory_order_relaxed);
+  }
+}
+
+bool AsyncNotifyHandler::tryDropOldest_()
+{
+  uint64_t pos = popPos_.load(std::memory_order_relaxed);
+  Record& record = records_[pos & mask_];
+  if (record.sequence.load(std::memory_order_acquire) != pos + 1)
+    return false;
+  // The slot could be reused while reading the severity, in which case the exchange below fails
+  if (record.severity.load(std::memory_order_relaxed) <= blockingSeverity_)
+    return false;
+  if (!popPos_.compare_exchange_strong(pos, pos + 1, std::memory_order_relaxed))
+    return false;
+
+  record.text.clear();
+  record.sequence.store(pos + mask_ + 1, std::memory_order_release);
+  dropped_.fetch_add(1, std::memory_order_relaxed);
+  processed_.fetch_add(1, std::memory_order_release);
+  return true;
+}
+
+bool AsyncNotifyHandler::hasRecords_() const
+{
+  const uint64_t pos = popPos_.load(std::memory_order_relaxed);
+  return records_[pos & mask_].sequence.load(std::memory_order_acquire) == pos + 1;
+}
+
+void AsyncNotifyHandler::write_(NotifySeverity severity, bool prefix, const std::string& text)
+{
+  target_->setSeverity(severity);
+  if (prefix)
+    target_->notifyPrefix();
+  target_->notify(text);
+}
+
+void AsyncNotifyHandler::run_()
+{
+  NotifySeverity severity = simNotify::NOTIFY_INFO;
+  bool prefix = false;
+  std::string text;
+  while (true)
+  {
+    if (tryPop_(severity, prefix, text))
+    {
+      write_(severity, prefix, text);
+      processed_.fetch_add(1, std::memory_order_release);
+      processedChanged_.notify_all();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(waitMutex_);
+    consumerWaiting_.store(true);
+    // Check again after announcing the wait; a producer that missed the flag has already published
+    if (!hasRecords_())
+    {
+      if (done_ && popPos_.load() == pushPos_.load())
+      {
+        consumerWaiting_.store(false);
+        break;
+      }
+      dataReady_.wait_for(lock, MAX_CONSUMER_WAIT);
+    }
+    consumerWaiting_.store(false);
+  }
+  processedChanged_.notify_all();
+}
+
+void AsyncNotifyHandler::wakeConsumer_()
+{
+  // Pairs with the store of consumerWaiting_ in run_(), so that either the consumer sees the
+  // new record or this thread sees the consumer waiting
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!consumerWaiting_.load())
+    return;
+  {
+    // Taking the lock ensures the consumer is inside wait_for() rather than about to call it
+    std::lock_guard<std::mutex> lock(waitMutex_);
+  }
+  dataReady_.notify_one();
+}
+
+}
@@ -0,0 +1,157 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMNOTIFY_ASYNCNOTIFYHANDLER_H
+#define SIMNOTIFY_ASYNCNOTIFYHANDLER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "simCore/Common/Common.h"
+#include "simNotify/NotifyHandler.h"
+
+namespace simNotify
+{
+
+  /**
+  * @ingroup Notify
+  * @brief NotifyHandler that writes messages to another handler on a background thread.
+  *
+  * Producers copy each preformatted message into a bounded lock-free ring and return
+  * immediately; a single consumer thread writes the messages in order to the target handler,
+  * which can be a CompositeHandler to fan out to several handlers.  The prefix is written by
+  * the consumer through the target's notifyPrefix(), so a prefix that includes a time stamp
+  * reflects the time of writing rather than the time of the call.
+  *
+  * Text written with several calls, e.g. through operator<<(), is collected per thread and
+  * queued as one message when the line ends with a newline, when the thread starts another
+  * message with notifyPrefix(), or when the thread calls flush().  The severity is captured when
+  * the message starts, so lines from different threads are never split or interleaved.
+  *
+  * When the ring is full, messages at or above the blocking severity wait for the consumer to
+  * free a slot.  Less severe messages instead discard the oldest queued message, so a burst of
+  * debug output cannot stall the caller or grow memory without bound.
+  *
+  * Queued messages are written before the destructor returns.  Messages generated by the
+  * target handler itself on the consumer thread are written immediately.
+  *
+  * Example:
+  *   simNotify::setNotifyHandlers(std::make_shared<simNotify::AsyncNotifyHandler>(simNotify::defaultNotifyHandler()));
+  */
+  class SDKNOTIFY_EXPORT AsyncNotifyHandler : public NotifyHandler
+  {
+  public:
+    /**
+    * Starts the consumer thread.
+    * @param[in ] target Handler that receives the messages; must not be nullptr
+    * @param[in ] capacity Maximum number of queued messages, rounded up to a power of 2
+    * @param[in ] blockingSeverity Messages of this severity or more severe are never dropped
+    */
+    explicit AsyncNotifyHandler(NotifyHandlerPtr target, size_t capacity = 4096, NotifySeverity blockingSeverity = simNotify::NOTIFY_WARN);
+    /** Writes all queued messages, then stops the consumer thread */
+    virtual ~AsyncNotifyHandler();
+
+    SDK_DISABLE_COPY_MOVE(AsyncNotifyHandler);
+
+    /** Starts a new message with a prefix from the calling thread */
+    virtual void notifyPrefix() override;
+    /** Adds to the calling thread's message, queuing it for the consumer thread at end of line */
+    virtual void notify(const std::string &message) override;
+
+    /** Queues the calling thread's partial message, then blocks until every message queued before the call has been written or dropped */
+    void flush();
+
+    /** Returns the number of messages discarded because the ring was full */
+    uint64_t droppedCount() const;
+
+  protected:
+    virtual void lockMutex_() override;
+    virtual void unlockMutex_() override;
+
+  private:
+    /** One queued message */
+    struct Record
+    {
+      /** Ring position of the record; tells producers and consumers whose turn the slot is */
+      std::atomic<uint64_t> sequence;
+      /** Atomic so that a producer may inspect the oldest record before deciding to drop it */
+      std::atomic<NotifySeverity> severity;
+      bool prefix = false;
+      std::string text;
+    };
+
+    /** Queues the calling thread's message, if any */
+    void queuePending_();
+    /** Adds a record, waiting or dropping records as needed if the ring is full */
+    void queue_(NotifySeverity severity, bool prefix, std::string& text);
+    /** Attempts to add a record without waiting; returns false if the ring is full */
+    bool tryPush_(NotifySeverity severity, bool prefix, std::string& text);
+    /** Attempts to remove the oldest record; returns false if the ring is empty */
+    bool tryPop_(NotifySeverity& severity, bool& prefix, std::string& text);
+    /** Attempts to discard the oldest record if it is less severe than the blocking severity */
+    bool tryDropOldest_();
+    /** Returns true if the oldest record is ready to be removed */
+    bool hasRecords_() const;
+    /** Writes a record to the target handler */
+    void write_(NotifySeverity severity, bool prefix, const std::string& text);
+    /** Consumer thread loop */
+    void run_();
+    /** Wakes the consumer thread if it is waiting for data */
+    void wakeConsumer_();
+
+    NotifyHandlerPtr target_;
+    const NotifySeverity blockingSeverity_;
+    /** Identifies the handler's messages in the per-thread buffers; unlike the address, never reused */
+    const uint64_t id_;
+
+    std::unique_ptr<Record[]> records_;
+    uint64_t mask_ = 0;
+    /** Next position to write; shared by producers */
+    std::atomic<uint64_t> pushPos_;
+    /** Next position to read; shared by the consumer and by producers dropping the oldest record */
+    std::atomic<uint64_t> popPos_;
+    /** Number of records written or dropped, for flush() */
+    std::atomic<uint64_t> processed_;
+    std::atomic<uint64_t> dropped_;
+
+    /** Protects the waits below; never held by producers on the fast path */
+    std::mutex waitMutex_;
+    /** Signaled when records are available or on shut down */
+    std::condition_variable dataReady_;
+    /** Signaled when the consumer has processed records, for flush() */
+    std::condition_variable processedChanged_;
+    std::atomic<bool> consumerWaiting_;
+    bool done_ = false;
+
+    /** Protects the base class stream used by the operator<<() formatting */
+    std::mutex streamMutex_;
+    std::thread consumer_;
+  };
+
+}
+
+#endif /* SIMNOTIFY_ASYNCNOTIFYHANDLER_H */
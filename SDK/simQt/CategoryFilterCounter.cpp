@@ -20,19 +20,30 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <QElapsedTimer>
 #include <QFutureWatcher>
 #include <QtConcurrent/QtConcurrentRun>
+#include "simData/CategoryData/CategoryData.h"
 #include "simData/CategoryData/CategoryFilter.h"
 #include "simData/CategoryData/CategoryNameManager.h"
+#include "simData/CategoryData/CompiledCategoryFilter.h"
 #include "simData/DataStore.h"
 #include "simQt/CategoryFilterCounter.h"
 
 namespace simQt {
 
+/** Default minimum time between partial results during a count, in milliseconds */
+static const int DEFAULT_PARTIAL_RESULTS_INTERVAL_MS = 100;
+
 CategoryFilterCounter::CategoryFilterCounter(QObject* parent)
   : QObject(parent),
     dirtyFlag_(false),
-    objectTypes_(simData::ALL)
+    objectTypes_(simData::ALL),
+    canceled_(false),
+    partialResultsIntervalMs_(DEFAULT_PARTIAL_RESULTS_INTERVAL_MS)
 {
 }
 
@@ -55,12 +66,16 @@ void CategoryFilterCounter::prepare()
   // Make a copy of all the current category data
   std::vector<simData::ObjectId> ids;
   idList_(ids);
+  allEntities_.reserve(ids.size());
   for (auto i = ids.begin(); i != ids.end(); ++i)
   {
     IdAndCategories entry;
     entry.id = *i;
-    simData::CategoryFilter::getCurrentCategoryValues(*ds, entry.id, entry.categories);
-    allEntities_.push_back(entry);
+    const simData::CategoryDataSlice* slice = ds->categoryDataSlice(entry.id);
+    if (slice)
+      slice->allInts(entry.categories);
+    std::sort(entry.categories.begin(), entry.categories.end());
+    allEntities_.push_back(std::move(entry));
   }
 
   // Initialize all filter entries based on state of filter
@@ -110,6 +125,21 @@ void CategoryFilterCounter::idList_(std::vector<simData::ObjectId>& ids) const
   ds->idList(&ids, objectTypes_);
 }
 
+void CategoryFilterCounter::cancel()
+{
+  canceled_ = true;
+}
+
+bool CategoryFilterCounter::isCanceled() const
+{
+  return canceled_;
+}
+
+void CategoryFilterCounter::setPartialResultsInterval(int msec)
+{
+  partialResultsIntervalMs_ = std::max(0, msec);
+}
+
 void CategoryFilterCounter::testAllCategories()
 {
   if (dirtyFlag_)
@@ -117,10 +147,27 @@ void CategoryFilterCounter::testAllCategories()
   // prepare() should turn off the dirty flag
   assert(!dirtyFlag_);
 
-  // Test every category we know about
+  // Test every category we know about, streaming the counts out periodically
+  CategoryCountResults partial;
+  QElapsedTimer sinceLastPartial;
+  sinceLastPartial.start();
   for (auto i = results_.allCategories.begin(); i != results_.allCategories.end(); ++i)
+  {
+    if (canceled_)
+      return;
     testCategory_(i->first, i->second);
-  Q_EMIT resultsReady(results_);
+    partial.allCategories.insert(*i);
+
+    // No need for partial results after the last category, since resultsReady() follows
+    if (sinceLastPartial.elapsed() >= partialResultsIntervalMs_ && std::next(i) != results_.allCategories.end())
+    {
+      Q_EMIT partialResultsReady(partial);
+      partial.allCategories.clear();
+      sinceLastPartial.restart();
+    }
+  }
+  if (!canceled_)
+    Q_EMIT resultsReady(results_);
 }
 
 const CategoryCountResults& CategoryFilterCounter::results() const
@@ -128,54 +175,36 @@ const CategoryCountResults& CategoryFilterCounter::results() const
   return results_;
 }
 
-// Inside thread (protected)
-void CategoryFilterCounter::filteredIds_(int ignoreNameInt, std::vector<const IdAndCategories*>& ids) const
-{
-  simData::CategoryFilter baseFilter(*filter_);
-  baseFilter.removeName(ignoreNameInt);
-
-  // Find all IDs that match the new filter without the name provided
-  for (auto idIter = allEntities_.begin(); idIter != allEntities_.end(); ++idIter)
-  {
-    if (baseFilter.matchData(idIter->categories))
-      ids.push_back(&(*idIter));
-  }
-}
-
 // Inside thread (protected)
 void CategoryFilterCounter::testCategory_(int nameInt, CategoryCountResults::ValueToCountMap& countMap)
 {
   // Start out by not testing anything in this filter
   simData::CategoryFilter baseFilter(*filter_);
   baseFilter.removeName(nameInt);
+  simData::CompiledCategoryFilter compiledFilter(baseFilter);
 
-  // Get all IDs that match the filter excluding this name
-  std::vector<const IdAndCategories*> idDataVec;
-  filteredIds_(nameInt, idDataVec);
-
-  // Loop through each value in this category.  If the platform matches, add it
-  for (auto vi = countMap.begin(); vi != countMap.end(); ++vi)
+  // Turning on a single value of this category, with all other values off, passes exactly the
+  // entities that pass the rest of the filter and have that value; so each entity that passes
+  // the rest of the filter counts toward its own value, or toward NO_CATEGORY_VALUE_AT_TIME
+  auto noValueCount = countMap.find(simData::CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME);
+  for (auto idIter = allEntities_.begin(); idIter != allEntities_.end(); ++idIter)
   {
-    // Test what happens when this filter value is turned on
-    baseFilter.setValue(nameInt, vi->first, true);
-    size_t& numMatches = vi->second;
-    // Assertion failure means the prepare() missed a category value
-    assert(numMatches == 0);
-
-    // Loop through each entity of interest
-    for (auto idIter = idDataVec.begin(); idIter != idDataVec.end(); ++idIter)
-    {
-      const IdAndCategories& idData = **idIter;
-      const simData::ObjectId& id = idData.id;
+    if (!compiledFilter.matchData(idIter->categories))
+      continue;
 
-      // Test the value and increment if it matches
-      const bool matches = baseFilter.matchData(idData.categories);
-      if (matches)
-        ++vi->second;
+    const auto& categories = idIter->categories;
+    auto nameIter = std::lower_bound(categories.begin(), categories.end(), std::make_pair(nameInt, std::numeric_limits<int>::min()));
+    if (nameIter == categories.end() || nameIter->first != nameInt)
+    {
+      if (noValueCount != countMap.end())
+        ++noValueCount->second;
+      continue;
     }
 
-    // Turn that value back off.  removeName()
-    baseFilter.setValue(nameInt, vi->first, false);
+    // Values added after prepare() are not counted
+    auto valueCount = countMap.find(nameIter->second);
+    if (valueCount != countMap.end())
+      ++valueCount->second;
   }
 }
 
@@ -187,10 +216,15 @@ AsyncCategoryCounter::AsyncCategoryCounter(QObject* parent)
     retestPending_(false),
     objectTypes_(simData::ALL)
 {
+  // Partial results cross threads through a queued connection
+  qRegisterMetaType<simQt::CategoryCountResults>("simQt::CategoryCountResults");
 }
 
 AsyncCategoryCounter::~AsyncCategoryCounter()
 {
+  // Let the background count finish quickly; the watcher owns and deletes the counter
+  if (counter_)
+    counter_->cancel();
 }
 
 void AsyncCategoryCounter::setFilter(const simData::CategoryFilter& filter)
@@ -213,6 +247,8 @@ void AsyncCategoryCounter::asyncCountEntities()
 {
   if (counter_ != nullptr)
   {
+    // Results of the ongoing count are stale; stop it and count again once it stops
+    counter_->cancel();
     retestPending_ = true;
     return;
   }
@@ -230,6 +266,7 @@ void AsyncCategoryCounter::asyncCountEntities()
   counter_->prepare();
 
   // Be sure to set up a connect() before setFuture() to avoid race.
+  connect(counter_, SIGNAL(partialResultsReady(simQt::CategoryCountResults)), this, SLOT(emitPartialResults_(simQt::CategoryCountResults)), Qt::QueuedConnection);
   connect(watcher, SIGNAL(finished()), this, SLOT(emitResults_()));
   // To prevent race conditions use deleteLater() instead of Qt parents to manage lifespan
   connect(watcher, SIGNAL(finished()), watcher, SLOT(deleteLater()));
@@ -241,6 +278,8 @@ void AsyncCategoryCounter::reset()
 {
   retestPending_ = false;
   dropNextResults_ = (counter_ != nullptr);
+  if (counter_)
+    counter_->cancel();
   objectTypes_ = simData::ALL;
   if (nextFilter_)
     nextFilter_->clear();
@@ -249,8 +288,8 @@ void AsyncCategoryCounter::reset()
 
 void AsyncCategoryCounter::emitResults_()
 {
-  // This call happens in the main thread and is the "join" for the job
-  if (!dropNextResults_)
+  // This call happens in the main thread and is the "join" for the job.  Canceled counts are incomplete.
+  if (!dropNextResults_ && !counter_->isCanceled())
   {
     lastResults_ = counter_->results();
     Q_EMIT resultsReady(lastResults_);
@@ -266,6 +305,14 @@ void AsyncCategoryCounter::emitResults_()
     asyncCountEntities();
 }
 
+void AsyncCategoryCounter::emitPartialResults_(const simQt::CategoryCountResults& results)
+{
+  // Partial results can arrive after the count was canceled or replaced
+  if (counter_ == nullptr || sender() != counter_ || dropNextResults_ || counter_->isCanceled())
+    return;
+  Q_EMIT partialResultsReady(results);
+}
+
 const simQt::CategoryCountResults& AsyncCategoryCounter::lastResults() const
 {
   return lastResults_;
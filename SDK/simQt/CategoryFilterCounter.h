@@ -23,8 +23,10 @@
 #ifndef SIMQT_CATEGORYFILTERCOUNTER_H
 #define SIMQT_CATEGORYFILTERCOUNTER_H
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 #include <QObject>
 #include "simCore/Common/Export.h"
@@ -51,7 +53,8 @@ struct CategoryCountResults
  * be impacted by clicking a category value line in a category tree widget.
  *
  * Note that this algorithm is O(m * n), scaling both on the number of entities (m) and the
- * total number of category values (n).
+ * number of category names (n).  Counting works on a snapshot of category data taken by
+ * prepare(), and can be stopped early from another thread with cancel().
  */
 class SDKQT_EXPORT CategoryFilterCounter : public QObject
 {
@@ -76,6 +79,21 @@ public:
    */
   void prepare();
 
+  /**
+   * Requests that a testAllCategories() in progress stop at the next category.  Thread safe.
+   * A canceled count does not emit resultsReady(), and its results() are incomplete.
+   */
+  void cancel();
+  /** Returns true if cancel() was called.  Thread safe. */
+  bool isCanceled() const;
+
+  /**
+   * Sets the minimum time between partialResultsReady() signals, in milliseconds; defaults to 100.
+   * An interval of 0 emits partial results after every category except the last.  Set this before
+   * calling testAllCategories().
+   */
+  void setPartialResultsInterval(int msec);
+
 public Q_SLOTS:
   /**
    * Performs the testing.  When done, results() will be valid, and resultsReady() will be emitted.
@@ -91,12 +109,19 @@ Q_SIGNALS:
   /** Called when testAllCategories() is completed. */
   void resultsReady(const simQt::CategoryCountResults& results);
 
+  /**
+   * Called periodically during testAllCategories() with the categories counted since the previous
+   * partial results.  Emitted from the thread running testAllCategories().
+   */
+  void partialResultsReady(const simQt::CategoryCountResults& results);
+
 private:
   /** Local storage structure for current category data.  Filled out by prepare(). */
   struct IdAndCategories
   {
     simData::ObjectId id;
-    simData::CategoryFilter::CurrentCategoryValues categories;
+    /** Name and value ints, sorted by name */
+    std::vector<std::pair<int, int> > categories;
   };
 
   /**
@@ -105,8 +130,6 @@ private:
    */
   void idList_(std::vector<simData::ObjectId>& ids) const;
 
-  /** Returns a list of ID+Categories that matches filter_.  Thread safe. */
-  void filteredIds_(int ignoreNameInt, std::vector<const IdAndCategories*>& ids) const;
   /** Tests an individual category and sets the counts for that category */
   void testCategory_(int nameInt, CategoryCountResults::ValueToCountMap& countMap);
 
@@ -120,13 +143,18 @@ private:
   bool dirtyFlag_;
   /** Filter entity results by object type */
   simData::ObjectType objectTypes_;
+  /** Set by cancel(), possibly from another thread */
+  std::atomic<bool> canceled_;
+  /** Minimum time between partialResultsReady() signals, in milliseconds */
+  int partialResultsIntervalMs_;
 };
 
 /**
  * Asynchronous implementation of a category counter.  Since CategoryFilterCounter is potentially
  * expensive, it can be advantageous to perform the calculations in the background.  This
- * implementation ensures that the counter only runs one at a time, and additional calls are
- * queued up for execution once the first execution finishes.
+ * implementation ensures that the counter only runs one at a time.  A request that arrives while a
+ * count is running cancels that count, and a new count starts as soon as the canceled one stops.
+ * Counts for each category are streamed through partialResultsReady() as they complete.
  */
 class SDKQT_EXPORT AsyncCategoryCounter : public QObject
 {
@@ -155,8 +183,8 @@ public Q_SLOTS:
    * Tests the filter against all known entities.  This function will query the data store for the
    * list of all entities and their category data, then prepare a CategoryFilterCounter.  It
    * executes the count in the background.  Once the count is complete, the resultsReady() signal
-   * is emitted.  If this is called while a count is ongoing in the background, another count will
-   * start once the first one finishes.  Only one count is queued at a time.
+   * is emitted.  If this is called while a count is ongoing in the background, the ongoing count
+   * is canceled and another count will start once it stops.  Only one count is queued at a time.
    */
   void asyncCountEntities();
 
@@ -167,9 +195,14 @@ Q_SIGNALS:
   /** Indicates that the asynchronous operation from testAsync() has completed. */
   void resultsReady(const simQt::CategoryCountResults& results);
 
+  /** Counts for some categories of the ongoing operation; contains only the categories counted since the last partial results. */
+  void partialResultsReady(const simQt::CategoryCountResults& results);
+
 private Q_SLOTS:
   /** Captures the results from counter_, clears the future watcher, emits results, and restarts if needed. */
   void emitResults_();
+  /** Forwards partial results from counter_, unless they belong to a canceled count */
+  void emitPartialResults_(const simQt::CategoryCountResults& results);
 
 private:
   simQt::CategoryCountResults lastResults_;
@@ -182,4 +215,6 @@ private:
 
 }
 
+Q_DECLARE_METATYPE(simQt::CategoryCountResults);
+
 #endif /* SIMQT_CATEGORYFILTERCOUNTER_H */
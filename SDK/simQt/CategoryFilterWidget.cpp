@@ -752,6 +752,11 @@ void CategoryFilterWidget::processCategoryCounts(const simQt::CategoryCountResul
   treeModel_->processCategoryCounts(results);
 }
 
+void CategoryFilterWidget::processPartialCategoryCounts(const simQt::CategoryCountResults& results)
+{
+  treeModel_->processPartialCategoryCounts(results);
+}
+
 bool CategoryFilterWidget::showEntityCount() const
 {
   return showEntityCount_;
@@ -772,6 +777,7 @@ void CategoryFilterWidget::setShowEntityCount(bool fl)
   {
     counter_ = new simQt::AsyncCategoryCounter(this);
     connect(counter_, SIGNAL(resultsReady(simQt::CategoryCountResults)), this, SLOT(processCategoryCounts(simQt::CategoryCountResults)));
+    connect(counter_, SIGNAL(partialResultsReady(simQt::CategoryCountResults)), this, SLOT(processPartialCategoryCounts(simQt::CategoryCountResults)));
     connect(treeModel_, SIGNAL(filterChanged(simData::CategoryFilter)), counter_, SLOT(setFilter(simData::CategoryFilter)));
     connect(treeModel_, SIGNAL(rowsInserted(QModelIndex, int, int)), counter_, SLOT(asyncCountEntities()));
     connect(treeModel_, &QAbstractItemModel::modelReset, counter_, &simQt::AsyncCategoryCounter::reset);
@@ -144,6 +144,8 @@ public Q_SLOTS:
   void setFilter(const simData::CategoryFilter& filter);
   /** Updates the (#) count next to category values with the given category value counts. */
   void processCategoryCounts(const simQt::CategoryCountResults& results);
+  /** Updates the (#) count next to category values for only the categories in the given partial counts. */
+  void processPartialCategoryCounts(const simQt::CategoryCountResults& results);
 
   /**
    * Marks the entity count as dirty; call this when adding or removing entities, or category data changes.
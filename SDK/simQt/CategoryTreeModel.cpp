@@ -20,6 +20,7 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include <QAbstractItemView>
 #include "simData/CategoryData/CategoryNameManager.h"
 #include "simData/DataStore.h"
@@ -1364,6 +1365,27 @@ void CategoryTreeModel::processCategoryCounts(const simQt::CategoryCountResults&
     Q_EMIT dataChanged(index(firstRowChanged, 0), index(lastRowChanged, 0));
 }
 
+void CategoryTreeModel::processPartialCategoryCounts(const simQt::CategoryCountResults& results)
+{
+  int firstRowChanged = -1;
+  int lastRowChanged = -1;
+  for (const auto& entry : results.allCategories)
+  {
+    // Might have a category removed between when we fired off the call and now
+    CategoryItem* categoryItem = findNameTree_(entry.first);
+    if (!categoryItem || !categoryItem->updateCounts(entry.second))
+      continue;
+
+    const int row = categories_.indexOf(categoryItem);
+    if (firstRowChanged == -1 || row < firstRowChanged)
+      firstRowChanged = row;
+    lastRowChanged = std::max(lastRowChanged, row);
+  }
+
+  if (firstRowChanged != -1)
+    Q_EMIT dataChanged(index(firstRowChanged, 0), index(lastRowChanged, 0));
+}
+
 void CategoryTreeModel::emitChildrenDataChanged_(const QModelIndex& parent)
 {
   // Change all children
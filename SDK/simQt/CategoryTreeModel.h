@@ -144,6 +144,8 @@ public Q_SLOTS:
   void setFilter(const simData::CategoryFilter& filter);
   /** Given results of a category count, updates the text for each category. */
   void processCategoryCounts(const simQt::CategoryCountResults& results);
+  /** Given results for some categories of a count in progress, updates the text for only those categories. */
+  void processPartialCategoryCounts(const simQt::CategoryCountResults& results);
 
 Q_SIGNALS:
   /** The internal filter has changed, possibly from user editing or programmatically. */
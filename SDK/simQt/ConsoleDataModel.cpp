@@ -20,6 +20,7 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include <cassert>
 #include <QDateTime>
 #include <QColor>
@@ -108,10 +109,13 @@ ConsoleDataModel::ConsoleDataModel(QObject* parent)
     numLines_(DEFAULT_MAX_LINES_SIZE),
     spamFilterTimeout_(5.0),
     minSeverity_(simNotify::NOTIFY_INFO),
+    firstLine_(0),
+    lineCount_(0),
+    repeatsChanged_(false),
     timeFormatString_(DEFAULT_TIME_FORMAT),
     pendingTimer_(new QTimer)
 {
-
+  lines_.resize(numLines_, nullptr);
   pendingTimer_->setInterval(PROCESS_PENDING_TIMEOUT);
   pendingTimer_->setSingleShot(true);
   connect(pendingTimer_, SIGNAL(timeout()), this, SLOT(processPendingAdds_()));
@@ -120,7 +124,8 @@ ConsoleDataModel::ConsoleDataModel(QObject* parent)
 ConsoleDataModel::~ConsoleDataModel()
 {
   delete pendingTimer_;
-  qDeleteAll(lines_);
+  for (int k = 0; k < lineCount_; ++k)
+    delete lineAt_(k);
   qDeleteAll(pendingLines_);
   auto channels = channels_.values();
   for (auto it = channels.begin(); it != channels.end(); ++it)
@@ -165,6 +170,8 @@ QVariant ConsoleDataModel::data(const QModelIndex& idx, int role) const
     case COLUMN_CATEGORY:
       return line->channel();
     case COLUMN_TEXT:
+      if (line->repeatCount() > 1)
+        return tr("%1 (x%2)").arg(line->text()).arg(line->repeatCount());
       return line->text();
     }
     break;
@@ -172,6 +179,9 @@ QVariant ConsoleDataModel::data(const QModelIndex& idx, int role) const
   case ConsoleDataModel::SEVERITY_ROLE:
     return line->severity();
 
+  case ConsoleDataModel::REPEAT_COUNT_ROLE:
+    return line->repeatCount();
+
   case Qt::ForegroundRole:
     // Colorization is optional
     if (!colorizeText_)
@@ -239,7 +249,7 @@ int ConsoleDataModel::rowCount(const QModelIndex &parent) const
 {
   if (parent.isValid())
     return 0;
-  return lines_.count();
+  return lineCount_;
 }
 
 QModelIndex ConsoleDataModel::parent(const QModelIndex &child) const
@@ -256,8 +266,8 @@ QModelIndex ConsoleDataModel::index(int row, int column, const QModelIndex &pare
   // Pull out list entry
   int indexInLines = row;
   if (newestOnTop()) // Reverse it if newest is on top
-    indexInLines = lines_.size() - row - 1;
-  LineEntry* entry = lines_[indexInLines];
+    indexInLines = lineCount_ - row - 1;
+  LineEntry* entry = lineAt_(indexInLines);
   return createIndex(row, column, entry);
 }
 
@@ -275,13 +285,14 @@ ConsoleChannelPtr ConsoleDataModel::registerChannel(const QString& name)
 
 void ConsoleDataModel::clear()
 {
-  if (lines_.count() <= 0)
+  if (lineCount_ <= 0)
     return;
 
-  beginRemoveRows(QModelIndex(), 0, lines_.count() - 1);
-  for (auto it = lines_.begin(); it != lines_.end(); ++it)
-    delete *it;
-  lines_.clear();
+  beginRemoveRows(QModelIndex(), 0, lineCount_ - 1);
+  for (int k = 0; k < lineCount_; ++k)
+    deleteLine_(lineAt_(k));
+  firstLine_ = 0;
+  lineCount_ = 0;
   endRemoveRows();
 }
 
@@ -299,37 +310,32 @@ void ConsoleDataModel::addEntry(simNotify::NotifySeverity severity, const QStrin
   }
 }
 
-bool ConsoleDataModel::isDuplicateEntry_(const QString& channel, const QString& text, double sinceTime) const
-{
-  return isDuplicateEntry_(pendingLines_, channel, text, sinceTime) ||
-    isDuplicateEntry_(lines_, channel, text, sinceTime);
-}
-
-bool ConsoleDataModel::isDuplicateEntry_(const QList<LineEntry*>& whichList, const QString& channel,
-  const QString& text, double sinceTime) const
+ConsoleDataModel::LineEntry* ConsoleDataModel::findDuplicateEntry_(const QString& channel, const QString& text, double sinceTime) const
 {
-  QListIterator<LineEntry*> iter(whichList);
-  iter.toBack();
-  // Iterate from the back to get proper time sorting
-  while (iter.hasPrevious())
-  {
-    const LineEntry* line = iter.previous();
-    // Break out if we hit the since-time
-    if (line->timeStamp() < sinceTime)
-      return false;
-    // Break out if we have a match
-    if (line->text() == text && line->channel() == channel)
-      return true;
-  }
-  return false;
+  // Only the most recent match needs to be checked; older matches are even further from the since-time
+  auto it = recentLines_.constFind(LineKey(channel, text));
+  if (it == recentLines_.constEnd() || it.value()->timeStamp() < sinceTime)
+    return nullptr;
+  return it.value();
 }
 
 void ConsoleDataModel::addPlainEntry_(simNotify::NotifySeverity severity, const QString& channel, const QString& text)
 {
-  // Don't add duplicates
+  // Don't add duplicates; count them against the earlier line instead
   const double currentTime = LineEntry::currentTime();
-  if (spamFilterTimeout() > 0 && isDuplicateEntry_(channel, text, currentTime - spamFilterTimeout()))
-    return;
+  if (spamFilterTimeout() > 0)
+  {
+    LineEntry* duplicate = findDuplicateEntry_(channel, text, currentTime - spamFilterTimeout());
+    if (duplicate != nullptr)
+    {
+      duplicate->addRepeat();
+      // Views are updated with the next batch of pending data
+      repeatsChanged_ = true;
+      if (!pendingTimer_->isActive())
+        pendingTimer_->start();
+      return;
+    }
+  }
 
   // Process the entry through filters (if filters are defined)
   LineEntry* newEntry = nullptr;
@@ -361,7 +367,13 @@ void ConsoleDataModel::addPlainEntry_(simNotify::NotifySeverity severity, const
 
   // Save in the pending list, only add items that meet the minimum severity level
   if (severity <= minSeverity_)
+  {
     pendingLines_.push_back(newEntry);
+    recentLines_.insert(LineKey(newEntry->channel(), newEntry->text()), newEntry);
+    // Lines beyond numLines() would be dropped on insertion anyway; drop them now to bound memory
+    if (pendingLines_.size() > numLines_)
+      deleteLine_(pendingLines_.takeFirst());
+  }
 
   // Notify users of new data -- this should be instant, even if we are just pending
   // NOTE that this signal is emitted no matter what the severity level is, unlike items in the pendingLines_
@@ -377,25 +389,38 @@ void ConsoleDataModel::addPlainEntry_(simNotify::NotifySeverity severity, const
 
 void ConsoleDataModel::processPendingAdds_()
 {
+  if (repeatsChanged_)
+  {
+    repeatsChanged_ = false;
+    if (lineCount_ > 0)
+      Q_EMIT dataChanged(index(0, COLUMN_TEXT, QModelIndex()), index(lineCount_ - 1, COLUMN_TEXT, QModelIndex()));
+  }
   if (pendingLines_.empty())
     return;
 
+  // Evict the oldest lines first so that all new lines fit in the ring with a single insertion
+  const int capacity = static_cast<int>(lines_.size());
+  const int numToAdd = static_cast<int>(pendingLines_.size());
+  assert(numToAdd <= capacity);
+  const int numToRemove = lineCount_ + numToAdd - capacity;
+  if (numToRemove > 0)
+    removeLines_(0, numToRemove);
+
   // Add the new lines: Pay attention to newest on top flag, which impacts whether
   // people watching us see these at the beginning (true), or end (false)
   // Note that indices are inclusive, so a size of 1 means an offset of 0 (hence the -1)
   if (newestOnTop())
-    beginInsertRows(QModelIndex(), 0, pendingLines_.size() - 1);
+    beginInsertRows(QModelIndex(), 0, numToAdd - 1);
   else
-    beginInsertRows(QModelIndex(), lines_.count(), lines_.count() + pendingLines_.size() - 1);
-  QListIterator<LineEntry*> iter(pendingLines_);
+    beginInsertRows(QModelIndex(), lineCount_, lineCount_ + numToAdd - 1);
   // Iterate from the front to get proper time sorting
-  while (iter.hasNext())
-    lines_.push_back(iter.next());
+  for (auto it = pendingLines_.begin(); it != pendingLines_.end(); ++it)
+  {
+    lines_[(firstLine_ + lineCount_) % capacity] = *it;
+    ++lineCount_;
+  }
   pendingLines_.clear();
   endInsertRows();
-
-  // Limit the internal number of lines saved
-  limitData_();
 }
 
 int ConsoleDataModel::numLines() const
@@ -412,41 +437,40 @@ void ConsoleDataModel::setMinimumSeverity(int severity)
   // if we are changing to a lower severity level, clear out all lines that exceed our minimum severity
   if (newSeverity < minSeverity_)
   {
-    int removeEndIndex = 0;
-    int lineIndex = 0;
-    // iterate through the lines_ list to check and remove lines
-    while (lineIndex < lines_.size())
+    // Compact the ring in a single pass; removing each block of lines separately would shift
+    // the newer lines once per block
+    int numKept = 0;
+    for (int k = 0; k < lineCount_; ++k)
     {
-      if (lineIndex + removeEndIndex < lines_.size() &&
-        lines_.at(lineIndex + removeEndIndex)->severity() > newSeverity)
-      {
-        // found an invalid severity level, update the index of our removal end block
-        removeEndIndex++;
-      }
-      // if we have any lines to remove, do it now, since we've reached the end of a block of invalid lines
-      else
+      if (lineAt_(k)->severity() <= newSeverity)
+        ++numKept;
+    }
+    if (numKept < lineCount_)
+    {
+      beginResetModel();
+      std::vector<LineEntry*> kept;
+      kept.reserve(numKept);
+      for (int k = 0; k < lineCount_; ++k)
       {
-        if (removeEndIndex > 0)
-        {
-          beginRemoveRows(QModelIndex(), lineIndex, lineIndex + removeEndIndex - 1);
-          for (; removeEndIndex > 0; removeEndIndex--)
-          {
-            delete lines_.at(lineIndex);
-            lines_.removeAt(lineIndex);
-          }
-          endRemoveRows();
-        }
-        lineIndex++;
+        LineEntry* line = lineAt_(k);
+        if (line->severity() <= newSeverity)
+          kept.push_back(line);
+        else
+          deleteLine_(line);
       }
+      std::copy(kept.begin(), kept.end(), lines_.begin());
+      firstLine_ = 0;
+      lineCount_ = numKept;
+      endResetModel();
     }
 
     // remove messages with invalid severity from the pendinglines_ list
-    lineIndex = 0;
+    int lineIndex = 0;
     while (lineIndex < pendingLines_.size())
     {
       if (pendingLines_.at(lineIndex)->severity() > newSeverity)
       {
-        delete pendingLines_.at(lineIndex);
+        deleteLine_(pendingLines_.at(lineIndex));
         pendingLines_.removeAt(lineIndex);
       }
       else
@@ -462,8 +486,10 @@ void ConsoleDataModel::setNumLines(int numLines)
   if (numLines != numLines_ && numLines > 0)
   {
     numLines_ = numLines;
-    lines_.reserve(numLines_);
     limitData_();
+    setLineCapacity_(numLines_);
+    while (pendingLines_.size() > numLines_)
+      deleteLine_(pendingLines_.takeFirst());
   }
 }
 
@@ -479,29 +505,61 @@ void ConsoleDataModel::setSpamFilterTimeout(double seconds)
 
 void ConsoleDataModel::limitData_()
 {
-  int linesLimit = simCore::sdkMax(1, numLines());
-  if (lines_.size() > linesLimit)
-  {
-    // and the pop_front below isn't going to be sufficient to limit data.
-    int numToRemove = lines_.size() - linesLimit;
-
-    // Remove as many rows as needed to get under the numLines(); line removal location
-    // is based on what observers see, so if newest is on top (true), remove from bottom
-    if (newestOnTop())
-      beginRemoveRows(QModelIndex(), lines_.size() - numToRemove - 1, lines_.size() - 1);
-    else
-      beginRemoveRows(QModelIndex(), 0, numToRemove - 1);
-    QList<LineEntry*>::iterator endIter = lines_.begin() + numToRemove;
-    for (QList<LineEntry*>::iterator iter = lines_.begin(); iter != endIter; ++iter)
-    {
-      delete *iter;
-    }
-    lines_.erase(lines_.begin(), endIter);
-    endRemoveRows();
+  const int linesLimit = simCore::sdkMax(1, numLines());
+  if (lineCount_ > linesLimit)
+    removeLines_(0, lineCount_ - linesLimit);
+}
 
-    // Make sure the math is right for arguments to lines_.erase()
-    assert(lines_.size() == linesLimit);
+ConsoleDataModel::LineEntry* ConsoleDataModel::lineAt_(int position) const
+{
+  return lines_[(firstLine_ + position) % lines_.size()];
+}
+
+void ConsoleDataModel::removeLines_(int position, int count)
+{
+  if (count <= 0)
+    return;
+  assert(position >= 0 && position + count <= lineCount_);
+
+  // Line removal location is based on what observers see, so if newest is on top (true), rows count from the newest line
+  if (newestOnTop())
+    beginRemoveRows(QModelIndex(), lineCount_ - position - count, lineCount_ - position - 1);
+  else
+    beginRemoveRows(QModelIndex(), position, position + count - 1);
+
+  for (int k = position; k < position + count; ++k)
+    deleteLine_(lineAt_(k));
+  const int capacity = static_cast<int>(lines_.size());
+  if (position == 0)
+  {
+    // Removing the oldest lines only moves the start of the ring
+    firstLine_ = (firstLine_ + count) % capacity;
+  }
+  else
+  {
+    for (int k = position + count; k < lineCount_; ++k)
+      lines_[(firstLine_ + k - count) % capacity] = lines_[(firstLine_ + k) % capacity];
   }
+  lineCount_ -= count;
+  endRemoveRows();
+}
+
+void ConsoleDataModel::setLineCapacity_(int capacity)
+{
+  assert(capacity >= lineCount_);
+  std::vector<LineEntry*> newLines(capacity, nullptr);
+  for (int k = 0; k < lineCount_; ++k)
+    newLines[k] = lineAt_(k);
+  lines_.swap(newLines);
+  firstLine_ = 0;
+}
+
+void ConsoleDataModel::deleteLine_(LineEntry* line)
+{
+  auto it = recentLines_.find(LineKey(line->channel(), line->text()));
+  if (it != recentLines_.end() && it.value() == line)
+    recentLines_.erase(it);
+  delete line;
 }
 
 QVariant ConsoleDataModel::colorForSeverity_(simNotify::NotifySeverity severity) const
@@ -572,9 +630,9 @@ void ConsoleDataModel::setTimeFormatString(const QString& formatString)
   // Emit that the data has changed for the time column
   timeFormatString_ = formatString;
   // Return early if we have no data
-  if (lines_.empty())
+  if (lineCount_ == 0)
     return;
-  Q_EMIT dataChanged(index(0, COLUMN_TIME, QModelIndex()), index(lines_.size() - 1, COLUMN_TIME, QModelIndex()));
+  Q_EMIT dataChanged(index(0, COLUMN_TIME, QModelIndex()), index(lineCount_ - 1, COLUMN_TIME, QModelIndex()));
 }
 
 ////////////////////////////////////////
@@ -583,7 +641,8 @@ ConsoleDataModel::LineEntry::LineEntry(simNotify::NotifySeverity severity, const
   : time_(ConsoleDataModel::LineEntry::currentTime()),
     severity_(severity),
     channel_(channel),
-    text_(text)
+    text_(text),
+    repeatCount_(1)
 {
 }
 
@@ -612,6 +671,16 @@ QString ConsoleDataModel::LineEntry::text() const
   return text_;
 }
 
+int ConsoleDataModel::LineEntry::repeatCount() const
+{
+  return repeatCount_;
+}
+
+void ConsoleDataModel::LineEntry::addRepeat()
+{
+  ++repeatCount_;
+}
+
 /////////////////////////////////////////////////////////////////
 
 SimpleConsoleTextFilter::SimpleConsoleTextFilter()
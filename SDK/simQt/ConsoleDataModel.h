@@ -24,9 +24,12 @@
 #define SIMQT_CONSOLEDATAMODEL_H
 
 #include <memory>
+#include <vector>
 #include <QSortFilterProxyModel>
+#include <QHash>
 #include <QList>
 #include <QMap>
+#include <QPair>
 #include <QMetaType>
 #include "simNotify/NotifySeverity.h"
 #include "simCore/Common/Export.h"
@@ -77,6 +80,8 @@ public:
 
   /** Severity of the row, in conjunction with data() (regardless of column) */
   static const int SEVERITY_ROLE = Qt::UserRole + 1;
+  /** Number of times the row's text was received within the spam filter timeout, in conjunction with data() */
+  static const int REPEAT_COUNT_ROLE = Qt::UserRole + 2;
 
   /**
   * Define the data in each column of the model.
@@ -119,7 +124,10 @@ public:
   bool colorizeText() const;
   /** Returns the maximum length of the in-memory console, including all logged values */
   int numLines() const;
-  /** Returns the number of seconds of spam filtering to prevent duplicate messages on the console; 0 for none. */
+  /**
+   * Returns the number of seconds of spam filtering to prevent duplicate messages on the console; 0 for none.
+   * Duplicates are coalesced into the earlier line, incrementing its repeat count.
+   */
   double spamFilterTimeout() const;
   /** If true, newest entries are at the top of the model; else they're at bottom. */
   bool newestOnTop() const;
@@ -169,16 +177,27 @@ private Q_SLOTS:
   void processPendingAdds_();
 
 private:
+  class LineEntry;
+
   /** Appends a new entry to the data model; text must be single line with no newlines */
   void addPlainEntry_(simNotify::NotifySeverity severity, const QString& channel, const QString& text);
   /** Returns an appropriate color, given a severity (QVariant() return is possible for default color) */
   QVariant colorForSeverity_(simNotify::NotifySeverity severity) const;
   /** Applies a data limit to the number of entries in memory based on numLines() */
   void limitData_();
-  /** Returns true if there is a match to the channel/text, at or after the time supplied */
-  bool isDuplicateEntry_(const QString& channel, const QString& text, double sinceTime) const;
-
-  /** Immutable line entry class holds a single line of data */
+  /** Returns the most recent line, pending or not, matching the channel/text at or after the time supplied; nullptr if none */
+  LineEntry* findDuplicateEntry_(const QString& channel, const QString& text, double sinceTime) const;
+
+  /** Returns the line at the given position in the model, where 0 is the oldest line */
+  LineEntry* lineAt_(int position) const;
+  /** Removes lines from the model, starting at the given position; emits the row removal */
+  void removeLines_(int position, int count);
+  /** Changes the capacity of the line ring, keeping the lines in the model; capacity must not be less than lineCount_ */
+  void setLineCapacity_(int capacity);
+  /** Removes the line from the duplicate lookup and deletes it */
+  void deleteLine_(LineEntry* line);
+
+  /** Line entry class holds a single line of data; only the repeat count changes after creation */
   class LineEntry
   {
   public:
@@ -188,16 +207,21 @@ private:
     simNotify::NotifySeverity severity() const;
     QString channel() const;
     QString text() const;
+    /** Number of times this line was received; starts at 1 */
+    int repeatCount() const;
+    /** Counts another receipt of this line */
+    void addRepeat();
 
   private:
     double time_;
     simNotify::NotifySeverity severity_;
     QString channel_;
     QString text_;
+    int repeatCount_;
   };
 
-  /** Returns true if there is a match, but only searching a single QList<> */
-  bool isDuplicateEntry_(const QList<LineEntry*>& whichList, const QString& channel, const QString& text, double sinceTime) const;
+  /** Key for the duplicate lookup: channel and text */
+  typedef QPair<QString, QString> LineKey;
 
   class ChannelImpl;
   /// Map of channel name to channel pointer
@@ -212,10 +236,18 @@ private:
   double spamFilterTimeout_;
   /// Minimum severity level for messages to keep in the model
   simNotify::NotifySeverity minSeverity_;
-  /// (Automatically) Sorted list of added lines
-  QList<LineEntry*> lines_;
-  /// (Automatically) Sorted list of lines ready to be added, but not yet put into the data model
+  /// Fixed capacity ring of lines in the model, sized to numLines(); sorted by time starting at firstLine_
+  std::vector<LineEntry*> lines_;
+  /// Index into lines_ of the oldest line
+  int firstLine_;
+  /// Number of lines in the model
+  int lineCount_;
+  /// (Automatically) Sorted list of lines ready to be added, but not yet put into the data model; at most numLines() long
   QList<LineEntry*> pendingLines_;
+  /// Most recent line for each channel and text, pending or in the model, for the spam filter
+  QHash<LineKey, LineEntry*> recentLines_;
+  /// True when the repeat count of a line in the model changed since the last processing of pending data
+  bool repeatsChanged_;
 
   /// Contains a list of all entry filters to apply before adding data
   QList<EntryFilterPtr> entryFilters_;
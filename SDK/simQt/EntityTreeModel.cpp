@@ -20,6 +20,8 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <limits>
 #include <QString>
 #include <QTimer>
 
@@ -32,9 +34,8 @@
 
 namespace simQt {
 
-// Performance can drop dramatically if there are too many regions to delete; stop after 50 regions and reset the model
-static const size_t MAX_REGIONS = 50;
-
+/// Removals with more continuous regions than this reset the model instead of signaling each region
+static const int MAX_REMOVAL_REGIONS = 50;
 
 /// notify the tree model about data store changes
 class EntityTreeModel::TreeListener : public simData::DataStore::DefaultListener
@@ -90,6 +91,8 @@ EntityTreeItem::EntityTreeItem(simData::DataStore* ds, simData::ObjectId id, sim
   : id_(id),
     type_(type),
     parentItem_(parent),
+    row_(0),
+    staleRowsBegin_(std::numeric_limits<int>::max()),
     markForRemoval_(false)
 {
   if (id_ != 0)
@@ -113,7 +116,7 @@ EntityTreeItem::~EntityTreeItem()
 
 void EntityTreeItem::appendChild(EntityTreeItem *item)
 {
-  childToRowIndex_[item] = childItems_.size();
+  item->row_ = static_cast<int>(childItems_.size());
   childItems_.append(item);
 }
 
@@ -183,18 +186,24 @@ EntityTreeItem* EntityTreeItem::parent()
 
 int EntityTreeItem::row() const
 {
-  if (parentItem_)
+  if (parentItem_ == nullptr)
+    return 0;
+
+  // Removing siblings shifts the rows after them; only renumber when this item is actually affected
+  if (parentItem_->childItems_.value(row_) != this)
   {
-    auto it = parentItem_->childToRowIndex_.find(this);
-    if (it != parentItem_->childToRowIndex_.end())
-    {
-      // verify the childToRowIndex_ map is correct
-      assert(parentItem_->childItems_[it->second] == this);
-      return it->second;
-    }
+    parentItem_->renumberChildren_();
+    if (parentItem_->childItems_.value(row_) != this)
+      return 0;
   }
+  return row_;
+}
 
-  return 0;
+void EntityTreeItem::renumberChildren_()
+{
+  for (int ii = staleRowsBegin_; ii < childItems_.size(); ++ii)
+    childItems_[ii]->row_ = ii;
+  staleRowsBegin_ = std::numeric_limits<int>::max();
 }
 
 void EntityTreeItem::markForRemoval()
@@ -233,7 +242,10 @@ void EntityTreeItem::markChildrenForRemoval_()
 
 int EntityTreeItem::removeMarkedChildren(EntityTreeModel* model)
 {
-  markForRemoval_ = false;
+  // A marked item is deleted along with all of its children by its parent, so there is no
+  // need to signal the removal of the children individually
+  if (markForRemoval_)
+    return 0;
 
   // Trim the tree from bottom up
   for (auto child : childItems_)
@@ -250,74 +262,99 @@ int EntityTreeItem::removeMarkedChildren(EntityTreeModel* model)
   if (static_cast<int>(childrenMarked_.size()) == childItems_.size())
   {
     model->beginRemoval(this, 0, childItems_.size() - 1);
-    for (auto ii = 0; ii < childItems_.size(); ++ii)
-      model->clearIndex(childItems_[ii]->id());
-    childItems_.clear();
-    childToRowIndex_.clear();
+    removeChildren_(model, 0, static_cast<int>(childItems_.size()));
     childrenMarked_.clear();
     model->endRemoval();
     return 0;
   }
 
-  // For better performance delete continuous regions of children
-
-  // Calculate regions
-  std::map<int, int> indexToDelta;
-  auto removalIt = childrenMarked_.begin();
-  int lastIndex = *removalIt;
-  int previousIndex = lastIndex;
-  ++removalIt;
-  int delta = 1;
-  for (; removalIt != childrenMarked_.end(); ++removalIt)
+  // For better performance delete continuous regions of children.  Delete regions backwards so
+  // the marked rows still to be processed do not shift; the cached rows of the siblings after
+  // each region are renumbered lazily by row().
+  auto removalIt = childrenMarked_.rbegin();
+  while (removalIt != childrenMarked_.rend())
   {
-    // If not continuous make a new entry
-    if (*removalIt != (previousIndex + 1))
-    {
-      // If too many, give up and reset the model
-      if (indexToDelta.size() > MAX_REGIONS)
-        return 1;
+    const int last = *removalIt;
+    int first = last;
+    for (++removalIt; (removalIt != childrenMarked_.rend()) && (*removalIt == first - 1); ++removalIt)
+      --first;
 
-      indexToDelta[lastIndex] = delta;
-      lastIndex = *removalIt;
-      delta = 1;
-    }
-    else
-      ++delta;
-
-    previousIndex = *removalIt;
+    model->beginRemoval(this, first, last);
+    removeChildren_(model, first, last - first + 1);
+    model->endRemoval();
   }
 
-  indexToDelta[lastIndex] = delta;
+  childrenMarked_.clear();
+  return 0;
+}
+
+int EntityTreeItem::countRemovalRegions() const
+{
+  // Children of a marked item go with it
+  if (markForRemoval_)
+    return 0;
+
+  int count = 0;
+  for (auto child : childItems_)
+    count += child->countRemovalRegions();
 
-  // Delete regions backwards so indexes do not need to be recalculated
-  for (auto it = indexToDelta.rbegin(); it != indexToDelta.rend(); ++it)
+  int previous = -2;
+  for (int row : childrenMarked_)
   {
-    // minus one on last argument because Qt is inclusive
-    model->beginRemoval(this, it->first, it->first + it->second - 1);
+    if (row != previous + 1)
+      ++count;
+    previous = row;
+  }
+  return count;
+}
 
-    // remove from the childToRowIndex_ map and from the model's index map
-    for (auto ii = it->first; ii < it->first + it->second; ++ii)
-    {
-      childToRowIndex_.erase(childItems_[ii]);
-      model->clearIndex(childItems_[ii]->id());
-    }
+void EntityTreeItem::compactMarkedChildren(EntityTreeModel* model)
+{
+  if (markForRemoval_)
+    return;
 
-    // remove from list
-    childItems_.erase(childItems_.begin() + it->first, childItems_.begin() + it->first + it->second);
+  for (auto child : childItems_)
+    child->compactMarkedChildren(model);
 
-    // Apply the deltas
-    for (auto& rowIndex : childToRowIndex_)
+  if (childrenMarked_.empty())
+    return;
+
+  // Slide the kept children down over the removed ones, then erase the tail once
+  int kept = *childrenMarked_.begin();
+  staleRowsBegin_ = std::min(staleRowsBegin_, kept);
+  auto marked = childrenMarked_.begin();
+  for (int ii = kept; ii < childItems_.size(); ++ii)
+  {
+    if (marked != childrenMarked_.end() && *marked == ii)
     {
-      // only need to modify the indexes above the removed region
-      if (rowIndex.second > it->first)
-        rowIndex.second -= it->second;
+      deleteChild_(model, childItems_[ii]);
+      ++marked;
     }
-
-    model->endRemoval();
+    else
+      childItems_[kept++] = childItems_[ii];
   }
-
+  childItems_.erase(childItems_.begin() + kept, childItems_.end());
   childrenMarked_.clear();
-  return 0;
+}
+
+void EntityTreeItem::removeChildren_(EntityTreeModel* model, int first, int count)
+{
+  for (int ii = first; ii < first + count; ++ii)
+    deleteChild_(model, childItems_[ii]);
+  childItems_.erase(childItems_.begin() + first, childItems_.begin() + first + count);
+  staleRowsBegin_ = std::min(staleRowsBegin_, first);
+}
+
+void EntityTreeItem::deleteChild_(EntityTreeModel* model, EntityTreeItem* child)
+{
+  std::vector<uint64_t> ids;
+  ids.push_back(child->id());
+  child->getChildrenIds(ids);
+  for (auto id : ids)
+    model->clearIndex(id);
+
+  // Items are deleted with their children
+  delete child;
 }
 
 //-----------------------------------------------------------------------------------------
@@ -412,7 +449,20 @@ void EntityTreeModel::queueCategoryDataChange_(uint64_t id)
 
 void EntityTreeModel::commitDelayedAdd_()
 {
-  for (auto uniqueId : delayedAdds_)
+  if (delayedAdds_.empty())
+    return;
+
+  // Swap out the queue in case a listener on the model signals asks for an index
+  std::vector<simData::ObjectId> adds;
+  adds.swap(delayedAdds_);
+
+  // Create all of the items first, then attach them with a single row insertion per parent.
+  // Items whose host is added in the same batch are attached directly, since the host is
+  // not yet part of the model.
+  std::vector<std::pair<EntityTreeItem*, std::vector<EntityTreeItem*> > > insertions;
+  std::unordered_map<EntityTreeItem*, size_t> parentToInsertion;
+  std::unordered_map<simData::ObjectId, EntityTreeItem*> newItems;
+  for (auto uniqueId : adds)
   {
     simData::ObjectType entityType = dataStore_->objectType(uniqueId);
     if (entityType == simData::NONE)
@@ -435,12 +485,77 @@ void EntityTreeModel::commitDelayedAdd_()
 
     // Only add the item if it's a valid top level entity, or if it has a valid host
     assert(!((hostId == 0) && entityTypeNeedsHost));
-    if ((hostId > 0 || !entityTypeNeedsHost))
+    if ((hostId == 0) && entityTypeNeedsHost)
+      continue;
+
+    // adding a duplicate
+    assert(findItem_(uniqueId) == nullptr && newItems.find(uniqueId) == newItems.end());
+    if ((findItem_(uniqueId) != nullptr) || (newItems.find(uniqueId) != newItems.end()))
+      continue;
+
+    EntityTreeItem* parentItem = rootItem_;
+    bool parentIsNew = false;
+    if (hostId != 0)
     {
-      addTreeItem_(uniqueId, entityType, hostId);
+      parentItem = findItem_(hostId);
+      if (parentItem == nullptr)
+      {
+        auto newIt = newItems.find(hostId);
+        if (newIt != newItems.end())
+        {
+          parentItem = newIt->second;
+          parentIsNew = true;
+        }
+      }
+
+      if (parentItem == nullptr)
+      {
+        // itemsById_ is out of sync WRT tree
+        assert(false);
+        continue;
+      }
+
+      if (!treeView_)
+      {
+        parentItem = rootItem_;
+        parentIsNew = false;
+      }
     }
+
+    EntityTreeItem* newItem = new EntityTreeItem(dataStore_, uniqueId, entityType, parentItem);
+    newItems[uniqueId] = newItem;
+    if (parentIsNew)
+    {
+      parentItem->appendChild(newItem);
+      continue;
+    }
+
+    auto inserted = parentToInsertion.insert(std::make_pair(parentItem, insertions.size()));
+    if (inserted.second)
+      insertions.push_back(std::make_pair(parentItem, std::vector<EntityTreeItem*>()));
+    insertions[inserted.first->second].second.push_back(newItem);
+  }
+
+  for (const auto& insertion : insertions)
+  {
+    EntityTreeItem* parentItem = insertion.first;
+    const QModelIndex parentIndex = (parentItem == rootItem_) ? QModelIndex() : createIndex(parentItem->row(), 0, parentItem);
+    const int first = parentItem->childCount();
+    beginInsertRows(parentIndex, first, first + static_cast<int>(insertion.second.size()) - 1);
+    for (auto newItem : insertion.second)
+    {
+      parentItem->appendChild(newItem);
+      addToIndex_(newItem);
+    }
+    endInsertRows();
   }
-  delayedAdds_.clear();
+}
+
+void EntityTreeModel::addToIndex_(EntityTreeItem* item)
+{
+  itemsById_[item->id()] = item;
+  for (int ii = 0; ii < item->childCount(); ++ii)
+    addToIndex_(item->child(ii));
 }
 
 void EntityTreeModel::commitAllDelayed_()
@@ -601,6 +716,7 @@ void EntityTreeModel::forceRefresh()
     // Get platform objects from DataStore
     simData::DataStore::IdList platformList;
     dataStore_->idList(&platformList, simData::PLATFORM);
+    itemsById_.reserve(platformList.size());
     buildTree_(simData::PLATFORM, dataStore_, platformList, nullptr);
     if (customAsTopLevel_)
     {
@@ -623,7 +739,7 @@ void EntityTreeModel::forceRefresh()
 
 EntityTreeItem* EntityTreeModel::findItem_(uint64_t entityId) const
 {
-  std::map<simData::ObjectId, EntityTreeItem*>::const_iterator it = itemsById_.find(entityId);
+  auto it = itemsById_.find(entityId);
   if (it != itemsById_.end())
     return it->second;
 
@@ -1057,9 +1173,20 @@ void EntityTreeModel::commitDelayedRemoval_()
     return;
 
   delayedRemovals_ = false;
+
+  // Each region costs a signal pair and a shift of the later rows, so scattered removals are
+  // cheaper as one reset that compacts each list of children in a single pass
+  if (rootItem_->countRemovalRegions() > MAX_REMOVAL_REGIONS)
+  {
+    beginResetModel();
+    rootItem_->compactMarkedChildren(this);
+    endResetModel();
+    return;
+  }
+
   if (rootItem_->removeMarkedChildren(this) != 0)
   {
-    // too many regions to delete, give up and reset the model
+    // tree is out of sync, give up and reset the model
     forceRefresh();
   }
 }
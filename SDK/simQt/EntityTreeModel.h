@@ -24,6 +24,7 @@
 #define SIMQT_ENTITYTREE_MODEL_H
 
 #include <set>
+#include <unordered_map>
 #include <QTreeWidgetItem>
 #include "simCore/Common/Common.h"
 #include "simData/DataStore.h"
@@ -81,15 +82,30 @@ public:
   /// Return true if the item is marked for removal
   bool isMarked() const;
   /**
-   * Remove the children marked for removal; recursive down to the leaf node
+   * Remove the children marked for removal; recursive down to the leaf node.  Each continuous
+   * region of marked children is removed with a single pair of Qt signals.
    * @param model The model for the items, needed to generate the appropriate Qt signals
    * @return 0 on success; non zero on failure and the model must be rebuilt.
    */
   int removeMarkedChildren(EntityTreeModel* model);
+  /** Returns the number of continuous regions of marked children removeMarkedChildren() would signal; recursive */
+  int countRemovalRegions() const;
+  /**
+   * Remove the children marked for removal without Qt signals; recursive down to the leaf node.
+   * Each list of children is compacted in a single pass.  Caller must reset the model around the call.
+   * @param model The model for the items, needed to clear the removed items from its index
+   */
+  void compactMarkedChildren(EntityTreeModel* model);
 
 protected:
   void notifyParentForRemoval_(EntityTreeItem* child);
   void markChildrenForRemoval_();
+  /** Removes and deletes count children starting at row first, clearing them and their children from the model's index */
+  void removeChildren_(EntityTreeModel* model, int first, int count);
+  /** Deletes the child, clearing it and its children from the model's index; does not remove it from childItems_ */
+  void deleteChild_(EntityTreeModel* model, EntityTreeItem* child);
+  /** Updates the cached row of the children whose rows shifted due to removals */
+  void renumberChildren_();
 
   simData::ObjectId id_; ///< id of the entity represented
   simData::ObjectType type_; ///< type of the entity
@@ -98,7 +114,8 @@ protected:
   bool highlight_;
   EntityTreeItem *parentItem_;  ///< parent of the item.  Null if top item
   QList<EntityTreeItem*> childItems_;  ///< Children of item, if any.  If no children, than item is a leaf
-  std::map<const EntityTreeItem*, int> childToRowIndex_; ///< Use a map to cache the row index for better performance
+  int row_;  ///< Cached row of this item in the parent; only valid if the parent has no stale rows at or before it
+  int staleRowsBegin_;  ///< First child row whose cached row may be out of date due to a removal
   bool markForRemoval_;  ///< This item is marked for removal
   std::set<int> childrenMarked_;  ///< Children of this item that are marked for removal
 };
@@ -195,6 +212,8 @@ private:
     const simData::DataStore::IdList& ids, EntityTreeItem *parent);
   EntityTreeItem* findItem_(uint64_t entityId) const;
   void addTreeItem_(uint64_t id, simData::ObjectType type, uint64_t parentId);
+  /** Adds the item and all of its children to itemsById_ */
+  void addToIndex_(EntityTreeItem* item);
 
   /** Queue the removal of the entity specified by the id */
   void queueRemoval_(uint64_t id);
@@ -208,7 +227,7 @@ private:
   void queueCategoryDataChange_(uint64_t id);
   /** Process any queue actions */
   void commitAllDelayed_();
-  /** Add any delayed entities */
+  /** Add any delayed entities, with one row insertion per parent */
   void commitDelayedAdd_();
   /** Remove any delayed entities */
   void commitDelayedRemoval_();
@@ -219,7 +238,7 @@ private:
   int countEntityTypes_(EntityTreeItem* parent, simData::ObjectType type) const;
 
   EntityTreeItem *rootItem_;  ///< Top of the entity tree
-  std::map<simData::ObjectId, EntityTreeItem*> itemsById_; ///< same information as rootItem, but keyed off of Object ID
+  std::unordered_map<simData::ObjectId, EntityTreeItem*> itemsById_; ///< same information as rootItem, but keyed off of Object ID
   bool treeView_;   ///< true = tree view; false = list view
   simData::DataStore* dataStore_;
   simData::DataStore::ListenerPtr listener_;
@@ -96,7 +96,9 @@ namespace
 
 //=====================================================================================
 SQLiteDataBaseReadUtil::SQLiteDataBaseReadUtil()
-  : textureSetSelectCommand_(""),
+  : cacheSize_(QS_DEFAULT_CACHE_SIZE),
+  mmapSize_(0),
+  textureSetSelectCommand_(""),
   tsInsertFileIdData_(2),
   tsInsertSetTextureSetName_(1),
   tsInsertSetIdRasterFormat_(2),
@@ -132,6 +134,30 @@ SQLiteDataBaseReadUtil::~SQLiteDataBaseReadUtil()
 {
 }
 
+//-------------------------------------------------------------------------------------
+void SQLiteDataBaseReadUtil::setCacheSize(int cacheSize)
+{
+  cacheSize_ = cacheSize;
+}
+
+//-------------------------------------------------------------------------------------
+int SQLiteDataBaseReadUtil::cacheSize() const
+{
+  return cacheSize_;
+}
+
+//-------------------------------------------------------------------------------------
+void SQLiteDataBaseReadUtil::setMmapSize(int64_t mmapSize)
+{
+  mmapSize_ = mmapSize;
+}
+
+//-------------------------------------------------------------------------------------
+int64_t SQLiteDataBaseReadUtil::mmapSize() const
+{
+  return mmapSize_;
+}
+
 //-------------------------------------------------------------------------------------
 QsErrorType SQLiteDataBaseReadUtil::openDatabaseFile(const std::string& dbFileName,
   sqlite3** sqlite3Db,
@@ -150,11 +176,21 @@ QsErrorType SQLiteDataBaseReadUtil::openDatabaseFile(const std::string& dbFileNa
     std::cerr << "openDatabaseFile sqlite3_open_v2 Error: " << dbFileName << "\n" << printExtendedErrorMessage(*sqlite3Db);
     return QS_IS_UNABLE_TO_OPEN_DB;
   }
-  if (sqlite3_exec(*sqlite3Db, "PRAGMA CACHE_SIZE=100;", nullptr, nullptr, nullptr) != SQLITE_OK)
+  const std::string cachePragma = "PRAGMA CACHE_SIZE=" + std::to_string(cacheSize_) + ";";
+  if (sqlite3_exec(*sqlite3Db, cachePragma.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK)
   {
     std::cerr << "Unable to set SQLite cache size " << dbFileName << "\n";
     std::cerr << printExtendedErrorMessage(*sqlite3Db);
   }
+  if (mmapSize_ > 0)
+  {
+    const std::string mmapPragma = "PRAGMA MMAP_SIZE=" + std::to_string(mmapSize_) + ";";
+    if (sqlite3_exec(*sqlite3Db, mmapPragma.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+      std::cerr << "Unable to set SQLite memory map size " << dbFileName << "\n";
+      std::cerr << printExtendedErrorMessage(*sqlite3Db);
+    }
+  }
 
   return QS_IS_OK;
 }
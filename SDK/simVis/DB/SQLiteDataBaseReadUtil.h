@@ -36,6 +36,8 @@ namespace simCore { class TimeStamp; }
 namespace simVis_db
 {
   static const char* QS_TO_ID = "id";
+  /** Default PRAGMA CACHE_SIZE for opened databases, in pages */
+  static const int QS_DEFAULT_CACHE_SIZE = 100;
 
   //=====================================================================================
   static const char* QS_DEFAULT_SET_TABLE_NAME = "default";
@@ -43,12 +45,28 @@ namespace simVis_db
   static const char* QS_TSO_NAME_OF_TEXTURE_SET_TABLE = "nt";
 
   //=====================================================================================
-  class SQLiteDataBaseReadUtil
+  class SDKVIS_EXPORT SQLiteDataBaseReadUtil
   {
   public:
     SQLiteDataBaseReadUtil();
     virtual ~SQLiteDataBaseReadUtil();
 
+    /**
+     * Sets the page cache size applied to databases opened by openDatabaseFile()
+     * @param[in] cacheSize Value for PRAGMA CACHE_SIZE; positive values are pages, negative values are KiB.  Defaults to QS_DEFAULT_CACHE_SIZE.
+     */
+    void setCacheSize(int cacheSize);
+    /** Retrieves the page cache size applied to opened databases */
+    int cacheSize() const;
+
+    /**
+     * Sets the number of bytes of the file to memory map in databases opened by openDatabaseFile()
+     * @param[in] mmapSize Value for PRAGMA MMAP_SIZE; 0 (default) disables memory mapped I/O
+     */
+    void setMmapSize(int64_t mmapSize);
+    /** Retrieves the number of bytes memory mapped in opened databases */
+    int64_t mmapSize() const;
+
     /** Opens a database file */
     QsErrorType openDatabaseFile(const std::string& dbFileName,
                                   sqlite3** sqlite3Db,
@@ -110,6 +128,8 @@ namespace simVis_db
                                   bool displayErrorMessage=false) const;
   protected:
     int sizeOfIdBlob_;
+    int cacheSize_;
+    int64_t mmapSize_;
 
     std::string textureSetSelectCommand_;
     std::string textureSetSelectFileCommand1_;
@@ -0,0 +1,334 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <iterator>
+#include "simCore/System/ThreadPool.h"
+#include "swapbytes.h"
+#include "SQLiteTileReader.h"
+
+namespace simVis_db {
+
+namespace
+{
+  /** Column of the tile data in a texture set table; matches SQLiteDataBaseReadUtil::tsInsertFileIdData_ */
+  static const int DATA_COLUMN = 1;
+
+  /** Maximum number of queued prefetch requests; requests this far behind the viewer are unlikely to be useful */
+  static const size_t MAX_PENDING_PREFETCHES = 64;
+
+  /** Maximum number of prefetched tiles in the cache; entries for nodes without data take no bytes, so bytes alone do not bound the cache */
+  static const size_t MAX_CACHE_ENTRIES = 1024;
+}
+
+//=====================================================================================
+struct SQLiteTileReader::Connection
+{
+  sqlite3* db = nullptr;
+  sqlite3_stmt* stmt = nullptr;
+
+  ~Connection()
+  {
+    if (stmt != nullptr)
+      sqlite3_finalize(stmt);
+    if (db != nullptr)
+      sqlite3_close(db);
+  }
+};
+
+//=====================================================================================
+SQLiteTileReader::SQLiteTileReader(const std::string& dbFileName, const std::string& dataTableName, int cacheSize, int64_t mmapSize)
+  : dbFileName_(dbFileName),
+  cacheBytes_(0),
+  maxCacheBytes_(0),
+  numPrefetchHits_(0)
+{
+  dbUtil_.setCacheSize(cacheSize);
+  dbUtil_.setMmapSize(mmapSize);
+
+  // Same command as SQLiteDataBaseReadUtil::readDataBuffer(); names with quotes are rejected to avoid injections
+  if (!dataTableName.empty() && dataTableName.find('"') == std::string::npos)
+  {
+    selectCommand_ = "SELECT * From \"";
+    selectCommand_.append(dataTableName);
+    selectCommand_.append("\" WHERE ");
+    selectCommand_.append(QS_TO_ID);
+    selectCommand_.append("=?");
+  }
+  else
+    std::cerr << "SQLiteTileReader invalid table name (" << dataTableName << ")\n";
+}
+
+//-------------------------------------------------------------------------------------
+SQLiteTileReader::~SQLiteTileReader()
+{
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    pending_.clear();
+  }
+  // Waits for an in-progress prefetch; remaining queued tasks find nothing pending
+  prefetchPool_.reset();
+}
+
+//-------------------------------------------------------------------------------------
+QsErrorType SQLiteTileReader::readTile(const FaceIndexType& faceIndex, const QSNodeId& nodeID, const TileConsumer& consumer, bool displayErrorMessage)
+{
+  const std::string tileId = packTileId(faceIndex, nodeID);
+
+  CacheEntry cached;
+  bool isCached = false;
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    if (maxCacheBytes_ > 0)
+    {
+      // A tile is read once by the foreground, so a hit is moved out of the cache
+      auto it = cache_.find(tileId);
+      if (it != cache_.end())
+      {
+        cached.found = it->second.found;
+        cached.data.swap(it->second.data);
+        cacheBytes_ -= cached.data.size();
+        cacheAge_.erase(it->second.age);
+        cache_.erase(it);
+        isCached = true;
+        ++numPrefetchHits_;
+      }
+      else
+      {
+        // No need for the background thread to read what the foreground is about to read
+        auto pendingIt = std::find(pending_.begin(), pending_.end(), tileId);
+        if (pendingIt != pending_.end())
+          pending_.erase(pendingIt);
+      }
+    }
+  }
+
+  if (isCached)
+  {
+    if (cached.found && !cached.data.empty())
+      consumer(cached.data.data(), static_cast<uint32_t>(cached.data.size()));
+    return QS_IS_OK;
+  }
+  return readFromDb_(tileId, consumer, displayErrorMessage);
+}
+
+//-------------------------------------------------------------------------------------
+void SQLiteTileReader::setPrefetchCacheSize(size_t cacheBytes)
+{
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  maxCacheBytes_ = cacheBytes;
+  if (maxCacheBytes_ == 0)
+    pending_.clear();
+  trimCache_();
+  // Calling thread counts as one of the pool's threads, so this starts a single background worker
+  if (maxCacheBytes_ > 0 && !prefetchPool_)
+    prefetchPool_.reset(new simCore::ThreadPool(2));
+}
+
+//-------------------------------------------------------------------------------------
+size_t SQLiteTileReader::prefetchCacheSize() const
+{
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  return maxCacheBytes_;
+}
+
+//-------------------------------------------------------------------------------------
+void SQLiteTileReader::prefetch(const FaceIndexType& faceIndex, const QSNodeId& nodeID)
+{
+  const std::string tileId = packTileId(faceIndex, nodeID);
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    if (maxCacheBytes_ == 0 || cache_.find(tileId) != cache_.end() ||
+      std::find(pending_.begin(), pending_.end(), tileId) != pending_.end())
+      return;
+    if (pending_.size() >= MAX_PENDING_PREFETCHES)
+      pending_.pop_front();
+    pending_.push_back(tileId);
+  }
+  // Each task reads the most recent request, so the queue behaves as a stack of what the viewer needs next
+  prefetchPool_->execute([this]() { runPrefetch_(); });
+}
+
+//-------------------------------------------------------------------------------------
+void SQLiteTileReader::cancelPrefetch()
+{
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  pending_.clear();
+}
+
+//-------------------------------------------------------------------------------------
+size_t SQLiteTileReader::numPrefetchHits() const
+{
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  return numPrefetchHits_;
+}
+
+//-------------------------------------------------------------------------------------
+std::string SQLiteTileReader::packTileId(const FaceIndexType& faceIndex, const QSNodeId& nodeID)
+{
+  std::string tileId(sizeof(FaceIndexType) + nodeID.sizeOf(), '\0');
+  uint8_t* idBlob = reinterpret_cast<uint8_t*>(&tileId[0]);
+  beWrite(idBlob, &faceIndex);
+  nodeID.pack(idBlob + sizeof(FaceIndexType));
+  return tileId;
+}
+
+//-------------------------------------------------------------------------------------
+std::unique_ptr<SQLiteTileReader::Connection> SQLiteTileReader::acquireConnection_(QsErrorType& err, bool displayErrorMessage)
+{
+  {
+    std::lock_guard<std::mutex> lock(connectionMutex_);
+    if (!idleConnections_.empty())
+    {
+      std::unique_ptr<Connection> connection = std::move(idleConnections_.back());
+      idleConnections_.pop_back();
+      err = QS_IS_OK;
+      return connection;
+    }
+  }
+
+  if (selectCommand_.empty())
+  {
+    err = QS_IS_PREPARE_ERROR;
+    return nullptr;
+  }
+
+  // Connection is only ever used by one thread at a time, so SQLite's own locking is not needed
+  std::unique_ptr<Connection> connection(new Connection);
+  err = dbUtil_.openDatabaseFile(dbFileName_, &connection->db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX);
+  if (err != QS_IS_OK)
+    return nullptr;
+
+  const int returnValue = sqlite3_prepare_v2(connection->db, selectCommand_.c_str(), static_cast<int>(selectCommand_.length()), &connection->stmt, nullptr);
+  if (returnValue != SQLITE_OK)
+  {
+    if (returnValue == SQLITE_BUSY || returnValue == SQLITE_LOCKED)
+    {
+      err = QS_IS_BUSY;
+      return nullptr;
+    }
+    if (displayErrorMessage)
+      std::cerr << "SQLiteTileReader sqlite3_prepare_v2 Error(" << returnValue << "): " << dbFileName_ << "\n  " << sqlite3_errmsg(connection->db) << "\n";
+    err = QS_IS_PREPARE_ERROR;
+    return nullptr;
+  }
+  return connection;
+}
+
+//-------------------------------------------------------------------------------------
+void SQLiteTileReader::releaseConnection_(std::unique_ptr<Connection> connection)
+{
+  std::lock_guard<std::mutex> lock(connectionMutex_);
+  idleConnections_.push_back(std::move(connection));
+}
+
+//-------------------------------------------------------------------------------------
+QsErrorType SQLiteTileReader::readFromDb_(const std::string& tileId, const TileConsumer& consumer, bool displayErrorMessage)
+{
+  QsErrorType err = QS_IS_OK;
+  std::unique_ptr<Connection> connection = acquireConnection_(err, displayErrorMessage);
+  if (!connection)
+    return err;
+
+  sqlite3_stmt* stmt = connection->stmt;
+  // tileId outlives the statement's use of the binding, which is cleared below
+  int returnValue = sqlite3_bind_blob(stmt, 1, tileId.data(), static_cast<int>(tileId.size()), SQLITE_STATIC);
+  const char* failedCall = "sqlite3_bind_blob";
+  if (returnValue == SQLITE_OK)
+  {
+    returnValue = sqlite3_step(stmt);
+    failedCall = "sqlite3_step";
+  }
+
+  if (returnValue == SQLITE_ROW)
+  {
+    // Blob remains valid until the statement is reset, so it is handed to the consumer in place
+    const TextureDataType* data = static_cast<const TextureDataType*>(sqlite3_column_blob(stmt, DATA_COLUMN));
+    const int dataSize = sqlite3_column_bytes(stmt, DATA_COLUMN);
+    if (data != nullptr && dataSize > 0)
+      consumer(data, static_cast<uint32_t>(dataSize));
+    err = QS_IS_OK;
+  }
+  else if (returnValue == SQLITE_DONE)
+    err = QS_IS_OK;
+  else if (returnValue == SQLITE_BUSY || returnValue == SQLITE_LOCKED)
+    err = QS_IS_BUSY;
+  else
+  {
+    if (displayErrorMessage)
+      std::cerr << "SQLiteTileReader " << failedCall << " Error(" << returnValue << "): " << dbFileName_ << "\n  " << sqlite3_errmsg(connection->db) << "\n";
+    err = QS_IS_UNABLE_TO_READ_DATA_BUFFER;
+  }
+
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  releaseConnection_(std::move(connection));
+  return err;
+}
+
+//-------------------------------------------------------------------------------------
+void SQLiteTileReader::runPrefetch_()
+{
+  std::string tileId;
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    if (pending_.empty())
+      return;
+    tileId = std::move(pending_.back());
+    pending_.pop_back();
+  }
+
+  CacheEntry entry;
+  const QsErrorType err = readFromDb_(tileId, [&entry](const TextureDataType* data, uint32_t dataSize) {
+    entry.found = true;
+    entry.data.assign(data, data + dataSize);
+  }, false);
+  // Errors are left for the foreground read to report
+  if (err != QS_IS_OK)
+    return;
+
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  if (maxCacheBytes_ == 0 || entry.data.size() > maxCacheBytes_ || cache_.find(tileId) != cache_.end())
+    return;
+  cacheBytes_ += entry.data.size();
+  cacheAge_.push_back(tileId);
+  entry.age = std::prev(cacheAge_.end());
+  cache_[tileId] = std::move(entry);
+  trimCache_();
+}
+
+//-------------------------------------------------------------------------------------
+void SQLiteTileReader::trimCache_()
+{
+  while (!cacheAge_.empty() && (maxCacheBytes_ == 0 || cacheBytes_ > maxCacheBytes_ || cache_.size() > MAX_CACHE_ENTRIES))
+  {
+    auto it = cache_.find(cacheAge_.front());
+    assert(it != cache_.end());
+    cacheBytes_ -= it->second.data.size();
+    cache_.erase(it);
+    cacheAge_.pop_front();
+  }
+}
+
+}
@@ -0,0 +1,153 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMVIS_DB_SQLITETILEREADER_H
+#define SIMVIS_DB_SQLITETILEREADER_H
+
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "QSCommon.h"
+#include "QSError.h"
+#include "QSNodeID96.h"
+#include "SQLiteDataBaseReadUtil.h"
+
+namespace simCore { class ThreadPool; }
+
+namespace simVis_db
+{
+  //=====================================================================================
+  /**
+   * Reads tiles from a texture set table, for concurrent use by tile loading threads.
+   *
+   * Reads check out a read only connection from a shared pool for their duration, so concurrent
+   * reads each use a different connection; connections keep an already prepared select statement
+   * between reads, so reads neither serialize on a single connection nor re-prepare SQL.
+   * Tile data is passed to the caller directly from SQLite's row buffer, without an intermediate copy.
+   *
+   * Tiles can optionally be prefetched by a background thread into a bounded memory cache, so that
+   * a later readTile() for the same tile is served without touching the database.
+   */
+  class SDKVIS_EXPORT SQLiteTileReader
+  {
+  public:
+    /** Receives a tile's data; the data pointer is only valid for the duration of the call */
+    typedef std::function<void(const TextureDataType* data, uint32_t dataSize)> TileConsumer;
+
+    /**
+     * Creates a reader.  Connections are opened on demand, when a read finds no idle connection in the pool.
+     * @param[in] dbFileName Name of a SQLite database file
+     * @param[in] dataTableName Name of the texture set table to read from
+     * @param[in] cacheSize Value for each connection's PRAGMA CACHE_SIZE; positive values are pages, negative values are KiB
+     * @param[in] mmapSize Bytes of the file memory mapped by each connection; 0 disables memory mapped I/O
+     */
+    SQLiteTileReader(const std::string& dbFileName, const std::string& dataTableName, int cacheSize = QS_DEFAULT_CACHE_SIZE, int64_t mmapSize = 0);
+    /** Cancels outstanding prefetches and closes all connections */
+    virtual ~SQLiteTileReader();
+
+    SDK_DISABLE_COPY_MOVE(SQLiteTileReader);
+
+    /**
+     * Reads a node's data and passes it to the consumer, on the calling thread.  The consumer is
+     * not called if the node has no data in the table.  Safe to call from multiple threads.
+     * @param[in] faceIndex Face index of the node
+     * @param[in] nodeID ID of the node within the face
+     * @param[in] consumer Receives the node's data
+     * @param[in] displayErrorMessage Determines whether to display error messages to console when failing
+     * @return QS_IS_OK on success, including when the node has no data; otherwise an error value
+     */
+    QsErrorType readTile(const FaceIndexType& faceIndex, const QSNodeId& nodeID, const TileConsumer& consumer, bool displayErrorMessage=false);
+
+    /**
+     * Enables background prefetching of tiles.
+     * @param[in] cacheBytes Maximum total bytes of prefetched tiles held in memory; 0 (default) disables prefetching
+     */
+    void setPrefetchCacheSize(size_t cacheBytes);
+    /** Retrieves the maximum total bytes of prefetched tiles held in memory */
+    size_t prefetchCacheSize() const;
+
+    /**
+     * Queues a node to be read on the background thread.  Ignored if prefetching is disabled, or if
+     * the node is already queued or cached.  When the queue is full, the oldest request is dropped.
+     * @param[in] faceIndex Face index of the node
+     * @param[in] nodeID ID of the node within the face
+     */
+    void prefetch(const FaceIndexType& faceIndex, const QSNodeId& nodeID);
+    /** Discards queued prefetch requests; tiles already in the cache are kept */
+    void cancelPrefetch();
+
+    /** Number of readTile() calls served from the prefetch cache */
+    size_t numPrefetchHits() const;
+
+    /** Packs a face index and node ID into the id column value of a texture set table row */
+    static std::string packTileId(const FaceIndexType& faceIndex, const QSNodeId& nodeID);
+
+  private:
+    /** Connection used by one thread at a time, with its prepared statement */
+    struct Connection;
+
+    /** Prefetched tile; an empty entry with found == false records a node that has no data */
+    struct CacheEntry
+    {
+      bool found = false;
+      std::vector<TextureDataType> data;
+      std::list<std::string>::iterator age;
+    };
+
+    /** Checks out an idle connection, opening a new one if none are idle; returns nullptr on error */
+    std::unique_ptr<Connection> acquireConnection_(QsErrorType& err, bool displayErrorMessage);
+    /** Returns a connection to the idle list */
+    void releaseConnection_(std::unique_ptr<Connection> connection);
+    /** Reads a tile from the database */
+    QsErrorType readFromDb_(const std::string& tileId, const TileConsumer& consumer, bool displayErrorMessage);
+    /** Reads one queued tile into the cache; executed on the prefetch thread */
+    void runPrefetch_();
+    /** Evicts the oldest cache entries until the cache fits; requires cacheMutex_ */
+    void trimCache_();
+
+    std::string dbFileName_;
+    SQLiteDataBaseReadUtil dbUtil_;
+    std::string selectCommand_;
+
+    std::mutex connectionMutex_;
+    std::vector<std::unique_ptr<Connection> > idleConnections_;
+
+    /** Protects all prefetch state below */
+    mutable std::mutex cacheMutex_;
+    size_t cacheBytes_;
+    size_t maxCacheBytes_;
+    size_t numPrefetchHits_;
+    std::deque<std::string> pending_;
+    std::map<std::string, CacheEntry> cache_;
+    /** Tile IDs in the cache, oldest first */
+    std::list<std::string> cacheAge_;
+    std::unique_ptr<simCore::ThreadPool> prefetchPool_;
+  };
+
+} // namespace simVis_db
+
+#endif /* SIMVIS_DB_SQLITETILEREADER_H */
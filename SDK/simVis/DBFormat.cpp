@@ -20,6 +20,8 @@
  * disclose, or release this software.
  *
  */
+#include <memory>
+#include <streambuf>
 #include "osgDB/FileUtils"
 #include "osgEarth/Cube"
 #include "osgEarth/ImageToHeightFieldConverter"
@@ -31,6 +33,7 @@
 #include "simVis/DB/QSCommon.h"
 #include "simVis/DB/swapbytes.h"
 #include "simVis/DB/SQLiteDataBaseReadUtil.h"
+#include "simVis/DB/SQLiteTileReader.h"
 
 using namespace simVis;
 using namespace simVis_db;
@@ -103,19 +106,47 @@ namespace
     return true;
   }
 
+  /** Read only stream buffer over existing memory, so that decoders can read tile data in place */
+  class MemoryStreamBuf : public std::streambuf
+  {
+  public:
+    MemoryStreamBuf(const char* data, int dataLen)
+    {
+      char* begin = const_cast<char*>(data);
+      setg(begin, begin, begin + dataLen);
+    }
+
+  protected:
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+    {
+      if ((which & std::ios_base::in) == 0)
+        return pos_type(off_type(-1));
+      char* origin = (dir == std::ios_base::beg) ? eback() : ((dir == std::ios_base::cur) ? gptr() : egptr());
+      if (off < eback() - origin || off > egptr() - origin)
+        return pos_type(off_type(-1));
+      setg(eback(), origin + off, egptr());
+      return pos_type(gptr() - eback());
+    }
+
+    virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+    {
+      return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+  };
+
   bool decompressZLIB(const char* input, int inputLen, std::string& output)
   {
     osgDB::BaseCompressor* comp = osgDB::Registry::instance()->getObjectWrapperManager()->findCompressor("zlib");
-    std::string inString(input, inputLen);
-    std::istringstream inStream(inString);
+    MemoryStreamBuf inBuf(input, inputLen);
+    std::istream inStream(&inBuf);
     return comp->decompress(inStream, output);
   }
 
   // Uses one of OSG's native ReaderWriter's to read image data from a buffer.
   bool readNativeImage(osgDB::ReaderWriter* reader, const char* inBuf, int inBufLen, osg::ref_ptr<osg::Image>& outImage)
   {
-    std::string inString(inBuf, inBufLen);
-    std::istringstream inStream(inString);
+    MemoryStreamBuf inStreamBuf(inBuf, inBufLen);
+    std::istream inStream(&inStreamBuf);
     osgDB::ReaderWriter::ReadResult result = reader->readImage(inStream);
     outImage = result.getImage();
     if (result.error() || !outImage.valid())
@@ -139,6 +170,14 @@ namespace
       db_ = nullptr;
     }
 
+    ~DBContext()
+    {
+      // Tile reader holds its own connections
+      reader_.reset();
+      if (db_)
+        sqlite3_close(db_);
+    }
+
     int rasterFormat_;
     int pixelLength_;
     int shallowLevel_;
@@ -149,6 +188,7 @@ namespace
     std::string pathname_;
     sqlite3* db_;
     SQLiteDataBaseReadUtil dbUtil_;
+    std::unique_ptr<SQLiteTileReader> reader_;
     PosXPosYExtents extents_[6];
     std::string source_;
     std::string classification_;
@@ -173,6 +213,28 @@ namespace
       outImage->setImage(size, size, 1, internalFormat, pixelFormat, type, data, osg::Image::USE_NEW_DELETE);
     }
 
+    /** Queues the tiles surrounding the given key for background reading, when prefetch is enabled */
+    void prefetchNeighbors_(const osgEarth::TileKey& key)
+    {
+      if (!reader_ || reader_->prefetchCacheSize() == 0)
+        return;
+      for (int dy = -1; dy <= 1; ++dy)
+      {
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+          if (dx == 0 && dy == 0)
+            continue;
+          const osgEarth::TileKey neighbor = key.createNeighborKey(dx, dy);
+          FaceIndexType faceId;
+          QSNodeId nodeId;
+          osg::Vec2d tileMin;
+          osg::Vec2d tileMax;
+          if (neighbor.valid() && convertTileKeyToQsKey(neighbor, faceId, nodeId, tileMin, tileMax) && extents_[faceId].isValid())
+            reader_->prefetch(faceId, nodeId);
+        }
+      }
+    }
+
     bool decodeRaster_(int rasterFormat, const char* inputBuffer, int inputBufferLen, osg::ref_ptr<osg::Image>& outImage)
     {
       switch (rasterFormat)
@@ -308,6 +370,9 @@ osgEarth::Config DBImageLayer::Options::getConfig() const
   osgEarth::Config conf = osgEarth::ImageLayer::Options::getConfig();
   conf.set("url", url());
   conf.set("deepest_level", deepestLevel());
+  conf.set("cache_size", cacheSize());
+  conf.set("mmap_size", mmapSize());
+  conf.set("prefetch_cache_size", prefetchCacheSize());
   return conf;
 }
 
@@ -315,6 +380,9 @@ void DBImageLayer::Options::fromConfig(const osgEarth::Config& conf)
 {
   conf.get("url", url());
   conf.get("deepest_level", deepestLevel());
+  conf.get("cache_size", cacheSize());
+  conf.get("mmap_size", mmapSize());
+  conf.get("prefetch_cache_size", prefetchCacheSize());
 }
 
 void DBImageLayer::setURL(const osgEarth::URI& value)
@@ -337,6 +405,37 @@ unsigned int DBImageLayer::getDeepestLevel() const
   return options().deepestLevel().get();
 }
 
+void DBImageLayer::setCacheSize(int value)
+{
+  options().cacheSize() = value;
+}
+
+int DBImageLayer::getCacheSize() const
+{
+  // Unset means the reader default
+  return options().cacheSize().isSet() ? options().cacheSize().get() : simVis_db::QS_DEFAULT_CACHE_SIZE;
+}
+
+void DBImageLayer::setMmapSize(unsigned int value)
+{
+  options().mmapSize() = value;
+}
+
+unsigned int DBImageLayer::getMmapSize() const
+{
+  return options().mmapSize().get();
+}
+
+void DBImageLayer::setPrefetchCacheSize(unsigned int value)
+{
+  options().prefetchCacheSize() = value;
+}
+
+unsigned int DBImageLayer::getPrefetchCacheSize() const
+{
+  return options().prefetchCacheSize().get();
+}
+
 void DBImageLayer::init()
 {
   osgEarth::ImageLayer::init();
@@ -399,6 +498,12 @@ osgEarth::Status DBImageLayer::openImplementation()
         osgEarth::Stringify() << "Failed to read metadata for " << cx.pathname_);
     }
 
+    // Tiles are read through the reader's shared pool of read only connections, separate from db_
+    cx.reader_.reset(new SQLiteTileReader(cx.pathname_, "default",
+      getCacheSize(),
+      static_cast<int64_t>(options().mmapSize().get()) * 1024 * 1024));
+    cx.reader_->setPrefetchCacheSize(static_cast<size_t>(options().prefetchCacheSize().get()) * 1024 * 1024);
+
     // Set up as a unified cube:
     osgEarth::Profile* profile = new osgEarth::Contrib::UnifiedCubeProfile();
     // DB are expected to be wgs84, which Cube defaults to
@@ -472,7 +577,7 @@ osgEarth::GeoImage DBImageLayer::createImageImplementation(const osgEarth::TileK
 {
   DBContext& cx = *static_cast<DBContext*>(context_);
 
-  if (!cx.db_)
+  if (!cx.reader_)
     return osgEarth::GeoImage::INVALID;
 
   osg::ref_ptr<osg::Image> result;
@@ -496,27 +601,20 @@ osgEarth::GeoImage DBImageLayer::createImageImplementation(const osgEarth::TileK
     return osgEarth::GeoImage::INVALID;
   }
 
-  // Query the database
-  TextureDataType* buf = nullptr;
-  uint32_t bufSize = 0;
+  // Query the database, decoding the tile straight from the database row
   uint32_t currentRasterSize = 0;
-
-  QsErrorType err = cx.dbUtil_.readDataBuffer(
-    cx.db_,
-    cx.pathname_,
-    "default",
-    faceId,
-    nodeId,
-    &buf,
-    &bufSize,
-    &currentRasterSize,
-    false, true);             // AllowLocalDB: no, we created it ourselves
+  bool decoded = false;
+  QsErrorType err = cx.reader_->readTile(faceId, nodeId, [&](const TextureDataType* data, uint32_t dataSize) {
+    currentRasterSize = dataSize;
+    decoded = cx.decodeRaster_(cx.rasterFormat_, reinterpret_cast<const char*>(data), static_cast<int>(dataSize), result);
+  }, true);
+  cx.prefetchNeighbors_(key);
 
   if (err == simVis_db::QS_IS_OK)
   {
     if (currentRasterSize > 0)
     {
-      if (cx.decodeRaster_(cx.rasterFormat_, (const char*)buf, currentRasterSize, result))
+      if (decoded)
       {
         // If result is 1x1, skip border processing
         if (result->s() >= 1 && result->t() >= 1)
@@ -578,8 +676,6 @@ osgEarth::GeoImage DBImageLayer::createImageImplementation(const osgEarth::TileK
     OE_WARN << "Failed to read image from " << key.str() << std::endl;
   }
 
-  delete[] buf;
-
   if (result.valid())
   {
     // Convert to RGBA8 if needed. osgEarth revision 84cdbe3e disables the auto-conversion to
@@ -607,6 +703,9 @@ osgEarth::Config DBElevationLayer::Options::getConfig() const
   osgEarth::Config conf = osgEarth::ElevationLayer::Options::getConfig();
   conf.set("url", url());
   conf.set("deepest_level", deepestLevel());
+  conf.set("cache_size", cacheSize());
+  conf.set("mmap_size", mmapSize());
+  conf.set("prefetch_cache_size", prefetchCacheSize());
   return conf;
 }
 
@@ -614,6 +713,9 @@ void DBElevationLayer::Options::fromConfig(const osgEarth::Config& conf)
 {
   conf.get("url", url());
   conf.get("deepest_level", deepestLevel());
+  conf.get("cache_size", cacheSize());
+  conf.get("mmap_size", mmapSize());
+  conf.get("prefetch_cache_size", prefetchCacheSize());
 }
 
 void DBElevationLayer::setURL(const osgEarth::URI& value)
@@ -636,6 +738,37 @@ unsigned int DBElevationLayer::getDeepestLevel() const
   return options().deepestLevel().get();
 }
 
+void DBElevationLayer::setCacheSize(int value)
+{
+  options().cacheSize() = value;
+}
+
+int DBElevationLayer::getCacheSize() const
+{
+  // Unset means the reader default
+  return options().cacheSize().isSet() ? options().cacheSize().get() : simVis_db::QS_DEFAULT_CACHE_SIZE;
+}
+
+void DBElevationLayer::setMmapSize(unsigned int value)
+{
+  options().mmapSize() = value;
+}
+
+unsigned int DBElevationLayer::getMmapSize() const
+{
+  return options().mmapSize().get();
+}
+
+void DBElevationLayer::setPrefetchCacheSize(unsigned int value)
+{
+  options().prefetchCacheSize() = value;
+}
+
+unsigned int DBElevationLayer::getPrefetchCacheSize() const
+{
+  return options().prefetchCacheSize().get();
+}
+
 void DBElevationLayer::init()
 {
   osgEarth::ElevationLayer::init();
@@ -699,6 +832,12 @@ osgEarth::Status DBElevationLayer::openImplementation()
         osgEarth::Stringify() << "Failed to read metadata for " << cx.pathname_);
     }
 
+    // Tiles are read through the reader's shared pool of read only connections, separate from db_
+    cx.reader_.reset(new SQLiteTileReader(cx.pathname_, "default",
+      getCacheSize(),
+      static_cast<int64_t>(options().mmapSize().get()) * 1024 * 1024));
+    cx.reader_->setPrefetchCacheSize(static_cast<size_t>(options().prefetchCacheSize().get()) * 1024 * 1024);
+
     // Set up as a unified cube:
     osg::ref_ptr<osgEarth::Profile> profile = new osgEarth::Contrib::UnifiedCubeProfile();
     // DB are expected to be wgs84, which Cube defaults to
@@ -772,7 +911,7 @@ osgEarth::GeoHeightField DBElevationLayer::createHeightFieldImplementation(const
 {
   DBContext& cx = *static_cast<DBContext*>(context_);
 
-  if (!cx.db_)
+  if (!cx.reader_)
     return osgEarth::GeoHeightField::INVALID;
 
   osg::ref_ptr<osg::HeightField> result;
@@ -790,28 +929,21 @@ osgEarth::GeoHeightField DBElevationLayer::createHeightFieldImplementation(const
     return osgEarth::GeoHeightField::INVALID;
   }
 
-  // Query the database
-  TextureDataType* buf = nullptr;
-  uint32_t bufSize = 0;
+  // Query the database, decoding the tile straight from the database row
   uint32_t currentRasterSize = 0;
-
-  QsErrorType err = cx.dbUtil_.readDataBuffer(
-    cx.db_,
-    cx.pathname_,
-    "default",
-    faceId,
-    nodeId,
-    &buf,
-    &bufSize,
-    &currentRasterSize,
-    false);             // AllowLocalDB: no, we created it ourselves
+  bool decoded = false;
+  osg::ref_ptr<osg::Image> image;
+  QsErrorType err = cx.reader_->readTile(faceId, nodeId, [&](const TextureDataType* data, uint32_t dataSize) {
+    currentRasterSize = dataSize;
+    decoded = cx.decodeRaster_(cx.rasterFormat_, reinterpret_cast<const char*>(data), static_cast<int>(dataSize), image);
+  });
+  cx.prefetchNeighbors_(key);
 
   if (err == simVis_db::QS_IS_OK)
   {
     if (currentRasterSize > 0)
     {
-      osg::ref_ptr<osg::Image> image;
-      if (cx.decodeRaster_(cx.rasterFormat_, (const char*)buf, currentRasterSize, image))
+      if (decoded)
       {
 
         // SIMDIS .db elevation data is y-inverted:
@@ -881,7 +1013,5 @@ osgEarth::GeoHeightField DBElevationLayer::createHeightFieldImplementation(const
     OE_WARN << "Failed to read heightfield from " << key.str() << std::endl;
   }
 
-  delete[] buf;
-
   return osgEarth::GeoHeightField(result.release(), key.getExtent());
 }
@@ -43,6 +43,9 @@ public: // serialization
     META_LayerOptions(simVis, Options, osgEarth::ImageLayer::Options);
     OE_OPTION(osgEarth::URI, url);
     OE_OPTION(unsigned int, deepestLevel);
+    OE_OPTION(int, cacheSize);
+    OE_OPTION(unsigned int, mmapSize);
+    OE_OPTION(unsigned int, prefetchCacheSize);
     virtual osgEarth::Config getConfig() const;
   private:
     void fromConfig(const osgEarth::Config&);
@@ -60,6 +63,18 @@ public:
   void setDeepestLevel(unsigned int value);
   unsigned int getDeepestLevel() const;
 
+  /// SQLite page cache size for each tile reading connection; positive values are pages, negative values are KiB; defaults to 100 pages
+  void setCacheSize(int value);
+  int getCacheSize() const;
+
+  /// Megabytes of the DB file to memory map for each tile reading connection; 0 (default) disables memory mapping
+  void setMmapSize(unsigned int value);
+  unsigned int getMmapSize() const;
+
+  /// Megabytes of memory for tiles prefetched around each requested tile; 0 (default) disables prefetching
+  void setPrefetchCacheSize(unsigned int value);
+  unsigned int getPrefetchCacheSize() const;
+
 public: // Layer
 
   /// Establishes a connection to the database
@@ -92,6 +107,9 @@ public: // serialization
     META_LayerOptions(simVis, Options, osgEarth::ElevationLayer::Options);
     OE_OPTION(osgEarth::URI, url);
     OE_OPTION(unsigned int, deepestLevel);
+    OE_OPTION(int, cacheSize);
+    OE_OPTION(unsigned int, mmapSize);
+    OE_OPTION(unsigned int, prefetchCacheSize);
     virtual osgEarth::Config getConfig() const;
   private:
     void fromConfig(const osgEarth::Config&);
@@ -108,6 +126,18 @@ public:
   void setDeepestLevel(unsigned int value);
   unsigned int getDeepestLevel() const;
 
+  /// SQLite page cache size for each tile reading connection; positive values are pages, negative values are KiB; defaults to 100 pages
+  void setCacheSize(int value);
+  int getCacheSize() const;
+
+  /// Megabytes of the DB file to memory map for each tile reading connection; 0 (default) disables memory mapping
+  void setMmapSize(unsigned int value);
+  unsigned int getMmapSize() const;
+
+  /// Megabytes of memory for tiles prefetched around each requested tile; 0 (default) disables prefetching
+  void setPrefetchCacheSize(unsigned int value);
+  unsigned int getPrefetchCacheSize() const;
+
 public: // Layer
 
   /// Establishes a connection to the database
@@ -68,6 +68,8 @@ struct ElevationQueryProxy::PrivateData
 #else
   osgEarth::Threading::Future<osgEarth::RefElevationSample> elevationResult_;
 #endif
+  /// Batch query service, created on first use of getElevations()
+  std::unique_ptr<ElevationQueryService> service_;
 };
 
 /**
@@ -233,6 +235,13 @@ bool ElevationQueryProxy::getElevation(const osgEarth::GeoPoint& point, double&
   return getElevationFromPool_(point, out_elevation, desiredResolution, out_actualResolution, blocking);
 }
 
+std::future<ElevationQueryService::ResultVector> ElevationQueryProxy::getElevations(const std::vector<osgEarth::GeoPoint>& points, double desiredResolution)
+{
+  if (!data_->service_)
+    data_->service_.reset(new ElevationQueryService(map_.get()));
+  return data_->service_->query(points, desiredResolution);
+}
+
 void ElevationQueryProxy::setMap(const osgEarth::Map* map)
 {
   // Avoid expensive operations on re-do of same map
@@ -247,6 +256,8 @@ void ElevationQueryProxy::setMap(const osgEarth::Map* map)
     delete asyncSampler_;
   }
   asyncSampler_ = new osgEarth::AsyncElevationSampler(map);
+  if (data_->service_)
+    data_->service_->setMap(map);
 
   map_ = map;
 
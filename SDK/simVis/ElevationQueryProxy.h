@@ -23,10 +23,13 @@
 #ifndef SIMVIS_ELEVATIONQUERYPROXY_H
 #define SIMVIS_ELEVATIONQUERYPROXY_H
 
+#include <future>
+#include <vector>
 #include "osg/observer_ptr"
 #include "osg/ref_ptr"
 #include "osgEarth/ElevationQuery"
 #include "simCore/Common/Common.h"
+#include "simVis/ElevationQueryService.h"
 
 namespace osg {
   class Group;
@@ -103,6 +106,16 @@ public:
   */
   bool getPendingElevation(double& out_elevation, double* out_actualResolution = 0L);
 
+  /**
+   * Starts an asynchronous query for the elevations of many points at once.  Prefer this over repeated
+   * getElevation() calls; points are grouped by elevation tile and resolved in parallel on worker threads.
+   * The worker threads and their tile cache are created on first use.
+   * @param points Points to sample
+   * @param desiredResolution Optimal resolution of elevation data, in map units; 0 for the best available
+   * @return Future that holds one result for each point
+   */
+  std::future<ElevationQueryService::ResultVector> getElevations(const std::vector<osgEarth::GeoPoint>& points, double desiredResolution = 0.0);
+
   /** Changes the MapNode that is associated with the query. */
   void setMap(const osgEarth::Map* map);
   /** Changes the MapNode that is associated with the query.  Calls setMap(osgEarth::Map*) appropriately. */
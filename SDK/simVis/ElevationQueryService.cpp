@@ -0,0 +1,235 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "osgEarth/Map"
+#include "osgEarth/Profile"
+#include "simCore/System/ThreadPool.h"
+#include "simVis/ElevationQueryService.h"
+
+namespace simVis
+{
+
+/// Elevation tiles from the elevation pool are 257 samples on a side
+static const int ELEVATION_TILE_SIZE = 257;
+
+double ElevationQueryService::Statistics::hitRate() const
+{
+  const uint64_t lookups = tileHits + tileMisses;
+  return lookups == 0 ? 0.0 : static_cast<double>(tileHits) / lookups;
+}
+
+ElevationQueryService::ElevationQueryService(const osgEarth::Map* map, unsigned int numThreads, size_t maxCachedTiles)
+  : map_(map),
+    maxLevel_(16),
+    maxCachedTiles_(std::max(static_cast<size_t>(1), maxCachedTiles)),
+    mapGeneration_(0),
+    numBatches_(0),
+    numPoints_(0),
+    tileHits_(0),
+    tileMisses_(0),
+    totalLatencyUs_(0),
+    maxLatencyUs_(0),
+    pool_(new simCore::ThreadPool(numThreads))
+{
+}
+
+ElevationQueryService::~ElevationQueryService()
+{
+  // Drain outstanding batches before the cache goes away
+  pool_.reset();
+}
+
+std::future<ElevationQueryService::ResultVector> ElevationQueryService::query(const std::vector<osgEarth::GeoPoint>& points, double desiredResolution)
+{
+  // std::function requires a copyable task, so the promise is shared
+  auto promise = std::make_shared<std::promise<ResultVector> >();
+  std::future<ResultVector> future = promise->get_future();
+  const auto startTime = std::chrono::steady_clock::now();
+  pool_->execute([this, promise, points, desiredResolution, startTime]() {
+    ResultVector results = resolve_(points, desiredResolution);
+
+    const uint64_t latencyUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count());
+    totalLatencyUs_ += latencyUs;
+    uint64_t prevMax = maxLatencyUs_.load();
+    while (latencyUs > prevMax && !maxLatencyUs_.compare_exchange_weak(prevMax, latencyUs))
+    {
+    }
+    numPoints_ += points.size();
+    ++numBatches_;
+
+    promise->set_value(std::move(results));
+  });
+  return future;
+}
+
+ElevationQueryService::ResultVector ElevationQueryService::resolve_(const std::vector<osgEarth::GeoPoint>& points, double desiredResolution)
+{
+  ResultVector results(points.size());
+  osg::ref_ptr<const osgEarth::Map> map;
+  uint64_t mapGeneration = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    map_.lock(map);
+    mapGeneration = mapGeneration_;
+  }
+  if (!map.valid() || !map->getProfile() || points.empty())
+    return results;
+
+  const osgEarth::Profile* profile = map->getProfile();
+  const unsigned int level = (desiredResolution > 0.0) ?
+    std::min(maxLevel(), profile->getLevelOfDetailForHorizResolution(desiredResolution, ELEVATION_TILE_SIZE)) : maxLevel();
+
+  // Group the points by the tile that covers them, keeping the map coordinates
+  std::map<osgEarth::TileKey, std::vector<size_t> > groups;
+  std::vector<osg::Vec2d> mapCoords(points.size());
+  for (size_t k = 0; k < points.size(); ++k)
+  {
+    osgEarth::GeoPoint mapPoint;
+    if (!points[k].transform(map->getSRS(), mapPoint))
+      continue;
+    mapCoords[k].set(mapPoint.x(), mapPoint.y());
+    const osgEarth::TileKey key = profile->createTileKey(mapPoint.x(), mapPoint.y(), level);
+    if (key.valid())
+      groups[key].push_back(k);
+  }
+
+  // Each group writes only to its own results, so groups can be resolved in parallel
+  std::vector<std::map<osgEarth::TileKey, std::vector<size_t> >::const_iterator> groupList;
+  groupList.reserve(groups.size());
+  for (auto it = groups.cbegin(); it != groups.cend(); ++it)
+    groupList.push_back(it);
+  pool_->parallelFor(groupList.size(), [&](size_t beginIndex, size_t endIndex) {
+    for (size_t g = beginIndex; g < endIndex; ++g)
+    {
+      osg::ref_ptr<osgEarth::ElevationTexture> tile = getTile_(*map, mapGeneration, groupList[g]->first);
+      if (!tile.valid())
+        continue;
+      for (size_t k : groupList[g]->second)
+      {
+        const osgEarth::ElevationSample sample = tile->getElevation(mapCoords[k].x(), mapCoords[k].y());
+        if (!sample.hasData())
+          continue;
+        Result& result = results[k];
+        result.elevation_m = sample.elevation().as(osgEarth::Units::METERS);
+        if (result.elevation_m == NO_DATA_VALUE)
+        {
+          result.elevation_m = 0.0;
+          continue;
+        }
+        result.resolution = sample.resolution().getValue();
+        result.valid = true;
+      }
+    }
+  });
+  return results;
+}
+
+osg::ref_ptr<osgEarth::ElevationTexture> ElevationQueryService::getTile_(const osgEarth::Map& map, uint64_t mapGeneration, const osgEarth::TileKey& key)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Cached tiles belong to the current map; a batch still running for a replaced map fetches from its own
+    auto it = (mapGeneration == mapGeneration_) ? tileIndex_.find(key) : tileIndex_.end();
+    if (it != tileIndex_.end())
+    {
+      ++tileHits_;
+      tiles_.splice(tiles_.begin(), tiles_, it->second);
+      return it->second->second;
+    }
+  }
+
+  // Fetch outside of the lock; lower resolution data is accepted where the key is deeper than the available data
+  ++tileMisses_;
+  osg::ref_ptr<osgEarth::ElevationTexture> tile;
+  osgEarth::ElevationPool::WorkingSet workingSet;
+  if (!map.getElevationPool()->getTile(key, true, tile, &workingSet, nullptr) || !tile.valid())
+    return tile;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // The map may have been replaced during the fetch, and another thread may have fetched the same tile
+  if (mapGeneration != mapGeneration_ || tileIndex_.find(key) != tileIndex_.end())
+    return tile;
+  tiles_.emplace_front(key, tile);
+  tileIndex_[key] = tiles_.begin();
+  while (tiles_.size() > maxCachedTiles_)
+  {
+    tileIndex_.erase(tiles_.back().first);
+    tiles_.pop_back();
+  }
+  return tile;
+}
+
+void ElevationQueryService::setMap(const osgEarth::Map* map)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (map == map_.get())
+    return;
+  map_ = map;
+  ++mapGeneration_;
+  tileIndex_.clear();
+  tiles_.clear();
+}
+
+void ElevationQueryService::setMaxLevel(unsigned int level)
+{
+  maxLevel_ = level;
+}
+
+unsigned int ElevationQueryService::maxLevel() const
+{
+  return maxLevel_;
+}
+
+void ElevationQueryService::clearCache()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  tileIndex_.clear();
+  tiles_.clear();
+}
+
+ElevationQueryService::Statistics ElevationQueryService::statistics() const
+{
+  Statistics stats;
+  stats.numBatches = numBatches_;
+  stats.numPoints = numPoints_;
+  stats.tileHits = tileHits_;
+  stats.tileMisses = tileMisses_;
+  if (stats.numBatches > 0)
+    stats.meanLatency = 1e-6 * totalLatencyUs_ / stats.numBatches;
+  stats.maxLatency = 1e-6 * maxLatencyUs_;
+  return stats;
+}
+
+void ElevationQueryService::resetStatistics()
+{
+  numBatches_ = 0;
+  numPoints_ = 0;
+  tileHits_ = 0;
+  tileMisses_ = 0;
+  totalLatencyUs_ = 0;
+  maxLatencyUs_ = 0;
+}
+
+}
@@ -0,0 +1,167 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMVIS_ELEVATIONQUERYSERVICE_H
+#define SIMVIS_ELEVATIONQUERYSERVICE_H
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "osg/observer_ptr"
+#include "osg/ref_ptr"
+#include "osgEarth/Elevation"
+#include "osgEarth/ElevationPool"
+#include "osgEarth/GeoData"
+#include "osgEarth/TileKey"
+#include "simCore/Common/Common.h"
+
+namespace osgEarth { class Map; }
+namespace simCore { class ThreadPool; }
+
+namespace simVis
+{
+
+/**
+ * Answers batches of elevation queries asynchronously.  Each call to query() returns a future that
+ * is fulfilled on a worker thread.  Points in a batch are grouped by the elevation tile that covers
+ * them, so each tile is fetched once per batch, and the tile groups are resolved in parallel.
+ * Tiles are kept in a least recently used cache that is shared by all batches.
+ *
+ * Like ElevationQueryProxy, the service does not hold a reference to the Map; batches that start
+ * after the Map is deleted fail all of their points.  Call setMap() when the Map changes.
+ */
+class SDKVIS_EXPORT ElevationQueryService
+{
+public:
+  /** Elevation of a single point */
+  struct Result
+  {
+    /** Elevation in meters HAE; 0 if there is no data */
+    double elevation_m = 0.0;
+    /** Resolution of the elevation data, in map units; 0 if there is no data */
+    double resolution = 0.0;
+    /** True if the elevation came from elevation data */
+    bool valid = false;
+  };
+  /** Results in the same order as the points of the query */
+  typedef std::vector<Result> ResultVector;
+
+  /** Counters since construction or the last resetStatistics() */
+  struct Statistics
+  {
+    /** Number of batches completed */
+    uint64_t numBatches = 0;
+    /** Number of points resolved */
+    uint64_t numPoints = 0;
+    /** Number of tiles found in the cache */
+    uint64_t tileHits = 0;
+    /** Number of tiles that had to be fetched from the elevation pool */
+    uint64_t tileMisses = 0;
+    /** Mean time from query() until the result is available, in seconds */
+    double meanLatency = 0.0;
+    /** Longest time from query() until the result is available, in seconds */
+    double maxLatency = 0.0;
+
+    /** Fraction of tile lookups served from the cache, from 0 to 1 */
+    double hitRate() const;
+  };
+
+  /**
+   * Creates the service
+   * @param map Map whose elevation pool is sampled
+   * @param numThreads Total number of threads resolving queries; 0 uses all hardware threads.  With a
+   *   single thread, query() resolves the batch before returning.
+   * @param maxCachedTiles Maximum number of elevation tiles to keep in memory
+   */
+  ElevationQueryService(const osgEarth::Map* map, unsigned int numThreads = 0, size_t maxCachedTiles = 256);
+  /** Waits for outstanding batches before returning */
+  virtual ~ElevationQueryService();
+
+  SDK_DISABLE_COPY_MOVE(ElevationQueryService);
+
+  /**
+   * Queues a batch of elevation queries.
+   * @param points Points to sample; any SRS that can be transformed to the map's SRS
+   * @param desiredResolution Optimal resolution of elevation data, in map units; 0 for the best available
+   * @return Future that holds one result for each point
+   */
+  std::future<ResultVector> query(const std::vector<osgEarth::GeoPoint>& points, double desiredResolution = 0.0);
+
+  /** Changes the Map to sample.  Clears the tile cache. */
+  void setMap(const osgEarth::Map* map);
+
+  /** Deepest tile level sampled when the best available resolution is requested; defaults to 16 */
+  void setMaxLevel(unsigned int level);
+  /** Deepest tile level sampled when the best available resolution is requested */
+  unsigned int maxLevel() const;
+
+  /** Discards all cached tiles */
+  void clearCache();
+
+  /** Returns hit rate and latency statistics */
+  Statistics statistics() const;
+  /** Resets the statistics counters */
+  void resetStatistics();
+
+private:
+  /** Cached elevation tiles, most recently used at the front */
+  typedef std::list<std::pair<osgEarth::TileKey, osg::ref_ptr<osgEarth::ElevationTexture> > > TileList;
+
+  /** Resolves a batch on a worker thread */
+  ResultVector resolve_(const std::vector<osgEarth::GeoPoint>& points, double desiredResolution);
+  /**
+   * Returns the tile for the key from the cache, or fetches it from the map's elevation pool.  The
+   * cache is only used while mapGeneration_ still matches the generation the map was read with.
+   */
+  osg::ref_ptr<osgEarth::ElevationTexture> getTile_(const osgEarth::Map& map, uint64_t mapGeneration, const osgEarth::TileKey& key);
+
+  osg::observer_ptr<const osgEarth::Map> map_;
+  std::atomic<unsigned int> maxLevel_;
+  size_t maxCachedTiles_;
+
+  /// Protects map_, mapGeneration_, tiles_ and tileIndex_
+  mutable std::mutex mutex_;
+  /// Incremented by each setMap() that changes the map, so that fetches for an older map are not cached
+  uint64_t mapGeneration_;
+  TileList tiles_;
+  std::map<osgEarth::TileKey, TileList::iterator> tileIndex_;
+
+  std::atomic<uint64_t> numBatches_;
+  std::atomic<uint64_t> numPoints_;
+  std::atomic<uint64_t> tileHits_;
+  std::atomic<uint64_t> tileMisses_;
+  /// Latency totals in microseconds
+  std::atomic<uint64_t> totalLatencyUs_;
+  std::atomic<uint64_t> maxLatencyUs_;
+
+  /// Declared last so that it is destroyed first, draining queued batches while the members above are valid
+  std::unique_ptr<simCore::ThreadPool> pool_;
+};
+
+}
+
+#endif /* SIMVIS_ELEVATIONQUERYSERVICE_H */
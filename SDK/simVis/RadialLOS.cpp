@@ -20,6 +20,8 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <limits>
 #include "osgEarth/GeoData"
@@ -28,6 +30,7 @@
 #include "simCore/Calc/Calculations.h"
 #include "simCore/Calc/CoordinateConverter.h"
 #include "simCore/Calc/Math.h"
+#include "simCore/System/ThreadPool.h"
 #include "simVis/RadialLOS.h"
 #include "simVis/Utils.h"
 
@@ -82,9 +85,11 @@ RadialLOS::RadialLOS()
     azim_center_(osgEarth::Angle(0.0, osgEarth::Units::DEGREES)),
     fov_(osgEarth::Angle(360.0, osgEarth::Units::DEGREES)),
     azim_resolution_(osgEarth::Angle(15.0, osgEarth::Units::DEGREES)),
-    elevationWorkingSet_(new osgEarth::ElevationPool::WorkingSet(WORKINGSET_SIZE)),
-    use_scene_graph_(false)
+    use_scene_graph_(false),
+    profileReuseDistance_(osgEarth::Distance(10.0, osgEarth::Units::METERS)),
+    profileMapRevision_(-1)
 {
+  resetWorkingSets_();
 }
 
 RadialLOS::RadialLOS(const RadialLOS& rhs)
@@ -107,7 +112,12 @@ RadialLOS& RadialLOS::operator=(const RadialLOS& rhs)
   fov_ = rhs.fov_;
   azim_resolution_ = rhs.azim_resolution_;
   use_scene_graph_ = rhs.use_scene_graph_;
-  elevationWorkingSet_.reset(new osgEarth::ElevationPool::WorkingSet(WORKINGSET_SIZE));
+  pool_ = rhs.pool_;
+  profileReuseDistance_ = rhs.profileReuseDistance_;
+  profileOriginLla_ = rhs.profileOriginLla_;
+  profileMap_ = rhs.profileMap_;
+  profileMapRevision_ = rhs.profileMapRevision_;
+  resetWorkingSets_();
   // nocopy: srs_
 
   return *this;
@@ -158,6 +168,37 @@ void RadialLOS::setAzimuthalResolution(const osgEarth::Angle& value)
   }
 }
 
+void RadialLOS::setComputeThreadCount(unsigned int numThreads)
+{
+  if (numThreads == 0)
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  if (numThreads == getComputeThreadCount())
+    return;
+
+  if (numThreads == 1)
+    pool_.reset();
+  else
+    pool_ = std::make_shared<simCore::ThreadPool>(numThreads);
+  resetWorkingSets_();
+}
+
+unsigned int RadialLOS::getComputeThreadCount() const
+{
+  return pool_ ? pool_->numThreads() : 1;
+}
+
+void RadialLOS::setProfileReuseDistance(const osgEarth::Distance& value)
+{
+  profileReuseDistance_ = value;
+}
+
+void RadialLOS::resetWorkingSets_()
+{
+  elevationWorkingSets_.clear();
+  for (unsigned int k = 0; k < getComputeThreadCount(); ++k)
+    elevationWorkingSets_.push_back(std::make_unique<osgEarth::ElevationPool::WorkingSet>(WORKINGSET_SIZE));
+}
+
 bool RadialLOS::compute(osgEarth::MapNode* mapNode, const simCore::Coordinate& originCoord)
 {
   assert(mapNode != nullptr);
@@ -167,157 +208,219 @@ bool RadialLOS::compute(osgEarth::MapNode* mapNode, const simCore::Coordinate& o
 #endif
 
 
-  // clear out existing data
-  radials_.clear();
-
   // set up the localizer transforms:
-  if (!convertCoordToGeoPoint(originCoord, originMap_, mapNode->getMapSRS()))
+  osgEarth::GeoPoint newOriginMap;
+  if (!convertCoordToGeoPoint(originCoord, newOriginMap, mapNode->getMapSRS()))
+  {
+    radials_.clear();
     return false;
+  }
 
-  osg::Matrix local2world;
-  originMap_.createLocalToWorld(local2world);
+  simCore::CoordinateConverter cc;
+  simCore::Coordinate originLlaCoord;
+  cc.convert(originCoord, originLlaCoord, simCore::COORD_SYS_LLA);
+  cc.setReferenceOrigin(originLlaCoord.position());
+
+  // Terrain profiles from the previous compute are still good if nothing but the origin changed, and it did not move far
+  const osgEarth::Map* map = mapNode->getMap();
+  const bool reuseProfiles = !dirty_ && !radials_.empty() &&
+    profileMap_.get() == map && profileMapRevision_ == static_cast<int>(map->getDataModelRevision()) &&
+    simCore::calculateGroundDist(profileOriginLla_, originLlaCoord.position(), simCore::WGS_84, nullptr) <= profileReuseDistance_.as(osgEarth::Units::METERS);
 
-  // convert everything to the proper units:
-  double azim_center  = azim_center_.as(osgEarth::Units::RADIANS);
-  double fov          = fov_.as(osgEarth::Units::RADIANS);
-  double azim_res_rad = azim_resolution_.as(osgEarth::Units::RADIANS);
-  double range_max_m  = range_max_.as(osgEarth::Units::METERS);
-  double range_res_m  = range_resolution_.as(osgEarth::Units::METERS);
-
-  // collect the azimuth list:
-  std::vector<double> azimuths;
-  double   azim_min_rad = azim_center - 0.5*fov;
-  double   azim_max_rad = azim_center + 0.5*fov;
-  double   halfSpan       = 0.5 * (azim_max_rad - azim_min_rad);
-  double   halfCount      = halfSpan/azim_res_rad;
-  double   halfRemainder  = fmod(halfSpan, azim_res_rad);
-  unsigned int halfCountInt = static_cast<unsigned int>(floor(halfCount));
-  double remainder = halfRemainder;
-
-  // Precision issues can sometimes cause a remainder to exist when azim_res_rad divides halfSpan evenly
-  if (osg::equivalent(fov, azim_res_rad * 2 * halfCountInt))
-    remainder = 0.0;
-
-  double azim_iter = azim_min_rad;
-  if (!osg::equivalent(remainder, 0.0))
+  originMap_ = newOriginMap;
+  // Scene graph sampling is not thread safe
+  simCore::ThreadPool* pool = use_scene_graph_ ? nullptr : pool_.get();
+
+  if (!reuseProfiles)
   {
-    azimuths.push_back(azim_iter);
-    azim_iter += remainder;
+    // clear out existing data
+    radials_.clear();
+
+    osg::Matrix local2world;
+    originMap_.createLocalToWorld(local2world);
+
+    // convert everything to the proper units:
+    double azim_center  = azim_center_.as(osgEarth::Units::RADIANS);
+    double fov          = fov_.as(osgEarth::Units::RADIANS);
+    double azim_res_rad = azim_resolution_.as(osgEarth::Units::RADIANS);
+    double range_max_m  = range_max_.as(osgEarth::Units::METERS);
+    double range_res_m  = range_resolution_.as(osgEarth::Units::METERS);
+
+    // collect the azimuth list:
+    double   azim_min_rad = azim_center - 0.5*fov;
+    double   azim_max_rad = azim_center + 0.5*fov;
+    double   halfSpan       = 0.5 * (azim_max_rad - azim_min_rad);
+    double   halfCount      = halfSpan/azim_res_rad;
+    double   halfRemainder  = fmod(halfSpan, azim_res_rad);
+    unsigned int halfCountInt = static_cast<unsigned int>(floor(halfCount));
+    double remainder = halfRemainder;
+
+    // Precision issues can sometimes cause a remainder to exist when azim_res_rad divides halfSpan evenly
+    if (osg::equivalent(fov, azim_res_rad * 2 * halfCountInt))
+      remainder = 0.0;
+
+    double azim_iter = azim_min_rad;
+    if (!osg::equivalent(remainder, 0.0))
+    {
+      radials_.push_back(Radial(azim_iter));
+      azim_iter += remainder;
+    }
+    for (unsigned int i = 0; i <= 2 * halfCountInt; ++i)
+    {
+      radials_.push_back(Radial(azim_iter));
+      azim_iter += azim_res_rad;
+    }
+    if (!osg::equivalent(remainder, 0.0))
+    {
+      radials_.push_back(Radial(azim_max_rad));
+    }
+
+    // sample the terrain along each radial; each thread uses its own elevation cache
+    if (pool)
+    {
+      std::atomic<size_t> nextWorkingSet(0);
+      pool->parallelFor(radials_.size(), [&](size_t beginIndex, size_t endIndex) {
+        osgEarth::ElevationPool::WorkingSet* workingSet = elevationWorkingSets_[nextWorkingSet++].get();
+        for (size_t k = beginIndex; k < endIndex; ++k)
+          sampleRadial_(mapNode, local2world, range_max_m, range_res_m, workingSet, radials_[k]);
+      });
+    }
+    else
+    {
+      for (auto i = radials_.begin(); i != radials_.end(); ++i)
+        sampleRadial_(mapNode, local2world, range_max_m, range_res_m, elevationWorkingSets_.front().get(), *i);
+    }
+
+    profileOriginLla_ = originLlaCoord.position();
+    profileMap_ = map;
+    profileMapRevision_ = static_cast<int>(map->getDataModelRevision());
   }
-  for (unsigned int i = 0; i <= 2 * halfCountInt; ++i)
+
+  // calculate the visibility of every sample from the (possibly moved) origin
+  if (pool)
   {
-    azimuths.push_back(azim_iter);
-    azim_iter += azim_res_rad;
+    pool->parallelFor(radials_.size(), [&](size_t beginIndex, size_t endIndex) {
+      for (size_t k = beginIndex; k < endIndex; ++k)
+        computeVisibility_(mapNode, originLlaCoord.position(), cc, radials_[k]);
+    });
   }
-  if (!osg::equivalent(remainder, 0.0))
+  else
   {
-    azimuths.push_back(azim_max_rad);
+    for (auto i = radials_.begin(); i != radials_.end(); ++i)
+      computeVisibility_(mapNode, originLlaCoord.position(), cc, *i);
   }
 
-  simCore::CoordinateConverter cc;
-  simCore::Coordinate originLlaCoord;
-  cc.convert(originCoord, originLlaCoord, simCore::COORD_SYS_LLA);
-  cc.setReferenceOrigin(originLlaCoord.position());
-
+  // To be valid there needs to be at least two consecutive points on the same azimuth
   bool validLos = false;
-  // step through the azimuthal range:
-  for (std::vector<double>::iterator i = azimuths.begin(); i != azimuths.end(); ++i)
+  for (auto i = radials_.begin(); i != radials_.end() && !validLos; ++i)
   {
-    double azim_rad = *i;
-    double x = sin(azim_rad);
-    double y = cos(azim_rad);
-
-    radials_.push_back(Radial(azim_rad));
-    Radial& radial = radials_.back();
-
-    // Track the highest elevation along this azimuth to check for visibility
-    double maxElev = -2 * M_PI;
-    // step through the distance range:
-    bool rangeDone = false;
-    bool lastSampleValid = false;
-    for (double range_m = range_res_m; !rangeDone; range_m += range_res_m)
+    for (size_t k = 1; k < i->samples_.size(); ++k)
     {
-      if (range_m >= range_max_m)
+      if (i->samples_[k - 1].valid_ && i->samples_[k].valid_)
       {
-        range_m = range_max_m;
-        rangeDone = true;
+        validLos = true;
+        break;
       }
+    }
+  }
 
-      // calculate the world point:
-      osg::Vec3d sampleWorld = osg::Vec3d(x*range_m, y*range_m, 0.0) * local2world;
+  srs_ = mapNode->getMapSRS();
 
-      // convert to a map point
-      osgEarth::GeoPoint mapPoint;
-      mapPoint.fromWorld(mapNode->getMapSRS(), sampleWorld);
+  dirty_ = false;
 
-      // sample the terrain at that point
-      double hamsl = 0.0, hae = 0.0;
+#ifdef LOS_TIME_PROFILING
+  osg::Timer_t endTime = osg::Timer::instance()->tick();
+  SIM_NOTICE << "RLOS::compute time=" << osg::Timer::instance()->delta_m(startTime, endTime) << " ms" << std::endl;
+#endif
 
-      bool ok;
-      if (use_scene_graph_)
-      {
-        ok = mapNode->getTerrain()->getHeight(mapPoint.getSRS(), mapPoint.x(), mapPoint.y(), &hamsl, &hae);
-      }
-      else
-      {
-        osgEarth::ElevationSample sample = mapNode->getMap()->getElevationPool()->getSample(mapPoint, osgEarth::Distance(1.0, osgEarth::Units::METERS), elevationWorkingSet_.get());
-        hae = sample.elevation().as(osgEarth::Units::METERS);
-        hamsl = hae;
-        ok = true;
-        if (hae == NO_DATA_VALUE)
-        {
-          // If there is invalid data at a point treat it as 0 HAE.
-          hae = 0.0;
-          hamsl = 0.0;
-        }
-      }
+  return validLos;
+}
 
-      if (ok)
-      {
-        // see if the point is unobstructed.
-        mapPoint.z() = hae;
+void RadialLOS::sampleRadial_(osgEarth::MapNode* mapNode, const osg::Matrix& local2world, double range_max_m, double range_res_m,
+  osgEarth::ElevationPool::WorkingSet* workingSet, Radial& radial) const
+{
+  double x = sin(radial.azim_rad_);
+  double y = cos(radial.azim_rad_);
 
-        simCore::Coordinate destCoord;
-        convertGeoPointToCoord(mapPoint, destCoord, mapNode);
+  // step through the distance range:
+  bool rangeDone = false;
+  for (double range_m = range_res_m; !rangeDone; range_m += range_res_m)
+  {
+    if (range_m >= range_max_m)
+    {
+      range_m = range_max_m;
+      rangeDone = true;
+    }
 
-        double elev;
-        simCore::calculateAbsAzEl(originLlaCoord.position(), destCoord.position(), nullptr, &elev, nullptr, simCore::FLAT_EARTH, &cc);
+    // calculate the world point:
+    osg::Vec3d sampleWorld = osg::Vec3d(x*range_m, y*range_m, 0.0) * local2world;
 
-        bool visible = false;
-        if (elev >= maxElev)
-        {
-          maxElev = elev;
-          visible = true;
-        }
+    // convert to a map point
+    osgEarth::GeoPoint mapPoint;
+    mapPoint.fromWorld(mapNode->getMapSRS(), sampleWorld);
 
-        radial.samples_.push_back(Sample(range_m, mapPoint, hamsl, hae, elev, visible));
-        if (!validLos)
-        {
-          // To be valid there needs to be at least two consecutive points on the same azimuth
-          if (lastSampleValid)
-            validLos = true;
-          lastSampleValid = true;
-        }
-      }
-      else
+    // sample the terrain at that point
+    double hamsl = 0.0, hae = 0.0;
+
+    bool ok;
+    if (use_scene_graph_)
+    {
+      ok = mapNode->getTerrain()->getHeight(mapPoint.getSRS(), mapPoint.x(), mapPoint.y(), &hamsl, &hae);
+    }
+    else
+    {
+      osgEarth::ElevationSample sample = mapNode->getMap()->getElevationPool()->getSample(mapPoint, osgEarth::Distance(1.0, osgEarth::Units::METERS), workingSet);
+      hae = sample.elevation().as(osgEarth::Units::METERS);
+      hamsl = hae;
+      ok = true;
+      if (hae == NO_DATA_VALUE)
       {
-        // record an "invalid" sample
-        radial.samples_.push_back(Sample(range_m, mapPoint));
-        lastSampleValid = false;
+        // If there is invalid data at a point treat it as 0 HAE.
+        hae = 0.0;
+        hamsl = 0.0;
       }
     }
+
+    if (ok)
+    {
+      mapPoint.z() = hae;
+      // elevation and visibility are filled in by computeVisibility_()
+      radial.samples_.push_back(Sample(range_m, mapPoint, hamsl, hae, 0.0, false));
+    }
+    else
+    {
+      // record an "invalid" sample
+      radial.samples_.push_back(Sample(range_m, mapPoint));
+    }
   }
+}
 
-  srs_ = mapNode->getMapSRS();
+void RadialLOS::computeVisibility_(osgEarth::MapNode* mapNode, const simCore::Vec3& originLla, const simCore::CoordinateConverter& cc,
+  Radial& radial) const
+{
+  // Track the highest elevation along this azimuth to check for visibility
+  double maxElev = -2 * M_PI;
+  for (auto i = radial.samples_.begin(); i != radial.samples_.end(); ++i)
+  {
+    Sample& sample = *i;
+    if (!sample.valid_)
+      continue;
 
-  dirty_ = false;
+    // see if the point is unobstructed.
+    simCore::Coordinate destCoord;
+    convertGeoPointToCoord(sample.point_, destCoord, mapNode);
 
-#ifdef LOS_TIME_PROFILING
-  osg::Timer_t endTime = osg::Timer::instance()->tick();
-  SIM_NOTICE << "RLOS::compute time=" << osg::Timer::instance()->delta_m(startTime, endTime) << " ms" << std::endl;
-#endif
+    double elev;
+    simCore::calculateAbsAzEl(originLla, destCoord.position(), nullptr, &elev, nullptr, simCore::FLAT_EARTH, &cc);
+    sample.elev_rad_ = elev;
 
-  return validLos;
+    sample.visible_ = false;
+    if (elev >= maxElev)
+    {
+      maxElev = elev;
+      sample.visible_ = true;
+    }
+  }
 }
 
 // Note: this method only used when use_scene_graph_ == true
@@ -24,6 +24,7 @@
 #define SIMVIS_RADIAL_LOS_H
 
 #include <memory>
+#include <vector>
 #include "simCore/Common/Common.h"
 #include "simCore/Calc/Coordinate.h"
 #include "simVis/Types.h"
@@ -31,6 +32,12 @@
 #include "osgEarth/GeoData"
 #include "osgEarth/SpatialReference"
 #include "osg/Node"
+#include "osg/observer_ptr"
+
+namespace simCore {
+  class CoordinateConverter;
+  class ThreadPool;
+}
 
 namespace simVis
 {
@@ -165,6 +172,35 @@ public:
    */
   bool getUseSceneGraph() const { return use_scene_graph_; }
 
+  /**
+   * Sets the number of threads used to sample the terrain and compute visibility in compute().
+   * Radials are split across the threads.  Scene graph sampling always uses the calling thread.
+   * @param[in ] numThreads Total number of threads including the calling thread; 1 (default)
+   *   computes on the calling thread only, 0 uses all hardware threads
+   */
+  void setComputeThreadCount(unsigned int numThreads);
+
+  /**
+   * Gets the number of threads used in compute()
+   * @return Thread count, at least 1
+   */
+  unsigned int getComputeThreadCount() const;
+
+  /**
+   * Sets the maximum horizontal distance that the origin may move from where the terrain was last
+   * sampled while still reusing those terrain profiles.  When compute() reuses the profiles, only
+   * the elevation angles and visibility are recalculated from the new origin.  Changing any other
+   * setting, or a change to the map's layers, always resamples the terrain.
+   * @param[in ] value Reuse distance; 0 resamples the terrain unless the origin is unchanged
+   */
+  void setProfileReuseDistance(const osgEarth::Distance& value);
+
+  /**
+   * Gets the maximum origin movement for which terrain profiles are reused
+   * @return Reuse distance
+   */
+  const osgEarth::Distance& getProfileReuseDistance() const { return profileReuseDistance_; }
+
 public:
 
   /**
@@ -243,11 +279,31 @@ private:
   osgEarth::Angle     fov_;
   osgEarth::Angle     azim_resolution_;
   osg::ref_ptr<const osgEarth::SpatialReference> srs_;
-  std::unique_ptr<osgEarth::ElevationPool::WorkingSet> elevationWorkingSet_;
+  /// Elevation caches, one for each compute thread
+  std::vector<std::unique_ptr<osgEarth::ElevationPool::WorkingSet> > elevationWorkingSets_;
   bool use_scene_graph_;
+  /// Pool for compute(); shared between copies, nullptr for single threaded computes
+  std::shared_ptr<simCore::ThreadPool> pool_;
+  osgEarth::Distance  profileReuseDistance_;
+  /// Origin (LLA) at which the terrain profiles in radials_ were sampled
+  simCore::Vec3       profileOriginLla_;
+  /// Map and map revision from which the terrain profiles in radials_ were sampled
+  osg::observer_ptr<const osgEarth::Map> profileMap_;
+  int                 profileMapRevision_;
 
   bool getBoundingRadials_(double azim_rad, const Radial*& out_r0, const Radial*& out_r1, double& out_mix) const;
 
+  /** Creates one elevation working set for each compute thread */
+  void resetWorkingSets_();
+
+  /** Fills the radial with terrain samples out to the maximum range; computeVisibility_() completes the samples */
+  void sampleRadial_(osgEarth::MapNode* mapNode, const osg::Matrix& local2world, double range_max_m, double range_res_m,
+    osgEarth::ElevationPool::WorkingSet* workingSet, Radial& radial) const;
+
+  /** Calculates the elevation angle from the origin and the visibility of each valid sample in the radial */
+  void computeVisibility_(osgEarth::MapNode* mapNode, const simCore::Vec3& originLla, const simCore::CoordinateConverter& cc,
+    Radial& radial) const;
+
   bool makeRadial_(Radial& out_radial) const;
 };
 
@@ -627,6 +627,7 @@ void ScenarioManager::clearEntities(simData::DataStore* dataStore)
           entityGraph_->removeEntity(record);
 
           // remove it from the entities list (works because EntityRepo is a map, will not work for vector)
+          customRenderingIds_.erase(i->first);
           entities_.erase(i++);
         }
         else
@@ -643,6 +644,7 @@ void ScenarioManager::clearEntities(simData::DataStore* dataStore)
     // just remove everything.
     entityGraph_->clear();
     entities_.clear();
+    customRenderingIds_.clear();
     projectorManager_->clear();
     hosterTable_.clear();
   }
@@ -689,6 +691,7 @@ void ScenarioManager::removeEntity(simData::ObjectId id)
     }
 
     // remove it from the entities list
+    customRenderingIds_.erase(id);
     entities_.erase(i);
   }
   SAFETRYEND("removing entity from scenario");
@@ -890,6 +893,7 @@ CustomRenderingNode* ScenarioManager::addCustomRendering(const simData::CustomRe
   }
   entities_[node->getId()] = new EntityRecord(node, nullptr, &dataStore);
   hosterTable_.insert(std::make_pair((host ? host->getId() : 0), node->getId()));
+  customRenderingIds_.insert(node->getId());
 
   notifyToolsOfAdd_(node);
 
@@ -1322,23 +1326,42 @@ void ScenarioManager::update(simData::DataStore* ds, bool force)
     scenarioEciLocator_->setEciRotationTime(ds->updateTime(), ds->updateTime());
 
   EntityVector updates;
-
-  SAFETRYBEGIN;
-  for (EntityRepo::const_iterator i = entities_.begin(); i != entities_.end(); ++i)
-  {
-    EntityRecord* record = i->second.get();
-
-    bool appliedUpdate = false;
-
+  const auto updateRecord = [this, force, &updates](EntityRecord* record) {
     // Note that entity classes decide how to process 'force' and record->updateSlice_->hasChanged()
     if (record->updateFromDataStore(force))
     {
       updates.push_back(record->getEntityNode());
-      appliedUpdate = true;
+      entityGraph_->addOrUpdate(record);
     }
+  };
 
-    if (appliedUpdate)
-      entityGraph_->addOrUpdate(record);
+  SAFETRYBEGIN;
+  simData::DataStore::IdList changedIds;
+  if (!force && incrementalUpdate_ && ds->changedEntities(&changedIds))
+  {
+    // Hosted entities depend on their host's state, e.g. a beam turns off with its platform, so visit them too
+    std::set<simData::ObjectId> visitIds(customRenderingIds_.begin(), customRenderingIds_.end());
+    while (!changedIds.empty())
+    {
+      const simData::ObjectId id = changedIds.back();
+      changedIds.pop_back();
+      visitIds.insert(id);
+      const auto range = hosterTable_.equal_range(id);
+      for (auto it = range.first; it != range.second; ++it)
+        changedIds.push_back(it->second);
+    }
+
+    for (const simData::ObjectId id : visitIds)
+    {
+      const EntityRepo::const_iterator i = entities_.find(id);
+      if (i != entities_.end())
+        updateRecord(i->second.get());
+    }
+  }
+  else
+  {
+    for (EntityRepo::const_iterator i = entities_.begin(); i != entities_.end(); ++i)
+      updateRecord(i->second.get());
   }
   SAFETRYEND("checking scenario for updates");
 
@@ -1384,6 +1407,16 @@ void ScenarioManager::update(simData::DataStore* ds, bool force)
   }
 }
 
+void ScenarioManager::setIncrementalUpdate(bool incremental)
+{
+  incrementalUpdate_ = incremental;
+}
+
+bool ScenarioManager::incrementalUpdate() const
+{
+  return incrementalUpdate_;
+}
+
 void ScenarioManager::removeAllTools_()
 {
   std::vector< osg::ref_ptr<ScenarioTool> > scenarioTools;
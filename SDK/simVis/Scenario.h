@@ -355,6 +355,18 @@ public:
   /** Set whether to use the most precise elevation sampling method for platform clamping.  Using max precision may cause performance hits. */
   void setUseMaxElevClampPrec(bool useMaxPrec);
 
+  /**
+   * Enables or disables incremental updates.  When enabled, and the data store reports its changed
+   * entities through simData::DataStore::changedEntities(), update() visits only the changed entities,
+   * the entities they host, and custom renderings, instead of every entity in the scenario.  Entities
+   * that are not visited do not refresh time-dependent label content, such as generic data, or time
+   * ticks.  A forced update always visits every entity.  Off by default.
+   * @param incremental True to visit only changed entities on update
+   */
+  void setIncrementalUpdate(bool incremental);
+  /** Returns true if update() visits only changed entities; see setIncrementalUpdate() */
+  bool incrementalUpdate() const;
+
   /** Return the proper library name */
   virtual const char* libraryName() const { return "simVis"; }
 
@@ -474,6 +486,10 @@ protected:
   typedef std::multimap< simData::ObjectId, simData::ObjectId > HosterTable;
   /** Maps the hoster to the hostee, for hosted entity types */
   HosterTable hosterTable_;
+  /** Custom renderings have no data store slice to report changes, so incremental updates always visit them */
+  std::set<simData::ObjectId> customRenderingIds_;
+  /** When true, update() visits only the entities reported by the data store as changed */
+  bool incrementalUpdate_ = false;
 
   /** Maintains a list of scenario tools, like Range Tool */
   ScenarioToolVector scenarioTools_;
@@ -21,6 +21,7 @@
  *
  */
 #include <cmath>
+#include <vector>
 #include "simCore/Common/SDKAssert.h"
 #include "simCore/Calc/Angle.h"
 #include "simCore/Calc/Math.h"
@@ -28,6 +29,7 @@
 #include "simCore/Calc/CoordinateSystem.h"
 #include "simCore/Calc/Random.h"
 #include "simCore/Calc/NumericalAnalysis.h"
+#include "simCore/System/ThreadPool.h"
 
 namespace {
 
@@ -1822,6 +1824,95 @@ int testTangentPlane2Sphere()
   return rv;
 }
 
+
+int testRelativeGeometryBatch()
+{
+  int rv = 0;
+
+  // Scatter entities within a few hundred km of a center point
+  const simCore::Vec3 center(0.6, -1.3, 0.);
+  simCore::UniformVariable offset(-0.05, 0.05);
+  simCore::UniformVariable alt(0., 12000.);
+  simCore::UniformVariable angle(-M_PI, M_PI);
+  simCore::UniformVariable speed(0., 300.);
+  const auto makeEntities = [&](size_t count, std::vector<simCore::Vec3>& lla, std::vector<simCore::Vec3>& ori, std::vector<simCore::Vec3>& vel) {
+    for (size_t k = 0; k < count; ++k)
+    {
+      lla.push_back(simCore::Vec3(center.lat() + offset(), center.lon() + offset(), alt()));
+      ori.push_back(simCore::Vec3(angle(), 0.5 * angle() / M_PI, 0.2 * angle()));
+      vel.push_back(simCore::Vec3(speed(), speed(), 0.1 * speed()));
+    }
+  };
+  std::vector<simCore::Vec3> fromLla, fromOri, fromVel, toLla, toOri, toVel;
+  makeEntities(7, fromLla, fromOri, fromVel);
+  // Not a multiple of any SIMD width, to cover partial packs
+  makeEntities(1029, toLla, toOri, toVel);
+  const size_t numPairs = fromLla.size() * toLla.size();
+
+  simCore::CoordinateConverter cc;
+  cc.setReferenceOrigin(center);
+  simCore::ThreadPool pool(3);
+  const simCore::EarthModelCalculations models[] = { simCore::WGS_84, simCore::TANGENT_PLANE_WGS_84, simCore::FLAT_EARTH };
+  for (const auto model : models)
+  {
+    std::vector<double> azim(numPairs), elev(numPairs), cmp(numPairs), slant(numPairs), ground(numPairs), rangeRate(numPairs);
+    simCore::RelativeGeometryOutputs outputs;
+    outputs.azim = azim.data();
+    outputs.elev = elev.data();
+    outputs.cmp = cmp.data();
+    outputs.slant = slant.data();
+    outputs.ground = ground.data();
+    outputs.rangeRate = rangeRate.data();
+    rv += SDK_ASSERT(simCore::calculateRelativeGeometry(fromLla.size(), fromLla.data(), fromOri.data(), fromVel.data(),
+      toLla.size(), toLla.data(), toOri.data(), toVel.data(), model, &cc, outputs) == 0);
+
+    for (size_t i = 0; i < fromLla.size(); ++i)
+    {
+      for (size_t j = 0; j < toLla.size(); ++j)
+      {
+        const size_t k = i * toLla.size() + j;
+        double az = 0.;
+        double el = 0.;
+        double cp = 0.;
+        simCore::calculateRelAzEl(fromLla[i], fromOri[i], toLla[j], &az, &el, &cp, model, &cc);
+        rv += SDK_ASSERT(simCore::areEqual(simCore::angFixPI(azim[k] - az), 0., 1e-9));
+        rv += SDK_ASSERT(simCore::areEqual(elev[k], el, 1e-9));
+        rv += SDK_ASSERT(simCore::areEqual(cmp[k], cp, 1e-7));
+        rv += SDK_ASSERT(simCore::areEqual(slant[k], simCore::calculateSlant(fromLla[i], toLla[j], model, &cc), 1e-6));
+        rv += SDK_ASSERT(simCore::areEqual(ground[k], simCore::calculateGroundDist(fromLla[i], toLla[j], model, &cc), 1e-6));
+        // calculateRangeRate() references flat earth at the from position; the batch uses coordConv's frame
+        const double expectedRate = (model == simCore::FLAT_EARTH) ?
+          fromVel[i].length() * cos(fromOri[i].yaw() - az) - toVel[j].length() * cos(toOri[j].yaw() - az) :
+          simCore::calculateRangeRate(fromLla[i], fromOri[i], toLla[j], toOri[j], model, &cc, fromVel[i], toVel[j]);
+        rv += SDK_ASSERT(simCore::areEqual(rangeRate[k], expectedRate, 1e-6));
+      }
+    }
+
+    // Thread pool and partial outputs give identical results
+    std::vector<double> pooledAzim(numPairs), pooledGround(numPairs);
+    simCore::RelativeGeometryOutputs pooled;
+    pooled.azim = pooledAzim.data();
+    pooled.ground = pooledGround.data();
+    rv += SDK_ASSERT(simCore::calculateRelativeGeometry(fromLla.size(), fromLla.data(), fromOri.data(), nullptr,
+      toLla.size(), toLla.data(), nullptr, nullptr, model, &cc, pooled, &pool) == 0);
+    rv += SDK_ASSERT(pooledAzim == azim);
+    rv += SDK_ASSERT(pooledGround == ground);
+  }
+
+  // Missing inputs and unsupported models are rejected
+  simCore::RelativeGeometryOutputs outputs;
+  std::vector<double> rangeRate(numPairs);
+  outputs.rangeRate = rangeRate.data();
+  rv += SDK_ASSERT(simCore::calculateRelativeGeometry(fromLla.size(), fromLla.data(), fromOri.data(), nullptr,
+    toLla.size(), toLla.data(), toOri.data(), toVel.data(), simCore::WGS_84, nullptr, outputs) != 0);
+  rv += SDK_ASSERT(simCore::calculateRelativeGeometry(fromLla.size(), fromLla.data(), fromOri.data(), fromVel.data(),
+    toLla.size(), toLla.data(), toOri.data(), toVel.data(), simCore::FLAT_EARTH, nullptr, outputs) != 0);
+  rv += SDK_ASSERT(simCore::calculateRelativeGeometry(fromLla.size(), fromLla.data(), fromOri.data(), fromVel.data(),
+    toLla.size(), toLla.data(), toOri.data(), toVel.data(), simCore::PERFECT_SPHERE, &cc, outputs) != 0);
+
+  return rv;
+}
+
 }
 
 int CalculationTest(int argc, char* argv[])
@@ -1852,5 +1943,6 @@ int CalculationTest(int argc, char* argv[])
   rv += testAoaSideslipTotalAoa();
   rv += testBoresightAlphaBeta();
   rv += testTangentPlane2Sphere();
+  rv += testRelativeGeometryBatch();
   return rv;
 }
@@ -0,0 +1,276 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/CoordinateConverter.h"
+#include "simCore/Calc/Math.h"
+
+namespace {
+
+/** Positions stored as separate arrays, as used by the batch conversions */
+struct Positions
+{
+  std::vector<double> a;
+  std::vector<double> b;
+  std::vector<double> c;
+
+  explicit Positions(size_t count = 0) : a(count), b(count), c(count) {}
+  size_t size() const { return a.size(); }
+  void push_back(const simCore::Vec3& v) { a.push_back(v.x()); b.push_back(v.y()); c.push_back(v.z()); }
+  simCore::Vec3 at(size_t k) const { return simCore::Vec3(a[k], b[k], c[k]); }
+};
+
+/** Random geodetic positions, including poles, the date line and altitudes from the earth center to GEO */
+Positions randomLla(size_t count)
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> lat(-M_PI_2, M_PI_2);
+  std::uniform_real_distribution<double> lon(-M_PI, M_PI);
+  std::uniform_real_distribution<double> alt(-6.0e6, 4.0e7);
+  Positions rv;
+  rv.push_back(simCore::Vec3(M_PI_2, 0.0, 100.0));
+  rv.push_back(simCore::Vec3(-M_PI_2, 0.0, 100.0));
+  rv.push_back(simCore::Vec3(0.0, M_PI, 0.0));
+  rv.push_back(simCore::Vec3(0.0, -M_PI, 0.0));
+  for (size_t k = rv.size(); k < count; ++k)
+    rv.push_back(simCore::Vec3(lat(gen), lon(gen), (k % 3 == 0) ? alt(gen) : alt(gen) * 1e-3));
+  return rv;
+}
+
+int testGeodeticEcef()
+{
+  int rv = 0;
+  // Odd count exercises the partial pack at the end
+  const Positions lla = randomLla(1001);
+  Positions ecef(lla.size());
+  simCore::CoordinateConverter::convertGeodeticPosToEcef(lla.size(), lla.a.data(), lla.b.data(), lla.c.data(), ecef.a.data(), ecef.b.data(), ecef.c.data());
+  Positions back(lla.size());
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(ecef.size(), ecef.a.data(), ecef.b.data(), ecef.c.data(), back.a.data(), back.b.data(), back.c.data());
+
+  for (size_t k = 0; k < lla.size(); ++k)
+  {
+    simCore::Vec3 expectedEcef;
+    simCore::CoordinateConverter::convertGeodeticPosToEcef(lla.at(k), expectedEcef);
+    rv += SDK_ASSERT(simCore::v3AreEqual(ecef.at(k), expectedEcef, 1e-6));
+
+    simCore::Vec3 expectedLla;
+    simCore::CoordinateConverter::convertEcefToGeodeticPos(expectedEcef, expectedLla);
+    const simCore::Vec3 actualLla = back.at(k);
+    rv += SDK_ASSERT(simCore::areEqual(actualLla.lat(), expectedLla.lat(), 1e-12));
+    rv += SDK_ASSERT(simCore::areAnglesEqual(actualLla.lon(), expectedLla.lon(), 1e-12));
+    rv += SDK_ASSERT(simCore::areEqual(actualLla.alt(), expectedLla.alt(), 1e-6));
+  }
+
+  // Points on the Z axis and at the earth center
+  const double axisX[] = { 0.0, 0.0, 0.0 };
+  const double axisY[] = { 0.0, 0.0, 0.0 };
+  const double axisZ[] = { 7.0e6, -7.0e6, 0.0 };
+  double lat[3];
+  double lon[3];
+  double alt[3];
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(3, axisX, axisY, axisZ, lat, lon, alt);
+  for (size_t k = 0; k < 3; ++k)
+  {
+    simCore::Vec3 expected;
+    simCore::CoordinateConverter::convertEcefToGeodeticPos(simCore::Vec3(axisX[k], axisY[k], axisZ[k]), expected);
+    rv += SDK_ASSERT(lat[k] == expected.lat());
+    rv += SDK_ASSERT(lon[k] == expected.lon());
+    rv += SDK_ASSERT(simCore::areEqual(alt[k], expected.alt(), 1e-6));
+  }
+
+  // Output may replace input
+  Positions inPlace = lla;
+  simCore::CoordinateConverter::convertGeodeticPosToEcef(inPlace.size(), inPlace.a.data(), inPlace.b.data(), inPlace.c.data(), inPlace.a.data(), inPlace.b.data(), inPlace.c.data());
+  rv += SDK_ASSERT(inPlace.a == ecef.a && inPlace.b == ecef.b && inPlace.c == ecef.c);
+  return rv;
+}
+
+int testEciAndTangentPlane()
+{
+  int rv = 0;
+  const Positions lla = randomLla(257);
+  Positions ecef(lla.size());
+  simCore::CoordinateConverter::convertGeodeticPosToEcef(lla.size(), lla.a.data(), lla.b.data(), lla.c.data(), ecef.a.data(), ecef.b.data(), ecef.c.data());
+
+  // ECI times up to a year, plus one past the fast range reduction limit
+  std::vector<double> times(ecef.size());
+  for (size_t k = 0; k < times.size(); ++k)
+    times[k] = k * 123456.7;
+  times.back() = 1.0e11;
+
+  Positions eci(ecef.size());
+  simCore::CoordinateConverter::convertEcefToEciPos(ecef.size(), times.data(), ecef.a.data(), ecef.b.data(), ecef.c.data(), eci.a.data(), eci.b.data(), eci.c.data());
+  Positions ecefAgain(ecef.size());
+  simCore::CoordinateConverter::convertEciToEcefPos(eci.size(), times.data(), eci.a.data(), eci.b.data(), eci.c.data(), ecefAgain.a.data(), ecefAgain.b.data(), ecefAgain.c.data());
+
+  simCore::CoordinateConverter cc;
+  cc.setReferenceOriginDegrees(36.5, -120.25, 10.0);
+  Positions enu(ecef.size());
+  rv += SDK_ASSERT(cc.convertEcefToXEastPos(ecef.size(), ecef.a.data(), ecef.b.data(), ecef.c.data(), enu.a.data(), enu.b.data(), enu.c.data()) == 0);
+  Positions ecefFromEnu(ecef.size());
+  rv += SDK_ASSERT(cc.convertXEastToEcefPos(enu.size(), enu.a.data(), enu.b.data(), enu.c.data(), ecefFromEnu.a.data(), ecefFromEnu.b.data(), ecefFromEnu.c.data()) == 0);
+
+  for (size_t k = 0; k < ecef.size(); ++k)
+  {
+    const simCore::Coordinate ecefCoord(simCore::COORD_SYS_ECEF, ecef.at(k), times[k]);
+    simCore::Coordinate expected;
+    // Single point conversion reduces the angle with fmod(), which loses accuracy over long times
+    if (times[k] < 1.0e7)
+    {
+      simCore::CoordinateConverter::convertEcefToEci(ecefCoord, expected);
+      rv += SDK_ASSERT(simCore::v3AreEqual(eci.at(k), expected.position(), 1e-6));
+    }
+    const double angle = simCore::EARTH_ROTATION_RATE * times[k];
+    const simCore::Vec3 rotated(cos(angle) * ecef.a[k] - sin(angle) * ecef.b[k], cos(angle) * ecef.b[k] + sin(angle) * ecef.a[k], ecef.c[k]);
+    rv += SDK_ASSERT(simCore::v3AreEqual(eci.at(k), rotated, 1e-6));
+    rv += SDK_ASSERT(simCore::v3AreEqual(ecefAgain.at(k), ecef.at(k), 1e-6));
+
+    cc.convert(ecefCoord, expected, simCore::COORD_SYS_XEAST);
+    rv += SDK_ASSERT(simCore::v3AreEqual(enu.at(k), expected.position(), 1e-6));
+    rv += SDK_ASSERT(simCore::v3AreEqual(ecefFromEnu.at(k), ecef.at(k), 1e-6));
+  }
+
+  // Tangent plane requires a reference origin
+  simCore::CoordinateConverter noOrigin;
+  rv += SDK_ASSERT(noOrigin.convertEcefToXEastPos(ecef.size(), ecef.a.data(), ecef.b.data(), ecef.c.data(), enu.a.data(), enu.b.data(), enu.c.data()) != 0);
+  return rv;
+}
+
+/** Loads a comma separated NGA gold data file */
+Positions loadGoldData(const std::string& fileName, bool degrees)
+{
+  Positions rv;
+  std::ifstream in(fileName);
+  std::string line;
+  while (std::getline(in, line))
+  {
+    double values[3];
+    char* pos = &line[0];
+    int found = 0;
+    for (; found < 3; ++found)
+    {
+      char* end = nullptr;
+      values[found] = strtod(pos, &end);
+      if (end == pos)
+        break;
+      pos = (*end == ',') ? end + 1 : end;
+    }
+    if (found != 3)
+      continue;
+    if (degrees)
+      rv.push_back(simCore::Vec3(values[0] * simCore::DEG2RAD, values[1] * simCore::DEG2RAD, values[2]));
+    else
+      rv.push_back(simCore::Vec3(values[0], values[1], values[2]));
+  }
+  return rv;
+}
+
+/** Validates against the NGA gold data, with the tolerances in GoldDataCoordConvertTest */
+int testGoldData(const std::string& dataDir)
+{
+  const Positions lla = loadGoldData(dataDir + "/geodetic.dat", true);
+  const Positions ecef = loadGoldData(dataDir + "/geocentric.dat", false);
+  int rv = 0;
+  rv += SDK_ASSERT(!lla.a.empty() && lla.size() == ecef.size());
+  if (rv != 0)
+    return rv;
+
+  Positions outEcef(lla.size());
+  simCore::CoordinateConverter::convertGeodeticPosToEcef(lla.size(), lla.a.data(), lla.b.data(), lla.c.data(), outEcef.a.data(), outEcef.b.data(), outEcef.c.data());
+  Positions outLla(ecef.size());
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(ecef.size(), ecef.a.data(), ecef.b.data(), ecef.c.data(), outLla.a.data(), outLla.b.data(), outLla.c.data());
+  for (size_t k = 0; k < lla.size(); ++k)
+  {
+    rv += SDK_ASSERT(simCore::v3AreEqual(outEcef.at(k), ecef.at(k), 0.9));
+    rv += SDK_ASSERT(simCore::areEqual(outLla.a[k], lla.a[k], 1.57e-7));
+    rv += SDK_ASSERT(simCore::areEqual(outLla.b[k], lla.b[k], 1.57e-7));
+    rv += SDK_ASSERT(simCore::areEqual(outLla.c[k], lla.c[k], 0.9));
+  }
+  return rv;
+}
+
+/** Prints the throughput of single point and batch conversions */
+void benchmark()
+{
+  const size_t count = 200000;
+  const Positions lla = randomLla(count);
+  Positions ecef(count);
+  Positions out(count);
+  typedef std::chrono::steady_clock Clock;
+  auto pointsPerSecond = [count](Clock::time_point start) {
+    return count / std::chrono::duration<double>(Clock::now() - start).count();
+  };
+
+  Clock::time_point start = Clock::now();
+  simCore::Vec3 v;
+  for (size_t k = 0; k < count; ++k)
+  {
+    simCore::CoordinateConverter::convertGeodeticPosToEcef(lla.at(k), v);
+    ecef.a[k] = v.x();
+    ecef.b[k] = v.y();
+    ecef.c[k] = v.z();
+  }
+  const double llaToEcefSingle = pointsPerSecond(start);
+
+  start = Clock::now();
+  for (size_t k = 0; k < count; ++k)
+  {
+    simCore::CoordinateConverter::convertEcefToGeodeticPos(ecef.at(k), v);
+    out.a[k] = v.x();
+  }
+  const double ecefToLlaSingle = pointsPerSecond(start);
+
+  start = Clock::now();
+  simCore::CoordinateConverter::convertGeodeticPosToEcef(count, lla.a.data(), lla.b.data(), lla.c.data(), ecef.a.data(), ecef.b.data(), ecef.c.data());
+  const double llaToEcefBatch = pointsPerSecond(start);
+
+  start = Clock::now();
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(count, ecef.a.data(), ecef.b.data(), ecef.c.data(), out.a.data(), out.b.data(), out.c.data());
+  const double ecefToLlaBatch = pointsPerSecond(start);
+
+  std::cout << "Batch conversions using " << simCore::CoordinateConverter::batchInstructionSet() << ", points/second:\n"
+    << "  LLA to ECEF: single " << llaToEcefSingle << ", batch " << llaToEcefBatch << "\n"
+    << "  ECEF to LLA: single " << ecefToLlaSingle << ", batch " << ecefToLlaBatch << std::endl;
+}
+
+}
+
+int CoordConvertBatchTest(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += SDK_ASSERT(testGeodeticEcef() == 0);
+  rv += SDK_ASSERT(testEciAndTangentPlane() == 0);
+  if (argc > 1)
+    rv += SDK_ASSERT(testGoldData(argv[1]) == 0);
+  benchmark();
+
+  std::cout << "CoordConvertBatchTest: " << (rv == 0 ? "PASSED" : "FAILED") << std::endl;
+  return rv;
+}
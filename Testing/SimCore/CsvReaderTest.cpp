@@ -20,9 +20,14 @@
  * disclose, or release this software.
  *
  */
+#include <filesystem>
+#include <fstream>
+#include <random>
 #include <sstream>
 #include "simCore/Common/SDKAssert.h"
 #include "simCore/String/CsvReader.h"
+#include "simCore/System/File.h"
+#include "simCore/System/ThreadPool.h"
 
 namespace {
 
@@ -625,6 +630,239 @@ int testLimitReadToSingleLine()
   return rv;
 }
 
+/** Settings shared by CsvReader and MappedCsvReader */
+struct ReaderSettings
+{
+  bool singleLine = false;
+  bool midlineComments = true;
+  bool skipEmptyLines = true;
+  bool trimmed = false;
+};
+
+/** Reads text with CsvReader, MappedCsvReader, and MappedCsvReader split into chunks, returning number of differences */
+int compareMappedReader(const std::string& text, const ReaderSettings& settings, size_t numChunks)
+{
+  int rv = 0;
+  std::istringstream is(text);
+  simCore::CsvReader reader(is);
+  reader.setLimitReadToSingleLine(settings.singleLine);
+  reader.setAllowMidlineComments(settings.midlineComments);
+  simCore::MappedCsvReader mapped(text);
+  mapped.setLimitReadToSingleLine(settings.singleLine);
+  mapped.setAllowMidlineComments(settings.midlineComments);
+  std::vector<simCore::MappedCsvReader> chunks = mapped.split(numChunks);
+  rv += SDK_ASSERT(chunks.size() <= numChunks);
+  size_t chunkIndex = 0;
+
+  std::vector<std::string> tokens;
+  std::vector<std::string_view> mappedTokens;
+  std::vector<std::string_view> chunkTokens;
+  while (rv == 0)
+  {
+    const int readerRv = settings.trimmed ? reader.readLineTrimmed(tokens, settings.skipEmptyLines) : reader.readLine(tokens, settings.skipEmptyLines);
+    const int mappedRv = settings.trimmed ? mapped.readLineTrimmed(mappedTokens, settings.skipEmptyLines) : mapped.readLine(mappedTokens, settings.skipEmptyLines);
+    int chunkRv = 1;
+    for (; chunkIndex < chunks.size(); ++chunkIndex)
+    {
+      simCore::MappedCsvReader& chunk = chunks[chunkIndex];
+      chunkRv = settings.trimmed ? chunk.readLineTrimmed(chunkTokens, settings.skipEmptyLines) : chunk.readLine(chunkTokens, settings.skipEmptyLines);
+      if (chunkRv == 0)
+        break;
+    }
+    rv += SDK_ASSERT(readerRv == mappedRv);
+    rv += SDK_ASSERT(readerRv == chunkRv);
+    if (readerRv != 0 || rv != 0)
+      break;
+
+    rv += SDK_ASSERT(std::vector<std::string_view>(tokens.begin(), tokens.end()) == mappedTokens);
+    rv += SDK_ASSERT(mappedTokens == chunkTokens);
+    rv += SDK_ASSERT(reader.lineNumber() == mapped.lineNumber());
+    rv += SDK_ASSERT(reader.lineNumber() == chunks[chunkIndex].lineNumber());
+  }
+  return rv;
+}
+
+int testMappedCsvReaderMatches()
+{
+  int rv = 0;
+
+  const std::vector<std::string> texts = {
+    "one,two,three\nfour,five,six",
+    "one,two\n\nthree,four,five\n\nsix,seven\n",
+    "one  , two,thr  ee\r\n four ,   five,six\r\n",
+    "#CommentLine,PostComment\nNo Comment Line,Second Token\nComment#Mid-Line,PostComment\n",
+    "\"Quoted#CommentLine\",PostComment\n",
+    "\"open quote\n\",end quote\nnextline",
+    "\"\n\nfirst line\n\"\nfourth line",
+    "One,\"Two\"\"\nThree",
+    "One,\"Two\nThree",
+    "a,\"quote \" ends early,c\n\"\"\"\",\"\",\"a\"\"b\"\r\n\r\r\n,,\n",
+    "\"crlf\r\ninside\",\"cr\rinside\"\r\nlast\r",
+  };
+  for (const std::string& text : texts)
+  {
+    for (int flags = 0; flags < 16; ++flags)
+    {
+      ReaderSettings settings;
+      settings.singleLine = (flags & 1) != 0;
+      settings.midlineComments = (flags & 2) != 0;
+      settings.skipEmptyLines = (flags & 4) != 0;
+      settings.trimmed = (flags & 8) != 0;
+      for (size_t numChunks = 1; numChunks <= 4; ++numChunks)
+        rv += SDK_ASSERT(compareMappedReader(text, settings, numChunks) == 0);
+    }
+  }
+
+  // Random text of characters with special meaning
+  std::mt19937 gen(1);
+  const char chars[] = { 'a', 'b', ',', '"', '#', '\n', '\r', ' ' };
+  for (int k = 0; k < 5000; ++k)
+  {
+    std::string text;
+    const size_t length = gen() % 40;
+    for (size_t i = 0; i < length; ++i)
+      text += chars[gen() % sizeof(chars)];
+    ReaderSettings settings;
+    settings.singleLine = (gen() % 2) != 0;
+    settings.midlineComments = (gen() % 2) != 0;
+    settings.skipEmptyLines = (gen() % 2) != 0;
+    settings.trimmed = (gen() % 2) != 0;
+    rv += SDK_ASSERT(compareMappedReader(text, settings, 1 + gen() % 5) == 0);
+  }
+
+  return rv;
+}
+
+int testMappedCsvReaderTokens()
+{
+  int rv = 0;
+
+  // Tokens refer to the text, unless they differ from it
+  const std::string text = "one,\"two\",\"th\"\"ree\"\n\"four\r\n\",five\r\n";
+  simCore::MappedCsvReader reader(text);
+  std::vector<std::string_view> tokens;
+  rv += SDK_ASSERT(reader.readLine(tokens) == 0);
+  rv += SDK_ASSERT(tokens.size() == 3);
+  rv += SDK_ASSERT(tokens[0] == "one");
+  rv += SDK_ASSERT(tokens[0].data() == text.data());
+  rv += SDK_ASSERT(tokens[1] == "two");
+  rv += SDK_ASSERT(tokens[1].data() == text.data() + 5);
+  rv += SDK_ASSERT(tokens[2] == "th\"ree");
+  rv += SDK_ASSERT(reader.lineText() == "one,\"two\",\"th\"\"ree\"\n");
+  rv += SDK_ASSERT(reader.lineNumber() == 1);
+  rv += SDK_ASSERT(reader.readLine(tokens) == 0);
+  rv += SDK_ASSERT(tokens.size() == 2);
+  rv += SDK_ASSERT(tokens[0] == "four\n");
+  rv += SDK_ASSERT(tokens[1] == "five");
+  rv += SDK_ASSERT(reader.lineText() == "\"four\r\n\",five\r\n");
+  rv += SDK_ASSERT(reader.lineNumber() == 2);
+  rv += SDK_ASSERT(reader.readLine(tokens) == 1);
+  rv += SDK_ASSERT(tokens.empty());
+
+  // Trimming does not copy
+  simCore::MappedCsvReader trimReader(std::string_view(" a , b "));
+  rv += SDK_ASSERT(trimReader.readLineTrimmed(tokens) == 0);
+  rv += SDK_ASSERT(tokens.size() == 2);
+  rv += SDK_ASSERT(tokens[0] == "a");
+  rv += SDK_ASSERT(tokens[1] == "b");
+  rv += SDK_ASSERT(tokens[1].data() == trimReader.text().data() + 5);
+
+  // No text
+  simCore::MappedCsvReader empty;
+  rv += SDK_ASSERT(empty.readLine(tokens) == 1);
+  rv += SDK_ASSERT(empty.split(4).empty());
+
+  return rv;
+}
+
+int testMappedCsvReaderFile()
+{
+  int rv = 0;
+
+  std::error_code unused;
+  const std::string tempDir = simCore::pathJoin({ std::filesystem::temp_directory_path(unused).string(), "mappedCsvReaderTest" });
+  rv += SDK_ASSERT(simCore::mkdir(tempDir, true) == 0);
+  const std::string csvFile = simCore::pathJoin({ tempDir, "test.csv" });
+
+  // Lines with quoted newlines, so that chunks must be split on record boundaries rather than newlines
+  std::string text = "# time,name,value\n";
+  for (int k = 0; k < 1000; ++k)
+  {
+    text += std::to_string(k) + ",\"name " + std::to_string(k);
+    text += (k % 7 == 0) ? "\nsecond line\"" : "\"";
+    text += "," + std::to_string(k * 2) + "\n";
+  }
+  std::ofstream(csvFile, std::ios::out | std::ios::binary) << text;
+
+  simCore::MappedCsvReader reader;
+  rv += SDK_ASSERT(reader.open(simCore::pathJoin({ tempDir, "missing.csv" })) != 0);
+  rv += SDK_ASSERT(reader.open(csvFile) == 0);
+  rv += SDK_ASSERT(reader.text() == text);
+
+  // Read serially, then read chunks in parallel
+  std::vector<std::string> serial;
+  std::vector<size_t> serialLines;
+  std::vector<std::string_view> tokens;
+  while (reader.readLine(tokens) == 0)
+  {
+    rv += SDK_ASSERT(tokens.size() == 3);
+    serial.push_back(std::string(tokens[1]));
+    serialLines.push_back(reader.lineNumber());
+  }
+  rv += SDK_ASSERT(serial.size() == 1000);
+  rv += SDK_ASSERT(serial[7] == "name 7\nsecond line");
+  rv += SDK_ASSERT(serialLines[999] == 1000 + 1000 / 7 + 2);
+
+  rv += SDK_ASSERT(reader.open(csvFile) == 0);
+  std::vector<simCore::MappedCsvReader> chunks = reader.split(4);
+  rv += SDK_ASSERT(chunks.size() == 4);
+  std::vector<std::vector<std::string> > chunkNames(chunks.size());
+  std::vector<std::vector<size_t> > chunkLines(chunks.size());
+  simCore::ThreadPool pool(4);
+  pool.parallelFor(chunks.size(), [&](size_t beginIndex, size_t endIndex) {
+    std::vector<std::string_view> chunkTokens;
+    for (size_t k = beginIndex; k < endIndex; ++k)
+    {
+      while (chunks[k].readLine(chunkTokens) == 0)
+      {
+        chunkNames[k].push_back(std::string(chunkTokens[1]));
+        chunkLines[k].push_back(chunks[k].lineNumber());
+      }
+    }
+  });
+  std::vector<std::string> parallel;
+  std::vector<size_t> parallelLines;
+  for (size_t k = 0; k < chunks.size(); ++k)
+  {
+    rv += SDK_ASSERT(!chunkNames[k].empty());
+    parallel.insert(parallel.end(), chunkNames[k].begin(), chunkNames[k].end());
+    parallelLines.insert(parallelLines.end(), chunkLines[k].begin(), chunkLines[k].end());
+  }
+  rv += SDK_ASSERT(parallel == serial);
+  rv += SDK_ASSERT(parallelLines == serialLines);
+
+  // Chunks keep the file mapped after the reader is gone
+  {
+    simCore::MappedCsvReader fileReader;
+    rv += SDK_ASSERT(fileReader.open(csvFile) == 0);
+    chunks = fileReader.split(2);
+  }
+  rv += SDK_ASSERT(chunks.size() == 2);
+  rv += SDK_ASSERT(chunks[1].readLine(tokens) == 0);
+  rv += SDK_ASSERT(tokens.size() == 3);
+
+  // Empty files read no lines
+  const std::string emptyFile = simCore::pathJoin({ tempDir, "empty.csv" });
+  std::ofstream(emptyFile, std::ios::out | std::ios::binary).close();
+  rv += SDK_ASSERT(reader.open(emptyFile) == 0);
+  rv += SDK_ASSERT(reader.readLine(tokens) == 1);
+
+  chunks.clear();
+  reader = simCore::MappedCsvReader();
+  simCore::remove(tempDir, true);
+  return rv;
+}
+
 int testRowReader()
 {
   int rv = 0;
@@ -747,6 +985,9 @@ int CsvReaderTest(int argc, char *argv[])
   rv += SDK_ASSERT(testCommentsInMiddle() == 0);
   rv += SDK_ASSERT(testMultiLineNumber() == 0);
   rv += SDK_ASSERT(testLimitReadToSingleLine() == 0);
+  rv += SDK_ASSERT(testMappedCsvReaderMatches() == 0);
+  rv += SDK_ASSERT(testMappedCsvReaderTokens() == 0);
+  rv += SDK_ASSERT(testMappedCsvReaderFile() == 0);
   rv += SDK_ASSERT(testRowReader() == 0);
 
   return rv;
@@ -20,12 +20,21 @@
  * disclose, or release this software.
  *
  */
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
 #include "simCore/Calc/Angle.h"
 #include "simCore/Common/SDKAssert.h"
 #include "simCore/EM/AntennaPattern.h"
+#include "simCore/EM/Decibel.h"
 #include "simCore/EM/Propagation.h"
 #include "simCore/EM/RadarCrossSection.h"
+#include "simCore/System/File.h"
+#include "simCore/System/ThreadPool.h"
 
 #define EXAMPLE_RCS_FILE                  "fake_rcs_3.rcs"
 
@@ -677,6 +686,249 @@ int antennaPatternTest(int argc, char* argv[])
   return rv;
 }
 
+
+int testAntennaGainGrid()
+{
+  int rv = 0;
+
+  // Table that is linear between 10 degree points, so a half degree grid reproduces it
+  simCore::AntennaPatternTable table;
+  for (int deg = -180; deg <= 180; deg += 10)
+    table.setAzimData(static_cast<float>(deg * simCore::DEG2RAD), -0.001f * deg * deg);
+  for (int deg = -90; deg <= 90; deg += 10)
+    table.setElevData(static_cast<float>(deg * simCore::DEG2RAD), -0.002f * deg * deg);
+  table.setValid(true);
+  simCore::AntennaGainParameters params;
+  params.refGain_ = 10.f;
+
+  simCore::AntennaGainGrid grid;
+  rv += SDK_ASSERT(!grid.valid());
+  rv += SDK_ASSERT(grid.gain(0.f, 0.f) == simCore::SMALL_DB_VAL);
+  rv += SDK_ASSERT(grid.build(table, params, 0.f) != 0);
+  rv += SDK_ASSERT(grid.build(table, params) == 0);
+  rv += SDK_ASSERT(grid.valid());
+  rv += SDK_ASSERT(grid.azimCount() == 721);
+  rv += SDK_ASSERT(grid.elevCount() == 361);
+  float min = 0.f;
+  float max = 0.f;
+  grid.minMaxGain(&min, &max);
+  rv += SDK_ASSERT(simCore::areEqual(max, 10.f, 1e-3));
+  rv += SDK_ASSERT(simCore::areEqual(min, 10.f - (32.4f + 16.2f) / 2.f, 1e-3));
+
+  std::vector<float> azim;
+  std::vector<float> elev;
+  for (int k = 0; k < 1000; ++k)
+  {
+    azim.push_back(static_cast<float>(-M_PI + 2. * M_PI * ((k * 37) % 1000) / 1000.));
+    elev.push_back(static_cast<float>(-M_PI_2 + M_PI * ((k * 91) % 1000) / 1000.));
+  }
+
+  for (size_t k = 0; k < azim.size(); ++k)
+  {
+    params.azim_ = azim[k];
+    params.elev_ = elev[k];
+    const float expected = table.gain(params);
+    rv += SDK_ASSERT(simCore::areEqual(grid.gain(azim[k], elev[k]), expected, 1e-3));
+    // Azimuth wraps
+    rv += SDK_ASSERT(simCore::areEqual(grid.gain(azim[k] + static_cast<float>(2. * M_PI), elev[k]), expected, 1e-3));
+  }
+  // Elevation clamps
+  rv += SDK_ASSERT(grid.gain(0.5f, 2.f) == grid.gain(0.5f, static_cast<float>(M_PI_2)));
+  rv += SDK_ASSERT(grid.gain(0.5f, -2.f) == grid.gain(0.5f, static_cast<float>(-M_PI_2)));
+
+  // Batch results match single lookups exactly, including across threads
+  std::vector<float> gains(azim.size());
+  grid.gain(azim.size(), azim.data(), elev.data(), gains.data());
+  for (size_t k = 0; k < azim.size(); ++k)
+    rv += SDK_ASSERT(gains[k] == grid.gain(azim[k], elev[k]));
+  std::vector<float> pooledGains(azim.size());
+  simCore::ThreadPool pool(4);
+  pool.parallelFor(azim.size(), [&](size_t beginIndex, size_t endIndex) {
+    grid.gain(endIndex - beginIndex, &azim[beginIndex], &elev[beginIndex], &pooledGains[beginIndex]);
+  });
+  rv += SDK_ASSERT(pooledGains == gains);
+
+  // Invalid patterns do not build
+  simCore::AntennaPatternTable empty;
+  rv += SDK_ASSERT(grid.build(empty, params) != 0);
+  rv += SDK_ASSERT(!grid.valid());
+
+  return rv;
+}
+
+/** Small RCS LUT with angles in degrees and RCS in square meters */
+std::string rcsLutText(int tableType)
+{
+  std::ostringstream os;
+  os << "0\nTest pattern\n" << tableType << "\n0\n0.5\n4\n"
+    // 1000 MHz, 0 deg elev, horizontal
+    << "1000\n0\n1\n4\n0 0\n0 1\n90 2\n180 3\n270 4\n"
+    // 1000 MHz, 10 deg elev, horizontal
+    << "1000\n10\n1\n2\n0 0\n0 5\n180 7\n"
+    // 3000 MHz, 0 deg elev, horizontal
+    << "3000\n0\n1\n1\n0 0\n0 10\n"
+    // 1000 MHz, 0 deg elev, vertical
+    << "1000\n0\n2\n2\n0 0\n0 20\n180 40\n";
+  return os.str();
+}
+
+/** Compares const lookups of two RCS LUTs over a range of inputs, returning number of mismatches */
+int compareRcsLookups(const simCore::RCSLUT& lut1, const simCore::RCSLUT& lut2)
+{
+  int rv = 0;
+  const float freqs[] = { 500.f, 1000.f, 1999.f, 2000.f, 2001.f, 5000.f };
+  const simCore::PolarityType pols[] = { simCore::POLARITY_UNKNOWN, simCore::POLARITY_HORIZONTAL, simCore::POLARITY_VERTICAL, simCore::POLARITY_CIRCULAR };
+  for (float freq : freqs)
+  {
+    for (simCore::PolarityType pol : pols)
+    {
+      for (int elev = -20; elev <= 20; elev += 3)
+      {
+        for (int azim = -360; azim <= 360; azim += 7)
+          rv += SDK_ASSERT(lut1.lookupRCSsm(freq, azim * simCore::DEG2RAD, elev * simCore::DEG2RAD, pol) == lut2.lookupRCSsm(freq, azim * simCore::DEG2RAD, elev * simCore::DEG2RAD, pol));
+      }
+    }
+  }
+  return rv;
+}
+
+int testRcsLutLookup()
+{
+  int rv = 0;
+
+  simCore::RCSLUT lut;
+  std::istringstream is(rcsLutText(simCore::RCS_LUT_TYPE));
+  rv += SDK_ASSERT(lut.loadRCSFile(is) == 0);
+  const simCore::PolarityType horz = simCore::POLARITY_HORIZONTAL;
+  const double deg = simCore::DEG2RAD;
+
+  // Azimuth is interpolated, and clamps past the last azimuth
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(1000.f, 0., 0., horz), 1.f, 1e-5));
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(1000.f, 45 * deg, 0., horz), 1.5f, 1e-5));
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(1000.f, 315 * deg, 0., horz), 4.f, 1e-5));
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(1000.f, -45 * deg, 0., horz), 4.f, 1e-5));
+  // Elevation is interpolated, and clamps outside the tables
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(1000.f, 0., 5 * deg, horz), 3.f, 1e-5));
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(1000.f, 90 * deg, 5 * deg, horz), 4.f, 1e-5));
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(1000.f, 90 * deg, 20 * deg, horz), 6.f, 1e-5));
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(1000.f, 90 * deg, -5 * deg, horz), 2.f, 1e-5));
+  // Frequency uses nearest neighbor, favoring the lower frequency on ties
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(2000.f, 90 * deg, 0., horz), 2.f, 1e-5));
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(2001.f, 90 * deg, 0., horz), 10.f, 1e-5));
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(5000.f, 90 * deg, 0., horz), 10.f, 1e-5));
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(500.f, 90 * deg, 0., horz), 2.f, 1e-5));
+  // Unknown polarity uses the first polarity; missing polarities return -300 dB
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(1000.f, 90 * deg, 0., simCore::POLARITY_VERTICAL), 30.f, 1e-5));
+  rv += SDK_ASSERT(simCore::areEqual(lut.lookupRCSsm(1000.f, 90 * deg, 0., simCore::POLARITY_UNKNOWN), 2.f, 1e-5));
+  rv += SDK_ASSERT(lut.lookupRCSdB(1000.f, 90 * deg, 0., simCore::POLARITY_CIRCULAR) == -300.f);
+
+  // Non-const lookups match
+  for (int elev = -20; elev <= 20; elev += 3)
+  {
+    for (int azim = -360; azim <= 360; azim += 7)
+    {
+      rv += SDK_ASSERT(lut.RCSsm(1000.f, azim * deg, elev * deg, horz) == lut.lookupRCSsm(1000.f, azim * deg, elev * deg, horz));
+      rv += SDK_ASSERT(lut.RCSdB(3000.f, azim * deg, elev * deg) == lut.lookupRCSdB(3000.f, azim * deg, elev * deg));
+    }
+  }
+
+  // Symmetric tables mirror negative azimuths
+  simCore::RCSLUT symLut;
+  std::istringstream symIs(rcsLutText(simCore::RCS_SYM_LUT_TYPE));
+  rv += SDK_ASSERT(symLut.loadRCSFile(symIs) == 0);
+  rv += SDK_ASSERT(simCore::areEqual(symLut.lookupRCSsm(1000.f, -45 * deg, 0., horz), 1.5f, 1e-5));
+
+  // Mean distribution adds modulation
+  simCore::RCSLUT distLut;
+  std::istringstream distIs(rcsLutText(simCore::RCS_DISTRIBUTION_FUNC_TYPE));
+  rv += SDK_ASSERT(distLut.loadRCSFile(distIs) == 0);
+  rv += SDK_ASSERT(simCore::areEqual(distLut.lookupRCSsm(1000.f, 45 * deg, 0., horz), 2.f, 1e-5));
+  rv += SDK_ASSERT(distLut.RCSsm(1000.f, 45 * deg, 0., horz) == distLut.lookupRCSsm(1000.f, 45 * deg, 0., horz));
+
+  // Concurrent lookups match serial lookups
+  std::vector<float> serial;
+  for (int k = 0; k < 10000; ++k)
+    serial.push_back(lut.lookupRCSsm(1000.f + k % 3000, k * 0.01, (k % 41 - 20) * deg, horz));
+  std::vector<float> pooled(serial.size());
+  simCore::ThreadPool pool(4);
+  pool.parallelFor(pooled.size(), [&](size_t beginIndex, size_t endIndex) {
+    for (size_t k = beginIndex; k < endIndex; ++k)
+      pooled[k] = lut.lookupRCSsm(1000.f + k % 3000, k * 0.01, (static_cast<int>(k % 41) - 20) * deg, horz);
+  });
+  rv += SDK_ASSERT(pooled == serial);
+
+  return rv;
+}
+
+int testRcsLutCache()
+{
+  int rv = 0;
+
+  simCore::RCSLUT lut;
+  std::istringstream is(rcsLutText(simCore::RCS_LUT_TYPE));
+  rv += SDK_ASSERT(lut.loadRCSFile(is) == 0);
+
+  // Stream round trip
+  std::stringstream cache(std::ios::in | std::ios::out | std::ios::binary);
+  rv += SDK_ASSERT(lut.saveBinaryCache(cache) == 0);
+  simCore::RCSLUT cached;
+  rv += SDK_ASSERT(cached.loadBinaryCache(cache) == 0);
+  rv += compareRcsLookups(lut, cached);
+  rv += SDK_ASSERT(cached.mean() == lut.mean());
+  rv += SDK_ASSERT(cached.median() == lut.median());
+  rv += SDK_ASSERT(cached.min() == lut.min());
+  rv += SDK_ASSERT(cached.max() == lut.max());
+  rv += SDK_ASSERT(cached.modulation() == lut.modulation());
+
+  // Truncated and corrupt caches fail and reset the data
+  const std::string cacheBytes = cache.str();
+  std::istringstream truncated(cacheBytes.substr(0, cacheBytes.size() - 3), std::ios::in | std::ios::binary);
+  rv += SDK_ASSERT(cached.loadBinaryCache(truncated) != 0);
+  rv += SDK_ASSERT(cached.lookupRCSdB(1000.f, 0., 0.) == -300.f);
+  std::istringstream corrupt("X" + cacheBytes.substr(1), std::ios::in | std::ios::binary);
+  rv += SDK_ASSERT(cached.loadBinaryCache(corrupt) != 0);
+
+  // File caches, written next to the source file and to a cache directory
+  std::error_code unused;
+  // Unique per run, so that parallel runs of the test do not share files
+  const std::string tempDirName = "rcsCacheTest" + std::to_string(std::random_device()());
+  const std::string tempDir = simCore::pathJoin({ std::filesystem::temp_directory_path(unused).string(), tempDirName });
+  const std::string cacheDir = simCore::pathJoin({ tempDir, "cache" });
+  rv += SDK_ASSERT(simCore::mkdir(cacheDir, true) == 0);
+  const std::string rcsFile = simCore::pathJoin({ tempDir, "test.rcs" });
+  const std::string rcsText = rcsLutText(simCore::RCS_LUT_TYPE);
+  std::ofstream(rcsFile, std::ios::out | std::ios::binary) << rcsText;
+
+  simCore::RCSLUT fileLut;
+  fileLut.setBinaryCache(true);
+  rv += SDK_ASSERT(fileLut.loadRCSFile(rcsFile) == 0);
+  rv += SDK_ASSERT(simCore::FileInfo(rcsFile + ".rcsbin").isRegularFile());
+  rv += compareRcsLookups(lut, fileLut);
+  simCore::RCSLUT dirLut;
+  dirLut.setBinaryCache(true, cacheDir);
+  rv += SDK_ASSERT(dirLut.loadRCSFile(rcsFile) == 0);
+  rv += SDK_ASSERT(std::distance(std::filesystem::directory_iterator(cacheDir), std::filesystem::directory_iterator()) == 1);
+
+  // Replace the source with an invalid file of the same size and time; only cached loads succeed
+  const auto modTime = std::filesystem::last_write_time(rcsFile);
+  std::ofstream(rcsFile, std::ios::out | std::ios::binary) << std::string(rcsText.size(), '#');
+  std::filesystem::last_write_time(rcsFile, modTime);
+  simCore::RCSLUT uncachedLut;
+  rv += SDK_ASSERT(uncachedLut.loadRCSFile(rcsFile) != 0);
+  rv += SDK_ASSERT(fileLut.loadRCSFile(rcsFile) == 0);
+  rv += compareRcsLookups(lut, fileLut);
+  rv += SDK_ASSERT(dirLut.loadRCSFile(rcsFile) == 0);
+  rv += compareRcsLookups(lut, dirLut);
+
+  // Changing the source time invalidates the caches
+  std::filesystem::last_write_time(rcsFile, modTime + std::chrono::seconds(10));
+  rv += SDK_ASSERT(fileLut.loadRCSFile(rcsFile) != 0);
+  rv += SDK_ASSERT(dirLut.loadRCSFile(rcsFile) != 0);
+
+  simCore::remove(tempDir, true);
+  return rv;
+}
+
 }
 
 int EMTest(int argc, char* argv[])
@@ -689,6 +941,9 @@ int EMTest(int argc, char* argv[])
   rv += testOneWayFreeSpaceRangeLoss();
   rv += testLossToPpf();
   rv += antennaPatternTest(argc, argv);
+  rv += testAntennaGainGrid();
+  rv += testRcsLutLookup();
+  rv += testRcsLutCache();
 
   std::cout << "EMTests " << ((rv == 0) ? "Passed" : "Failed") << std::endl;
 
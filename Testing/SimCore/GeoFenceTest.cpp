@@ -22,10 +22,15 @@
  */
 #include <float.h>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
 #include "simCore/Common/SDKAssert.h"
 #include "simCore/Calc/Angle.h"
 #include "simCore/Calc/Coordinate.h"
+#include "simCore/Calc/CoordinateConverter.h"
 #include "simCore/Calc/GeoFence.h"
+#include "simCore/Calc/Geometry.h"
 
 namespace {
 
@@ -658,6 +663,185 @@ int testGeoFilter2DPolygonNPole()
   return rv;
 }
 
+/** Reference implementation of GeoFence::contains(), testing every triangle of the hull with no culling */
+bool bruteForceContains(const simCore::GeoFence& fence, const simCore::Vec3& ecef)
+{
+  const auto& triangles = fence.triangles();
+  if (triangles.empty())
+    return false;
+
+  // Backface plane, as calculated by GeoFence
+  const auto& points = fence.points();
+  simCore::Vec3 minV(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+  simCore::Vec3 maxV(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+  for (const auto& v : points)
+  {
+    for (size_t k = 0; k < 3; ++k)
+    {
+      minV[k] = std::min(minV[k], v[k]);
+      maxV[k] = std::max(maxV[k], v[k]);
+    }
+  }
+  const simCore::Plane backfacePlane(((minV + maxV) / 2.).normalize(), simCore::WGS_A * 4.);
+
+  const auto& ecefNormalized = ecef.normalize();
+  const auto& onSurface = ecefNormalized * simCore::WGS_A;
+  if (simCore::rayIntersectsPlane({ onSurface, -ecefNormalized }, backfacePlane).value_or(1.) >= 0.)
+    return false;
+
+  const double half = simCore::WGS_A * 0.5;
+  const std::vector<simCore::Vec3> targets = { {half, 0, 0}, {-half, 0, 0}, {0, half, 0}, {0, -half, 0}, {0, 0, half}, {0, 0, -half} };
+  size_t numInside = 0;
+  size_t numOutside = 0;
+  for (const auto& target : targets)
+  {
+    const simCore::Ray ray{ onSurface, (target - onSurface).normalize() };
+    int count = 0;
+    for (const auto& triangle : triangles)
+    {
+      if (simCore::rayIntersectsTriangle(ray, triangle, true).intersects)
+        ++count;
+    }
+    if (count % 2 == 1)
+      ++numInside;
+    else
+      ++numOutside;
+    if (numInside > 3 || numOutside > 3)
+      break;
+  }
+  return numInside > numOutside;
+}
+
+/** Creates a fence around the LLA center (rad) with a jagged, possibly concave outline */
+std::shared_ptr<simCore::GeoFence> makeRandomFence(std::mt19937& gen, double lat, double lon, double radius, size_t numPoints)
+{
+  std::uniform_real_distribution<double> jitter(0.3, 1.0);
+  std::vector<simCore::Vec3> lla;
+  for (size_t k = 0; k < numPoints; ++k)
+  {
+    const double angle = M_TWOPI * k / numPoints;
+    const double r = radius * jitter(gen);
+    lla.push_back(simCore::Vec3(lat + r * sin(angle), lon + r * cos(angle), 0.));
+  }
+  return std::make_shared<simCore::GeoFence>(lla, simCore::COORD_SYS_LLA);
+}
+
+/** Returns a random ECEF point within about twice the radius (rad) of the LLA center (rad) */
+simCore::Vec3 makeRandomPoint(std::mt19937& gen, double lat, double lon, double radius)
+{
+  std::uniform_real_distribution<double> offset(-2. * radius, 2. * radius);
+  std::uniform_real_distribution<double> alt(-100., 10000.);
+  simCore::Vec3 ecef;
+  simCore::CoordinateConverter::convertGeodeticPosToEcef(simCore::Vec3(simCore::angFix90(lat + offset(gen)), lon + offset(gen), alt(gen)), ecef);
+  return ecef;
+}
+
+int testAccelerationMatchesBruteForce()
+{
+  int rv = 0;
+  std::mt19937 gen(2718);
+  std::uniform_real_distribution<double> latDist(-80. * simCore::DEG2RAD, 80. * simCore::DEG2RAD);
+  std::uniform_real_distribution<double> lonDist(-M_PI, M_PI);
+  std::uniform_real_distribution<double> radiusDist(0.001, 0.6);
+
+  int mismatches = 0;
+  size_t numInside = 0;
+  for (int fenceNum = 0; fenceNum < 40; ++fenceNum)
+  {
+    const double lat = latDist(gen);
+    const double lon = lonDist(gen);
+    const double radius = radiusDist(gen);
+    const auto fence = makeRandomFence(gen, lat, lon, radius, 3 + fenceNum * 7);
+
+    std::vector<simCore::Vec3> points;
+    for (int k = 0; k < 200; ++k)
+      points.push_back(makeRandomPoint(gen, lat, lon, radius));
+    // Far away points, including the antipode
+    for (int k = 0; k < 20; ++k)
+      points.push_back(makeRandomPoint(gen, latDist(gen), lonDist(gen), 0.));
+    points.push_back(-points.front());
+
+    std::vector<bool> batch;
+    fence->contains(points, batch);
+    rv += SDK_ASSERT(batch.size() == points.size());
+    for (size_t k = 0; k < points.size(); ++k)
+    {
+      const bool expected = bruteForceContains(*fence, points[k]);
+      if (expected)
+        ++numInside;
+      if (fence->contains(points[k]) != expected || batch[k] != expected)
+        ++mismatches;
+    }
+  }
+  rv += SDK_ASSERT(mismatches == 0);
+  // Make sure the test is meaningful
+  rv += SDK_ASSERT(numInside > 400);
+
+  // Empty and invalid fences contain nothing
+  simCore::GeoFence empty;
+  std::vector<bool> batch = { true };
+  const std::vector<simCore::Vec3> points = { simCore::Vec3(simCore::WGS_A, 0., 0.), simCore::Vec3() };
+  empty.contains(points, batch);
+  rv += SDK_ASSERT(batch.size() == 2 && !batch[0] && !batch[1]);
+  return rv;
+}
+
+int testGeoFenceSet()
+{
+  int rv = 0;
+  std::mt19937 gen(31415);
+  std::uniform_real_distribution<double> latDist(-80. * simCore::DEG2RAD, 80. * simCore::DEG2RAD);
+  std::uniform_real_distribution<double> lonDist(-M_PI, M_PI);
+  std::uniform_real_distribution<double> radiusDist(0.01, 0.3);
+
+  std::vector<std::shared_ptr<simCore::GeoFence> > fences;
+  for (int k = 0; k < 100; ++k)
+    fences.push_back(makeRandomFence(gen, latDist(gen), lonDist(gen), radiusDist(gen), 12));
+  // Overlapping fences around the same center, and a hemisphere sized fence the cone cannot bound
+  fences.push_back(makeRandomFence(gen, 0.2, 0.3, 0.2, 8));
+  fences.push_back(makeRandomFence(gen, 0.2, 0.3, 0.1, 8));
+  const size_t nullIndex = fences.size();
+  fences.push_back(nullptr);
+  std::vector<simCore::Vec3> hemisphere;
+  for (int k = 0; k < 8; ++k)
+    hemisphere.push_back(simCore::Vec3(-10. * simCore::DEG2RAD, M_TWOPI * k / 8, 0.));
+  fences.push_back(std::make_shared<simCore::GeoFence>(hemisphere, simCore::COORD_SYS_LLA));
+
+  simCore::GeoFenceSet fenceSet(fences);
+  // Null fence keeps its index, so later fences keep theirs
+  rv += SDK_ASSERT(fenceSet.size() == fences.size());
+  rv += SDK_ASSERT(fenceSet.fence(nullIndex) == nullptr);
+  rv += SDK_ASSERT(fenceSet.fence(fenceSet.size()) == nullptr);
+  rv += SDK_ASSERT(fenceSet.fence(fenceSet.size() - 1) == fences.back());
+
+  int mismatches = 0;
+  size_t numFound = 0;
+  std::vector<size_t> indices;
+  for (int k = 0; k < 5000; ++k)
+  {
+    const simCore::Vec3& pt = (k % 2 == 0) ? makeRandomPoint(gen, 0.2, 0.3, 0.15) : makeRandomPoint(gen, latDist(gen), lonDist(gen), 0.);
+    std::vector<size_t> expected;
+    for (size_t index = 0; index < fences.size(); ++index)
+    {
+      if (fences[index] && fences[index]->contains(pt))
+        expected.push_back(index);
+    }
+    fenceSet.containing(pt, indices);
+    if (indices != expected || fenceSet.anyContains(pt) != !expected.empty())
+      ++mismatches;
+    numFound += expected.size();
+  }
+  rv += SDK_ASSERT(mismatches == 0);
+  rv += SDK_ASSERT(numFound > 2500);
+
+  fenceSet.clear();
+  rv += SDK_ASSERT(fenceSet.size() == 0);
+  fenceSet.containing(simCore::Vec3(simCore::WGS_A, 0., 0.), indices);
+  rv += SDK_ASSERT(indices.empty());
+  rv += SDK_ASSERT(!fenceSet.anyContains(simCore::Vec3(simCore::WGS_A, 0., 0.)));
+  return rv;
+}
+
 }
 
 int GeoFenceTest(int argc, char* argv[])
@@ -670,6 +854,8 @@ int GeoFenceTest(int argc, char* argv[])
   rv += SDK_ASSERT(testGeoFilter2DPolygonZeroDeg() == 0);
   rv += SDK_ASSERT(testGeoFilter2DPolygonDateline() == 0);
   rv += SDK_ASSERT(testGeoFilter2DPolygonNPole() == 0);
+  rv += SDK_ASSERT(testAccelerationMatchesBruteForce() == 0);
+  rv += SDK_ASSERT(testGeoFenceSet() == 0);
 
   std::cout << "GeoFenceTest: " << (rv == 0 ? "PASSED" : "FAILED") << "\n";
   return rv;
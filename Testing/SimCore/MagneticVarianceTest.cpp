@@ -20,7 +20,13 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
 #include "simCore/Common/SDKAssert.h"
 #include "simCore/Calc/Vec3.h"
 #include "simCore/Calc/Angle.h"
@@ -161,6 +167,88 @@ namespace
     return rv;
   }
 
+  int magneticVarianceGridTest()
+  {
+    int rv = 0;
+    simCore::WorldMagneticModel wmm;
+    simCore::MagneticVarianceGrid grid(183, 2022, simCore::DEG2RAD, simCore::DEG2RAD, 100. * 1000., 25. * 1000.);
+
+    // Tiles are computed on demand
+    rv += SDK_ASSERT(grid.numTiles() > 1);
+    rv += SDK_ASSERT(grid.numComputedTiles() == 0);
+    double varianceRad = 0.;
+    rv += SDK_ASSERT(grid.calculateMagneticVariance(simCore::Vec3(0., 120. * simCore::DEG2RAD, 0.), varianceRad) == 0);
+    rv += SDK_ASSERT(grid.numComputedTiles() == 1);
+    rv += SDK_ASSERT(simCore::areAnglesEqual(varianceRad * simCore::RAD2DEG, -0.06, 0.02));
+    // Top altitude layer, from WMM2020testvalues.pdf
+    rv += SDK_ASSERT(grid.calculateMagneticVariance(simCore::Vec3(0., 120. * simCore::DEG2RAD, 100. * 1000.), varianceRad) == 0);
+    rv += SDK_ASSERT(simCore::areAnglesEqual(varianceRad * simCore::RAD2DEG, -0.05, 0.02));
+
+    // Compare against the full model, away from the magnetic and geographic poles
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<double> latDist(-50. * simCore::DEG2RAD, 50. * simCore::DEG2RAD);
+    std::uniform_real_distribution<double> lonDist(-M_PI, M_PI);
+    std::uniform_real_distribution<double> altDist(-1000., 150. * 1000.);
+    std::vector<simCore::Vec3> positions;
+    std::vector<double> expected;
+    double maxError = 0.;
+    for (int k = 0; k < 5000; ++k)
+    {
+      simCore::Vec3 lla(latDist(gen), lonDist(gen), altDist(gen));
+      double gridVariance = 0.;
+      rv += SDK_ASSERT(grid.calculateMagneticVariance(lla, gridVariance) == 0);
+      // Grid clamps altitude to its range
+      lla.setAlt(std::clamp(lla.alt(), 0., 100. * 1000.));
+      double exactVariance = 0.;
+      wmm.calculateMagneticVariance(lla, 183, 2022, exactVariance);
+      maxError = std::max(maxError, std::fabs(simCore::angFixPI(gridVariance - exactVariance)));
+      positions.push_back(lla);
+      expected.push_back(gridVariance);
+    }
+    rv += SDK_ASSERT(maxError < 0.1 * simCore::DEG2RAD);
+
+    // Longitude wraps, latitude clamps at the poles
+    double wrapped = 0.;
+    rv += SDK_ASSERT(grid.calculateMagneticVariance(simCore::Vec3(0.3, 0.2 + M_TWOPI, 0.), wrapped) == 0);
+    rv += SDK_ASSERT(grid.calculateMagneticVariance(simCore::Vec3(0.3, 0.2, 0.), varianceRad) == 0);
+    rv += SDK_ASSERT(simCore::areAnglesEqual(wrapped, varianceRad, 1e-9));
+    rv += SDK_ASSERT(grid.calculateMagneticVariance(simCore::Vec3(M_PI_2, 0., 0.), varianceRad) == 0);
+    rv += SDK_ASSERT(grid.calculateMagneticVariance(simCore::Vec3(-2., 0., 0.), varianceRad) == 0);
+    rv += SDK_ASSERT(grid.calculateMagneticVariance(simCore::Vec3(std::numeric_limits<double>::quiet_NaN(), 0., 0.), varianceRad) != 0);
+
+    // Bearing conversions round trip
+    double bearing = 1.0;
+    rv += SDK_ASSERT(grid.calculateMagneticBearing(positions[0], bearing) == 0);
+    rv += SDK_ASSERT(simCore::areAnglesEqual(bearing, 1.0 - expected[0], 1e-9));
+    rv += SDK_ASSERT(grid.calculateTrueBearing(positions[0], bearing) == 0);
+    rv += SDK_ASSERT(simCore::areAnglesEqual(bearing, 1.0, 1e-9));
+
+    // Queries from many threads on a fresh grid must fill in tiles consistently
+    simCore::MagneticVarianceGrid sharedGrid(183, 2022, simCore::DEG2RAD, simCore::DEG2RAD, 100. * 1000., 25. * 1000.);
+    std::vector<int> mismatches(4, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < mismatches.size(); ++t)
+    {
+      threads.emplace_back([&sharedGrid, &positions, &expected, &mismatches, t]() {
+        for (size_t k = 0; k < positions.size(); ++k)
+        {
+          const size_t index = (k + t * 997) % positions.size();
+          double value = 0.;
+          if (sharedGrid.calculateMagneticVariance(positions[index], value) != 0 || value != expected[index])
+            ++mismatches[t];
+        }
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+    for (int count : mismatches)
+      rv += SDK_ASSERT(count == 0);
+
+    sharedGrid.computeAll();
+    rv += SDK_ASSERT(sharedGrid.numComputedTiles() == sharedGrid.numTiles());
+    return rv;
+  }
+
 }
 
 int MagneticVarianceTest(int argc, char* argv[])
@@ -168,6 +256,7 @@ int MagneticVarianceTest(int argc, char* argv[])
   int rv = 0;
 
   rv += calculateMagneticVarianceTest();
+  rv += magneticVarianceGridTest();
 
   std::cout << "MagneticVarianceTest " << ((rv == 0) ? "Passed" : "Failed") << std::endl;
 
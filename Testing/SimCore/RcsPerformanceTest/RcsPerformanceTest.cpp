@@ -0,0 +1,195 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/MathConstants.h"
+#include "simCore/EM/RadarCrossSection.h"
+#include "simCore/System/File.h"
+#include "simCore/System/ThreadPool.h"
+#include "simNotify/Notify.h"
+
+namespace {
+
+/** Number of lookups timed for each lookup method */
+static const size_t NUM_LOOKUPS = 2000000;
+/** Number of times each load is repeated; the best time is reported */
+static const int NUM_LOADS = 3;
+
+/** Writes an RCS LUT with 2 polarities, 20 frequencies, and 1 degree elevation and azimuth steps */
+void writeRcsLut(const std::string& fname)
+{
+  std::ofstream os(fname, std::ios::out | std::ios::binary);
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<float> rcsDist(0.1f, 100.f);
+  const int numFreqs = 20;
+  const int numElevs = 61;
+  const int numAzims = 360;
+  os << "0\nPerformance test pattern\n" << simCore::RCS_LUT_TYPE << "\n0\n0.5\n" << 2 * numFreqs * numElevs << "\n";
+  for (int pol = simCore::POLARITY_HORIZONTAL; pol <= simCore::POLARITY_VERTICAL; ++pol)
+  {
+    for (int freq = 0; freq < numFreqs; ++freq)
+    {
+      for (int elev = -30; elev < -30 + numElevs; ++elev)
+      {
+        os << 1000 + 500 * freq << "\n" << elev << "\n" << pol << "\n" << numAzims << "\n0 0\n";
+        for (int azim = 0; azim < numAzims; ++azim)
+          os << azim << " " << rcsDist(gen) << "\n";
+      }
+    }
+  }
+}
+
+/** Returns the elapsed time since start in milliseconds */
+double elapsedMs(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** Loads the file NUM_LOADS times and returns the best load time in milliseconds, or a negative value on error */
+double timeLoad(simCore::RCSLUT& lut, const std::string& fname)
+{
+  double bestMs = -1.;
+  for (int k = 0; k < NUM_LOADS; ++k)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    if (lut.loadRCSFile(fname) != 0)
+      return -1.;
+    const double ms = elapsedMs(start);
+    if (bestMs < 0. || ms < bestMs)
+      bestMs = ms;
+  }
+  return bestMs;
+}
+
+/** Input to a single RCS lookup */
+struct LookupInput
+{
+  float freq;
+  double azim;
+  double elev;
+  simCore::PolarityType pol;
+};
+
+void reportLookups(const std::string& name, double ms, float checksum)
+{
+  std::cout << "  " << name << ": " << ms << " ms, " << (NUM_LOOKUPS / ms / 1000.) << " M lookups/s (checksum " << checksum << ")" << std::endl;
+}
+
+}
+
+/**
+ * Times loading an RCS file from text and from its binary cache, and times the non-const
+ * RCSsm() lookups against the const lookupRCSsm() lookups, serially and in a thread pool.
+ * Usage: RcsPerformanceTest [rcsFile]
+ * Without a file, a generated RCS LUT is used.
+ */
+int main(int argc, char* argv[])
+{
+  // Each load logs the file name; keep the output to the timings
+  simNotify::setNotifyLevel(simNotify::NOTIFY_WARN);
+
+  std::error_code unused;
+  const std::string tempDir = simCore::pathJoin({ std::filesystem::temp_directory_path(unused).string(), "rcsPerformanceTest" + std::to_string(std::random_device()()) });
+  if (simCore::mkdir(tempDir, true) != 0)
+  {
+    std::cerr << "Unable to create " << tempDir << std::endl;
+    return 1;
+  }
+  std::string fname;
+  if (argc > 1)
+    fname = argv[1];
+  else
+  {
+    fname = simCore::pathJoin({ tempDir, "generated.rcs" });
+    writeRcsLut(fname);
+  }
+  std::cout << "RCS file " << fname << " (" << std::filesystem::file_size(fname, unused) << " bytes):" << std::endl;
+
+  simCore::RCSLUT textLut;
+  const double textMs = timeLoad(textLut, fname);
+  simCore::RCSLUT cachedLut;
+  cachedLut.setBinaryCache(true, tempDir);
+  // First load parses the text and writes the cache
+  const auto start = std::chrono::steady_clock::now();
+  const int cacheRv = cachedLut.loadRCSFile(fname);
+  const double writeMs = elapsedMs(start);
+  const double cacheMs = timeLoad(cachedLut, fname);
+  if (textMs < 0. || cacheRv != 0 || cacheMs < 0.)
+  {
+    std::cerr << "Unable to load " << fname << std::endl;
+    simCore::remove(tempDir, true);
+    return 1;
+  }
+  std::cout << "  Text parse: " << textMs << " ms" << std::endl;
+  std::cout << "  Text parse and cache write: " << writeMs << " ms" << std::endl;
+  std::cout << "  Cache load: " << cacheMs << " ms" << std::endl;
+
+  std::mt19937 gen(5678);
+  std::uniform_real_distribution<float> freqDist(500.f, 12000.f);
+  std::uniform_real_distribution<double> azimDist(-M_PI, M_PI);
+  std::uniform_real_distribution<double> elevDist(-40. * simCore::DEG2RAD, 40. * simCore::DEG2RAD);
+  std::vector<LookupInput> inputs(NUM_LOOKUPS);
+  for (auto& input : inputs)
+  {
+    input.freq = freqDist(gen);
+    input.azim = azimDist(gen);
+    input.elev = elevDist(gen);
+    input.pol = (gen() % 2 == 0) ? simCore::POLARITY_HORIZONTAL : simCore::POLARITY_VERTICAL;
+  }
+
+  // Sum the results so that the lookups cannot be optimized out
+  auto lookupStart = std::chrono::steady_clock::now();
+  float checksum = 0.f;
+  for (const auto& input : inputs)
+    checksum += textLut.RCSsm(input.freq, input.azim, input.elev, input.pol);
+  reportLookups("RCSsm", elapsedMs(lookupStart), checksum);
+
+  lookupStart = std::chrono::steady_clock::now();
+  checksum = 0.f;
+  for (const auto& input : inputs)
+    checksum += textLut.lookupRCSsm(input.freq, input.azim, input.elev, input.pol);
+  reportLookups("lookupRCSsm", elapsedMs(lookupStart), checksum);
+
+  simCore::ThreadPool pool;
+  std::vector<float> results(inputs.size());
+  const simCore::RCSLUT& constLut = textLut;
+  lookupStart = std::chrono::steady_clock::now();
+  pool.parallelFor(inputs.size(), [&inputs, &results, &constLut](size_t beginIndex, size_t endIndex) {
+    for (size_t k = beginIndex; k < endIndex; ++k)
+      results[k] = constLut.lookupRCSsm(inputs[k].freq, inputs[k].azim, inputs[k].elev, inputs[k].pol);
+  });
+  const double pooledMs = elapsedMs(lookupStart);
+  checksum = 0.f;
+  for (float rcs : results)
+    checksum += rcs;
+  reportLookups("lookupRCSsm, " + std::to_string(pool.numThreads()) + " threads", pooledMs, checksum);
+
+  simCore::remove(tempDir, true);
+  return 0;
+}
@@ -0,0 +1,104 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <vector>
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/System/ThreadPool.h"
+
+namespace {
+
+int testParallelFor(unsigned int numThreads)
+{
+  int rv = 0;
+  simCore::ThreadPool pool(numThreads);
+  rv += SDK_ASSERT(pool.numThreads() == numThreads);
+
+  // Every index must be visited exactly once, regardless of how the range divides
+  for (size_t count : { 0, 1, 3, 4, 5, 1000, 1001 })
+  {
+    std::vector<int> visits(count, 0);
+    std::atomic<int> numCalls = 0;
+    pool.parallelFor(count, [&visits, &numCalls](size_t beginIndex, size_t endIndex) {
+      ++numCalls;
+      for (size_t k = beginIndex; k < endIndex; ++k)
+        ++visits[k];
+    });
+    rv += SDK_ASSERT(std::all_of(visits.begin(), visits.end(), [](int v) { return v == 1; }));
+    rv += SDK_ASSERT(numCalls <= static_cast<int>(numThreads));
+    if (count > 0)
+      rv += SDK_ASSERT(numCalls >= 1);
+  }
+
+  // Nested calls must not deadlock
+  std::atomic<size_t> sum = 0;
+  pool.parallelFor(8, [&pool, &sum](size_t beginIndex, size_t endIndex) {
+    for (size_t k = beginIndex; k < endIndex; ++k)
+    {
+      pool.parallelFor(100, [&sum](size_t innerBegin, size_t innerEnd) {
+        sum += innerEnd - innerBegin;
+      });
+    }
+  });
+  rv += SDK_ASSERT(sum == 800);
+
+  return rv;
+}
+
+int testExecute()
+{
+  int rv = 0;
+  std::atomic<int> count = 0;
+  {
+    simCore::ThreadPool pool(3);
+    for (int k = 0; k < 100; ++k)
+      pool.execute([&count]() { ++count; });
+    // Destructor completes the outstanding tasks
+  }
+  rv += SDK_ASSERT(count == 100);
+
+  // Without workers, the task runs immediately
+  simCore::ThreadPool serialPool(1);
+  serialPool.execute([&count]() { ++count; });
+  rv += SDK_ASSERT(count == 101);
+
+  return rv;
+}
+
+}
+
+int ThreadPoolTest(int argc, char* argv[])
+{
+  int rv = 0;
+
+  rv += SDK_ASSERT(testParallelFor(1) == 0);
+  rv += SDK_ASSERT(testParallelFor(2) == 0);
+  rv += SDK_ASSERT(testParallelFor(4) == 0);
+  rv += SDK_ASSERT(testExecute() == 0);
+  rv += SDK_ASSERT(simCore::ThreadPool().numThreads() >= 1);
+
+  std::cout << "simCore ThreadPoolTest: " << (rv == 0 ? "PASSED" : "FAILED") << "\n";
+
+  return rv;
+}
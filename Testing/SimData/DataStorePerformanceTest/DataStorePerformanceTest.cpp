@@ -20,14 +20,20 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include <fstream>
+#include <random>
+#include <thread>
 
 #include "simCore/Common/Version.h"
 #include "simCore/String/UtfUtils.h"
+#include "simData/ColumnarPlatformUpdateSlice.h"
 #include "simData/MemoryDataStore.h"
 #include "simData/LinearInterpolator.h"
 #include "simData/DataTable.h"
 #include "simData/CategoryData/CategoryFilter.h"
+#include "simData/CategoryData/CategoryNameManager.h"
+#include "simData/CategoryData/CompiledCategoryFilter.h"
 #include "simCore/Time/Utils.h"
 #include "simCore/Calc/Math.h"
 #include "simCore/Common/SDKAssert.h"
@@ -566,7 +572,9 @@ struct TopLevelOptions
     dataLimiting(false),
     playforward(true),
     addListener(true),
-    testCD(false)
+    testCD(false),
+    updateThreads(1),
+    scaling(false)
   {
   }
 
@@ -578,6 +586,8 @@ struct TopLevelOptions
   bool playforward;  // True = move time forwards, False = move time backwards
   bool addListener;  // True = count the number of callbacks
   bool testCD;       // True = testing will include testing of CategoryData
+  unsigned int updateThreads;  // Number of threads for the platform update, 0 for hardware concurrency
+  bool scaling;      // True = repeat the file mode playback with increasing thread counts
 };
 
 /// Initializes the DataStore and creates all the entities
@@ -628,13 +638,442 @@ int cleanUpDataStore(simData::DataStore& ds, const TopLevelOptions& options, Ent
       // time counter will be <= calculated count due to ds not updating when nothing changes
       rv += SDK_ASSERT(counters.time <= static_cast<size_t>(options.numberOfSeconds*options.frameRate + 1));  // The plus 1 because of the update to force the remove callback
     }
-    else
+    else if (!options.scaling)
       rv += SDK_ASSERT(counters.time == static_cast<size_t>(options.numberOfSeconds*options.frameRate + 1));  // The plus 1 because of the update to force the remove callback
   }
 
   return rv;
 }
 
+/// Plays back the loaded data once and returns the elapsed time in seconds
+double playback(simData::DataStore& ds, const TopLevelOptions& options, Entities& entities)
+{
+  double direction = 1.0;
+  int offset = 0;
+  if (!options.playforward)
+  {
+    // Change the values to cause a reverse playback
+    direction *= -1.0;
+    offset = -options.numberOfSeconds*options.frameRate;
+  }
+
+  const double startTime = simCore::systemTimeToSecsBgnYr();
+  for (int ii = 0; ii < options.numberOfSeconds*options.frameRate; ii++)
+  {
+    // Add the 0.0001 so we never get an exact hit
+    const double time = 0.0001 + direction*static_cast<double>(ii+offset)/static_cast<double>(options.frameRate);
+    ds.update(time);
+    if (options.testCD && entities.platforms->initialId() > 0)
+    {
+      simData::CategoryFilter::CurrentCategoryValues curVals;
+      simData::CategoryFilter::getCurrentCategoryValues(ds, entities.platforms->initialId(), curVals);
+      simData::CategoryFilter::CurrentCategoryValues curVals2;
+      simData::CategoryFilter::getCurrentCategoryValues(ds, entities.platforms->lastId(), curVals2);
+    }
+  }
+
+  const double endTime = simCore::systemTimeToSecsBgnYr();
+  return endTime-startTime;
+}
+
+/// Repeats the playback with 1, 2, 4, ... threads up to the hardware concurrency and reports the speedup; returns the average pass time
+double scalingPlayback(simData::MemoryDataStore& ds, const TopLevelOptions& options, Entities& entities)
+{
+  const unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+  const double numFrames = static_cast<double>(options.numberOfSeconds*options.frameRate);
+  double singleThreadTime = 0.0;
+  double totalTime = 0.0;
+  int numPasses = 0;
+  unsigned int threads = 1;
+  while (true)
+  {
+    ds.setUpdateThreadCount(threads);
+    const double elapsed = playback(ds, options, entities);
+    totalTime += elapsed;
+    ++numPasses;
+    if (threads == 1)
+      singleThreadTime = elapsed;
+
+    std::cout << "Update threads " << threads << ": " << elapsed * 1000.0 / numFrames << " ms/update, speedup "
+      << (elapsed > 0.0 ? singleThreadTime / elapsed : 0.0) << std::endl;
+
+    if (threads == maxThreads)
+      break;
+    threads = std::min(threads * 2, maxThreads);
+  }
+
+  ds.setUpdateThreadCount(options.updateThreads);
+  // Report the average pass so the caller's per-update average stays meaningful
+  return totalTime / numPasses;
+}
+
+/// Times the ID based lookups that the update loops and callers rely on, for every entity in the data store
+void entityLookups(const simData::DataStore& ds)
+{
+  const int numPasses = 10;
+  simData::DataStore::IdList ids;
+  const double idListStart = simCore::systemTimeToSecsBgnYr();
+  for (int pass = 0; pass < numPasses; ++pass)
+  {
+    ids.clear();
+    ds.idList(&ids);
+  }
+  const double idListTime = simCore::systemTimeToSecsBgnYr() - idListStart;
+
+  // Shuffle so the lookups do not walk the containers in storage order
+  std::vector<simData::ObjectId> shuffled(ids.begin(), ids.end());
+  std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1234));
+
+  size_t found = 0;
+  const double typeStart = simCore::systemTimeToSecsBgnYr();
+  for (int pass = 0; pass < numPasses; ++pass)
+  {
+    for (const auto id : shuffled)
+    {
+      if (ds.objectType(id) != simData::NONE)
+        ++found;
+    }
+  }
+  const double typeTime = simCore::systemTimeToSecsBgnYr() - typeStart;
+
+  const double prefsStart = simCore::systemTimeToSecsBgnYr();
+  for (int pass = 0; pass < numPasses; ++pass)
+  {
+    for (const auto id : shuffled)
+    {
+      simData::DataStore::Transaction txn;
+      if (ds.commonPrefs(id, &txn) != nullptr)
+        ++found;
+    }
+  }
+  const double prefsTime = simCore::systemTimeToSecsBgnYr() - prefsStart;
+
+  const double numLookups = static_cast<double>(std::max<size_t>(1, numPasses * shuffled.size()));
+  std::cout << "Entity lookups for " << ids.size() << " entities (" << found << " hits):" << std::endl
+    << "  idList " << idListTime * 1000.0 / numPasses << " ms" << std::endl
+    << "  objectType " << typeTime * 1.0e9 / numLookups << " ns/lookup" << std::endl
+    << "  commonPrefs " << prefsTime * 1.0e9 / numLookups << " ns/lookup" << std::endl;
+}
+
+/// Fills a platform update slice with one point per second, for the slice comparison
+template <typename SliceType>
+void fillSlice(SliceType& slice, size_t numPoints)
+{
+  for (size_t k = 0; k < numPoints; ++k)
+  {
+    simData::PlatformUpdate* update = new simData::PlatformUpdate;
+    update->set_time(static_cast<double>(k));
+    update->setPosition(simCore::Vec3(6378137.0 + k, 1.0, 2.0));
+    update->setOrientation(simCore::Vec3(0.1, 0.2, 0.3));
+    update->setVelocity(simCore::Vec3(100.0, 0.0, 0.0));
+    slice.insert(update);
+  }
+}
+
+/// Returns the average time in nanoseconds of lower_bound() at the given times
+double timeLowerBound(const simData::PlatformUpdateSlice& slice, const std::vector<double>& times)
+{
+  double sum = 0.0;
+  const double startTime = simCore::systemTimeToSecsBgnYr();
+  for (const double time : times)
+  {
+    const simData::PlatformUpdate* update = slice.lower_bound(time).peekNext();
+    if (update != nullptr)
+      sum += update->x();
+  }
+  const double elapsed = simCore::systemTimeToSecsBgnYr() - startTime;
+  // Use the sum so the loop cannot be optimized away
+  if (sum < 0.0)
+    std::cout << sum << std::endl;
+  return elapsed * 1.0e9 / static_cast<double>(std::max<size_t>(1, times.size()));
+}
+
+/// Returns the average time in nanoseconds of an interpolated time update while playing forward through the slice
+template <typename SliceType>
+double timePlayback(SliceType& slice, simData::Interpolator& interpolator, size_t numPoints)
+{
+  const size_t numSteps = numPoints * 4;
+  const double startTime = simCore::systemTimeToSecsBgnYr();
+  for (size_t k = 0; k < numSteps; ++k)
+    slice.update(static_cast<double>(k) * 0.25 + 0.1, &interpolator);
+  const double elapsed = simCore::systemTimeToSecsBgnYr() - startTime;
+  return elapsed * 1.0e9 / static_cast<double>(numSteps);
+}
+
+/// Compares memory per point and search latency of the deque based and columnar platform update slices
+void compareSlices()
+{
+  const size_t numPoints = 2000000;
+  simData::MemoryDataSlice<simData::PlatformUpdate> memorySlice;
+  simData::ColumnarPlatformUpdateSlice columnarSlice;
+  fillSlice(memorySlice, numPoints);
+  fillSlice(columnarSlice, numPoints);
+
+  std::vector<double> times(1000000);
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<double> timeDist(0.0, static_cast<double>(numPoints));
+  for (auto& time : times)
+    time = timeDist(gen);
+
+  simData::LinearInterpolator interpolator;
+  // The deque slice cost excludes heap bookkeeping for each allocated point, so it is a lower bound
+  std::cout << "Platform update slices with " << numPoints << " points:" << std::endl
+    << "  MemoryDataSlice: >= " << sizeof(simData::PlatformUpdate) + sizeof(simData::PlatformUpdate*) << " bytes/point, lower_bound "
+    << timeLowerBound(memorySlice, times) << " ns, interpolated update " << timePlayback(memorySlice, interpolator, numPoints) << " ns" << std::endl
+    << "  ColumnarPlatformUpdateSlice: " << static_cast<double>(columnarSlice.memoryUsage()) / numPoints << " bytes/point, lower_bound "
+    << timeLowerBound(columnarSlice, times) << " ns, interpolated update " << timePlayback(columnarSlice, interpolator, numPoints) << " ns" << std::endl;
+}
+
+/// Sums visited row values, for the table access comparison
+class RowSummer : public simData::DataTable::RowVisitor
+{
+public:
+  /** Adds up the value of one column in each row */
+  explicit RowSummer(simData::TableColumnId columnId)
+    : columnId_(columnId)
+  {
+  }
+  virtual VisitReturn visit(const simData::TableRow& row)
+  {
+    double value = 0.0;
+    if (row.value(columnId_, value).isSuccess())
+      sum += value;
+    return VISIT_CONTINUE;
+  }
+  double sum = 0.0;
+private:
+  simData::TableColumnId columnId_;
+};
+
+/// Sums runs of double values, for the table access comparison
+class RunSummer : public simData::TableColumn::RunVisitor
+{
+public:
+  virtual void visit(std::span<const double> times, std::span<const uint8_t> values) {}
+  virtual void visit(std::span<const double> times, std::span<const int8_t> values) {}
+  virtual void visit(std::span<const double> times, std::span<const uint16_t> values) {}
+  virtual void visit(std::span<const double> times, std::span<const int16_t> values) {}
+  virtual void visit(std::span<const double> times, std::span<const uint32_t> values) {}
+  virtual void visit(std::span<const double> times, std::span<const int32_t> values) {}
+  virtual void visit(std::span<const double> times, std::span<const uint64_t> values) {}
+  virtual void visit(std::span<const double> times, std::span<const int64_t> values) {}
+  virtual void visit(std::span<const double> times, std::span<const float> values) {}
+  virtual void visit(std::span<const double> times, std::span<const double> values)
+  {
+    for (const double value : values)
+      sum += value;
+  }
+  virtual void visit(std::span<const double> times, std::span<const std::string> values) {}
+  double sum = 0.0;
+};
+
+/// Compares the time to read a single column of a wide data table through rows, iterators, runs, and readColumn()
+void compareTableAccess()
+{
+  const size_t numColumns = 200;
+  const size_t numRows = 20000;
+  simData::MemoryDataStore ds;
+  simData::DataTable* table = nullptr;
+  ds.dataTableManager().addDataTable(1, "Wide Table", &table);
+  std::vector<simData::TableColumn*> columns(numColumns, nullptr);
+  for (size_t k = 0; k < numColumns; ++k)
+    table->addColumn("Column " + std::to_string(k), simData::VT_DOUBLE, 0, &columns[k]);
+  for (size_t row = 0; row < numRows; ++row)
+  {
+    simData::TableRow newRow;
+    newRow.setTime(static_cast<double>(row));
+    for (size_t k = 0; k < numColumns; ++k)
+      newRow.setValue(columns[k]->columnId(), static_cast<double>(row + k));
+    table->addRow(newRow);
+  }
+  const simData::TableColumn* column = columns[numColumns / 2];
+  const double endTime = static_cast<double>(numRows);
+
+  double startTime = simCore::systemTimeToSecsBgnYr();
+  RowSummer rowSummer(column->columnId());
+  table->accept(0.0, endTime, rowSummer);
+  const double rowTime = simCore::systemTimeToSecsBgnYr() - startTime;
+
+  startTime = simCore::systemTimeToSecsBgnYr();
+  double iterSum = 0.0;
+  simData::TableColumn::Iterator iter = column->begin();
+  while (iter.hasNext())
+  {
+    double value = 0.0;
+    iter.next()->getValue(value);
+    iterSum += value;
+  }
+  const double iterTime = simCore::systemTimeToSecsBgnYr() - startTime;
+
+  startTime = simCore::systemTimeToSecsBgnYr();
+  RunSummer runSummer;
+  column->accept(0.0, endTime, runSummer);
+  const double runTime = simCore::systemTimeToSecsBgnYr() - startTime;
+
+  startTime = simCore::systemTimeToSecsBgnYr();
+  std::vector<double> times;
+  std::vector<double> values;
+  table->readColumn(column->columnId(), 0.0, endTime, times, values);
+  double readSum = 0.0;
+  for (const double value : values)
+    readSum += value;
+  const double readTime = simCore::systemTimeToSecsBgnYr() - startTime;
+
+  if (rowSummer.sum != iterSum || runSummer.sum != iterSum || readSum != iterSum)
+    std::cerr << "Column sums do not match" << std::endl;
+  const double toNs = 1.0e9 / static_cast<double>(numRows);
+  std::cout << "Reading one column of a " << numColumns << " column x " << numRows << " row table:" << std::endl
+    << "  Row visitor: " << rowTime * toNs << " ns/row" << std::endl
+    << "  Column iterator: " << iterTime * toNs << " ns/row" << std::endl
+    << "  Column run visitor: " << runTime * toNs << " ns/row" << std::endl
+    << "  readColumn(): " << readTime * toNs << " ns/row" << std::endl;
+}
+
+/// Returns the average time in nanoseconds per frame of reading every column at the frame time
+double timeColumnFrames(const std::vector<simData::TableColumn*>& columns, const std::vector<double>& frameTimes)
+{
+  double sum = 0.0;
+  const double startTime = simCore::systemTimeToSecsBgnYr();
+  for (const double frameTime : frameTimes)
+  {
+    for (const auto* column : columns)
+    {
+      simData::TableColumn::Iterator iter = column->findAtOrBeforeTime(frameTime);
+      if (iter.hasNext())
+        sum += iter.next()->time();
+    }
+  }
+  const double elapsed = simCore::systemTimeToSecsBgnYr() - startTime;
+  // Use the sum so the loop cannot be optimized away
+  if (sum < 0.0)
+    std::cout << sum << std::endl;
+  return elapsed * 1.0e9 / static_cast<double>(std::max<size_t>(1, frameTimes.size()));
+}
+
+/// Returns the average time in nanoseconds per frame of interpolating every column at the frame time
+double timeInterpolatedFrames(const std::vector<simData::TableColumn*>& columns, const std::vector<double>& frameTimes)
+{
+  double sum = 0.0;
+  const double startTime = simCore::systemTimeToSecsBgnYr();
+  for (const double frameTime : frameTimes)
+  {
+    for (const auto* column : columns)
+    {
+      double value = 0.0;
+      column->interpolate(value, frameTime, nullptr);
+      sum += value;
+    }
+  }
+  const double elapsed = simCore::systemTimeToSecsBgnYr() - startTime;
+  // Use the sum so the loop cannot be optimized away
+  if (sum < 0.0)
+    std::cout << sum << std::endl;
+  return elapsed * 1.0e9 / static_cast<double>(std::max<size_t>(1, frameTimes.size()));
+}
+
+/// Compares per-frame lookup cost of reading all columns of a table during playback and during random seeks
+void compareTimeLookups()
+{
+  const size_t numColumns = 50;
+  const size_t numRows = 200000;
+  simData::MemoryDataStore ds;
+  simData::DataTable* table = nullptr;
+  ds.dataTableManager().addDataTable(1, "Lookup Table", &table);
+  std::vector<simData::TableColumn*> columns(numColumns, nullptr);
+  for (size_t k = 0; k < numColumns; ++k)
+    table->addColumn("Column " + std::to_string(k), simData::VT_DOUBLE, 0, &columns[k]);
+  for (size_t row = 0; row < numRows; ++row)
+  {
+    simData::TableRow newRow;
+    newRow.setTime(static_cast<double>(row));
+    for (size_t k = 0; k < numColumns; ++k)
+      newRow.setValue(columns[k]->columnId(), static_cast<double>(row));
+    table->addRow(newRow);
+  }
+
+  // Playback at 4 frames per data point, then random seeks
+  std::vector<double> playbackTimes;
+  for (size_t frame = 0; frame < numRows; ++frame)
+    playbackTimes.push_back(static_cast<double>(frame) * 0.25);
+  std::vector<double> seekTimes(playbackTimes.size());
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<double> timeDist(0.0, static_cast<double>(numRows));
+  for (auto& time : seekTimes)
+    time = timeDist(gen);
+
+  std::cout << "Reading " << numColumns << " columns per frame from a " << numRows << " row table:" << std::endl
+    << "  findAtOrBeforeTime() playback: " << timeColumnFrames(columns, playbackTimes) << " ns/frame, random seeks: "
+    << timeColumnFrames(columns, seekTimes) << " ns/frame" << std::endl
+    << "  interpolate() playback: " << timeInterpolatedFrames(columns, playbackTimes) << " ns/frame, random seeks: "
+    << timeInterpolatedFrames(columns, seekTimes) << " ns/frame" << std::endl;
+}
+
+/// Compares CategoryFilter::match() to the compiled filter, and times incremental re-evaluation after a small change
+void compareCategoryFilter()
+{
+  const size_t numEntities = 50000;
+  const int numCategories = 10;
+  const int numValues = 20;
+  simUtil::DataStoreTestHelper helper;
+  simData::DataStore* ds = helper.dataStore();
+  std::mt19937 gen(1234);
+  std::uniform_int_distribution<int> valueDist(0, numValues - 1);
+  std::vector<uint64_t> ids;
+  for (size_t k = 0; k < numEntities; ++k)
+  {
+    const uint64_t id = helper.addPlatform();
+    ids.push_back(id);
+    for (int cat = 0; cat < numCategories; ++cat)
+      helper.addCategoryData(id, "Category " + std::to_string(cat), "Value " + std::to_string(valueDist(gen)), 0.0);
+  }
+  ds->update(0.0);
+
+  // Half the values of half the categories are checked
+  simData::CategoryNameManager& catNameMgr = ds->categoryNameManager();
+  simData::CategoryFilter filter(ds);
+  for (int cat = 0; cat < numCategories; cat += 2)
+  {
+    const int nameInt = catNameMgr.nameToInt("Category " + std::to_string(cat));
+    for (int value = 0; value < numValues; ++value)
+      filter.setValue(nameInt, catNameMgr.valueToInt("Value " + std::to_string(value)), value % 2 == 0 || cat > 4);
+  }
+
+  size_t matched = 0;
+  double startTime = simCore::systemTimeToSecsBgnYr();
+  for (const uint64_t id : ids)
+    matched += filter.match(*ds, id) ? 1 : 0;
+  const double filterTime = simCore::systemTimeToSecsBgnYr() - startTime;
+
+  size_t compiledMatched = 0;
+  startTime = simCore::systemTimeToSecsBgnYr();
+  simData::CompiledCategoryFilter compiled(filter);
+  for (const uint64_t id : ids)
+    compiledMatched += compiled.match(*ds, id) ? 1 : 0;
+  const double compiledTime = simCore::systemTimeToSecsBgnYr() - startTime;
+
+  simData::CategoryFilterResults results(*ds);
+  results.setFilter(filter);
+  startTime = simCore::systemTimeToSecsBgnYr();
+  results.evaluate();
+  const double fullTime = simCore::systemTimeToSecsBgnYr() - startTime;
+
+  // Change category data on 1% of the entities
+  for (size_t k = 0; k < numEntities; k += 100)
+    helper.addCategoryData(ids[k], "Category 0", "Value " + std::to_string(valueDist(gen)), 1.0);
+  ds->update(1.0);
+  startTime = simCore::systemTimeToSecsBgnYr();
+  const size_t tested = results.evaluate();
+  const double incrementalTime = simCore::systemTimeToSecsBgnYr() - startTime;
+
+  std::cout << "Filtering " << numEntities << " entities with " << numCategories << " categories each (" << matched << " match):" << std::endl
+    << "  CategoryFilter::match(): " << filterTime * 1000.0 << " ms" << std::endl
+    << "  CompiledCategoryFilter::match(): " << compiledTime * 1000.0 << " ms, including compile" << std::endl
+    << "  CategoryFilterResults full evaluation: " << fullTime * 1000.0 << " ms" << std::endl
+    << "  CategoryFilterResults after changing " << tested << " entities: " << incrementalTime * 1000.0 << " ms" << std::endl;
+  if (compiledMatched != matched)
+    std::cout << "  ERROR: compiled filter matched " << compiledMatched << " entities" << std::endl;
+}
+
 /// Simulates file mode by loading the data than doing one playback
 double fileMode(simData::DataStore& ds, simUtil::DataStoreTestHelper& helper, TopLevelOptions& options, Entities& entities)
 {
@@ -663,32 +1102,11 @@ double fileMode(simData::DataStore& ds, simUtil::DataStoreTestHelper& helper, To
   // The sleep helps with looking at the data in the Intel tools
   Sleep(1000);
 
-  double direction = 1.0;
-  int offset = 0;
-  if (!options.playforward)
-  {
-    // Change the values to cause a reverse playback
-    direction *= -1.0;
-    offset = -options.numberOfSeconds*options.frameRate;
-  }
-
-  const double startTime = simCore::systemTimeToSecsBgnYr();
-  for (int ii = 0; ii < options.numberOfSeconds*options.frameRate; ii++)
-  {
-    // Add the 0.0001 so we never get an exact hit
-    const double time = 0.0001 + direction*static_cast<double>(ii+offset)/static_cast<double>(options.frameRate);
-    ds.update(time);
-    if (options.testCD && entities.platforms->initialId() > 0)
-    {
-      simData::CategoryFilter::CurrentCategoryValues curVals;
-      simData::CategoryFilter::getCurrentCategoryValues(ds, entities.platforms->initialId(), curVals);
-      simData::CategoryFilter::CurrentCategoryValues curVals2;
-      simData::CategoryFilter::getCurrentCategoryValues(ds, entities.platforms->lastId(), curVals2);
-    }
-  }
+  simData::MemoryDataStore* mds = dynamic_cast<simData::MemoryDataStore*>(&ds);
+  if (options.scaling && mds)
+    return scalingPlayback(*mds, options, entities);
 
-  const double endTime = simCore::systemTimeToSecsBgnYr();
-  return endTime-startTime;
+  return playback(ds, options, entities);
 }
 
 /// Simulates live mode by repeatedly adding data and doing an update
@@ -804,6 +1222,7 @@ void writeExampleConfigurationFile()
   output << "Interpolate true          # State of the DataStore interpolation" << std::endl;
   output << "NumberOfSeconds 150       # Seconds of data" << std::endl;
   output << "DataLimiting false        # Used in Live mode to limit the amount of data, limits are set below" << std::endl;
+  output << "UpdateThreads 1           # Threads used to update platforms, 0 for hardware concurrency" << std::endl;
   output << std::endl;
 
   writeEntityConfigurationPart(output, "Platform", 1000);
@@ -817,16 +1236,21 @@ void writeExampleConfigurationFile()
 
 void usage()
 {
-    std::cerr << "DataStorePerformanceTest InputConfigfile | --help | --testCD | --WriteExampleConfigFile" << std::endl;
+    std::cerr << "DataStorePerformanceTest InputConfigfile | --help | --testCD | --scaling | --compareSlices | --compareTableAccess | --compareTimeLookups | --compareCategoryFilter | --WriteExampleConfigFile" << std::endl;
     std::cerr << "  InputConfigFile specifies the parameters for the performance test" << std::endl;
     std::cerr << "  --testCD include testing of CategoryData" << std::endl;
+    std::cerr << "  --scaling repeat the File mode playback with increasing update thread counts" << std::endl;
+    std::cerr << "  --compareSlices compares memory use and search times of the platform update slice implementations" << std::endl;
+    std::cerr << "  --compareTableAccess compares row visitation to column iteration and bulk column reads of a data table" << std::endl;
+    std::cerr << "  --compareTimeLookups measures per-frame cost of data table time lookups for playback and random seeks" << std::endl;
+    std::cerr << "  --compareCategoryFilter compares category filter matching to the compiled filter and incremental evaluation" << std::endl;
     std::cerr << "  --WriteExampleConfigFile writes out an example configuration file to DataStorePerformanceTest.conf" << std::endl;
     std::cerr << "  --help display this text" << std::endl;
 }
 /// Look for the configuration file name on the command line
 int parseCommandLine(int argc, char** argv, std::string& fileName, TopLevelOptions& options)
 {
-  if (argc < 2 || argc > 3)
+  if (argc < 2 || argc > 4)
   {
     usage();
     return -1;
@@ -845,12 +1269,34 @@ int parseCommandLine(int argc, char** argv, std::string& fileName, TopLevelOptio
     writeExampleConfigurationFile();
     return 0;
   }
+  if (inputValue == "--compareSlices")
+  {
+    compareSlices();
+    return 0;
+  }
+  if (inputValue == "--compareTableAccess")
+  {
+    compareTableAccess();
+    return 0;
+  }
+  if (inputValue == "--compareTimeLookups")
+  {
+    compareTimeLookups();
+    return 0;
+  }
+  if (inputValue == "--compareCategoryFilter")
+  {
+    compareCategoryFilter();
+    return 0;
+  }
 
   for (int i = 1; i < argc; i++)
   {
     const std::string& testValue = std::string(argv[i]);
     if (testValue == "--testCD")
       options.testCD = true;
+    else if (testValue == "--scaling")
+      options.scaling = true;
     else
       fileName = testValue;
   }
@@ -1038,6 +1484,8 @@ int loadConfigurationFile(const std::string& fileName, TopLevelOptions& options,
         options.numberOfSeconds = atoi(tokens[1].c_str());
       else if (simCore::caseCompare(tokens[0], "DataLimiting") == 0)
         options.dataLimiting = (simCore::caseCompare(tokens[1], "True") == 0);
+      else if (simCore::caseCompare(tokens[0], "UpdateThreads") == 0)
+        options.updateThreads = static_cast<unsigned int>(atoi(tokens[1].c_str()));
       else
       {
         std::cerr << "Unknown command on line " << currentLineNumber << std::endl;
@@ -1115,6 +1563,8 @@ int main(int argc, char *argv[])
   }
 
   simData::LinearInterpolator* interpolator = initializeDataStore(ds, helper, options, entities, &counters);
+  ds.setUpdateThreadCount(options.updateThreads);
+  entityLookups(ds);
 
   double updateTime;
   if (options.fileMode)
@@ -20,13 +20,21 @@
  * disclose, or release this software.
  *
  */
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <set>
 #include <string>
+#include <type_traits>
 #include "simCore/Common/SDKAssert.h"
 #include "simCore/Calc/Math.h"
 #include "simData/DataTable.h"
 #include "simData/MemoryDataStore.h"
+#include "simData/MemoryTable/ChunkedArray.h"
 #include "simData/MemoryTable/DoubleBufferTimeContainer.h"
 #include "simData/MemoryTable/SubTable.h"
+#include "simData/MemoryTable/Table.h"
 #include "simData/MemoryTable/TableManager.h"
 #include "simUtil/DataStoreTestHelper.h"
 
@@ -2313,6 +2321,427 @@ int maxSubTableRowTest()
   return rv;
 }
 
+int chunkedArrayTest()
+{
+  int rv = 0;
+  typedef simData::MemoryTable::ChunkedArray<int> IntArray;
+  const size_t CHUNK = IntArray::CHUNK_SIZE;
+  IntArray arr;
+  rv += SDK_ASSERT(arr.empty());
+  rv += SDK_ASSERT(arr.run(0, 10).empty());
+  for (size_t k = 0; k < 3 * CHUNK; ++k)
+    arr.push_back(static_cast<int>(k));
+  rv += SDK_ASSERT(arr.size() == 3 * CHUNK);
+  rv += SDK_ASSERT(arr[CHUNK + 5] == static_cast<int>(CHUNK + 5));
+
+  // Runs end at chunk boundaries and at the requested count
+  rv += SDK_ASSERT(arr.run(0, 3 * CHUNK).size() == CHUNK);
+  rv += SDK_ASSERT(arr.run(CHUNK - 2, 10).size() == 2);
+  rv += SDK_ASSERT(arr.run(CHUNK, 10).size() == 10);
+  rv += SDK_ASSERT(arr.run(CHUNK, 10)[3] == static_cast<int>(CHUNK + 3));
+  rv += SDK_ASSERT(arr.run(3 * CHUNK, 10).empty());
+
+  // Removing from the front shifts run boundaries
+  arr.pop_front();
+  arr.erase(0, 9);
+  rv += SDK_ASSERT(arr.size() == 3 * CHUNK - 10);
+  rv += SDK_ASSERT(arr[0] == 10);
+  rv += SDK_ASSERT(arr.run(0, 3 * CHUNK).size() == CHUNK - 10);
+  arr.erase(0, CHUNK);
+  rv += SDK_ASSERT(arr[0] == static_cast<int>(CHUNK + 10));
+
+  // Insertion and removal in the middle
+  arr.insert(1, -1);
+  rv += SDK_ASSERT(arr[0] == static_cast<int>(CHUNK + 10));
+  rv += SDK_ASSERT(arr[1] == -1);
+  rv += SDK_ASSERT(arr[2] == static_cast<int>(CHUNK + 11));
+  arr.erase(1);
+  rv += SDK_ASSERT(arr[1] == static_cast<int>(CHUNK + 11));
+  arr.erase(5, arr.size());
+  rv += SDK_ASSERT(arr.size() == 5);
+  rv += SDK_ASSERT(arr[4] == static_cast<int>(CHUNK + 14));
+  arr.push_back(7);
+  rv += SDK_ASSERT(arr.size() == 6);
+  rv += SDK_ASSERT(arr[5] == 7);
+
+  // Insert past the end appends
+  arr.insert(100, 8);
+  rv += SDK_ASSERT(arr[6] == 8);
+  arr.clear();
+  rv += SDK_ASSERT(arr.empty());
+  rv += SDK_ASSERT(arr.capacity() == 0);
+  arr.push_back(1);
+  rv += SDK_ASSERT(arr.size() == 1 && arr[0] == 1);
+  return rv;
+}
+
+/** Counts live instances, to verify that chunks construct only stored values */
+struct LiveCounter
+{
+  static int live;
+  LiveCounter() { ++live; }
+  LiveCounter(const LiveCounter& rhs) : value(rhs.value) { ++live; }
+  explicit LiveCounter(int v) : value(v) { ++live; }
+  ~LiveCounter() { --live; }
+  LiveCounter& operator=(const LiveCounter&) = default;
+  int value = 0;
+};
+int LiveCounter::live = 0;
+
+int chunkedArrayFootprintTest()
+{
+  int rv = 0;
+  // Chunks are sized in bytes
+  rv += SDK_ASSERT(simData::MemoryTable::ChunkedArray<double>::CHUNK_SIZE * sizeof(double) == 4096);
+  rv += SDK_ASSERT(simData::MemoryTable::ChunkedArray<uint8_t>::CHUNK_SIZE == 4096);
+  rv += SDK_ASSERT(simData::MemoryTable::ChunkedArray<std::string>::CHUNK_SIZE * sizeof(std::string) <= 4096);
+
+  // A one-row column of a table holds a single small allocation
+  simData::MemoryTable::ChunkedArray<double> oneRow;
+  oneRow.push_back(1.5);
+  rv += SDK_ASSERT(oneRow.capacity() == simData::MemoryTable::ChunkedArray<double>::INITIAL_CAPACITY);
+  rv += SDK_ASSERT(oneRow.capacity() * sizeof(double) <= 64);
+
+  {
+    typedef simData::MemoryTable::ChunkedArray<LiveCounter> CounterArray;
+    const size_t CHUNK = CounterArray::CHUNK_SIZE;
+    CounterArray arr;
+    arr.push_back(LiveCounter(0));
+    rv += SDK_ASSERT(LiveCounter::live == 1);
+
+    // First chunk doubles up to full size, keeping values through each move
+    for (size_t k = 1; k < 2 * CHUNK + 5; ++k)
+    {
+      arr.push_back(LiveCounter(static_cast<int>(k)));
+      rv += SDK_ASSERT(arr.capacity() >= arr.size());
+    }
+    rv += SDK_ASSERT(LiveCounter::live == static_cast<int>(2 * CHUNK + 5));
+    rv += SDK_ASSERT(arr.capacity() == 3 * CHUNK);
+    for (size_t k = 0; k < arr.size(); ++k)
+      rv += SDK_ASSERT(arr[k].value == static_cast<int>(k));
+
+    // Appending a value of the array itself while it grows
+    CounterArray small;
+    for (int k = 0; k < static_cast<int>(CounterArray::INITIAL_CAPACITY); ++k)
+      small.push_back(LiveCounter(k));
+    small.push_back(small[1]);
+    rv += SDK_ASSERT(small[CounterArray::INITIAL_CAPACITY].value == 1);
+    small.clear();
+
+    // Removed values are destroyed, and unused chunks released
+    arr.erase(0, CHUNK + 1);
+    rv += SDK_ASSERT(LiveCounter::live == static_cast<int>(CHUNK + 4));
+    rv += SDK_ASSERT(arr[0].value == static_cast<int>(CHUNK + 1));
+    arr.erase(3, arr.size());
+    rv += SDK_ASSERT(LiveCounter::live == 3);
+    rv += SDK_ASSERT(arr.capacity() == CHUNK);
+
+    // Copies and moves keep the values
+    CounterArray copy(arr);
+    rv += SDK_ASSERT(LiveCounter::live == 6);
+    CounterArray moved(std::move(arr));
+    rv += SDK_ASSERT(LiveCounter::live == 6);
+    rv += SDK_ASSERT(moved.size() == 3 && moved[2].value == copy[2].value);
+    copy = moved;
+    rv += SDK_ASSERT(LiveCounter::live == 6);
+  }
+  rv += SDK_ASSERT(LiveCounter::live == 0);
+  return rv;
+}
+
+/** Counts runs from TableColumn::accept() and verifies their time ordering */
+class RunCounter : public simData::TableColumn::RunVisitor
+{
+public:
+  virtual void visit(std::span<const double> times, std::span<const uint8_t> values) { add_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const int8_t> values) { add_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const uint16_t> values) { add_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const int16_t> values) { add_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const uint32_t> values) { add_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const int32_t> values) { add_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const uint64_t> values) { add_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const int64_t> values) { add_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const float> values) { add_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const double> values) { add_(times, values); }
+  virtual void visit(std::span<const double> times, std::span<const std::string> values) { add_(times, values); }
+
+  size_t numRuns = 0;
+  size_t numValues = 0;
+  int errors = 0;
+  std::vector<std::string> strings;
+
+private:
+  template <typename T>
+  void add_(std::span<const double> times, std::span<const T> values)
+  {
+    errors += SDK_ASSERT(!times.empty());
+    errors += SDK_ASSERT(times.size() == values.size());
+    for (size_t k = 0; k < times.size(); ++k)
+    {
+      errors += SDK_ASSERT(times[k] > lastTime_);
+      lastTime_ = times[k];
+    }
+    if constexpr (std::is_same_v<T, std::string>)
+      strings.insert(strings.end(), values.begin(), values.end());
+    ++numRuns;
+    numValues += values.size();
+  }
+
+  double lastTime_ = -std::numeric_limits<double>::max();
+};
+
+/** Verifies that readColumn() matches the values from column iteration within the time range */
+int compareReadColumn(const simData::DataTable& table, const simData::TableColumn& column, double beginTime, double endTime)
+{
+  int rv = 0;
+  std::vector<double> times;
+  std::vector<double> values;
+  rv += SDK_ASSERT(table.readColumn(column.columnId(), beginTime, endTime, times, values).isSuccess());
+  rv += SDK_ASSERT(times.size() == values.size());
+
+  size_t index = 0;
+  simData::TableColumn::Iterator iter = column.lower_bound(beginTime);
+  while (iter.hasNext() && iter.peekNext()->time() < endTime)
+  {
+    simData::TableColumn::IteratorDataPtr data = iter.next();
+    double value = 0.0;
+    data->getValue(value);
+    if (index < times.size())
+    {
+      rv += SDK_ASSERT(times[index] == data->time());
+      rv += SDK_ASSERT(values[index] == value);
+    }
+    ++index;
+  }
+  rv += SDK_ASSERT(index == times.size());
+  return rv;
+}
+
+int columnRunTest()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  simData::DataTable* table = nullptr;
+  rv += SDK_ASSERT(ds.dataTableManager().addDataTable(1, "Run Table", &table).isSuccess());
+  simData::TableColumn* intColumn = nullptr;
+  simData::TableColumn* stringColumn = nullptr;
+  rv += SDK_ASSERT(table->addColumn("Int", simData::VT_INT32, 0, &intColumn).isSuccess());
+  rv += SDK_ASSERT(table->addColumn("String", simData::VT_STRING, 0, &stringColumn).isSuccess());
+
+  // Enough rows to cross chunk boundaries in the column storage
+  const size_t NUM_ROWS = 3000;
+  for (size_t k = 0; k < NUM_ROWS; ++k)
+  {
+    simData::TableRow row;
+    row.setTime(static_cast<double>(k));
+    row.setValue(intColumn->columnId(), static_cast<int32_t>(k * 2));
+    row.setValue(stringColumn->columnId(), std::to_string(k));
+    rv += SDK_ASSERT(table->addRow(row).isSuccess());
+  }
+  // Out of order time breaks up the runs
+  simData::TableRow row;
+  row.setTime(1000.5);
+  row.setValue(intColumn->columnId(), -5);
+  row.setValue(stringColumn->columnId(), std::string("-5"));
+  rv += SDK_ASSERT(table->addRow(row).isSuccess());
+
+  RunCounter counter;
+  intColumn->accept(0.0, 1e10, counter);
+  rv += counter.errors;
+  rv += SDK_ASSERT(counter.numValues == NUM_ROWS + 1);
+  // [0,1000], 1000.5, [1001,1023], [1024,2047], [2048,2999]
+  rv += SDK_ASSERT(counter.numRuns == 5);
+
+  // End time is exclusive and begin time is inclusive
+  RunCounter partial;
+  stringColumn->accept(10.0, 20.0, partial);
+  rv += partial.errors;
+  rv += SDK_ASSERT(partial.numValues == 10);
+  rv += SDK_ASSERT(partial.numRuns == 1);
+  rv += SDK_ASSERT(partial.strings.size() == 10 && partial.strings.front() == "10" && partial.strings.back() == "19");
+
+  RunCounter none;
+  intColumn->accept(20.0, 10.0, none);
+  rv += SDK_ASSERT(none.numRuns == 0);
+
+  rv += compareReadColumn(*table, *intColumn, 0.0, 1e10);
+  rv += compareReadColumn(*table, *intColumn, 999.0, 1024.0);
+  rv += compareReadColumn(*table, *stringColumn, 0.0, 1e10);
+  std::vector<double> times;
+  std::vector<double> values;
+  rv += SDK_ASSERT(table->readColumn(intColumn->columnId(), 1000.0, 1001.0, times, values).isSuccess());
+  rv += SDK_ASSERT(values.size() == 2 && values[0] == 2000.0 && values[1] == -5.0);
+  rv += SDK_ASSERT(table->readColumn(12345, 0.0, 1e10, times, values).isError());
+  rv += SDK_ASSERT(times.empty() && values.empty());
+  return rv;
+}
+
+int columnRunDataLimitTest()
+{
+  int rv = 0;
+  simUtil::DataStoreTestHelper testHelper;
+  simData::DataStore* ds = testHelper.dataStore();
+  uint64_t plat1 = testHelper.addPlatform();
+  ds->setDataLimiting(true);
+  simData::DataStore::Transaction t;
+  simData::PlatformPrefs* prefs = ds->mutable_platformPrefs(plat1, &t);
+  prefs->mutable_commonprefs()->set_datalimitpoints(100);
+  t.commit();
+
+  simData::DataTable* table = nullptr;
+  rv += SDK_ASSERT(ds->dataTableManager().addDataTable(plat1, "Run Limit Table", &table).isSuccess());
+  simData::TableColumn* column = nullptr;
+  rv += SDK_ASSERT(table->addColumn("Double", simData::VT_DOUBLE, 0, &column).isSuccess());
+
+  // Data limiting splits values between the fresh and stale containers
+  for (size_t k = 0; k < 175; ++k)
+  {
+    simData::TableRow row;
+    row.setTime(static_cast<double>(k));
+    row.setValue(column->columnId(), k * 0.5);
+    rv += SDK_ASSERT(table->addRow(row).isSuccess());
+  }
+  RunCounter counter;
+  column->accept(0.0, 1e10, counter);
+  rv += counter.errors;
+  rv += SDK_ASSERT(counter.numValues == column->size());
+  rv += SDK_ASSERT(counter.numRuns == 2);
+  rv += compareReadColumn(*table, *column, 0.0, 1e10);
+  rv += compareReadColumn(*table, *column, 140.0, 160.0);
+  return rv;
+}
+
+
+int timeLookupIndexTest()
+{
+  int rv = 0;
+  simData::MemoryTable::DoubleBufferTimeContainer tc;
+
+  // Even times in order, then odd times out of order, across many sample strides
+  std::set<double> reference;
+  for (int k = 0; k < 2000; k += 2)
+  {
+    tc.findOrAddTime(k);
+    reference.insert(k);
+  }
+  for (int k = 1999; k > 0; k -= 6)
+  {
+    tc.findOrAddTime(k);
+    reference.insert(k);
+  }
+  rv += SDK_ASSERT(tc.size() == reference.size());
+
+  // Random searches match the reference
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(-10.0, 2010.0);
+  for (int k = 0; k < 2000; ++k)
+  {
+    const double t = (k % 3 == 0) ? std::floor(dist(gen)) : dist(gen);
+    auto expectedLower = reference.lower_bound(t);
+    auto expectedUpper = reference.upper_bound(t);
+    simData::MemoryTable::TimeContainer::Iterator lower = tc.lower_bound(t);
+    simData::MemoryTable::TimeContainer::Iterator upper = tc.upper_bound(t);
+    rv += SDK_ASSERT(lower.hasNext() == (expectedLower != reference.end()));
+    rv += SDK_ASSERT(upper.hasNext() == (expectedUpper != reference.end()));
+    if (lower.hasNext() && expectedLower != reference.end())
+      rv += SDK_ASSERT(lower.peekNext().time() == *expectedLower);
+    if (upper.hasNext() && expectedUpper != reference.end())
+      rv += SDK_ASSERT(upper.peekNext().time() == *expectedUpper);
+    rv += SDK_ASSERT(tc.find(t).hasNext() == (reference.count(t) != 0));
+  }
+
+  // Playback forward and backward through the data, as answered from the cursor
+  for (double t = 0.0; t <= 1999.0; t += 0.5)
+    rv += SDK_ASSERT(tc.lower_bound(t).peekNext().time() == *reference.lower_bound(t));
+  for (double t = 1999.0; t >= 0.0; t -= 0.5)
+    rv += SDK_ASSERT(tc.lower_bound(t).peekNext().time() == *reference.lower_bound(t));
+
+  // A copy searches its own samples
+  std::unique_ptr<simData::MemoryTable::TimeContainer> copy(tc.clone());
+  for (double t = 0.0; t <= 1999.0; t += 7.25)
+    rv += SDK_ASSERT(copy->lower_bound(t).peekNext().time() == *reference.lower_bound(t));
+
+  // Inserting in the middle and erasing keep the lookups consistent
+  tc.findOrAddTime(1000.25);
+  reference.insert(1000.25);
+  tc.erase(tc.find(500.0), simData::MemoryTable::TimeContainer::ERASE_FIXOFFSETS);
+  reference.erase(500.0);
+  for (double t = 0.0; t <= 1999.0; t += 3.75)
+    rv += SDK_ASSERT(tc.lower_bound(t).peekNext().time() == *reference.lower_bound(t));
+
+  // After a swap, the stale bin keeps its samples and the fresh bin starts over
+  tc.swapFreshStaleData(nullptr, std::vector<simData::DataTable::TableObserverPtr>());
+  for (int k = 3000; k < 3100; ++k)
+  {
+    tc.findOrAddTime(k);
+    reference.insert(k);
+  }
+  rv += SDK_ASSERT(tc.size() == reference.size());
+  for (double t = 0.0; t <= 3099.0; t += 4.5)
+    rv += SDK_ASSERT(tc.lower_bound(t).peekNext().time() == *reference.lower_bound(t));
+  return rv;
+}
+
+int compactTest()
+{
+  int rv = 0;
+  simUtil::DataStoreTestHelper testHelper;
+  simData::DataStore* ds = testHelper.dataStore();
+  uint64_t plat1 = testHelper.addPlatform();
+  ds->setDataLimiting(true);
+  simData::DataStore::Transaction t;
+  simData::PlatformPrefs* prefs = ds->mutable_platformPrefs(plat1, &t);
+  prefs->mutable_commonprefs()->set_datalimitpoints(1000);
+  t.commit();
+
+  simData::DataTable* table = nullptr;
+  rv += SDK_ASSERT(ds->dataTableManager().addDataTable(plat1, "Compact Table", &table).isSuccess());
+  simData::TableColumn* intColumn = nullptr;
+  simData::TableColumn* stringColumn = nullptr;
+  rv += SDK_ASSERT(table->addColumn("Int", simData::VT_INT32, 0, &intColumn).isSuccess());
+  rv += SDK_ASSERT(table->addColumn("String", simData::VT_STRING, 0, &stringColumn).isSuccess());
+
+  // Insert rows in reverse time order, so that storage order is the opposite of time order
+  for (int k = 599; k >= 0; --k)
+  {
+    simData::TableRow row;
+    row.setTime(k);
+    row.setValue(intColumn->columnId(), k * 3);
+    row.setValue(stringColumn->columnId(), std::to_string(k));
+    rv += SDK_ASSERT(table->addRow(row).isSuccess());
+  }
+  // Data limiting swapped the first 500 rows into the stale bin
+  RunCounter before;
+  intColumn->accept(0.0, 1e10, before);
+  rv += before.errors;
+  rv += SDK_ASSERT(before.numValues == intColumn->size());
+
+  static_cast<simData::MemoryTable::Table*>(table)->compact();
+  RunCounter after;
+  intColumn->accept(0.0, 1e10, after);
+  rv += after.errors;
+  rv += SDK_ASSERT(after.numValues == before.numValues);
+  // Fresh bin is still in reverse order, but the stale bin is a single run
+  rv += SDK_ASSERT(after.numRuns < before.numRuns);
+  rv += SDK_ASSERT(after.numRuns == before.numRuns - 500 + 1);
+  rv += compareReadColumn(*table, *intColumn, 0.0, 1e10);
+  rv += compareReadColumn(*table, *stringColumn, 0.0, 1e10);
+  simData::TableColumn::Iterator iter = stringColumn->begin();
+  while (iter.hasNext())
+  {
+    simData::TableColumn::IteratorDataPtr data = iter.next();
+    std::string value;
+    data->getValue(value);
+    rv += SDK_ASSERT(value == std::to_string(static_cast<int>(data->time())));
+  }
+
+  // Compacting again has no effect
+  static_cast<simData::MemoryTable::Table*>(table)->compact();
+  RunCounter again;
+  intColumn->accept(0.0, 1e10, again);
+  rv += SDK_ASSERT(again.numRuns == after.numRuns);
+  return rv;
+}
 }
 
 int MemoryDataTableTest(int argc, char* argv[])
@@ -2331,5 +2760,11 @@ int MemoryDataTableTest(int argc, char* argv[])
   rv += testPartialFlush();
   rv += getTimeRangeTest();
   rv += maxSubTableRowTest();
+  rv += chunkedArrayTest();
+  rv += chunkedArrayFootprintTest();
+  rv += columnRunTest();
+  rv += columnRunDataLimitTest();
+  rv += timeLookupIndexTest();
+  rv += compactTest();
   return rv;
 }
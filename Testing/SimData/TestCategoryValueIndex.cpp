@@ -0,0 +1,220 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <random>
+#include "simCore/Common/SDKAssert.h"
+#include "simData/CategoryData/CategoryData.h"
+#include "simData/CategoryData/CategoryNameManager.h"
+#include "simData/CategoryData/CategoryValueIndex.h"
+#include "simData/DataStore.h"
+#include "simUtil/DataStoreTestHelper.h"
+
+namespace
+{
+
+int testIndexUpdates()
+{
+  int rv = 0;
+  simData::CategoryValueIndex index;
+  rv += SDK_ASSERT(index.numEntities() == 0);
+  rv += SDK_ASSERT(index.count(1, 2) == 0);
+
+  // Names 1 and 2, values 10 and 11
+  rv += SDK_ASSERT(index.update(5, { { 2, 11 }, { 1, 10 } }));
+  rv += SDK_ASSERT(index.update(3, { { 1, 10 } }));
+  rv += SDK_ASSERT(!index.update(3, { { 1, 10 } }));
+  rv += SDK_ASSERT(!index.update(7, {}));
+  rv += SDK_ASSERT(index.numEntities() == 2);
+  rv += SDK_ASSERT(index.count(1, 10) == 2);
+  rv += SDK_ASSERT(index.count(2, 11) == 1);
+  rv += SDK_ASSERT(index.value(5, 2) == 11);
+  rv += SDK_ASSERT(index.value(3, 2) == simData::CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME);
+  rv += SDK_ASSERT(index.value(7, 1) == simData::CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME);
+
+  std::vector<simData::ObjectId> ids;
+  index.entities(1, 10, ids);
+  rv += SDK_ASSERT(ids == std::vector<simData::ObjectId>({ 3, 5 }));
+
+  // Change a value, drop a name, and add a name
+  rv += SDK_ASSERT(index.update(5, { { 1, 11 }, { 3, 12 } }));
+  rv += SDK_ASSERT(index.count(1, 10) == 1);
+  rv += SDK_ASSERT(index.count(1, 11) == 1);
+  rv += SDK_ASSERT(index.count(2, 11) == 0);
+  rv += SDK_ASSERT(index.count(3, 12) == 1);
+  std::map<int, size_t> counts;
+  index.valueCounts(1, counts);
+  const std::map<int, size_t> expectedCounts = { { 10, 1 }, { 11, 1 } };
+  rv += SDK_ASSERT(counts == expectedCounts);
+  index.valueCounts(2, counts);
+  rv += SDK_ASSERT(counts.empty());
+  index.entities(1, ids);
+  rv += SDK_ASSERT(ids == std::vector<simData::ObjectId>({ 3, 5 }));
+
+  // No values removes the entity
+  rv += SDK_ASSERT(index.update(3, {}));
+  rv += SDK_ASSERT(index.numEntities() == 1);
+  index.remove(5);
+  rv += SDK_ASSERT(index.numEntities() == 0);
+  rv += SDK_ASSERT(index.count(1, 11) == 0);
+  index.entities(1, ids);
+  rv += SDK_ASSERT(ids.empty());
+  return rv;
+}
+
+int testLargeSets()
+{
+  int rv = 0;
+  simData::CategoryValueIndex index;
+  std::mt19937 gen(1234);
+  std::uniform_int_distribution<int> valueDist(0, 3);
+
+  // Many random moves between a few values exercise the pending change merging
+  const simData::ObjectId numEntities = 5000;
+  std::vector<int> expected(numEntities + 1, -1);
+  for (int pass = 0; pass < 10; ++pass)
+  {
+    for (simData::ObjectId id = 1; id <= numEntities; ++id)
+    {
+      const int value = valueDist(gen);
+      if (value == 0)
+        index.update(id, {});
+      else
+        index.update(id, { { 1, value } });
+      expected[id] = (value == 0) ? -1 : value;
+      if (id % 997 == 0)
+      {
+        index.remove(id - 1);
+        expected[id - 1] = -1;
+      }
+    }
+
+    // Reads see pending changes without merging them, so reading again gives the same answer
+    const simData::CategoryValueIndex& constIndex = index;
+    for (int value = 1; value <= 3; ++value)
+    {
+      std::vector<simData::ObjectId> expectedIds;
+      for (simData::ObjectId id = 1; id <= numEntities; ++id)
+      {
+        if (expected[id] == value)
+          expectedIds.push_back(id);
+      }
+      std::vector<simData::ObjectId> ids;
+      constIndex.entities(1, value, ids);
+      rv += SDK_ASSERT(ids == expectedIds);
+      constIndex.entities(1, value, ids);
+      rv += SDK_ASSERT(ids == expectedIds);
+      rv += SDK_ASSERT(constIndex.count(1, value) == expectedIds.size());
+    }
+
+    std::vector<simData::ObjectId> expectedIds;
+    for (simData::ObjectId id = 1; id <= numEntities; ++id)
+    {
+      if (expected[id] != -1)
+        expectedIds.push_back(id);
+    }
+    std::vector<simData::ObjectId> ids;
+    constIndex.entities(1, ids);
+    rv += SDK_ASSERT(ids == expectedIds);
+  }
+  return rv;
+}
+
+/** Counts entities with the value by visiting every slice */
+size_t bruteForceCount(const simData::DataStore& ds, int nameInt, int valueInt)
+{
+  simData::DataStore::IdList ids;
+  ds.idList(&ids);
+  size_t count = 0;
+  for (auto id : ids)
+  {
+    std::map<int, int> values;
+    ds.categoryDataSlice(id)->allInts(values);
+    auto iter = values.find(nameInt);
+    if (iter != values.end() && iter->second == valueInt)
+      ++count;
+  }
+  return count;
+}
+
+int testDataStoreIndex()
+{
+  int rv = 0;
+  simUtil::DataStoreTestHelper testHelper;
+  simData::DataStore* ds = testHelper.dataStore();
+  const simData::CategoryValueIndex& index = ds->categoryValueIndex();
+
+  // Platforms change Color at times 1 through 4, and some have Size
+  std::vector<uint64_t> ids;
+  const std::vector<std::string> colors = { "Red", "Green", "Blue" };
+  for (int k = 0; k < 30; ++k)
+  {
+    const uint64_t id = testHelper.addPlatform();
+    ids.push_back(id);
+    for (int time = 1; time <= 4; ++time)
+      testHelper.addCategoryData(id, "Color", colors[(k + time) % colors.size()], static_cast<double>(time));
+    if (k % 2 == 0)
+      testHelper.addCategoryData(id, "Size", "Large", 2.5);
+  }
+  rv += SDK_ASSERT(index.numEntities() == 0);
+
+  simData::CategoryNameManager& catNameMgr = ds->categoryNameManager();
+  const int colorInt = catNameMgr.nameToInt("Color");
+  const int sizeInt = catNameMgr.nameToInt("Size");
+  const int largeInt = catNameMgr.valueToInt("Large");
+  for (double time : { 0.0, 1.0, 2.0, 2.5, 4.0, 1.5, 3.0 })
+  {
+    ds->update(time);
+    for (const auto& color : colors)
+    {
+      const int valueInt = catNameMgr.valueToInt(color);
+      rv += SDK_ASSERT(index.count(colorInt, valueInt) == bruteForceCount(*ds, colorInt, valueInt));
+    }
+    rv += SDK_ASSERT(index.count(sizeInt, largeInt) == bruteForceCount(*ds, sizeInt, largeInt));
+  }
+
+  // Late data for the current time is picked up on the next update
+  testHelper.addCategoryData(ids[1], "Size", "Large", 0.0);
+  ds->update(3.0);
+  rv += SDK_ASSERT(index.count(sizeInt, largeInt) == 16);
+  rv += SDK_ASSERT(index.value(ids[1], sizeInt) == largeInt);
+
+  // Removed entities leave the index
+  ds->removeEntity(ids[0]);
+  rv += SDK_ASSERT(index.count(sizeInt, largeInt) == 15);
+  rv += SDK_ASSERT(index.numEntities() == ids.size() - 1);
+
+  ds->clear();
+  rv += SDK_ASSERT(index.numEntities() == 0);
+  return rv;
+}
+
+}
+
+int TestCategoryValueIndex(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += testIndexUpdates();
+  rv += testLargeSets();
+  rv += testDataStoreIndex();
+  return rv;
+}
@@ -0,0 +1,236 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <iostream>
+#include <optional>
+#include "simCore/Common/SDKAssert.h"
+#include "simData/ColumnarPlatformUpdateSlice.h"
+#include "simData/LinearInterpolator.h"
+#include "simData/MemoryDataSlice.h"
+
+namespace
+{
+
+/** Creates a heap allocated update with distinct values for every field */
+simData::PlatformUpdate* newUpdate(double time, double seed)
+{
+  simData::PlatformUpdate* update = new simData::PlatformUpdate;
+  update->set_time(time);
+  update->set_x(seed);
+  update->set_y(seed + 1.0);
+  update->set_z(seed + 2.0);
+  update->set_psi(seed * 0.01);
+  update->set_theta(seed * 0.02);
+  update->set_phi(seed * 0.03);
+  update->set_vx(seed + 3.0);
+  update->set_vy(seed + 4.0);
+  update->set_vz(seed + 5.0);
+  return update;
+}
+
+bool samePoint(const simData::PlatformUpdate* a, const simData::PlatformUpdate* b)
+{
+  if (a == nullptr || b == nullptr)
+    return a == b;
+  return a->time() == b->time() && a->x() == b->x() && a->y() == b->y() && a->z() == b->z() &&
+    a->psi() == b->psi() && a->theta() == b->theta() && a->phi() == b->phi() &&
+    a->vx() == b->vx() && a->vy() == b->vy() && a->vz() == b->vz();
+}
+
+/** Inserts the same point into both slices */
+void insertBoth(simData::MemoryDataSlice<simData::PlatformUpdate>& memory, simData::ColumnarPlatformUpdateSlice& columnar, double time, double seed)
+{
+  memory.insert(newUpdate(time, seed));
+  columnar.insert(newUpdate(time, seed));
+}
+
+/** Compares contents, bounds and current state of the two slices */
+int compareSlices(const simData::MemoryDataSlice<simData::PlatformUpdate>& memory, const simData::ColumnarPlatformUpdateSlice& columnar)
+{
+  int rv = 0;
+  rv += SDK_ASSERT(memory.numItems() == columnar.numItems());
+  rv += SDK_ASSERT(memory.firstTime() == columnar.firstTime());
+  rv += SDK_ASSERT(memory.lastTime() == columnar.lastTime());
+  rv += SDK_ASSERT(memory.hasChanged() == columnar.hasChanged());
+  rv += SDK_ASSERT(memory.isInterpolated() == columnar.isInterpolated());
+  rv += SDK_ASSERT(samePoint(memory.current(), columnar.current()));
+  rv += SDK_ASSERT(samePoint(memory.interpolationBounds().first, columnar.interpolationBounds().first));
+  rv += SDK_ASSERT(samePoint(memory.interpolationBounds().second, columnar.interpolationBounds().second));
+
+  auto memoryIt = memory.lower_bound(-1.0);
+  auto columnarIt = columnar.lower_bound(-1.0);
+  while (memoryIt.hasNext() && columnarIt.hasNext())
+    rv += SDK_ASSERT(samePoint(memoryIt.next(), columnarIt.next()));
+  rv += SDK_ASSERT(memoryIt.hasNext() == columnarIt.hasNext());
+  return rv;
+}
+
+int testInsertAndSearch()
+{
+  int rv = 0;
+  simData::MemoryDataSlice<simData::PlatformUpdate> memory;
+  simData::ColumnarPlatformUpdateSlice columnar;
+  rv += compareSlices(memory, columnar);
+  rv += SDK_ASSERT(columnar.deltaTime(1.0) == -1.0);
+
+  // Enough points to span several chunks, with out of order inserts and replacements
+  for (int k = 0; k < 1000; ++k)
+    insertBoth(memory, columnar, k * 2.0, k);
+  for (int k = 0; k < 1000; k += 7)
+    insertBoth(memory, columnar, k * 2.0 + 1.0, k + 0.5);
+  for (int k = 0; k < 1000; k += 13)
+    insertBoth(memory, columnar, k * 2.0, -k);
+  rv += compareSlices(memory, columnar);
+
+  for (double time = -1.0; time < 2002.0; time += 0.75)
+  {
+    rv += SDK_ASSERT(samePoint(memory.lower_bound(time).peekNext(), columnar.lower_bound(time).peekNext()));
+    rv += SDK_ASSERT(samePoint(memory.upper_bound(time).peekNext(), columnar.upper_bound(time).peekNext()));
+    rv += SDK_ASSERT(samePoint(memory.upper_bound(time).peekPrevious(), columnar.upper_bound(time).peekPrevious()));
+    rv += SDK_ASSERT(memory.deltaTime(time) == columnar.deltaTime(time));
+  }
+
+  // The iterator keeps its two most recent points valid
+  auto it = columnar.lower_bound(10.0);
+  const simData::PlatformUpdate* first = it.next();
+  const simData::PlatformUpdate* second = it.next();
+  rv += SDK_ASSERT(first->time() == 10.0);
+  rv += SDK_ASSERT(second->time() == 12.0);
+  return rv;
+}
+
+int testTimeUpdates()
+{
+  int rv = 0;
+  simData::LinearInterpolator interpolator;
+  simData::MemoryDataSlice<simData::PlatformUpdate> memory;
+  simData::ColumnarPlatformUpdateSlice columnar;
+  for (int k = 1; k <= 600; ++k)
+    insertBoth(memory, columnar, k, k * 10.0);
+
+  // Forward and backward playback, with and without interpolation; repeated times are not a change
+  const double times[] = { 0.5, 1.0, 1.0, 1.25, 1.5, 2.0, 2.0, 300.0, 300.3, 299.9, 600.0, 700.0, 700.0, 0.0 };
+  for (double time : times)
+  {
+    memory.update(time, &interpolator);
+    columnar.update(time, &interpolator);
+    rv += compareSlices(memory, columnar);
+  }
+  for (double time : times)
+  {
+    memory.update(time);
+    columnar.update(time);
+    rv += compareSlices(memory, columnar);
+  }
+  for (double time : times)
+  {
+    std::optional<double> memoryStart;
+    std::optional<double> memoryEnd;
+    std::optional<double> columnarStart;
+    std::optional<double> columnarEnd;
+    memory.update(time, memoryStart, memoryEnd);
+    columnar.update(time, columnarStart, columnarEnd);
+    rv += compareSlices(memory, columnar);
+    rv += SDK_ASSERT(memoryStart == columnarStart);
+    rv += SDK_ASSERT(memoryEnd == columnarEnd);
+  }
+
+  // Inserting before the current point shifts it, but does not change it
+  memory.update(400.0);
+  columnar.update(400.0);
+  insertBoth(memory, columnar, 10.5, 1.0);
+  memory.update(400.0);
+  columnar.update(400.0);
+  rv += compareSlices(memory, columnar);
+  rv += SDK_ASSERT(!columnar.hasChanged());
+
+  // Replacing the current point is a change
+  insertBoth(memory, columnar, 400.0, 7.0);
+  memory.update(400.0);
+  columnar.update(400.0);
+  rv += compareSlices(memory, columnar);
+  rv += SDK_ASSERT(columnar.hasChanged());
+  return rv;
+}
+
+int testLimitAndFlush()
+{
+  int rv = 0;
+  simData::MemoryDataSlice<simData::PlatformUpdate> memory;
+  simData::ColumnarPlatformUpdateSlice columnar;
+
+  // Live mode style data limiting, with the current point kept at the newest time
+  for (int k = 0; k < 5000; ++k)
+  {
+    insertBoth(memory, columnar, k, k);
+    memory.update(k);
+    columnar.update(k);
+    memory.limitByPoints(300);
+    columnar.limitByPoints(300);
+    if (k % 100 == 0)
+      rv += compareSlices(memory, columnar);
+  }
+  rv += compareSlices(memory, columnar);
+  // Chunks released by limiting are reused, so storage stays bounded
+  rv += SDK_ASSERT(columnar.memoryUsage() < 8 * 300 * sizeof(simData::PlatformUpdate));
+
+  memory.limitByTime(100.0);
+  columnar.limitByTime(100.0);
+  rv += compareSlices(memory, columnar);
+  rv += SDK_ASSERT(columnar.numItems() == 100);
+
+  memory.flush(4950.0, 4960.0);
+  columnar.flush(4950.0, 4960.0);
+  rv += SDK_ASSERT(columnar.current() == nullptr);
+  rv += compareSlices(memory, columnar);
+  memory.update(4955.0);
+  columnar.update(4955.0);
+  rv += compareSlices(memory, columnar);
+  rv += SDK_ASSERT(columnar.current()->time() == 4949.0);
+
+  // Static points survive a flush that keeps static points
+  simData::ColumnarPlatformUpdateSlice staticSlice;
+  staticSlice.insert(newUpdate(-1.0, 1.0));
+  staticSlice.flush(true);
+  rv += SDK_ASSERT(staticSlice.numItems() == 1);
+  staticSlice.flush(false);
+  rv += SDK_ASSERT(staticSlice.numItems() == 0);
+
+  memory.flush();
+  columnar.flush();
+  rv += compareSlices(memory, columnar);
+  rv += SDK_ASSERT(columnar.numItems() == 0);
+  return rv;
+}
+
+}
+
+int TestColumnarSlice(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += testInsertAndSearch();
+  rv += testTimeUpdates();
+  rv += testLimitAndFlush();
+
+  std::cout << "TestColumnarSlice: " << (rv == 0 ? "PASSED" : "FAILED") << std::endl;
+  return rv;
+}
@@ -0,0 +1,278 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <random>
+#include <regex>
+#include "simCore/Common/SDKAssert.h"
+#include "simData/CategoryData/CategoryNameManager.h"
+#include "simData/CategoryData/CategoryFilter.h"
+#include "simData/CategoryData/CompiledCategoryFilter.h"
+#include "simData/DataStore.h"
+#include "simUtil/DataStoreTestHelper.h"
+
+namespace
+{
+
+/** Regular expression filter based on std::regex, since simQt is not available to simData tests */
+class StdRegExpFilter : public simData::RegExpFilter
+{
+public:
+  explicit StdRegExpFilter(const std::string& pattern)
+    : pattern_(pattern),
+      regex_(pattern)
+  {
+  }
+
+  virtual bool match(const std::string& test) const override
+  {
+    ++matchCount;
+    return std::regex_search(test, regex_);
+  }
+
+  virtual std::string pattern() const override
+  {
+    return pattern_;
+  }
+
+  mutable int matchCount = 0;
+
+private:
+  std::string pattern_;
+  std::regex regex_;
+};
+
+const int NUM_CATEGORIES = 5;
+const int NUM_VALUES = 6;
+
+/** Adds platforms with random category data; some platforms have no value for some categories */
+std::vector<uint64_t> addRandomPlatforms(simUtil::DataStoreTestHelper& testHelper, size_t count, std::mt19937& gen)
+{
+  std::uniform_int_distribution<int> valueDist(0, NUM_VALUES);
+  std::vector<uint64_t> ids;
+  for (size_t k = 0; k < count; ++k)
+  {
+    const uint64_t id = testHelper.addPlatform();
+    ids.push_back(id);
+    for (int cat = 0; cat < NUM_CATEGORIES; ++cat)
+    {
+      const int value = valueDist(gen);
+      // Highest value means no data for the category
+      if (value < NUM_VALUES)
+        testHelper.addCategoryData(id, "Cat" + std::to_string(cat), "Value" + std::to_string(value), 0.0);
+    }
+  }
+  testHelper.dataStore()->update(0.0);
+  return ids;
+}
+
+/** Fills the filter with random checks, including the special values, unchecked names, and regular expressions */
+void randomFilter(simData::CategoryFilter& filter, std::mt19937& gen)
+{
+  simData::CategoryNameManager& catNameMgr = filter.getDataStore()->categoryNameManager();
+  std::uniform_int_distribution<int> dist(0, 9);
+  filter.clear();
+  for (int cat = 0; cat < NUM_CATEGORIES; ++cat)
+  {
+    const int choice = dist(gen);
+    if (choice < 3)
+      continue;
+    const int nameInt = catNameMgr.nameToInt("Cat" + std::to_string(cat));
+    for (int value = 0; value < NUM_VALUES; ++value)
+    {
+      if (dist(gen) < 5)
+        filter.setValue(nameInt, catNameMgr.valueToInt("Value" + std::to_string(value)), dist(gen) < 5);
+    }
+    if (dist(gen) < 5)
+      filter.setValue(nameInt, simData::CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME, dist(gen) < 5);
+    if (dist(gen) < 5)
+      filter.setValue(nameInt, simData::CategoryNameManager::UNLISTED_CATEGORY_VALUE, dist(gen) < 5);
+    // Only names with values in the filter can be unchecked
+    if (choice == 9 && filter.getCategoryFilter().count(nameInt) != 0)
+      filter.updateCategoryFilterName(nameInt, false);
+    else if (choice == 8)
+      filter.setCategoryRegExp(nameInt, std::make_shared<StdRegExpFilter>("[" + std::to_string(dist(gen) % NUM_VALUES) + "-5]$"));
+  }
+}
+
+int testCompiledMatch()
+{
+  int rv = 0;
+  simUtil::DataStoreTestHelper testHelper;
+  simData::DataStore* ds = testHelper.dataStore();
+  std::mt19937 gen(1234);
+  const std::vector<uint64_t> ids = addRandomPlatforms(testHelper, 200, gen);
+
+  // Empty filter matches everything
+  simData::CategoryFilter filter(ds);
+  simData::CompiledCategoryFilter compiled(filter);
+  rv += SDK_ASSERT(compiled.isEmpty());
+  for (uint64_t id : ids)
+    rv += SDK_ASSERT(compiled.match(*ds, id));
+
+  int numPassed = 0;
+  int numFailed = 0;
+  for (int iteration = 0; iteration < 200; ++iteration)
+  {
+    randomFilter(filter, gen);
+    compiled.compile(filter);
+    for (uint64_t id : ids)
+    {
+      const bool expected = filter.match(*ds, id);
+      rv += SDK_ASSERT(compiled.match(*ds, id) == expected);
+      ++(expected ? numPassed : numFailed);
+    }
+  }
+  // Make sure the random filters exercise both outcomes
+  rv += SDK_ASSERT(numPassed > 1000);
+  rv += SDK_ASSERT(numFailed > 1000);
+
+  // Unsorted name/value data gives the same results
+  simData::CategoryNameManager& catNameMgr = ds->categoryNameManager();
+  const int cat0 = catNameMgr.nameToInt("Cat0");
+  const int cat1 = catNameMgr.nameToInt("Cat1");
+  const int value1 = catNameMgr.valueToInt("Value1");
+  const int value2 = catNameMgr.valueToInt("Value2");
+  filter.clear();
+  filter.setValue(cat0, value1, true);
+  filter.setValue(cat1, value2, true);
+  compiled.compile(filter);
+  std::vector<std::pair<int, int> > data = { { cat1, value2 }, { cat0, value1 } };
+  rv += SDK_ASSERT(compiled.matchData(data));
+  data = { { cat1, value1 }, { cat0, value1 } };
+  rv += SDK_ASSERT(!compiled.matchData(data));
+  data = { { cat0, value1 } };
+  rv += SDK_ASSERT(!compiled.matchData(data));
+  return rv;
+}
+
+int testRegExpCache()
+{
+  int rv = 0;
+  simUtil::DataStoreTestHelper testHelper;
+  simData::DataStore* ds = testHelper.dataStore();
+  std::mt19937 gen(5678);
+  const std::vector<uint64_t> ids = addRandomPlatforms(testHelper, 100, gen);
+
+  simData::CategoryFilter filter(ds);
+  auto regExp = std::make_shared<StdRegExpFilter>("[0-2]$");
+  filter.setCategoryRegExp(ds->categoryNameManager().nameToInt("Cat0"), regExp);
+  simData::CompiledCategoryFilter compiled(filter);
+  rv += SDK_ASSERT(!compiled.isEmpty());
+  // The empty string is tested once during compile
+  rv += SDK_ASSERT(regExp->matchCount == 1);
+
+  for (int pass = 0; pass < 3; ++pass)
+  {
+    for (uint64_t id : ids)
+    {
+      const int before = regExp->matchCount;
+      const bool expected = filter.match(*ds, id);
+      regExp->matchCount = before;
+      rv += SDK_ASSERT(compiled.match(*ds, id) == expected);
+    }
+  }
+  // Each distinct value is tested at most once, plus the empty string
+  rv += SDK_ASSERT(regExp->matchCount <= NUM_VALUES + 1);
+
+  // Without a data store the filter cannot convert values to strings, and ignores regular expressions
+  simData::CategoryFilter noDataStore(nullptr);
+  noDataStore.setCategoryRegExp(ds->categoryNameManager().nameToInt("Cat0"), regExp);
+  compiled.compile(noDataStore);
+  rv += SDK_ASSERT(compiled.isEmpty());
+  return rv;
+}
+
+int testFilterResults()
+{
+  int rv = 0;
+  simUtil::DataStoreTestHelper testHelper;
+  simData::DataStore* ds = testHelper.dataStore();
+  std::mt19937 gen(9012);
+  std::vector<uint64_t> ids = addRandomPlatforms(testHelper, 50, gen);
+  simData::CategoryNameManager& catNameMgr = ds->categoryNameManager();
+
+  simData::CategoryFilterResults results(*ds);
+  simData::CategoryFilter filter(ds);
+  filter.setValue(catNameMgr.nameToInt("Cat0"), catNameMgr.valueToInt("Value0"), true);
+  results.setFilter(filter);
+
+  // First evaluation tests everything, and reports every entity as changed
+  std::vector<uint64_t> changed;
+  rv += SDK_ASSERT(results.evaluate(&changed) == ids.size());
+  rv += SDK_ASSERT(changed.size() == ids.size());
+  for (uint64_t id : ids)
+    rv += SDK_ASSERT(results.matches(id) == filter.match(*ds, id));
+
+  // Nothing changed, nothing tested
+  rv += SDK_ASSERT(results.evaluate(&changed) == 0);
+  rv += SDK_ASSERT(changed.empty());
+
+  // Category change on a single entity re-tests only that entity
+  const uint64_t changeId = ids[7];
+  const bool wasMatch = results.matches(changeId);
+  testHelper.addCategoryData(changeId, "Cat0", wasMatch ? "Value1" : "Value0", 1.0);
+  ds->update(1.0);
+  rv += SDK_ASSERT(results.evaluate(&changed) == 1);
+  rv += SDK_ASSERT(changed.size() == 1 && changed[0] == changeId);
+  rv += SDK_ASSERT(results.matches(changeId) == !wasMatch);
+
+  // Change that does not alter the result is tested but not reported
+  testHelper.addCategoryData(changeId, "Cat3", "Value5", 2.0);
+  ds->update(2.0);
+  rv += SDK_ASSERT(results.evaluate(&changed) == 1);
+  rv += SDK_ASSERT(changed.empty());
+
+  // New entity is tested and reported
+  const uint64_t newId = testHelper.addPlatform();
+  rv += SDK_ASSERT(results.evaluate(&changed) == 1);
+  rv += SDK_ASSERT(changed.size() == 1 && changed[0] == newId);
+  rv += SDK_ASSERT(!results.matches(newId));
+
+  // Removed entities are skipped
+  ds->removeEntity(ids[3]);
+  testHelper.addCategoryData(ids[4], "Cat4", "Value5", 3.0);
+  ds->removeEntity(ids[4]);
+  rv += SDK_ASSERT(results.evaluate(&changed) == 0);
+  rv += SDK_ASSERT(results.matches(ids[3]));
+
+  // Filter change re-tests everything
+  filter.setValue(catNameMgr.nameToInt("Cat0"), catNameMgr.valueToInt("Value1"), true);
+  results.setFilter(filter);
+  rv += SDK_ASSERT(results.evaluate(&changed) == ids.size() - 1);
+  std::vector<uint64_t> allIds;
+  ds->idList(&allIds);
+  for (uint64_t id : allIds)
+    rv += SDK_ASSERT(results.matches(id) == filter.match(*ds, id));
+  return rv;
+}
+
+}
+
+int TestCompiledCategoryFilter(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += testCompiledMatch();
+  rv += testRegExpCache();
+  rv += testFilterResults();
+  return rv;
+}
@@ -0,0 +1,155 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <iostream>
+#include <map>
+#include <random>
+#include "simCore/Common/SDKAssert.h"
+#include "simData/EntityIndex.h"
+
+namespace
+{
+
+int testIndexAgainstMap()
+{
+  int rv = 0;
+  simData::EntityIndex index;
+  std::map<simData::ObjectId, uint32_t> expected;
+
+  // Mix of sequential and scattered IDs, with enough removals to exercise backward shift deletion
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<simData::ObjectId> idDist(1, 3000);
+  for (int k = 0; k < 20000; ++k)
+  {
+    const simData::ObjectId id = (k % 3 == 0) ? static_cast<simData::ObjectId>(k) : idDist(gen);
+    if (gen() % 3 == 0)
+    {
+      rv += SDK_ASSERT(index.erase(id) == (expected.erase(id) == 1));
+    }
+    else
+    {
+      index.set(id, simData::PLATFORM, static_cast<uint32_t>(k));
+      expected[id] = static_cast<uint32_t>(k);
+    }
+  }
+
+  rv += SDK_ASSERT(index.size() == expected.size());
+  for (simData::ObjectId id = 0; id < 21000; ++id)
+  {
+    const simData::EntityIndex::Record* record = index.find(id);
+    const auto it = expected.find(id);
+    if (it == expected.end())
+      rv += SDK_ASSERT(record == nullptr);
+    else
+    {
+      rv += SDK_ASSERT(record != nullptr && record->id == id && record->slot == it->second);
+    }
+  }
+
+  index.clear();
+  rv += SDK_ASSERT(index.size() == 0);
+  rv += SDK_ASSERT(index.find(3) == nullptr);
+  return rv;
+}
+
+int testSharedIndex()
+{
+  int rv = 0;
+  simData::EntityIndex index;
+  simData::EntityMap<int> platforms(index, simData::PLATFORM);
+  simData::EntityMap<int> beams(index, simData::BEAM);
+
+  for (simData::ObjectId id = 1; id <= 10; ++id)
+  {
+    if (id % 2)
+      platforms[id] = static_cast<int>(id * 10);
+    else
+      beams[id] = static_cast<int>(id * 10);
+  }
+  rv += SDK_ASSERT(index.size() == 10);
+  rv += SDK_ASSERT(platforms.size() == 5);
+  rv += SDK_ASSERT(beams.size() == 5);
+
+  // The type recorded in the shared index keeps maps from seeing each other's IDs
+  rv += SDK_ASSERT(platforms.find(2) == platforms.end());
+  rv += SDK_ASSERT(beams.find(2) != beams.end() && beams.find(2)->second == 20);
+  rv += SDK_ASSERT(index.find(3) != nullptr && index.find(3)->type == simData::PLATFORM);
+  rv += SDK_ASSERT(index.find(4) != nullptr && index.find(4)->type == simData::BEAM);
+
+  // Erasing from the middle moves the last value into the hole; every ID must still resolve
+  rv += SDK_ASSERT(platforms.erase(3) == 1);
+  rv += SDK_ASSERT(platforms.erase(3) == 0);
+  rv += SDK_ASSERT(beams.erase(3) == 0);
+  rv += SDK_ASSERT(platforms.size() == 4);
+  rv += SDK_ASSERT(index.find(3) == nullptr);
+  for (simData::ObjectId id : { 1, 5, 7, 9 })
+  {
+    const auto it = platforms.find(id);
+    rv += SDK_ASSERT(it != platforms.end() && it->first == id && it->second == static_cast<int>(id * 10));
+  }
+
+  // Iteration visits every value once
+  int sum = 0;
+  for (const auto& value : platforms)
+    sum += value.second;
+  rv += SDK_ASSERT(sum == 10 + 50 + 70 + 90);
+
+  // Clearing one map leaves the other map's IDs in the shared index
+  platforms.clear();
+  rv += SDK_ASSERT(platforms.empty());
+  rv += SDK_ASSERT(index.size() == 5);
+  rv += SDK_ASSERT(index.find(1) == nullptr);
+  rv += SDK_ASSERT(beams.find(10) != beams.end() && beams.find(10)->second == 100);
+  return rv;
+}
+
+int testPrivateIndex()
+{
+  int rv = 0;
+  // Maps with their own index may hold the same IDs, including the scenario ID 0
+  simData::EntityMap<int> generic;
+  simData::EntityMap<int> category;
+  generic[0] = 1;
+  generic[5] = 2;
+  category[0] = 3;
+  category[5] = 4;
+  rv += SDK_ASSERT(generic.find(0)->second == 1);
+  rv += SDK_ASSERT(category.find(0)->second == 3);
+  rv += SDK_ASSERT(generic.erase(0) == 1);
+  rv += SDK_ASSERT(generic.find(0) == generic.end());
+  rv += SDK_ASSERT(category.find(0) != category.end());
+  rv += SDK_ASSERT(generic.find(5)->second == 2);
+  return rv;
+}
+
+}
+
+int TestEntityIndex(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += testIndexAgainstMap();
+  rv += testSharedIndex();
+  rv += testPrivateIndex();
+
+  std::cout << "TestEntityIndex: " << (rv == 0 ? "PASSED" : "FAILED") << std::endl;
+  return rv;
+}
@@ -0,0 +1,348 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "simCore/Common/SDKAssert.h"
+#include "simData/DataTable.h"
+#include "simData/IngestQueue.h"
+#include "simData/MemoryDataStore.h"
+
+namespace {
+
+/** Counts entity update notifications, to verify that platform updates are batched */
+class UpdateCounter : public simData::DataStore::DefaultNewUpdatesListener
+{
+public:
+  virtual void onEntityUpdate(simData::DataStore* source, simData::ObjectId id, double dataTime) override
+  {
+    ++singles;
+  }
+  virtual void onEntityUpdates(simData::DataStore* source, simData::ObjectId id, double firstTime, double lastTime) override
+  {
+    ++batches;
+  }
+
+  int singles = 0;
+  int batches = 0;
+};
+
+simData::PlatformUpdate makeUpdate(double time)
+{
+  simData::PlatformUpdate update;
+  update.set_time(time);
+  update.set_x(time);
+  update.set_y(0.0);
+  update.set_z(0.0);
+  return update;
+}
+
+int testCreateAndUpdate()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  std::shared_ptr<UpdateCounter> counter(new UpdateCounter);
+  ds.addNewUpdatesListener(counter);
+  simData::IngestQueue queue(ds);
+  std::shared_ptr<simData::IngestQueue::Producer> producer = queue.createProducer();
+
+  // Create a platform and a hosted beam using the placeholder ID
+  simData::PlatformProperties platProps;
+  platProps.set_originalid(10);
+  simData::PlatformPrefs platPrefs;
+  platPrefs.mutable_commonprefs()->set_name("Plat");
+  const simData::ObjectId platPlaceholder = producer->addPlatform(platProps, &platPrefs);
+  rv += SDK_ASSERT(platPlaceholder != 0);
+  simData::BeamProperties beamProps;
+  beamProps.set_hostid(platPlaceholder);
+  const simData::ObjectId beamPlaceholder = producer->addBeam(beamProps);
+  rv += SDK_ASSERT(beamPlaceholder != 0 && beamPlaceholder != platPlaceholder);
+
+  for (int k = 0; k < 10; ++k)
+    rv += SDK_ASSERT(producer->addPlatformUpdate(platPlaceholder, makeUpdate(k)));
+  simData::BeamUpdate beamUpdate;
+  beamUpdate.set_time(1.0);
+  beamUpdate.set_range(100.0);
+  rv += SDK_ASSERT(producer->addBeamUpdate(beamPlaceholder, beamUpdate));
+
+  // Nothing reaches the data store until drained
+  simData::DataStore::IdList ids;
+  ds.idList(&ids);
+  rv += SDK_ASSERT(ids.empty());
+  rv += SDK_ASSERT(producer->queueDepth() == 13);
+  rv += SDK_ASSERT(queue.resolve(platPlaceholder) == 0);
+
+  queue.update(5.0);
+  rv += SDK_ASSERT(producer->queueDepth() == 0);
+  const simData::ObjectId platId = queue.resolve(platPlaceholder);
+  const simData::ObjectId beamId = queue.resolve(beamPlaceholder);
+  rv += SDK_ASSERT(platId != 0 && platId != platPlaceholder);
+  rv += SDK_ASSERT(beamId != 0 && beamId != beamPlaceholder);
+  rv += SDK_ASSERT(queue.resolve(platId) == platId);
+
+  simData::DataStore::Transaction txn;
+  const simData::PlatformProperties* props = ds.platformProperties(platId, &txn);
+  rv += SDK_ASSERT(props != nullptr && props->originalid() == 10);
+  const simData::PlatformPrefs* prefs = ds.platformPrefs(platId, &txn);
+  rv += SDK_ASSERT(prefs != nullptr && prefs->commonprefs().name() == "Plat");
+  const simData::BeamProperties* bProps = ds.beamProperties(beamId, &txn);
+  rv += SDK_ASSERT(bProps != nullptr && bProps->hostid() == platId);
+
+  // Platform updates arrive as a single batch
+  const simData::PlatformUpdateSlice* slice = ds.platformUpdateSlice(platId);
+  rv += SDK_ASSERT(slice->numItems() == 10);
+  rv += SDK_ASSERT(slice->current() != nullptr && slice->current()->x() == 5.0);
+  rv += SDK_ASSERT(counter->batches == 1);
+  rv += SDK_ASSERT(counter->singles == 1);  // from the beam update
+  rv += SDK_ASSERT(ds.beamUpdateSlice(beamId)->numItems() == 1);
+
+  // Updates for the real ID after drain, including out of order times, still apply
+  rv += SDK_ASSERT(producer->addPlatformUpdate(platId, makeUpdate(20.0)));
+  rv += SDK_ASSERT(producer->addPlatformUpdate(platId, makeUpdate(10.5)));
+  rv += SDK_ASSERT(queue.drain() == 2);
+  rv += SDK_ASSERT(slice->numItems() == 12);
+  rv += SDK_ASSERT(slice->lastTime() == 20.0);
+
+  // Unknown entities and tables count as failures
+  rv += SDK_ASSERT(producer->addPlatformUpdate(platId + 1000, makeUpdate(1.0)));
+  simData::TableRow row;
+  row.setTime(1.0);
+  rv += SDK_ASSERT(producer->addTableRow(platId, "No Such Table", row));
+  rv += SDK_ASSERT(queue.drain() == 2);
+  const simData::IngestQueue::Stats stats = queue.stats();
+  rv += SDK_ASSERT(stats.failed == 2);
+  rv += SDK_ASSERT(stats.drained == 17);
+  rv += SDK_ASSERT(stats.pushed == 17);
+  rv += SDK_ASSERT(stats.dropped == 0);
+  rv += SDK_ASSERT(stats.queueDepth == 0);
+  rv += SDK_ASSERT(stats.maxLatencySeconds >= stats.meanLatencySeconds);
+  return rv;
+}
+
+int testTableRows()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  simData::IngestQueue queue(ds);
+
+  simData::DataTable* table = nullptr;
+  rv += SDK_ASSERT(ds.dataTableManager().addDataTable(0, "Scenario Table", &table).isSuccess());
+  simData::TableColumn* column = nullptr;
+  rv += SDK_ASSERT(table->addColumn("Value", simData::VT_DOUBLE, 0, &column).isSuccess());
+
+  std::shared_ptr<simData::IngestQueue::Producer> producer = queue.createProducer();
+  for (int k = 0; k < 5; ++k)
+  {
+    simData::TableRow row;
+    row.setTime(k);
+    row.setValue(column->columnId(), k * 10.0);
+    rv += SDK_ASSERT(producer->addTableRow(0, "Scenario Table", row));
+  }
+  rv += SDK_ASSERT(column->size() == 0);
+  rv += SDK_ASSERT(queue.drain() == 5);
+  rv += SDK_ASSERT(column->size() == 5);
+  rv += SDK_ASSERT(queue.stats().failed == 0);
+  return rv;
+}
+
+int testDrops()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  // Capacity rounds up to 4
+  simData::IngestQueue queue(ds, 3);
+  std::shared_ptr<simData::IngestQueue::Producer> producer = queue.createProducer();
+
+  const simData::ObjectId plat = producer->addPlatform(simData::PlatformProperties());
+  for (int k = 0; k < 3; ++k)
+    rv += SDK_ASSERT(producer->addPlatformUpdate(plat, makeUpdate(k)));
+  rv += SDK_ASSERT(!producer->addPlatformUpdate(plat, makeUpdate(3.0)));
+  rv += SDK_ASSERT(producer->addPlatform(simData::PlatformProperties()) == 0);
+  rv += SDK_ASSERT(producer->dropped() == 2);
+  rv += SDK_ASSERT(queue.stats().queueDepth == 4);
+
+  // Room again after draining
+  rv += SDK_ASSERT(queue.drain() == 4);
+  rv += SDK_ASSERT(producer->addPlatformUpdate(plat, makeUpdate(3.0)));
+  rv += SDK_ASSERT(queue.drain() == 1);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(queue.resolve(plat))->numItems() == 4);
+
+  // Counters survive the release of the producer
+  producer.reset();
+  queue.drain();
+  const simData::IngestQueue::Stats stats = queue.stats();
+  rv += SDK_ASSERT(stats.pushed == 5);
+  rv += SDK_ASSERT(stats.dropped == 2);
+  rv += SDK_ASSERT(stats.drained == 5);
+  return rv;
+}
+
+int testSlotReuse()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  // Ring of 2 slots; pushes alternate between them
+  simData::IngestQueue queue(ds, 2);
+  std::shared_ptr<simData::IngestQueue::Producer> producer = queue.createProducer();
+
+  simData::PlatformPrefs prefs;
+  prefs.mutable_commonprefs()->set_name("First");
+  const simData::ObjectId first = producer->addPlatform(simData::PlatformProperties(), &prefs);
+  rv += SDK_ASSERT(producer->addPlatformUpdate(first, makeUpdate(1.0)));
+  rv += SDK_ASSERT(queue.drain() == 2);
+
+  // Reuses the first slot's platform item, which must not keep the earlier prefs
+  const simData::ObjectId second = producer->addPlatform(simData::PlatformProperties());
+  // Second slot switches from a platform update to a command
+  simData::PlatformCommand command;
+  command.set_time(1.0);
+  command.mutable_updateprefs()->mutable_commonprefs()->set_name("Second");
+  rv += SDK_ASSERT(producer->addPlatformCommand(second, command));
+  rv += SDK_ASSERT(queue.drain() == 2);
+  rv += SDK_ASSERT(queue.stats().failed == 0);
+
+  // And back again; the reused update item carries the new platform and time
+  rv += SDK_ASSERT(producer->addPlatformUpdate(second, makeUpdate(2.0)));
+  rv += SDK_ASSERT(producer->addPlatformUpdate(second, makeUpdate(3.0)));
+  rv += SDK_ASSERT(queue.drain() == 2);
+
+  const simData::ObjectId firstId = queue.resolve(first);
+  const simData::ObjectId secondId = queue.resolve(second);
+  rv += SDK_ASSERT(firstId != 0 && secondId != 0 && firstId != secondId);
+  simData::DataStore::Transaction txn;
+  rv += SDK_ASSERT(ds.platformPrefs(firstId, &txn)->commonprefs().name() == "First");
+  rv += SDK_ASSERT(ds.platformPrefs(secondId, &txn)->commonprefs().name() != "First");
+  rv += SDK_ASSERT(ds.platformUpdateSlice(firstId)->numItems() == 1);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(secondId)->numItems() == 2);
+  rv += SDK_ASSERT(ds.platformUpdateSlice(secondId)->lastTime() == 3.0);
+  rv += SDK_ASSERT(ds.platformCommandSlice(secondId)->numItems() == 1);
+  return rv;
+}
+
+int testPlaceholderTrim()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  simData::IngestQueue queue(ds);
+  std::shared_ptr<simData::IngestQueue::Producer> producer = queue.createProducer();
+
+  // Enough creations to pass the trim threshold
+  const int numPlatforms = 3000;
+  std::vector<simData::ObjectId> placeholders;
+  for (int k = 0; k < numPlatforms; ++k)
+    placeholders.push_back(producer->addPlatform(simData::PlatformProperties()));
+  queue.drain();
+
+  // Remove all but the last platform; later drains forget their placeholders
+  for (int k = 0; k < numPlatforms - 1; ++k)
+    ds.removeEntity(queue.resolve(placeholders[k]));
+  const simData::ObjectId liveId = queue.resolve(placeholders.back());
+  rv += SDK_ASSERT(liveId != 0);
+  for (int k = 0; k < numPlatforms; ++k)
+    producer->addPlatform(simData::PlatformProperties());
+  queue.drain();
+
+  rv += SDK_ASSERT(queue.resolve(placeholders.front()) == 0);
+  rv += SDK_ASSERT(queue.resolve(placeholders[numPlatforms - 2]) == 0);
+  rv += SDK_ASSERT(queue.resolve(placeholders.back()) == liveId);
+  // Updates through the live placeholder still apply
+  rv += SDK_ASSERT(producer->addPlatformUpdate(placeholders.back(), makeUpdate(1.0)));
+  queue.drain();
+  rv += SDK_ASSERT(ds.platformUpdateSlice(liveId)->numItems() == 1);
+  return rv;
+}
+
+int testMultipleProducers()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  simData::IngestQueue queue(ds, 256);
+
+  // Create the platforms up front, on the data store thread
+  const size_t numProducers = 4;
+  const int numUpdates = 2000;
+  std::vector<simData::ObjectId> ids;
+  for (size_t k = 0; k < numProducers; ++k)
+  {
+    simData::DataStore::Transaction txn;
+    simData::PlatformProperties* props = ds.addPlatform(&txn);
+    ids.push_back(props->id());
+    txn.commit();
+  }
+
+  // Each thread retries until its push succeeds, while this thread drains
+  std::atomic<size_t> running(numProducers);
+  std::vector<std::thread> threads;
+  for (size_t k = 0; k < numProducers; ++k)
+  {
+    std::shared_ptr<simData::IngestQueue::Producer> producer = queue.createProducer();
+    const simData::ObjectId id = ids[k];
+    threads.emplace_back([producer, id, &running]() {
+      for (int time = 0; time < numUpdates; ++time)
+      {
+        while (!producer->addPlatformUpdate(id, makeUpdate(time)))
+          std::this_thread::yield();
+      }
+      --running;
+    });
+  }
+  while (running > 0)
+  {
+    queue.drain();
+    std::this_thread::yield();
+  }
+  for (auto& thread : threads)
+    thread.join();
+  queue.drain();
+
+  for (simData::ObjectId id : ids)
+  {
+    const simData::PlatformUpdateSlice* slice = ds.platformUpdateSlice(id);
+    rv += SDK_ASSERT(slice->numItems() == numUpdates);
+    rv += SDK_ASSERT(slice->firstTime() == 0.0);
+    rv += SDK_ASSERT(slice->lastTime() == numUpdates - 1);
+  }
+  const simData::IngestQueue::Stats stats = queue.stats();
+  rv += SDK_ASSERT(stats.drained == numProducers * numUpdates);
+  rv += SDK_ASSERT(stats.pushed == stats.drained);
+  rv += SDK_ASSERT(stats.failed == 0);
+  rv += SDK_ASSERT(stats.queueDepth == 0);
+  return rv;
+}
+
+}
+
+int TestIngestQueue(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += SDK_ASSERT(testCreateAndUpdate() == 0);
+  rv += SDK_ASSERT(testTableRows() == 0);
+  rv += SDK_ASSERT(testDrops() == 0);
+  rv += SDK_ASSERT(testSlotReuse() == 0);
+  rv += SDK_ASSERT(testPlaceholderTrim() == 0);
+  rv += SDK_ASSERT(testMultipleProducers() == 0);
+
+  std::cout << "TestIngestQueue: " << (rv == 0 ? "PASSED" : "FAILED") << std::endl;
+  return rv;
+}
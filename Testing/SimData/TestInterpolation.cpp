@@ -22,7 +22,10 @@
  */
 #include <iostream>
 
+#include <vector>
+
 #include "simCore/Calc/CoordinateSystem.h"
+#include "simCore/Calc/Math.h"
 #include "simCore/Calc/Units.h"
 #include "simCore/Common/Version.h"
 #include "simData/MemoryDataStore.h"
@@ -415,6 +418,134 @@ void testInterpolation_linearAngle()
   assertEquals(lslice->isInterpolated(), false);
 }
 
+/** Creates a platform update near the surface at the given time, with orientation and velocity */
+simData::PlatformUpdate makePlatformUpdate(double time, double offset, bool withOrientation, bool withVelocity)
+{
+  simData::PlatformUpdate u;
+  u.set_time(time);
+  u.set_x(simCore::WGS_A * cos(offset) + 100.0 * time);
+  u.set_y(simCore::WGS_A * sin(offset) + 50.0 * time);
+  u.set_z(1000.0 * offset + 10.0 * time);
+  if (withOrientation)
+  {
+    u.set_psi(0.1 + offset + 0.2 * time);
+    u.set_theta(0.05 * time);
+    u.set_phi(M_TWOPI - 0.1 - 0.3 * time);
+  }
+  if (withVelocity)
+  {
+    u.set_vx(100.0);
+    u.set_vy(50.0 + time);
+    u.set_vz(10.0);
+  }
+  return u;
+}
+
+/** Returns true if the values are equal, or within t of each other */
+bool closeTo(double a, double b, double t)
+{
+  return a == b || simCore::areEqual(a, b, t);
+}
+
+bool samePlatformUpdate(const simData::PlatformUpdate& a, const simData::PlatformUpdate& b, double t)
+{
+  return a.time() == b.time() && closeTo(a.x(), b.x(), t) && closeTo(a.y(), b.y(), t) && closeTo(a.z(), b.z(), t) &&
+    a.has_orientation() == b.has_orientation() && a.has_velocity() == b.has_velocity() &&
+    closeTo(a.psi(), b.psi(), t) && closeTo(a.theta(), b.theta(), t) && closeTo(a.phi(), b.phi(), t) &&
+    closeTo(a.vx(), b.vx(), t) && closeTo(a.vy(), b.vy(), t) && closeTo(a.vz(), b.vz(), t);
+}
+
+void testInterpolation_bracketCache()
+{
+  simData::LinearInterpolator cached;
+  simData::LinearInterpolator uncached;
+  assertTrue(cached.bracketCacheEnabled());
+  uncached.setBracketCacheEnabled(false);
+  assertTrue(!uncached.bracketCacheEnabled());
+
+  simData::PlatformUpdate prev = makePlatformUpdate(1.0, 0.2, true, true);
+  simData::PlatformUpdate next = makePlatformUpdate(2.0, 0.2, true, true);
+
+  // Repeated interpolation inside the same bracket gives the same answer as recomputing every time
+  for (double time = 1.0; time <= 2.0; time += 0.125)
+  {
+    simData::PlatformUpdate a;
+    simData::PlatformUpdate b;
+    assertTrue(cached.interpolate(time, prev, next, &a));
+    assertTrue(uncached.interpolate(time, prev, next, &b));
+    assertTrue(samePlatformUpdate(a, b, 0.0));
+  }
+
+  // Modifying an update in place must not serve the stale cached bracket
+  prev.set_x(prev.x() + 1000.0);
+  prev.set_psi(prev.psi() + 0.5);
+  {
+    simData::PlatformUpdate a;
+    simData::PlatformUpdate b;
+    cached.interpolate(1.5, prev, next, &a);
+    uncached.interpolate(1.5, prev, next, &b);
+    assertTrue(samePlatformUpdate(a, b, 0.0));
+  }
+
+  // Orientation is only interpolated when both ends have it
+  prev.clear_psi();
+  prev.clear_theta();
+  prev.clear_phi();
+  {
+    simData::PlatformUpdate a;
+    simData::PlatformUpdate b;
+    cached.interpolate(1.5, prev, next, &a);
+    uncached.interpolate(1.5, prev, next, &b);
+    assertTrue(!a.has_orientation());
+    assertTrue(samePlatformUpdate(a, b, 0.0));
+  }
+}
+
+void testInterpolation_batch()
+{
+  const size_t numPlatforms = 50;
+  std::vector<simData::PlatformUpdate> prevs;
+  std::vector<simData::PlatformUpdate> nexts;
+  for (size_t k = 0; k < numPlatforms; ++k)
+  {
+    // Mix of platforms with and without orientation and velocity
+    const double offset = 0.01 * static_cast<double>(k);
+    prevs.push_back(makePlatformUpdate(1.0, offset, (k % 2) == 0, (k % 3) == 0));
+    nexts.push_back(makePlatformUpdate(2.0 + 0.1 * static_cast<double>(k), offset, (k % 2) == 0, (k % 3) == 0));
+  }
+
+  std::vector<simData::PlatformUpdate> batchResults(numPlatforms);
+  std::vector<const simData::PlatformUpdate*> prevPtrs;
+  std::vector<const simData::PlatformUpdate*> nextPtrs;
+  std::vector<simData::PlatformUpdate*> resultPtrs;
+  for (size_t k = 0; k < numPlatforms; ++k)
+  {
+    prevPtrs.push_back(&prevs[k]);
+    nextPtrs.push_back(&nexts[k]);
+    resultPtrs.push_back(&batchResults[k]);
+  }
+  // Invalid entries are skipped
+  resultPtrs[3] = nullptr;
+  resultPtrs[7] = const_cast<simData::PlatformUpdate*>(prevPtrs[7]);
+
+  simData::LinearInterpolator interpolator;
+  for (double time = 1.0; time <= 2.0; time += 0.25)
+  {
+    assertEquals(interpolator.interpolate(time, numPlatforms, prevPtrs.data(), nextPtrs.data(), resultPtrs.data()), numPlatforms - 2);
+    for (size_t k = 0; k < numPlatforms; ++k)
+    {
+      if (k == 3 || k == 7)
+        continue;
+      simData::PlatformUpdate single;
+      interpolator.interpolate(time, prevs[k], nexts[k], &single);
+      // Batch conversions may round differently than the single conversions
+      assertTrue(samePlatformUpdate(single, batchResults[k], 1.0e-4));
+    }
+  }
+  assertTrue(!batchResults[3].has_time());
+  assertEquals(interpolator.interpolate(1.0, 0, prevPtrs.data(), nextPtrs.data(), resultPtrs.data()), static_cast<size_t>(0));
+}
+
 }
 
 int TestInterpolation(int argc, char* argv[])
@@ -427,6 +558,8 @@ int TestInterpolation(int argc, char* argv[])
     testInterpolation_linear(simData::DataStore::InterpolatorState::EXTERNAL);
     testInterpolation_linear(simData::DataStore::InterpolatorState::INTERNAL);
     testInterpolation_linearAngle();
+    testInterpolation_bracketCache();
+    testInterpolation_batch();
 
     return 0;
   }
@@ -21,6 +21,7 @@
  *
  */
 
+#include <vector>
 #include "simCore/Common/SDKAssert.h"
 #include "simData/MemoryDataStore.h"
 #include "simUtil/DataStoreTestHelper.h"
@@ -325,6 +326,36 @@ protected:
   simData::DataStore::ListenerPtr listener2_;
 };
 
+/// Adds and removes platforms and beams while another beam is being removed
+class ChangeEntitiesDuringRemove : public simData::DataStore::DefaultListener
+{
+public:
+  ChangeEntitiesDuringRemove(simUtil::DataStoreTestHelper& helper, uint64_t trigger, const std::vector<uint64_t>& toRemove, int numToAdd)
+    : helper_(helper),
+      trigger_(trigger),
+      toRemove_(toRemove),
+      numToAdd_(numToAdd)
+  {
+  }
+
+  virtual void onRemoveEntity(simData::DataStore *source, simData::ObjectId removedId, simData::ObjectType ot)
+  {
+    if (removedId != trigger_)
+      return;
+    trigger_ = 0;
+    for (auto id : toRemove_)
+      source->removeEntity(id);
+    for (int k = 0; k < numToAdd_; ++k)
+      helper_.addBeam(helper_.addPlatform());
+  }
+
+private:
+  simUtil::DataStoreTestHelper& helper_;
+  uint64_t trigger_;
+  std::vector<uint64_t> toRemove_;
+  int numToAdd_;
+};
+
 int testAddEntity()
 {
   int rv = 0;
@@ -836,6 +867,54 @@ int testMultipleRemoval()
   return rv;
 }
 
+int testEntityChangesDuringRemoval()
+{
+  int rv = 0;
+  simUtil::DataStoreTestHelper testHelper;
+  simData::DataStore* ds = testHelper.dataStore();
+
+  const uint64_t other = testHelper.addPlatform();
+  const uint64_t otherBeam = testHelper.addBeam(other);
+  const uint64_t victim = testHelper.addPlatform();
+  // Host and its beam are last in their containers, so removing the victims moves them
+  const uint64_t host = testHelper.addPlatform();
+  const uint64_t beam = testHelper.addBeam(host);
+
+  // Enough additions to reallocate the containers while the host is being removed
+  const int numAdded = 100;
+  std::vector<uint64_t> toRemove;
+  toRemove.push_back(victim);
+  toRemove.push_back(otherBeam);
+  ds->addListener(simData::DataStore::ListenerPtr(new ChangeEntitiesDuringRemove(testHelper, beam, toRemove, numAdded)));
+  ds->removeEntity(host);
+
+  rv += SDK_ASSERT(ds->objectType(host) == simData::NONE);
+  rv += SDK_ASSERT(ds->objectType(beam) == simData::NONE);
+  rv += SDK_ASSERT(ds->objectType(victim) == simData::NONE);
+  rv += SDK_ASSERT(ds->objectType(otherBeam) == simData::NONE);
+  rv += SDK_ASSERT(ds->objectType(other) == simData::PLATFORM);
+
+  simData::DataStore::IdList platforms;
+  ds->idList(&platforms, simData::PLATFORM);
+  rv += SDK_ASSERT(platforms.size() == numAdded + 1);
+  simData::DataStore::IdList beams;
+  ds->idList(&beams, simData::BEAM);
+  rv += SDK_ASSERT(beams.size() == numAdded);
+  for (auto id : platforms)
+  {
+    simData::DataStore::Transaction txn;
+    const simData::PlatformProperties* props = ds->platformProperties(id, &txn);
+    rv += SDK_ASSERT(props != nullptr && props->id() == id);
+  }
+  for (auto id : beams)
+  {
+    simData::DataStore::Transaction txn;
+    const simData::BeamProperties* props = ds->beamProperties(id, &txn);
+    rv += SDK_ASSERT(props != nullptr && props->id() == id);
+  }
+  return rv;
+}
+
 }
 
 int TestListener(int argc, char* argv[])
@@ -851,6 +930,7 @@ int TestListener(int argc, char* argv[])
   rv += testFlush();
   rv += testScenarioDelete();
   rv += testMultipleRemoval();
+  rv += testEntityChangesDuringRemoval();
 
   return rv;
 }
@@ -1978,6 +1978,121 @@ int testDataStorePlatformLifespan()
   return rv;
 }
 
+/** Verifies that splitting the platform update across threads gives the same results as a single threaded update */
+int testParallelUpdate(simData::DataStore::InterpolatorState state)
+{
+  int rv = 0;
+
+  simData::MemoryDataStore serialDs;
+  simData::MemoryDataStore parallelDs;
+  parallelDs.setUpdateThreadCount(4);
+  rv += SDK_ASSERT(serialDs.updateThreadCount() == 1);
+  rv += SDK_ASSERT(parallelDs.updateThreadCount() == 4);
+
+  simData::LinearInterpolator interpolator;
+  simUtil::DataStoreTestHelper serialHelper(&serialDs);
+  simUtil::DataStoreTestHelper parallelHelper(&parallelDs);
+  std::vector<uint64_t> ids;
+  for (simUtil::DataStoreTestHelper* helper : { &serialHelper, &parallelHelper })
+  {
+    helper->dataStore()->setInterpolator(&interpolator);
+    helper->dataStore()->enableInterpolation(state);
+
+    // Enough platforms to cross the threshold for a parallel update; stagger the start times so some are not yet valid
+    ids.clear();
+    for (int k = 0; k < 500; ++k)
+    {
+      const uint64_t id = helper->addPlatform();
+      ids.push_back(id);
+      for (int time = k % 3; time < 10; ++time)
+        helper->addPlatformUpdate(time, id);
+    }
+  }
+
+  for (double time : { 0.5, 1.0, 2.25, 5.0, 4.5, 9.0, 12.0 })
+  {
+    serialDs.update(time);
+    parallelDs.update(time);
+    for (uint64_t id : ids)
+    {
+      const simData::PlatformUpdate* serialUpdate = serialDs.platformUpdateSlice(id)->current();
+      const simData::PlatformUpdate* parallelUpdate = parallelDs.platformUpdateSlice(id)->current();
+      rv += SDK_ASSERT((serialUpdate == nullptr) == (parallelUpdate == nullptr));
+      if (serialUpdate == nullptr || parallelUpdate == nullptr)
+        continue;
+      rv += SDK_ASSERT(serialUpdate->time() == parallelUpdate->time());
+      rv += SDK_ASSERT(serialUpdate->x() == parallelUpdate->x());
+      rv += SDK_ASSERT(serialUpdate->y() == parallelUpdate->y());
+      rv += SDK_ASSERT(serialUpdate->z() == parallelUpdate->z());
+      rv += SDK_ASSERT(serialDs.platformUpdateSlice(id)->isInterpolated() == parallelDs.platformUpdateSlice(id)->isInterpolated());
+    }
+  }
+
+  // Going back to a single thread releases the pool
+  parallelDs.setUpdateThreadCount(1);
+  rv += SDK_ASSERT(parallelDs.updateThreadCount() == 1);
+
+  return rv;
+}
+
+/** Verifies the IDs reported by changedEntities() */
+int testChangedEntities()
+{
+  int rv = 0;
+
+  simUtil::DataStoreTestHelper testHelper;
+  simData::DataStore* ds = testHelper.dataStore();
+
+  const uint64_t plat1 = testHelper.addPlatform();
+  const uint64_t plat2 = testHelper.addPlatform();
+  testHelper.addPlatformUpdate(0.0, plat1);
+  testHelper.addPlatformUpdate(10.0, plat1);
+  testHelper.addPlatformUpdate(0.0, plat2);
+  testHelper.addPlatformUpdate(10.0, plat2);
+
+  // New entities are always reported
+  simData::DataStore::IdList ids;
+  ds->update(1.0);
+  rv += SDK_ASSERT(ds->changedEntities(&ids));
+  rv += SDK_ASSERT(ids == simData::DataStore::IdList({ plat1, plat2 }));
+
+  // Nothing changes without interpolation while time stays between the same points
+  ds->update(2.0);
+  rv += SDK_ASSERT(ds->changedEntities(&ids));
+  rv += SDK_ASSERT(ids.empty());
+
+  // New data for one platform only affects that platform
+  testHelper.addPlatformUpdate(3.0, plat2);
+  ds->update(4.0);
+  rv += SDK_ASSERT(ds->changedEntities(&ids));
+  rv += SDK_ASSERT(ids == simData::DataStore::IdList({ plat2 }));
+
+  // Update to the same time is skipped entirely
+  ds->update(4.0);
+  rv += SDK_ASSERT(ds->changedEntities(&ids));
+  rv += SDK_ASSERT(ids.empty());
+
+  // Preference changes are reported on the next update
+  simData::DataStore::Transaction txn;
+  simData::PlatformPrefs* prefs = ds->mutable_platformPrefs(plat1, &txn);
+  prefs->set_scale(2.0);
+  txn.complete(&prefs);
+  ds->update(4.0);
+  rv += SDK_ASSERT(ds->changedEntities(&ids));
+  rv += SDK_ASSERT(ids == simData::DataStore::IdList({ plat1 }));
+
+  // Interpolated platforms change on every time change
+  simData::LinearInterpolator interpolator;
+  ds->setInterpolator(&interpolator);
+  ds->enableInterpolation(true);
+  ds->update(5.0);
+  ds->update(6.0);
+  rv += SDK_ASSERT(ds->changedEntities(&ids));
+  rv += SDK_ASSERT(ids == simData::DataStore::IdList({ plat1, plat2 }));
+
+  return rv;
+}
+
 }
 
 int TestMemoryDataStore(int argc, char* argv[])
@@ -2003,6 +2118,10 @@ int TestMemoryDataStore(int argc, char* argv[])
     rv += testOriginalId();
     rv += testDataStoreHelperPlatformLifespan();
     rv += testDataStorePlatformLifespan();
+    rv += testParallelUpdate(simData::DataStore::InterpolatorState::OFF);
+    rv += testParallelUpdate(simData::DataStore::InterpolatorState::EXTERNAL);
+    rv += testParallelUpdate(simData::DataStore::InterpolatorState::INTERNAL);
+    rv += testChangedEntities();
     return rv;
   }
   catch (const MemDataStoreAssertException& e)
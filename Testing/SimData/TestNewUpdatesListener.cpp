@@ -21,6 +21,7 @@
  *
  */
 #include <map>
+#include <vector>
 #include "simCore/Common/SDKAssert.h"
 #include "simData/DataStoreProxy.h"
 #include "simData/DataTable.h"
@@ -95,6 +96,20 @@ private:
   std::set<simData::ObjectId> flushedIds_;
 };
 
+/** Counts the batch notifications from addPlatformUpdates(), and relies on the default for the rest */
+class BatchCollector : public TimeCollector
+{
+public:
+  /** Record the batch time range */
+  virtual void onEntityUpdates(simData::DataStore* source, simData::ObjectId id, double firstTime, double lastTime)
+  {
+    batches.push_back(std::make_pair(firstTime, lastTime));
+  }
+
+  /** Time range of each batch received */
+  std::vector<std::pair<double, double> > batches;
+};
+
 int testEntityCollection()
 {
   simUtil::DataStoreTestHelper helper;
@@ -477,6 +492,81 @@ int testIgnoresCategoryData()
   return rv;
 }
 
+
+int testBatchUpdates()
+{
+  simUtil::DataStoreTestHelper helper;
+
+  simData::DataStore* ds = helper.dataStore();
+  std::shared_ptr<TimeCollector> timeCollector(new TimeCollector);
+  std::shared_ptr<BatchCollector> batchCollector(new BatchCollector);
+  ds->addNewUpdatesListener(timeCollector);
+  ds->addNewUpdatesListener(batchCollector);
+
+  simData::ObjectId plat1 = helper.addPlatform(1);
+  std::vector<simData::PlatformUpdate> updates(5);
+  for (size_t k = 0; k < updates.size(); ++k)
+  {
+    updates[k].set_time(1.0 + k);
+    updates[k].set_x(static_cast<double>(k));
+  }
+
+  int rv = 0;
+  rv += SDK_ASSERT(ds->addPlatformUpdates(plat1, updates.data(), updates.size()) == 0);
+
+  // One batch notification; default implementation reports the first and last times
+  rv += SDK_ASSERT(batchCollector->batches.size() == 1);
+  rv += SDK_ASSERT(batchCollector->batches[0] == std::make_pair(1.0, 5.0));
+  auto p1Times = timeCollector->getTimes(plat1);
+  rv += SDK_ASSERT(p1Times.size() == 2);
+  rv += SDK_ASSERT(p1Times.count(1.0) != 0);
+  rv += SDK_ASSERT(p1Times.count(5.0) != 0);
+
+  // All points are stored, same as adding them one at a time
+  const simData::PlatformUpdateSlice* slice = ds->platformUpdateSlice(plat1);
+  rv += SDK_ASSERT(slice->numItems() == 5);
+  rv += SDK_ASSERT(slice->firstTime() == 1.0);
+  rv += SDK_ASSERT(slice->lastTime() == 5.0);
+
+  // Repeated times replace the earlier point, both within the batch and against stored data
+  updates.resize(3);
+  updates[0].set_time(5.0);
+  updates[0].set_x(50.0);
+  updates[1].set_time(6.0);
+  updates[2].set_time(6.0);
+  updates[2].set_x(60.0);
+  rv += SDK_ASSERT(ds->addPlatformUpdates(plat1, updates.data(), updates.size()) == 0);
+  rv += SDK_ASSERT(batchCollector->batches.size() == 2);
+  rv += SDK_ASSERT(slice->numItems() == 6);
+  ds->update(5.0);
+  rv += SDK_ASSERT(slice->current() != nullptr && slice->current()->x() == 50.0);
+  ds->update(6.0);
+  rv += SDK_ASSERT(slice->current() != nullptr && slice->current()->x() == 60.0);
+
+  // Unsorted batches and unknown entities are rejected without notification
+  updates[0].set_time(8.0);
+  updates[1].set_time(7.0);
+  rv += SDK_ASSERT(ds->addPlatformUpdates(plat1, updates.data(), updates.size()) != 0);
+  rv += SDK_ASSERT(ds->addPlatformUpdates(plat1 + 100, updates.data(), 1) != 0);
+  rv += SDK_ASSERT(batchCollector->batches.size() == 2);
+  rv += SDK_ASSERT(slice->numItems() == 6);
+
+  // Data limiting is applied to the batch
+  ds->setDataLimiting(true);
+  simData::PlatformPrefs prefs;
+  prefs.mutable_commonprefs()->set_datalimitpoints(3);
+  helper.updatePlatformPrefs(prefs, plat1);
+  updates.resize(4);
+  for (size_t k = 0; k < updates.size(); ++k)
+    updates[k].set_time(10.0 + k);
+  rv += SDK_ASSERT(ds->addPlatformUpdates(plat1, updates.data(), updates.size()) == 0);
+  rv += SDK_ASSERT(slice->numItems() == 3);
+  rv += SDK_ASSERT(slice->firstTime() == 11.0);
+  rv += SDK_ASSERT(slice->lastTime() == 13.0);
+
+  return rv;
+}
+
 }
 
 int TestNewUpdatesListener(int argc, char* argv[])
@@ -486,5 +576,6 @@ int TestNewUpdatesListener(int argc, char* argv[])
   rv += SDK_ASSERT(testDataTableCollection() == 0);
   rv += SDK_ASSERT(testDataStoreProxy() == 0);
   rv += SDK_ASSERT(testIgnoresCategoryData() == 0);
+  rv += SDK_ASSERT(testBatchUpdates() == 0);
   return rv;
 }
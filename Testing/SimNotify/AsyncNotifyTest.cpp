@@ -0,0 +1,282 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "simNotify/AsyncNotifyHandler.h"
+#include "simNotify/Notify.h"
+#include "simCore/Common/SDKAssert.h"
+#include "NotifySupport.h"
+
+using NotifyTestSupport::StringStreamNotify;
+
+namespace
+{
+
+/** Records messages, optionally blocking inside notify() until released */
+class GateNotify : public simNotify::NotifyHandler
+{
+public:
+  virtual void notifyPrefix() override {}
+
+  virtual void notify(const std::string& message) override
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    messages_.push_back(message);
+    severities_.push_back(severity());
+    entered_ = true;
+    changed_.notify_all();
+    changed_.wait(lock, [this]() { return open_; });
+  }
+
+  /** Waits until a message is being written */
+  void waitForEntry()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this]() { return entered_; });
+  }
+
+  /** Lets all messages through */
+  void open()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open_ = true;
+    changed_.notify_all();
+  }
+
+  std::vector<std::string> messages() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return messages_;
+  }
+
+  std::vector<simNotify::NotifySeverity> severities() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return severities_;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::condition_variable changed_;
+  std::vector<std::string> messages_;
+  std::vector<simNotify::NotifySeverity> severities_;
+  bool entered_ = false;
+  bool open_ = false;
+};
+
+/** Sends a line with prefix directly to the handler, bypassing the notify level */
+void send(simNotify::NotifyHandler& handler, simNotify::NotifySeverity severity, const std::string& message)
+{
+  handler.setSeverity(severity);
+  handler.notifyPrefix();
+  handler.notify(message + "\n");
+}
+
+int testOrderAndPrefix()
+{
+  int rv = 0;
+  auto target = std::make_shared<StringStreamNotify>();
+  auto async = std::make_shared<simNotify::AsyncNotifyHandler>(target);
+  simNotify::setNotifyHandlers(async);
+
+  SIM_WARN << "Warn 1" << std::endl;
+  SIM_FATAL << "Fatal 1" << std::endl;
+  SIM_DEBUG_FP << "Suppressed" << std::endl;
+  async->flush();
+  rv += SDK_ASSERT(target->allLines() == "[Date] [Time] [WARN] Warn 1\n[Date] [Time] [FATAL] Fatal 1\n");
+  rv += SDK_ASSERT(async->droppedCount() == 0);
+
+  simNotify::setNotifyHandlers(simNotify::defaultNotifyHandler());
+  return rv;
+}
+
+int testThreads()
+{
+  int rv = 0;
+  const int numThreads = 4;
+  const int numMessages = 2000;
+  auto target = std::make_shared<StringStreamNotify>();
+  // Small ring forces the producers to wait; warnings are never dropped
+  simNotify::AsyncNotifyHandler async(target, 16);
+  async.setSeverity(simNotify::NOTIFY_WARN);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; ++t)
+  {
+    threads.emplace_back([&async, t, numMessages]() {
+      for (int k = 0; k < numMessages; ++k)
+        async.notify(std::to_string(t) + " " + std::to_string(k) + "\n");
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  async.flush();
+  rv += SDK_ASSERT(async.droppedCount() == 0);
+
+  // Every message arrives, in order for each producer
+  std::vector<int> next(numThreads, 0);
+  std::istringstream lines(target->allLines());
+  int thread = 0;
+  int index = 0;
+  int count = 0;
+  while (lines >> thread >> index)
+  {
+    rv += SDK_ASSERT(thread >= 0 && thread < numThreads);
+    if (thread < 0 || thread >= numThreads)
+      break;
+    rv += SDK_ASSERT(next[thread] == index);
+    next[thread] = index + 1;
+    ++count;
+  }
+  rv += SDK_ASSERT(count == numThreads * numMessages);
+  return rv;
+}
+
+int testDropOldest()
+{
+  int rv = 0;
+  auto target = std::make_shared<GateNotify>();
+  {
+    simNotify::AsyncNotifyHandler async(target, 4);
+
+    // Stall the consumer inside the target
+    send(async, simNotify::NOTIFY_WARN, "first");
+    target->waitForEntry();
+
+    // Less severe messages evict the oldest ones
+    for (int k = 0; k < 10; ++k)
+      send(async, simNotify::NOTIFY_INFO, "info" + std::to_string(k));
+    rv += SDK_ASSERT(async.droppedCount() == 6);
+    target->open();
+    async.flush();
+
+    const std::vector<std::string> expected = { "first\n", "info6\n", "info7\n", "info8\n", "info9\n" };
+    rv += SDK_ASSERT(target->messages() == expected);
+  }
+
+  target = std::make_shared<GateNotify>();
+  {
+    simNotify::AsyncNotifyHandler async(target, 4);
+    send(async, simNotify::NOTIFY_WARN, "first");
+    target->waitForEntry();
+
+    // An important message at the front of the ring is kept; the new message is dropped instead
+    send(async, simNotify::NOTIFY_ERROR, "error");
+    for (int k = 0; k < 5; ++k)
+      send(async, simNotify::NOTIFY_DEBUG_INFO, "debug" + std::to_string(k));
+    rv += SDK_ASSERT(async.droppedCount() == 2);
+    target->open();
+    // Destructor writes everything still queued
+  }
+  const std::vector<std::string> expected = { "first\n", "error\n", "debug0\n", "debug1\n", "debug2\n" };
+  rv += SDK_ASSERT(target->messages() == expected);
+  return rv;
+}
+
+int testFragments()
+{
+  int rv = 0;
+  auto target = std::make_shared<GateNotify>();
+  {
+    simNotify::AsyncNotifyHandler async(target, 4);
+    send(async, simNotify::NOTIFY_WARN, "first");
+    target->waitForEntry();
+
+    // Start a line in fragments, as through simNotify::notify()
+    async.setSeverity(simNotify::NOTIFY_NOTICE);
+    async.notifyPrefix();
+    async << "value " << 42;
+
+    // Another thread fills the ring and changes the severity while the line is in progress
+    std::thread other([&async]() {
+      for (int k = 0; k < 10; ++k)
+        send(async, simNotify::NOTIFY_DEBUG_INFO, "debug" + std::to_string(k));
+    });
+    other.join();
+    rv += SDK_ASSERT(async.droppedCount() == 6);
+
+    // Finishing the line queues it as one message, dropping the oldest
+    async << " of " << 3.5 << std::endl;
+    rv += SDK_ASSERT(async.droppedCount() == 7);
+
+    // Text without a newline is queued by flush()
+    async.setSeverity(simNotify::NOTIFY_WARN);
+    async << "partial";
+    target->open();
+    async.flush();
+  }
+  const std::vector<std::string> expected = { "first\n", "debug7\n", "debug8\n", "debug9\n", "value 42 of 3.5\n", "partial" };
+  rv += SDK_ASSERT(target->messages() == expected);
+  const std::vector<simNotify::NotifySeverity> severities = { simNotify::NOTIFY_WARN, simNotify::NOTIFY_DEBUG_INFO,
+    simNotify::NOTIFY_DEBUG_INFO, simNotify::NOTIFY_DEBUG_INFO, simNotify::NOTIFY_NOTICE, simNotify::NOTIFY_WARN };
+  rv += SDK_ASSERT(target->severities() == severities);
+  return rv;
+}
+
+/** Generates a message of its own while writing a message */
+class EchoNotify : public StringStreamNotify
+{
+public:
+  virtual void notify(const std::string& message) override
+  {
+    StringStreamNotify::notify(message);
+    if (message == "Outer\n")
+      SIM_WARN << "Inner" << std::endl;
+  }
+};
+
+int testReentrant()
+{
+  int rv = 0;
+  auto target = std::make_shared<EchoNotify>();
+  auto async = std::make_shared<simNotify::AsyncNotifyHandler>(target);
+  simNotify::setNotifyHandlers(async);
+  SIM_WARN << "Outer" << std::endl;
+  async->flush();
+  rv += SDK_ASSERT(target->allLines() == "[Date] [Time] [WARN] Outer\n[Date] [Time] [WARN] Inner\n");
+
+  SIM_WARN << "Last" << std::endl;
+  simNotify::setNotifyHandlers(simNotify::defaultNotifyHandler());
+  // Releasing the last reference writes the queued message
+  async.reset();
+  rv += SDK_ASSERT(target->allLines() == "[Date] [Time] [WARN] Outer\n[Date] [Time] [WARN] Inner\n[Date] [Time] [WARN] Last\n");
+  return rv;
+}
+
+}
+
+int AsyncNotifyTest(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += testOrderAndPrefix();
+  rv += testThreads();
+  rv += testDropOldest();
+  rv += testFragments();
+  rv += testReentrant();
+  return rv;
+}
@@ -0,0 +1,300 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <QCoreApplication>
+#include "simCore/Common/SDKAssert.h"
+#include "simData/CategoryData/CategoryFilter.h"
+#include "simData/CategoryData/CategoryNameManager.h"
+#include "simData/MemoryDataStore.h"
+#include "simQt/CategoryFilterCounter.h"
+
+namespace {
+
+const int NUM_CATEGORIES = 4;
+const int NUM_VALUES = 5;
+
+uint64_t addPlatform(simData::DataStore& ds)
+{
+  simData::DataStore::Transaction t;
+  simData::PlatformProperties* props = ds.addPlatform(&t);
+  const uint64_t id = props->id();
+  t.commit();
+  return id;
+}
+
+uint64_t addBeam(simData::DataStore& ds, uint64_t hostId)
+{
+  simData::DataStore::Transaction t;
+  simData::BeamProperties* props = ds.addBeam(&t);
+  props->set_hostid(hostId);
+  const uint64_t id = props->id();
+  t.commit();
+  return id;
+}
+
+/** Gives the entity a random value for each category; some entities get no value for some categories */
+void addRandomCategories(simData::DataStore& ds, uint64_t id, std::mt19937& gen)
+{
+  std::uniform_int_distribution<int> valueDist(0, NUM_VALUES);
+  simData::DataStore::Transaction t;
+  simData::CategoryData* catData = ds.addCategoryData(id, &t);
+  catData->set_time(0.0);
+  for (int cat = 0; cat < NUM_CATEGORIES; ++cat)
+  {
+    const int value = valueDist(gen);
+    // Highest value means no data for the category
+    if (value == NUM_VALUES)
+      continue;
+    simData::CategoryData_Entry* entry = catData->add_entry();
+    entry->set_key("Cat" + std::to_string(cat));
+    entry->set_value("Value" + std::to_string(value));
+  }
+  t.complete(&catData);
+}
+
+/** Fills the data store with platforms and beams holding random category data */
+void fillDataStore(simData::DataStore& ds, int numPlatforms)
+{
+  std::mt19937 gen(1234);
+  for (int k = 0; k < numPlatforms; ++k)
+  {
+    const uint64_t platformId = addPlatform(ds);
+    addRandomCategories(ds, platformId, gen);
+    if (k % 4 == 0)
+      addRandomCategories(ds, addBeam(ds, platformId), gen);
+  }
+  ds.update(0.0);
+}
+
+/** Counts the entities that pass the filter when only the given value of the category is checked */
+size_t bruteForceCount(simData::DataStore& ds, const simData::CategoryFilter& filter, simData::ObjectType objectTypes, int nameInt, int valueInt)
+{
+  simData::CategoryFilter singleValue(&ds);
+  singleValue.assign(filter, false);
+  singleValue.removeName(nameInt);
+  singleValue.setValue(nameInt, valueInt, true);
+
+  std::vector<simData::ObjectId> ids;
+  ds.idList(&ids, objectTypes);
+  return std::count_if(ids.begin(), ids.end(), [&](simData::ObjectId id) { return singleValue.match(ds, id); });
+}
+
+/** Verifies that the results hold a count for every known value of every category, and that each count is correct */
+int checkCounts(simData::DataStore& ds, const simData::CategoryFilter& filter, simData::ObjectType objectTypes, const simQt::CategoryCountResults& results)
+{
+  int rv = 0;
+  const simData::CategoryNameManager& nameManager = ds.categoryNameManager();
+  std::vector<int> names;
+  nameManager.allCategoryNameInts(names);
+  rv += SDK_ASSERT(results.allCategories.size() == names.size());
+  for (int nameInt : names)
+  {
+    auto countsIter = results.allCategories.find(nameInt);
+    rv += SDK_ASSERT(countsIter != results.allCategories.end());
+    if (countsIter == results.allCategories.end())
+      continue;
+    const simQt::CategoryCountResults::ValueToCountMap& counts = countsIter->second;
+
+    std::vector<int> values;
+    nameManager.allValueIntsInCategory(nameInt, values);
+    values.push_back(simData::CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME);
+    rv += SDK_ASSERT(counts.size() == values.size());
+    for (int valueInt : values)
+    {
+      auto count = counts.find(valueInt);
+      rv += SDK_ASSERT(count != counts.end());
+      if (count != counts.end())
+        rv += SDK_ASSERT(count->second == bruteForceCount(ds, filter, objectTypes, nameInt, valueInt));
+    }
+  }
+  return rv;
+}
+
+/** Returns the count for the named category value, or 0 if it is not in the results */
+size_t countFor(const simQt::CategoryCountResults& results, int nameInt, int valueInt)
+{
+  auto countsIter = results.allCategories.find(nameInt);
+  if (countsIter == results.allCategories.end())
+    return 0;
+  auto count = countsIter->second.find(valueInt);
+  return (count == countsIter->second.end()) ? 0 : count->second;
+}
+
+int testCounts()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  fillDataStore(ds, 40);
+
+  // A value that no entity holds still gets a count
+  simData::CategoryNameManager& nameManager = ds.categoryNameManager();
+  const int cat0 = nameManager.nameToInt("Cat0");
+  const int cat1 = nameManager.nameToInt("Cat1");
+  const int cat2 = nameManager.nameToInt("Cat2");
+  const int unusedValue = nameManager.addCategoryValue(cat0, "Unused");
+
+  simData::CategoryFilter filter(&ds);
+  simQt::CategoryFilterCounter counter;
+  int numResults = 0;
+  QObject::connect(&counter, &simQt::CategoryFilterCounter::resultsReady, [&numResults]() { ++numResults; });
+
+  // Empty filter
+  counter.setFilter(filter);
+  counter.testAllCategories();
+  rv += SDK_ASSERT(numResults == 1);
+  rv += checkCounts(ds, filter, simData::ALL, counter.results());
+  rv += SDK_ASSERT(countFor(counter.results(), cat0, unusedValue) == 0);
+  rv += SDK_ASSERT(countFor(counter.results(), cat0, simData::CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME) > 0);
+
+  // Mix of checked values, the no-value and unlisted-value entries, and a category left out of the filter
+  filter.setValue(cat0, nameManager.valueToInt("Value0"), true);
+  filter.setValue(cat0, nameManager.valueToInt("Value1"), true);
+  filter.setValue(cat0, simData::CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME, true);
+  filter.setValue(cat1, nameManager.valueToInt("Value2"), false);
+  filter.setValue(cat1, simData::CategoryNameManager::UNLISTED_CATEGORY_VALUE, true);
+  filter.setValue(cat2, nameManager.valueToInt("Value3"), true);
+  filter.setValue(cat2, simData::CategoryNameManager::NO_CATEGORY_VALUE_AT_TIME, true);
+  counter.setFilter(filter);
+  counter.testAllCategories();
+  rv += SDK_ASSERT(numResults == 2);
+  rv += checkCounts(ds, filter, simData::ALL, counter.results());
+
+  // Restricting the object types restricts the counts
+  counter.setObjectTypes(simData::PLATFORM);
+  counter.testAllCategories();
+  rv += checkCounts(ds, filter, simData::PLATFORM, counter.results());
+  counter.setObjectTypes(simData::BEAM);
+  counter.testAllCategories();
+  rv += checkCounts(ds, filter, simData::BEAM, counter.results());
+
+  // Values added after prepare() are not counted
+  const int lateValue = nameManager.addCategoryValue(cat0, "Late");
+  counter.testAllCategories();
+  const simQt::CategoryCountResults::ValueToCountMap& cat0Counts = counter.results().allCategories.find(cat0)->second;
+  rv += SDK_ASSERT(cat0Counts.find(lateValue) == cat0Counts.end());
+  return rv;
+}
+
+int testCancel()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  fillDataStore(ds, 20);
+  simData::CategoryFilter filter(&ds);
+
+  // Canceling before the count stops it before the first category
+  {
+    simQt::CategoryFilterCounter counter;
+    int numResults = 0;
+    int numPartials = 0;
+    QObject::connect(&counter, &simQt::CategoryFilterCounter::resultsReady, [&numResults]() { ++numResults; });
+    QObject::connect(&counter, &simQt::CategoryFilterCounter::partialResultsReady, [&numPartials]() { ++numPartials; });
+    counter.setFilter(filter);
+    counter.setPartialResultsInterval(0);
+    rv += SDK_ASSERT(!counter.isCanceled());
+    counter.cancel();
+    rv += SDK_ASSERT(counter.isCanceled());
+    counter.testAllCategories();
+    rv += SDK_ASSERT(numResults == 0);
+    rv += SDK_ASSERT(numPartials == 0);
+  }
+
+  // Canceling in the middle of the count stops it at the next category
+  {
+    simQt::CategoryFilterCounter counter;
+    int numResults = 0;
+    int numPartials = 0;
+    QObject::connect(&counter, &simQt::CategoryFilterCounter::resultsReady, [&numResults]() { ++numResults; });
+    QObject::connect(&counter, &simQt::CategoryFilterCounter::partialResultsReady, [&counter, &numPartials]() {
+      ++numPartials;
+      counter.cancel();
+    });
+    counter.setFilter(filter);
+    counter.setPartialResultsInterval(0);
+    counter.testAllCategories();
+    rv += SDK_ASSERT(counter.isCanceled());
+    rv += SDK_ASSERT(numResults == 0);
+    rv += SDK_ASSERT(numPartials == 1);
+  }
+  return rv;
+}
+
+int testPartialResults()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  fillDataStore(ds, 20);
+  simData::CategoryFilter filter(&ds);
+  filter.setValue(ds.categoryNameManager().nameToInt("Cat3"), ds.categoryNameManager().valueToInt("Value4"), true);
+
+  simQt::CategoryFilterCounter counter;
+  std::vector<simQt::CategoryCountResults> partials;
+  simQt::CategoryCountResults finalResults;
+  int numResults = 0;
+  QObject::connect(&counter, &simQt::CategoryFilterCounter::partialResultsReady, [&partials](const simQt::CategoryCountResults& results) {
+    partials.push_back(results);
+  });
+  QObject::connect(&counter, &simQt::CategoryFilterCounter::resultsReady, [&finalResults, &numResults](const simQt::CategoryCountResults& results) {
+    finalResults = results;
+    ++numResults;
+  });
+  counter.setFilter(filter);
+  counter.setPartialResultsInterval(0);
+  counter.testAllCategories();
+  rv += SDK_ASSERT(numResults == 1);
+  rv += checkCounts(ds, filter, simData::ALL, finalResults);
+
+  // Every category but the last streams out on its own, with the same counts as the final results
+  const simQt::CategoryCountResults::AllCategories& all = finalResults.allCategories;
+  rv += SDK_ASSERT(all.size() == NUM_CATEGORIES);
+  rv += SDK_ASSERT(partials.size() == all.size() - 1);
+  simQt::CategoryCountResults::AllCategories streamed;
+  for (const auto& partial : partials)
+  {
+    rv += SDK_ASSERT(partial.allCategories.size() == 1);
+    streamed.insert(partial.allCategories.begin(), partial.allCategories.end());
+  }
+  rv += SDK_ASSERT(streamed.size() == partials.size());
+  rv += SDK_ASSERT(streamed.find(all.rbegin()->first) == streamed.end());
+  for (const auto& category : streamed)
+  {
+    auto finalIter = all.find(category.first);
+    rv += SDK_ASSERT(finalIter != all.end() && finalIter->second == category.second);
+  }
+  return rv;
+}
+
+}
+
+int CategoryFilterCounterTest(int argc, char* argv[])
+{
+  int rv = 0;
+  QCoreApplication app(argc, argv);
+  rv += testCounts();
+  rv += testCancel();
+  rv += testPartialResults();
+  return rv;
+}
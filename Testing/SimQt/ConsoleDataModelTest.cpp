@@ -0,0 +1,403 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <utility>
+#include <vector>
+#include <QCoreApplication>
+#include "simCore/Common/SDKAssert.h"
+#include "simQt/ConsoleDataModel.h"
+
+using simQt::ConsoleDataModel;
+
+namespace {
+
+/** First and last rows of a sequence of row signals */
+typedef std::vector<std::pair<int, int> > RowRanges;
+
+/** Rows of each structural signal emitted by a model */
+struct SignalLog
+{
+  RowRanges inserted;
+  RowRanges removed;
+  int resets = 0;
+  int dataChanges = 0;
+
+  void clear()
+  {
+    inserted.clear();
+    removed.clear();
+    resets = 0;
+    dataChanges = 0;
+  }
+};
+
+void connectLog(const QAbstractItemModel& model, SignalLog& log)
+{
+  QObject::connect(&model, &QAbstractItemModel::rowsInserted, [&log](const QModelIndex&, int first, int last) { log.inserted.push_back(std::make_pair(first, last)); });
+  QObject::connect(&model, &QAbstractItemModel::rowsRemoved, [&log](const QModelIndex&, int first, int last) { log.removed.push_back(std::make_pair(first, last)); });
+  QObject::connect(&model, &QAbstractItemModel::modelReset, [&log]() { ++log.resets; });
+  QObject::connect(&model, &QAbstractItemModel::dataChanged, [&log]() { ++log.dataChanges; });
+}
+
+/** Pending lines are added to the model on a timer; add them now instead of waiting */
+void processPending(ConsoleDataModel& model)
+{
+  QMetaObject::invokeMethod(&model, "processPendingAdds_", Qt::DirectConnection);
+}
+
+QString lineText(int number)
+{
+  return QString("Line %1").arg(number);
+}
+
+/** Adds lines "Line first" through "Line first + count - 1" */
+void addLines(ConsoleDataModel& model, int first, int count, simNotify::NotifySeverity severity = simNotify::NOTIFY_INFO)
+{
+  for (int k = first; k < first + count; ++k)
+    model.addEntry(severity, "Test", lineText(k));
+}
+
+QString textAt(const ConsoleDataModel& model, int row)
+{
+  return model.data(model.index(row, ConsoleDataModel::COLUMN_TEXT, QModelIndex()), Qt::DisplayRole).toString();
+}
+
+/** Verifies the rows hold the numbered lines, oldest first, in the order required by newestOnTop() */
+int checkLines(const ConsoleDataModel& model, const std::vector<int>& numbers)
+{
+  int rv = 0;
+  const int rows = model.rowCount(QModelIndex());
+  rv += SDK_ASSERT(rows == static_cast<int>(numbers.size()));
+  if (rows != static_cast<int>(numbers.size()))
+    return rv;
+  for (int row = 0; row < rows; ++row)
+  {
+    const int position = model.newestOnTop() ? (rows - row - 1) : row;
+    rv += SDK_ASSERT(textAt(model, row) == lineText(numbers[position]));
+  }
+  return rv;
+}
+
+/** Returns the numbers from first through last */
+std::vector<int> range(int first, int last)
+{
+  std::vector<int> numbers;
+  for (int k = first; k <= last; ++k)
+    numbers.push_back(k);
+  return numbers;
+}
+
+int testRingWraparound()
+{
+  int rv = 0;
+  ConsoleDataModel model;
+  model.setNumLines(5);
+  SignalLog log;
+  connectLog(model, log);
+
+  addLines(model, 0, 3);
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == 0);
+  processPending(model);
+  rv += checkLines(model, range(0, 2));
+  rv += SDK_ASSERT(log.inserted == RowRanges({ { 0, 2 } }));
+  rv += SDK_ASSERT(log.removed.empty());
+
+  // Overflow evicts the oldest rows, then appends the new rows
+  log.clear();
+  addLines(model, 3, 4);
+  processPending(model);
+  rv += checkLines(model, range(2, 6));
+  rv += SDK_ASSERT(log.removed == RowRanges({ { 0, 1 } }));
+  rv += SDK_ASSERT(log.inserted == RowRanges({ { 1, 4 } }));
+
+  // Wrap around the end of the ring several times, in batches of different sizes
+  int next = 7;
+  for (int batch : { 1, 5, 3, 2, 4, 5, 1 })
+  {
+    addLines(model, next, batch);
+    next += batch;
+    processPending(model);
+    rv += checkLines(model, range(next - 5, next - 1));
+  }
+
+  // More pending lines than the model holds keep only the newest
+  addLines(model, next, 12);
+  next += 12;
+  processPending(model);
+  rv += checkLines(model, range(next - 5, next - 1));
+
+  model.clear();
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == 0);
+  addLines(model, next, 2);
+  processPending(model);
+  rv += checkLines(model, range(next, next + 1));
+  return rv;
+}
+
+int testNewestOnTop()
+{
+  int rv = 0;
+  for (bool newestOnTop : { false, true })
+  {
+    ConsoleDataModel model;
+    model.setNumLines(5);
+    model.setNewestOnTop(newestOnTop);
+    SignalLog log;
+    connectLog(model, log);
+
+    addLines(model, 0, 5);
+    processPending(model);
+    rv += checkLines(model, range(0, 4));
+    rv += SDK_ASSERT(log.inserted == RowRanges({ { 0, 4 } }));
+
+    // Oldest rows are at the bottom when newest is on top
+    log.clear();
+    addLines(model, 5, 2);
+    processPending(model);
+    rv += checkLines(model, range(2, 6));
+    if (newestOnTop)
+    {
+      rv += SDK_ASSERT(textAt(model, 0) == lineText(6));
+      rv += SDK_ASSERT(log.removed == RowRanges({ { 3, 4 } }));
+      rv += SDK_ASSERT(log.inserted == RowRanges({ { 0, 1 } }));
+    }
+    else
+    {
+      rv += SDK_ASSERT(textAt(model, 0) == lineText(2));
+      rv += SDK_ASSERT(log.removed == RowRanges({ { 0, 1 } }));
+      rv += SDK_ASSERT(log.inserted == RowRanges({ { 3, 4 } }));
+    }
+
+    // Shrinking removes the oldest rows
+    log.clear();
+    model.setNumLines(2);
+    rv += checkLines(model, range(5, 6));
+    if (newestOnTop)
+      rv += SDK_ASSERT(log.removed == RowRanges({ { 2, 4 } }));
+    else
+      rv += SDK_ASSERT(log.removed == RowRanges({ { 0, 2 } }));
+
+    // Changing the order resets the model
+    log.clear();
+    model.setNewestOnTop(!newestOnTop);
+    rv += SDK_ASSERT(log.resets == 1);
+    rv += checkLines(model, range(5, 6));
+  }
+  return rv;
+}
+
+int testNumLines()
+{
+  int rv = 0;
+  ConsoleDataModel model;
+  model.setNumLines(10);
+  rv += SDK_ASSERT(model.numLines() == 10);
+  SignalLog log;
+  connectLog(model, log);
+
+  // Wrap the ring before resizing it
+  addLines(model, 0, 7);
+  processPending(model);
+  addLines(model, 7, 6);
+  processPending(model);
+  rv += checkLines(model, range(3, 12));
+
+  // Shrink keeps the newest lines
+  log.clear();
+  model.setNumLines(4);
+  rv += SDK_ASSERT(model.numLines() == 4);
+  rv += checkLines(model, range(9, 12));
+  rv += SDK_ASSERT(log.removed == RowRanges({ { 0, 5 } }));
+
+  // Grow keeps all lines, then fills up to the new size
+  log.clear();
+  model.setNumLines(8);
+  rv += checkLines(model, range(9, 12));
+  rv += SDK_ASSERT(log.removed.empty() && log.inserted.empty() && log.resets == 0);
+  addLines(model, 13, 3);
+  processPending(model);
+  rv += checkLines(model, range(9, 15));
+  addLines(model, 16, 3);
+  processPending(model);
+  rv += checkLines(model, range(11, 18));
+
+  // Shrink also limits the pending lines
+  addLines(model, 19, 6);
+  model.setNumLines(3);
+  rv += checkLines(model, range(16, 18));
+  processPending(model);
+  rv += checkLines(model, range(22, 24));
+
+  // Invalid sizes are ignored
+  model.setNumLines(0);
+  rv += SDK_ASSERT(model.numLines() == 3);
+  return rv;
+}
+
+int testRepeats()
+{
+  int rv = 0;
+  ConsoleDataModel model;
+  model.setSpamFilterTimeout(60.0);
+  SignalLog log;
+  connectLog(model, log);
+
+  // Repeats are counted against the earlier pending line
+  model.addEntry(simNotify::NOTIFY_INFO, "Test", "Repeated");
+  model.addEntry(simNotify::NOTIFY_INFO, "Test", "Repeated");
+  model.addEntry(simNotify::NOTIFY_INFO, "Test", "Other");
+  model.addEntry(simNotify::NOTIFY_INFO, "Test", "Repeated");
+  // Same text on another channel is not a repeat
+  model.addEntry(simNotify::NOTIFY_INFO, "Second", "Repeated");
+  processPending(model);
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == 3);
+  rv += SDK_ASSERT(textAt(model, 0) == "Repeated (x3)");
+  rv += SDK_ASSERT(textAt(model, 1) == "Other");
+  rv += SDK_ASSERT(textAt(model, 2) == "Repeated");
+  const QModelIndex first = model.index(0, ConsoleDataModel::COLUMN_TEXT, QModelIndex());
+  rv += SDK_ASSERT(model.data(first, ConsoleDataModel::REPEAT_COUNT_ROLE).toInt() == 3);
+  rv += SDK_ASSERT(model.data(model.index(1, ConsoleDataModel::COLUMN_TEXT, QModelIndex()), ConsoleDataModel::REPEAT_COUNT_ROLE).toInt() == 1);
+  // Repeat count applies regardless of column
+  rv += SDK_ASSERT(model.data(model.index(0, ConsoleDataModel::COLUMN_TIME, QModelIndex()), ConsoleDataModel::REPEAT_COUNT_ROLE).toInt() == 3);
+
+  // Repeats of a line already in the model update it with the next batch
+  log.clear();
+  model.addEntry(simNotify::NOTIFY_INFO, "Test", "Repeated");
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == 3);
+  processPending(model);
+  rv += SDK_ASSERT(log.dataChanges == 1);
+  rv += SDK_ASSERT(log.inserted.empty());
+  rv += SDK_ASSERT(textAt(model, 0) == "Repeated (x4)");
+  rv += SDK_ASSERT(model.data(first, ConsoleDataModel::REPEAT_COUNT_ROLE).toInt() == 4);
+
+  // Without the spam filter, every line is added
+  model.setSpamFilterTimeout(0.0);
+  model.addEntry(simNotify::NOTIFY_INFO, "Test", "Other");
+  processPending(model);
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == 4);
+  rv += SDK_ASSERT(textAt(model, 3) == "Other");
+
+  // Evicted lines no longer collect repeats
+  model.setSpamFilterTimeout(60.0);
+  model.setNumLines(4);
+  model.addEntry(simNotify::NOTIFY_INFO, "Test", "New");
+  processPending(model);
+  rv += SDK_ASSERT(textAt(model, 0) == "Other");
+  model.addEntry(simNotify::NOTIFY_INFO, "Test", "Repeated");
+  processPending(model);
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == 4);
+  rv += SDK_ASSERT(textAt(model, 3) == "Repeated");
+  rv += SDK_ASSERT(model.data(model.index(3, ConsoleDataModel::COLUMN_TEXT, QModelIndex()), ConsoleDataModel::REPEAT_COUNT_ROLE).toInt() == 1);
+
+  // Clearing also forgets the lines
+  model.clear();
+  model.addEntry(simNotify::NOTIFY_INFO, "Test", "New");
+  processPending(model);
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == 1);
+  rv += SDK_ASSERT(textAt(model, 0) == "New");
+  return rv;
+}
+
+/** Severity of line number k in testMinimumSeverity() */
+simNotify::NotifySeverity severityOf(int k)
+{
+  switch (k % 3)
+  {
+  case 0:
+    return simNotify::NOTIFY_INFO;
+  case 1:
+    return simNotify::NOTIFY_WARN;
+  }
+  return simNotify::NOTIFY_ERROR;
+}
+
+int testMinimumSeverity()
+{
+  int rv = 0;
+  ConsoleDataModel model;
+  model.setNumLines(6);
+  SignalLog log;
+  connectLog(model, log);
+
+  // Wrap the ring with mixed severities
+  for (int k = 0; k < 10; ++k)
+  {
+    addLines(model, k, 1, severityOf(k));
+    if (k == 3)
+      processPending(model);
+  }
+  processPending(model);
+  rv += checkLines(model, range(4, 9));
+
+  // Less severe messages are dropped on entry
+  addLines(model, 10, 1, simNotify::NOTIFY_DEBUG_INFO);
+  processPending(model);
+  rv += checkLines(model, range(4, 9));
+
+  // Raising the minimum severity removes lines from the model and from the pending lines
+  addLines(model, 11, 1, simNotify::NOTIFY_INFO);
+  addLines(model, 12, 1, simNotify::NOTIFY_WARN);
+  log.clear();
+  model.setMinimumSeverity(simNotify::NOTIFY_WARN);
+  rv += SDK_ASSERT(log.resets == 1);
+  rv += checkLines(model, { 4, 5, 7, 8 });
+  rv += SDK_ASSERT(model.data(model.index(0, ConsoleDataModel::COLUMN_TEXT, QModelIndex()), ConsoleDataModel::SEVERITY_ROLE).toInt() == simNotify::NOTIFY_WARN);
+  rv += SDK_ASSERT(model.data(model.index(1, ConsoleDataModel::COLUMN_TEXT, QModelIndex()), ConsoleDataModel::SEVERITY_ROLE).toInt() == simNotify::NOTIFY_ERROR);
+  processPending(model);
+  rv += checkLines(model, { 4, 5, 7, 8, 12 });
+
+  // Compacted ring keeps working as it fills and wraps
+  addLines(model, 13, 3, simNotify::NOTIFY_ERROR);
+  processPending(model);
+  rv += checkLines(model, { 7, 8, 12, 13, 14, 15 });
+
+  // Raising again removes the warnings; repeating the call does nothing
+  log.clear();
+  model.setMinimumSeverity(simNotify::NOTIFY_ERROR);
+  model.setMinimumSeverity(simNotify::NOTIFY_ERROR);
+  rv += SDK_ASSERT(log.resets == 1);
+  rv += checkLines(model, { 8, 13, 14, 15 });
+
+  // Lowering the minimum severity does not bring lines back, and does not reset
+  log.clear();
+  model.setMinimumSeverity(simNotify::NOTIFY_INFO);
+  rv += SDK_ASSERT(log.resets == 0);
+  rv += checkLines(model, { 8, 13, 14, 15 });
+  addLines(model, 16, 1, simNotify::NOTIFY_INFO);
+  processPending(model);
+  rv += checkLines(model, { 8, 13, 14, 15, 16 });
+  return rv;
+}
+
+}
+
+int ConsoleDataModelTest(int argc, char* argv[])
+{
+  int rv = 0;
+  QCoreApplication app(argc, argv);
+  rv += testRingWraparound();
+  rv += testNewestOnTop();
+  rv += testNumLines();
+  rv += testRepeats();
+  rv += testMinimumSeverity();
+  return rv;
+}
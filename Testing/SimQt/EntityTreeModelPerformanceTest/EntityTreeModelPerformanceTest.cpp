@@ -0,0 +1,134 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include "simData/MemoryDataStore.h"
+#include "simQt/EntityTreeModel.h"
+
+namespace {
+
+/** Default number of platforms; each platform gets one beam */
+static const int DEFAULT_NUM_PLATFORMS = 20000;
+
+uint64_t addPlatform(simData::DataStore& ds)
+{
+  simData::DataStore::Transaction t;
+  simData::PlatformProperties* props = ds.addPlatform(&t);
+  const uint64_t id = props->id();
+  t.commit();
+  return id;
+}
+
+uint64_t addBeam(simData::DataStore& ds, uint64_t hostId)
+{
+  simData::DataStore::Transaction t;
+  simData::BeamProperties* props = ds.addBeam(&t);
+  props->set_hostid(hostId);
+  const uint64_t id = props->id();
+  t.commit();
+  return id;
+}
+
+/** Advances the data store time, which commits the queued model changes; returns the elapsed time in ms */
+double advanceTime(simData::DataStore& ds)
+{
+  QElapsedTimer timer;
+  timer.start();
+  ds.update(ds.updateTime() + 1.0);
+  return timer.nsecsElapsed() * 1e-6;
+}
+
+/** Rebuilds the model from the data store; returns the elapsed time in ms */
+double refresh(simQt::EntityTreeModel& model)
+{
+  QElapsedTimer timer;
+  timer.start();
+  model.forceRefresh();
+  return timer.nsecsElapsed() * 1e-6;
+}
+
+void report(const std::string& name, double updateMs, double refreshMs)
+{
+  std::cout << "  " << name << ": " << updateMs << " ms, full rebuild " << refreshMs << " ms" << std::endl;
+}
+
+/** Creates a model with the given number of platforms and beams, times the adds, then runs the removal */
+template <typename RemoveFn>
+void timeRemoval(int numPlatforms, const std::string& name, RemoveFn removeFn)
+{
+  simData::MemoryDataStore ds;
+  simQt::EntityTreeModel model(nullptr, &ds);
+  model.setToTreeView();
+  // First add resets an empty model; only later adds are inserted
+  addPlatform(ds);
+  advanceTime(ds);
+
+  std::vector<uint64_t> platformIds;
+  for (int k = 0; k < numPlatforms; ++k)
+  {
+    platformIds.push_back(addPlatform(ds));
+    addBeam(ds, platformIds.back());
+  }
+  const double addMs = advanceTime(ds);
+  report("Add " + std::to_string(numPlatforms) + " platforms with beams", addMs, refresh(model));
+
+  const size_t numRemoved = removeFn(ds, platformIds);
+  const double removeMs = advanceTime(ds);
+  report("Remove " + std::to_string(numRemoved) + " platforms, " + name, removeMs, refresh(model));
+}
+
+}
+
+/**
+ * Times EntityTreeModel updates for bulk adds and for contiguous, lightly scattered and heavily
+ * scattered removals, each next to a full rebuild of the model with forceRefresh().
+ * Usage: EntityTreeModelPerformanceTest [numPlatforms]
+ */
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  const int numPlatforms = (argc > 1) ? std::max(100, atoi(argv[1])) : DEFAULT_NUM_PLATFORMS;
+  std::cout << "EntityTreeModel with " << numPlatforms << " platforms:" << std::endl;
+
+  timeRemoval(numPlatforms, "contiguous", [](simData::DataStore& ds, const std::vector<uint64_t>& ids) {
+    for (size_t k = 0; k < ids.size() / 2; ++k)
+      ds.removeEntity(ids[k]);
+    return ids.size() / 2;
+  });
+  timeRemoval(numPlatforms, "10 regions", [](simData::DataStore& ds, const std::vector<uint64_t>& ids) {
+    for (size_t k = 0; k < 10; ++k)
+      ds.removeEntity(ids[k * ids.size() / 10]);
+    return static_cast<size_t>(10);
+  });
+  timeRemoval(numPlatforms, "every other one", [](simData::DataStore& ds, const std::vector<uint64_t>& ids) {
+    for (size_t k = 0; k < ids.size(); k += 2)
+      ds.removeEntity(ids[k]);
+    return (ids.size() + 1) / 2;
+  });
+  return 0;
+}
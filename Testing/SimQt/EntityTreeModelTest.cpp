@@ -0,0 +1,218 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <vector>
+#include <QCoreApplication>
+#include "simCore/Common/SDKAssert.h"
+#include "simData/MemoryDataStore.h"
+#include "simQt/EntityTreeModel.h"
+
+namespace {
+
+/** Number of platforms used by the bulk tests; each platform gets one beam */
+static const int NUM_PLATFORMS = 4000;
+
+/** Counts the structural signals emitted by a model */
+struct SignalCounts
+{
+  int inserts = 0;
+  int removes = 0;
+  int resets = 0;
+};
+
+void connectCounts(const QAbstractItemModel& model, SignalCounts& counts)
+{
+  QObject::connect(&model, &QAbstractItemModel::rowsInserted, [&counts]() { ++counts.inserts; });
+  QObject::connect(&model, &QAbstractItemModel::rowsRemoved, [&counts]() { ++counts.removes; });
+  QObject::connect(&model, &QAbstractItemModel::modelReset, [&counts]() { ++counts.resets; });
+}
+
+uint64_t addPlatform(simData::DataStore& ds)
+{
+  simData::DataStore::Transaction t;
+  simData::PlatformProperties* props = ds.addPlatform(&t);
+  const uint64_t id = props->id();
+  t.commit();
+  return id;
+}
+
+uint64_t addBeam(simData::DataStore& ds, uint64_t hostId)
+{
+  simData::DataStore::Transaction t;
+  simData::BeamProperties* props = ds.addBeam(&t);
+  props->set_hostid(hostId);
+  const uint64_t id = props->id();
+  t.commit();
+  return id;
+}
+
+/** Advances the data store time, which commits the queued model changes */
+void advanceTime(simData::DataStore& ds)
+{
+  ds.update(ds.updateTime() + 1.0);
+}
+
+/** Verifies that every row of the model maps back to itself through the ID index */
+int checkIndexes(const simQt::EntityTreeModel& model, const QModelIndex& parent)
+{
+  int rv = 0;
+  const int rows = model.rowCount(parent);
+  for (int row = 0; row < rows; ++row)
+  {
+    const QModelIndex index = model.index(row, 0, parent);
+    const QModelIndex byId = model.index(model.uniqueId(index));
+    rv += SDK_ASSERT(byId == index);
+    rv += SDK_ASSERT(model.parent(index) == parent);
+    rv += checkIndexes(model, index);
+  }
+  return rv;
+}
+
+int testBulkAddAndRemove()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  simQt::EntityTreeModel model(nullptr, &ds);
+  model.setToTreeView();
+
+  // Adding to an empty model resets it
+  const uint64_t firstId = addPlatform(ds);
+  advanceTime(ds);
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == 1);
+
+  SignalCounts counts;
+  connectCounts(model, counts);
+
+  // New platforms and their new beams go in with a single insertion
+  std::vector<uint64_t> platformIds;
+  std::vector<uint64_t> beamIds;
+  for (int k = 0; k < NUM_PLATFORMS; ++k)
+  {
+    platformIds.push_back(addPlatform(ds));
+    beamIds.push_back(addBeam(ds, platformIds.back()));
+  }
+  advanceTime(ds);
+  rv += SDK_ASSERT(counts.inserts == 1);
+  rv += SDK_ASSERT(counts.resets == 0);
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == NUM_PLATFORMS + 1);
+  rv += SDK_ASSERT(model.countEntityTypes(simData::BEAM) == NUM_PLATFORMS);
+  rv += SDK_ASSERT(model.index(beamIds.back()).parent() == model.index(platformIds.back()));
+
+  // New beams on existing platforms go in with one insertion per platform
+  counts = SignalCounts();
+  addBeam(ds, firstId);
+  addBeam(ds, firstId);
+  addBeam(ds, platformIds.front());
+  advanceTime(ds);
+  rv += SDK_ASSERT(counts.inserts == 2);
+  rv += SDK_ASSERT(model.rowCount(model.index(firstId)) == 2);
+  rv += SDK_ASSERT(model.rowCount(model.index(platformIds.front())) == 2);
+  rv += checkIndexes(model, QModelIndex());
+
+  // A few scattered platforms are removed with one signal pair per region
+  counts = SignalCounts();
+  ds.removeEntity(platformIds[10]);
+  ds.removeEntity(platformIds[20]);
+  ds.removeEntity(platformIds[22]);
+  advanceTime(ds);
+  rv += SDK_ASSERT(counts.resets == 0);
+  // Beams are removed along with their host, without signals of their own
+  rv += SDK_ASSERT(counts.removes == 3);
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == NUM_PLATFORMS - 2);
+  rv += SDK_ASSERT(!model.index(beamIds[20]).isValid());
+  rv += SDK_ASSERT(model.index(beamIds[21]).parent() == model.index(platformIds[21]));
+  rv += checkIndexes(model, QModelIndex());
+
+  // Remove the rest of every other platform; too many regions to signal, so the model resets once
+  counts = SignalCounts();
+  for (size_t k = 0; k < platformIds.size(); k += 2)
+    ds.removeEntity(platformIds[k]);
+  advanceTime(ds);
+  rv += SDK_ASSERT(counts.resets == 1);
+  rv += SDK_ASSERT(counts.removes == 0);
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == NUM_PLATFORMS / 2 + 1);
+  rv += SDK_ASSERT(model.countEntityTypes(simData::BEAM) == NUM_PLATFORMS / 2 + 2);
+  rv += SDK_ASSERT(!model.index(platformIds.front()).isValid());
+  rv += SDK_ASSERT(!model.index(beamIds.front()).isValid());
+  rv += SDK_ASSERT(model.index(beamIds[1]).parent() == model.index(platformIds[1]));
+  rv += checkIndexes(model, QModelIndex());
+
+  // Compare against a full rebuild of the remaining entities
+  model.forceRefresh();
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == NUM_PLATFORMS / 2 + 1);
+  rv += checkIndexes(model, QModelIndex());
+
+  // Removing everything under a platform, and an entire list, still works
+  counts = SignalCounts();
+  ds.removeEntity(beamIds[1]);
+  advanceTime(ds);
+  rv += SDK_ASSERT(counts.removes == 1);
+  rv += SDK_ASSERT(model.rowCount(model.index(platformIds[1])) == 0);
+  for (size_t k = 1; k < platformIds.size(); k += 2)
+    ds.removeEntity(platformIds[k]);
+  ds.removeEntity(firstId);
+  advanceTime(ds);
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == 0);
+  rv += SDK_ASSERT(counts.resets == 0);
+
+  return rv;
+}
+
+int testListView()
+{
+  int rv = 0;
+  simData::MemoryDataStore ds;
+  simQt::EntityTreeModel model(nullptr, &ds);
+  model.setToListView();
+  addPlatform(ds);
+  advanceTime(ds);
+
+  SignalCounts counts;
+  connectCounts(model, counts);
+  const uint64_t platformId = addPlatform(ds);
+  const uint64_t beamId = addBeam(ds, platformId);
+  advanceTime(ds);
+
+  // All entities are top level, inserted together
+  rv += SDK_ASSERT(counts.inserts == 1);
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == 3);
+  rv += SDK_ASSERT(!model.index(beamId).parent().isValid());
+  rv += checkIndexes(model, QModelIndex());
+
+  ds.removeEntity(platformId);
+  advanceTime(ds);
+  rv += SDK_ASSERT(model.rowCount(QModelIndex()) == 1);
+  rv += SDK_ASSERT(!model.index(beamId).isValid());
+  rv += SDK_ASSERT(counts.resets == 0);
+  return rv;
+}
+
+}
+
+int EntityTreeModelTest(int argc, char* argv[])
+{
+  int rv = 0;
+  QCoreApplication app(argc, argv);
+  rv += testBulkAddAndRemove();
+  rv += testListView();
+  return rv;
+}
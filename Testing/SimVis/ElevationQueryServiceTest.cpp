@@ -0,0 +1,240 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "osg/HeightField"
+#include "osgEarth/ElevationLayer"
+#include "osgEarth/Map"
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Common/Version.h"
+#include "simCore/Calc/Math.h"
+#include "simVis/ElevationQueryService.h"
+
+namespace
+{
+
+/// Synthetic terrain height in meters; a plane so that interpolation between posts is exact
+double planeHeight(double lonDeg, double latDeg)
+{
+  return 100.0 + 20.0 * lonDeg + 10.0 * latDeg;
+}
+
+/** Synthetic elevation layer with heights from planeHeight(), plus an offset */
+class PlaneElevationLayer : public osgEarth::ElevationLayer
+{
+public:
+  explicit PlaneElevationLayer(double offset = 0.0)
+    : osgEarth::ElevationLayer(),
+      offset_(offset),
+      held_(false),
+      numStarted_(0)
+  {
+  }
+
+  /** Makes tile creation wait until release() */
+  void hold() { held_ = true; }
+  /** Lets held tile creation continue */
+  void release() { held_ = false; }
+  /** Number of tiles whose creation has started */
+  int numStarted() const { return numStarted_; }
+
+  virtual osgEarth::Status openImplementation() override
+  {
+    const osgEarth::Status parent = osgEarth::ElevationLayer::openImplementation();
+    if (parent.isError())
+      return parent;
+    setProfile(osgEarth::Profile::create(osgEarth::Profile::GLOBAL_GEODETIC));
+    return osgEarth::Status::NoError;
+  }
+
+  virtual osgEarth::GeoHeightField createHeightFieldImplementation(const osgEarth::TileKey& key, osgEarth::ProgressCallback* progress) const override
+  {
+    ++numStarted_;
+    while (held_)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    const unsigned int size = 33;
+    const osgEarth::GeoExtent& extent = key.getExtent();
+    osg::ref_ptr<osg::HeightField> hf = new osg::HeightField();
+    hf->allocate(size, size);
+    for (unsigned int col = 0; col < size; ++col)
+    {
+      for (unsigned int row = 0; row < size; ++row)
+      {
+        const double lon = extent.xMin() + extent.width() * col / (size - 1);
+        const double lat = extent.yMin() + extent.height() * row / (size - 1);
+        hf->setHeight(col, row, static_cast<float>(planeHeight(lon, lat) + offset_));
+      }
+    }
+    return osgEarth::GeoHeightField(hf.get(), extent);
+  }
+
+private:
+  double offset_;
+  std::atomic<bool> held_;
+  mutable std::atomic<int> numStarted_;
+};
+
+/** Grid of points around the given center, in degrees */
+std::vector<osgEarth::GeoPoint> makePoints(const osgEarth::Map* map, double lonDeg, double latDeg, int count)
+{
+  std::vector<osgEarth::GeoPoint> points;
+  for (int i = 0; i < count; ++i)
+  {
+    for (int j = 0; j < count; ++j)
+      points.push_back(osgEarth::GeoPoint(map->getSRS()->getGeographicSRS(), lonDeg + 0.01 * i, latDeg + 0.01 * j, 0.0, osgEarth::ALTMODE_ABSOLUTE));
+  }
+  return points;
+}
+
+int checkResults(const std::vector<osgEarth::GeoPoint>& points, const simVis::ElevationQueryService::ResultVector& results, double offset = 0.0)
+{
+  int rv = 0;
+  rv += SDK_ASSERT(points.size() == results.size());
+  for (size_t k = 0; k < points.size() && k < results.size(); ++k)
+  {
+    rv += SDK_ASSERT(results[k].valid);
+    rv += SDK_ASSERT(simCore::areEqual(results[k].elevation_m, planeHeight(points[k].x(), points[k].y()) + offset, 0.5));
+  }
+  return rv;
+}
+
+int testBatch(const osgEarth::Map* map)
+{
+  int rv = 0;
+  simVis::ElevationQueryService service(map, 4);
+  service.setMaxLevel(10);
+  const std::vector<osgEarth::GeoPoint> points = makePoints(map, 10.0, 20.0, 20);
+
+  // First batch fetches every tile; a repeat of the same points is served from the cache
+  rv += checkResults(points, service.query(points).get());
+  const simVis::ElevationQueryService::Statistics first = service.statistics();
+  rv += SDK_ASSERT(first.numBatches == 1);
+  rv += SDK_ASSERT(first.numPoints == points.size());
+  rv += SDK_ASSERT(first.tileHits == 0);
+  rv += SDK_ASSERT(first.tileMisses > 0);
+  // Tiles are de-duplicated, so there are far fewer tile lookups than points
+  rv += SDK_ASSERT(first.tileMisses < points.size());
+
+  rv += checkResults(points, service.query(points).get());
+  const simVis::ElevationQueryService::Statistics second = service.statistics();
+  rv += SDK_ASSERT(second.numBatches == 2);
+  rv += SDK_ASSERT(second.tileMisses == first.tileMisses);
+  rv += SDK_ASSERT(second.tileHits == first.tileMisses);
+  rv += SDK_ASSERT(simCore::areEqual(second.hitRate(), 0.5));
+  rv += SDK_ASSERT(second.maxLatency >= second.meanLatency);
+
+  service.resetStatistics();
+  rv += SDK_ASSERT(service.statistics().numBatches == 0);
+  service.clearCache();
+  rv += checkResults(points, service.query(points).get());
+  rv += SDK_ASSERT(service.statistics().tileHits == 0);
+  return rv;
+}
+
+int testConcurrentBatches(const osgEarth::Map* map)
+{
+  int rv = 0;
+  // Small cache forces evictions while batches run in parallel
+  simVis::ElevationQueryService service(map, 4, 4);
+  service.setMaxLevel(12);
+  std::vector<std::vector<osgEarth::GeoPoint> > batches;
+  std::vector<std::future<simVis::ElevationQueryService::ResultVector> > futures;
+  for (int k = 0; k < 8; ++k)
+  {
+    batches.push_back(makePoints(map, -40.0 + 10.0 * k, -30.0 + 5.0 * k, 10));
+    futures.push_back(service.query(batches.back()));
+  }
+  for (size_t k = 0; k < futures.size(); ++k)
+    rv += checkResults(batches[k], futures[k].get());
+
+  const simVis::ElevationQueryService::Statistics stats = service.statistics();
+  rv += SDK_ASSERT(stats.numBatches == batches.size());
+  std::cout << "ElevationQueryService: " << stats.numPoints << " points in " << stats.numBatches << " batches, hit rate "
+    << stats.hitRate() << ", mean latency " << stats.meanLatency * 1e3 << " ms, max latency " << stats.maxLatency * 1e3 << " ms\n";
+  return rv;
+}
+
+int testSetMapDuringBatch()
+{
+  int rv = 0;
+  osg::ref_ptr<PlaneElevationLayer> oldLayer = new PlaneElevationLayer();
+  osg::ref_ptr<osgEarth::Map> oldMap = new osgEarth::Map();
+  oldMap->addLayer(oldLayer.get());
+  osg::ref_ptr<osgEarth::Map> newMap = new osgEarth::Map();
+  newMap->addLayer(new PlaneElevationLayer(1000.0));
+
+  simVis::ElevationQueryService service(oldMap.get(), 2);
+  service.setMaxLevel(10);
+  const std::vector<osgEarth::GeoPoint> points = makePoints(oldMap.get(), 10.0, 20.0, 5);
+
+  // Replace the map while the batch is fetching tiles from the old one
+  oldLayer->hold();
+  std::future<simVis::ElevationQueryService::ResultVector> future = service.query(points);
+  while (oldLayer->numStarted() == 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  service.setMap(newMap.get());
+  oldLayer->release();
+  rv += checkResults(points, future.get());
+
+  // Tiles fetched for the old map must not answer queries for the new one
+  rv += checkResults(points, service.query(points).get(), 1000.0);
+  return rv;
+}
+
+int testNoMap(const osgEarth::Map* map)
+{
+  int rv = 0;
+  simVis::ElevationQueryService service(map, 1);
+  service.setMap(nullptr);
+  const std::vector<osgEarth::GeoPoint> points = makePoints(map, 0.0, 0.0, 2);
+  const simVis::ElevationQueryService::ResultVector results = service.query(points).get();
+  rv += SDK_ASSERT(results.size() == points.size());
+  for (const auto& result : results)
+    rv += SDK_ASSERT(!result.valid);
+  return rv;
+}
+
+}
+
+int ElevationQueryServiceTest(int argc, char* argv[])
+{
+  int rv = 0;
+
+  // Check the SIMDIS SDK version
+  simCore::checkVersionThrow();
+
+  osg::ref_ptr<osgEarth::Map> map = new osgEarth::Map();
+  map->addLayer(new PlaneElevationLayer());
+
+  // Run tests
+  rv += testBatch(map.get());
+  rv += testConcurrentBatches(map.get());
+  rv += testSetMapDuringBatch();
+  rv += testNoMap(map.get());
+
+  return rv;
+}
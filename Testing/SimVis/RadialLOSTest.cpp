@@ -0,0 +1,266 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code is in accompanying LICENSE.txt file. If you did
+ * not receive a LICENSE.txt with this code, email simdis@us.navy.mil.
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <chrono>
+#include <iostream>
+#include "osg/HeightField"
+#include "osgEarth/ElevationLayer"
+#include "osgEarth/Map"
+#include "osgEarth/MapNode"
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Common/Version.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Coordinate.h"
+#include "simCore/Calc/Math.h"
+#include "simVis/RadialLOS.h"
+
+namespace
+{
+
+/// Longitude range (deg) of a 500 m ridge, about 4 to 5 km east of the origin at 0,0
+const double RIDGE_MIN_LON = 0.036;
+const double RIDGE_MAX_LON = 0.045;
+const double RIDGE_HEIGHT = 500.0;
+
+/** Synthetic elevation layer: flat at 0 HAE except for a north-south ridge east of the origin */
+class RidgeElevationLayer : public osgEarth::ElevationLayer
+{
+public:
+  RidgeElevationLayer()
+    : osgEarth::ElevationLayer()
+  {
+  }
+
+  virtual osgEarth::Status openImplementation() override
+  {
+    const osgEarth::Status parent = osgEarth::ElevationLayer::openImplementation();
+    if (parent.isError())
+      return parent;
+    setProfile(osgEarth::Profile::create(osgEarth::Profile::GLOBAL_GEODETIC));
+    return osgEarth::Status::NoError;
+  }
+
+  virtual osgEarth::GeoHeightField createHeightFieldImplementation(const osgEarth::TileKey& key, osgEarth::ProgressCallback* progress) const override
+  {
+    const unsigned int size = 65;
+    const osgEarth::GeoExtent& extent = key.getExtent();
+    osg::ref_ptr<osg::HeightField> hf = new osg::HeightField();
+    hf->allocate(size, size);
+    for (unsigned int col = 0; col < size; ++col)
+    {
+      const double lon = extent.xMin() + extent.width() * col / (size - 1);
+      const float height = (lon >= RIDGE_MIN_LON && lon <= RIDGE_MAX_LON) ? static_cast<float>(RIDGE_HEIGHT) : 0.f;
+      for (unsigned int row = 0; row < size; ++row)
+        hf->setHeight(col, row, height);
+    }
+    return osgEarth::GeoHeightField(hf.get(), extent);
+  }
+};
+
+/** Returns the radial closest to the given azimuth, or nullptr if there are none */
+const simVis::RadialLOS::Radial* findRadial(const simVis::RadialLOS& los, double azimRad)
+{
+  const simVis::RadialLOS::Radial* best = nullptr;
+  double bestDiff = 0.0;
+  for (const auto& radial : los.getRadials())
+  {
+    const double diff = fabs(simCore::angFix2PI(radial.azim_rad_ - azimRad + M_PI) - M_PI);
+    if (!best || diff < bestDiff)
+    {
+      best = &radial;
+      bestDiff = diff;
+    }
+  }
+  return best;
+}
+
+/** Returns the sample closest to the given range, or nullptr if there are none */
+const simVis::RadialLOS::Sample* findSample(const simVis::RadialLOS::Radial& radial, double range)
+{
+  const simVis::RadialLOS::Sample* best = nullptr;
+  for (const auto& sample : radial.samples_)
+  {
+    if (!best || fabs(sample.range_m_ - range) < fabs(best->range_m_ - range))
+      best = &sample;
+  }
+  return best;
+}
+
+void configure(simVis::RadialLOS& los)
+{
+  los.setMaxRange(osgEarth::Distance(10.0, osgEarth::Units::KILOMETERS));
+  los.setRangeResolution(osgEarth::Distance(100.0, osgEarth::Units::METERS));
+  los.setAzimuthalResolution(osgEarth::Angle(5.0, osgEarth::Units::DEGREES));
+}
+
+simCore::Coordinate originAt(double eastMeters)
+{
+  // Roughly 111.32 km per degree of longitude on the equator
+  return simCore::Coordinate(simCore::COORD_SYS_LLA, simCore::Vec3(0.0, eastMeters / 111320.0 * simCore::DEG2RAD, 10.0));
+}
+
+int testRidge(osgEarth::MapNode* mapNode)
+{
+  int rv = 0;
+  simVis::RadialLOS los;
+  configure(los);
+  rv += SDK_ASSERT(los.compute(mapNode, originAt(0.0)));
+
+  // Looking west, the terrain is flat and everything is visible
+  const simVis::RadialLOS::Radial* west = findRadial(los, -M_PI_2);
+  rv += SDK_ASSERT(west != nullptr);
+  if (west)
+  {
+    rv += SDK_ASSERT(west->samples_.size() == los.getNumSamplesPerRadial());
+    for (const auto& sample : west->samples_)
+      rv += SDK_ASSERT(sample.valid_ && sample.visible_);
+  }
+
+  // Looking east, the ridge face is visible and the terrain behind it is not
+  const simVis::RadialLOS::Radial* east = findRadial(los, M_PI_2);
+  rv += SDK_ASSERT(east != nullptr);
+  if (east)
+  {
+    const simVis::RadialLOS::Sample* before = findSample(*east, 3000.0);
+    const simVis::RadialLOS::Sample* onRidge = findSample(*east, 4500.0);
+    const simVis::RadialLOS::Sample* behind = findSample(*east, 8000.0);
+    rv += SDK_ASSERT(before && before->visible_);
+    rv += SDK_ASSERT(onRidge && onRidge->visible_ && simCore::areEqual(onRidge->hae_m_, RIDGE_HEIGHT, 1.0));
+    rv += SDK_ASSERT(behind && !behind->visible_);
+  }
+  return rv;
+}
+
+int testThreadsMatchSerial(osgEarth::MapNode* mapNode)
+{
+  int rv = 0;
+  simVis::RadialLOS serial;
+  configure(serial);
+  rv += SDK_ASSERT(serial.compute(mapNode, originAt(0.0)));
+
+  simVis::RadialLOS threaded;
+  configure(threaded);
+  threaded.setComputeThreadCount(4);
+  rv += SDK_ASSERT(threaded.getComputeThreadCount() == 4);
+  rv += SDK_ASSERT(threaded.compute(mapNode, originAt(0.0)));
+
+  rv += SDK_ASSERT(serial.getRadials().size() == threaded.getRadials().size());
+  if (serial.getRadials().size() != threaded.getRadials().size())
+    return rv;
+  for (size_t k = 0; k < serial.getRadials().size(); ++k)
+  {
+    const simVis::RadialLOS::Radial& a = serial.getRadials()[k];
+    const simVis::RadialLOS::Radial& b = threaded.getRadials()[k];
+    rv += SDK_ASSERT(a.azim_rad_ == b.azim_rad_);
+    rv += SDK_ASSERT(a.samples_.size() == b.samples_.size());
+    for (size_t i = 0; i < a.samples_.size() && i < b.samples_.size(); ++i)
+    {
+      rv += SDK_ASSERT(a.samples_[i].hae_m_ == b.samples_[i].hae_m_);
+      rv += SDK_ASSERT(a.samples_[i].elev_rad_ == b.samples_[i].elev_rad_);
+      rv += SDK_ASSERT(a.samples_[i].visible_ == b.samples_[i].visible_);
+    }
+  }
+  return rv;
+}
+
+int testProfileReuse(osgEarth::MapNode* mapNode)
+{
+  int rv = 0;
+  simVis::RadialLOS los;
+  configure(los);
+  los.setProfileReuseDistance(osgEarth::Distance(10.0, osgEarth::Units::METERS));
+  rv += SDK_ASSERT(los.compute(mapNode, originAt(0.0)));
+  const simVis::RadialLOS::Radial* east = findRadial(los, M_PI_2);
+  rv += SDK_ASSERT(east != nullptr && !east->samples_.empty());
+  if (!east || east->samples_.empty())
+    return rv;
+  const double firstLon = east->samples_.front().point_.x();
+
+  // A small move reuses the sampled profile, but visibility is recomputed from the new origin
+  const double firstElev = east->samples_.front().elev_rad_;
+  rv += SDK_ASSERT(los.compute(mapNode, originAt(5.0)));
+  east = findRadial(los, M_PI_2);
+  rv += SDK_ASSERT(east->samples_.front().point_.x() == firstLon);
+  rv += SDK_ASSERT(east->samples_.front().elev_rad_ != firstElev);
+  const simVis::RadialLOS::Sample* behind = findSample(*east, 8000.0);
+  rv += SDK_ASSERT(behind && !behind->visible_);
+
+  // Drift is measured from where the profile was sampled, so a second small move resamples
+  rv += SDK_ASSERT(los.compute(mapNode, originAt(12.0)));
+  east = findRadial(los, M_PI_2);
+  rv += SDK_ASSERT(east->samples_.front().point_.x() != firstLon);
+
+  // Changing a setting always resamples
+  const double secondLon = east->samples_.front().point_.x();
+  los.setRangeResolution(osgEarth::Distance(50.0, osgEarth::Units::METERS));
+  rv += SDK_ASSERT(los.compute(mapNode, originAt(12.0)));
+  east = findRadial(los, M_PI_2);
+  rv += SDK_ASSERT(east->samples_.front().point_.x() != secondLon);
+  return rv;
+}
+
+/** Reports radials per second for full terrain sampling; informational only */
+void reportThroughput(osgEarth::MapNode* mapNode, unsigned int numThreads)
+{
+  simVis::RadialLOS los;
+  configure(los);
+  los.setAzimuthalResolution(osgEarth::Angle(1.0, osgEarth::Units::DEGREES));
+  los.setComputeThreadCount(numThreads);
+  // Origins 100 m apart never reuse profiles
+  los.setProfileReuseDistance(osgEarth::Distance(0.0, osgEarth::Units::METERS));
+
+  const int numComputes = 10;
+  size_t numRadials = 0;
+  const auto startTime = std::chrono::steady_clock::now();
+  for (int k = 0; k < numComputes; ++k)
+  {
+    los.compute(mapNode, originAt(100.0 * k));
+    numRadials += los.getRadials().size();
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+  std::cout << "RadialLOS with " << los.getComputeThreadCount() << " thread(s): "
+    << numRadials / simCore::sdkMax(elapsed.count(), 1e-9) << " radials/s\n";
+}
+
+}
+
+int RadialLOSTest(int argc, char* argv[])
+{
+  int rv = 0;
+
+  // Check the SIMDIS SDK version
+  simCore::checkVersionThrow();
+
+  osg::ref_ptr<osgEarth::Map> map = new osgEarth::Map();
+  map->addLayer(new RidgeElevationLayer());
+  osg::ref_ptr<osgEarth::MapNode> mapNode = new osgEarth::MapNode(map.get());
+
+  // Run tests
+  rv += testRidge(mapNode.get());
+  rv += testThreadsMatchSerial(mapNode.get());
+  rv += testProfileReuse(mapNode.get());
+
+  reportThroughput(mapNode.get(), 1);
+  reportThroughput(mapNode.get(), 0);
+
+  return rv;
+}